@@ -25,7 +25,10 @@ public class InlineCodeEditor : ModuleRules
             "WorkspaceMenuStructure",
             "ToolMenus",
             "EditorStyle",
-            "Projects"
+            "Projects",
+            "DirectoryWatcher",
+            "Json",
+            "ApplicationCore"
         });
     }
 }
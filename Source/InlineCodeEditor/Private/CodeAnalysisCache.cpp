@@ -0,0 +1,296 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeAnalysisCache.h"
+#include "Async/Async.h"
+#include "FCppSyntaxHighlighter.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeTryLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace CodeAnalysisCacheFormat {
+constexpr uint32 Magic = 0x43454349; // "ICEC"
+constexpr uint32 Version = 3;
+
+const TCHAR *Extension = TEXT(".icec");
+
+uint64 HashText(const FString &Text) {
+  return CityHash64(reinterpret_cast<const char *>(*Text),
+                    Text.Len() * sizeof(TCHAR));
+}
+} // namespace CodeAnalysisCacheFormat
+
+static TAutoConsoleVariable<int32> CVarICECacheMaxSizeMB(
+    TEXT("ICE.Cache.MaxSizeMB"), 256,
+    TEXT("Maximum size (MB) of the ICE analysis cache under Saved/ICE/Cache. ")
+        TEXT("Least recently used entries are evicted first."),
+    ECVF_Default);
+
+/**
+ * Entries of the cache directory, scanned once by the first worker writing
+ * to it and kept up to date since
+ */
+namespace CodeAnalysisCacheEntries {
+struct FEntry {
+  int64 Size = 0;
+  FDateTime LastUsed;
+};
+
+/** Guards the state below */
+FCriticalSection Lock;
+
+bool bScanned = false;
+TMap<FString, FEntry> Entries;
+int64 TotalBytes = 0;
+
+/** Scan the directory, if not done yet; with Lock held */
+void Scan(const FString &CacheDir) {
+  if (bScanned) {
+    return;
+  }
+  bScanned = true;
+  IFileManager::Get().IterateDirectoryStat(
+      *CacheDir, [](const TCHAR *Path, const FFileStatData &StatData) {
+        if (!StatData.bIsDirectory &&
+            FString(Path).EndsWith(CodeAnalysisCacheFormat::Extension)) {
+          Entries.Add(Path, {StatData.FileSize, StatData.ModificationTime});
+          TotalBytes += StatData.FileSize;
+        }
+        return true;
+      });
+}
+
+/** Forget an entry; with Lock held */
+void Remove(const FString &EntryPath) {
+  FEntry Entry;
+  if (Entries.RemoveAndCopyValue(EntryPath, Entry)) {
+    TotalBytes -= Entry.Size;
+  }
+}
+} // namespace CodeAnalysisCacheEntries
+
+/** Delete an entry that cannot be read, on a worker */
+static void DiscardEntry(const FString &EntryPath) {
+  Async(EAsyncExecution::ThreadPool, [EntryPath]() {
+    FScopeLock Lock(&CodeAnalysisCacheEntries::Lock);
+    IFileManager::Get().Delete(*EntryPath);
+    CodeAnalysisCacheEntries::Remove(EntryPath);
+  });
+}
+
+FString FCodeAnalysisCache::GetCacheDir() {
+  return FPaths::ProjectSavedDir() / TEXT("ICE") / TEXT("Cache");
+}
+
+FString FCodeAnalysisCache::GetEntryPath(uint64 ContentHash) {
+  return GetCacheDir() / FString::Printf(TEXT("%016llx"), ContentHash) +
+         CodeAnalysisCacheFormat::Extension;
+}
+
+TFuture<FCodeAnalysisCacheHit> FCodeAnalysisCache::Load(const FString &Text) {
+  return Async(EAsyncExecution::ThreadPool, [Text]() {
+    FCodeAnalysisCacheHit Hit;
+    if (!ReadEntry(Text, Hit)) {
+      return FCodeAnalysisCacheHit();
+    }
+    return Hit;
+  });
+}
+
+bool FCodeAnalysisCache::ReadEntry(const FString &Text,
+                                   FCodeAnalysisCacheHit &OutHit) {
+  const uint64 ContentHash = CodeAnalysisCacheFormat::HashText(Text);
+  const FString EntryPath = GetEntryPath(ContentHash);
+
+  TArray<uint8> Bytes;
+  if (!IFileManager::Get().FileExists(*EntryPath) ||
+      !FFileHelper::LoadFileToArray(Bytes, *EntryPath)) {
+    return false;
+  }
+
+  // [Magic][Version][ContentHash][TextLength][PayloadCrc][Payload]
+  FMemoryReader Reader(Bytes);
+  uint32 Magic = 0;
+  uint32 Version = 0;
+  uint64 StoredHash = 0;
+  int32 TextLength = 0;
+  uint32 PayloadCrc = 0;
+  Reader << Magic << Version << StoredHash << TextLength << PayloadCrc;
+
+  const int64 PayloadStart = Reader.Tell();
+  const bool bValid =
+      !Reader.IsError() && Magic == CodeAnalysisCacheFormat::Magic &&
+      Version == CodeAnalysisCacheFormat::Version &&
+      StoredHash == ContentHash && TextLength == Text.Len() &&
+      FCrc::MemCrc32(Bytes.GetData() + PayloadStart,
+                     Bytes.Num() - PayloadStart) == PayloadCrc;
+  if (!bValid) {
+    DiscardEntry(EntryPath);
+    return false;
+  }
+
+  FCodeDocumentLines &Lines = OutHit.Lines;
+  Reader << Lines.LineStarts << Lines.IndentLevels;
+
+  int32 NumFoldRegions = 0;
+  Reader << NumFoldRegions;
+  if (NumFoldRegions < 0 || NumFoldRegions > Lines.LineStarts.Num()) {
+    Reader.SetError();
+  } else {
+    Lines.FoldRegions.Reserve(NumFoldRegions);
+    for (int32 Index = 0; Index < NumFoldRegions && !Reader.IsError();
+         ++Index) {
+      FCodeFoldRegion &Region = Lines.FoldRegions.AddDefaulted_GetRef();
+      Reader << Region.StartLine << Region.EndLine << Region.IndentLevel;
+    }
+  }
+
+  if (Reader.IsError()) {
+    UE_LOG(LogTemp, Warning,
+           TEXT("InlineCodeEditor: Discarding unreadable analysis cache %s"),
+           *EntryPath);
+    DiscardEntry(EntryPath);
+    return false;
+  }
+
+  // The token lines are read into the tokenizer on the game thread
+  const int64 TokenLinesStart = Reader.Tell();
+  OutHit.TokenLines.Append(Bytes.GetData() + TokenLinesStart,
+                           Bytes.Num() - TokenLinesStart);
+  OutHit.EntryPath = EntryPath;
+
+  // The timestamp is the entry's last use, for LRU eviction
+  const FDateTime Now = FDateTime::UtcNow();
+  IFileManager::Get().SetTimeStamp(*EntryPath, Now);
+  FScopeLock Lock(&CodeAnalysisCacheEntries::Lock);
+  if (CodeAnalysisCacheEntries::FEntry *Entry =
+          CodeAnalysisCacheEntries::Entries.Find(EntryPath)) {
+    Entry->LastUsed = Now;
+  }
+  return true;
+}
+
+bool FCodeAnalysisCache::Apply(const FCodeAnalysisCacheHit &Hit,
+                               FCppSyntaxTokenizer &Tokenizer) {
+  FMemoryReader Reader(Hit.TokenLines);
+  if (!Tokenizer.LoadCachedLines(Reader)) {
+    UE_LOG(LogTemp, Warning,
+           TEXT("InlineCodeEditor: Discarding unreadable analysis cache %s"),
+           *Hit.EntryPath);
+    DiscardEntry(Hit.EntryPath);
+    return false;
+  }
+  return true;
+}
+
+void FCodeAnalysisCache::Store(const FString &Text,
+                               const FCodeDocumentLines &Lines,
+                               const FCppSyntaxTokenizer &Tokenizer) {
+  const uint64 ContentHash = CodeAnalysisCacheFormat::HashText(Text);
+  FString EntryPath = GetEntryPath(ContentHash);
+
+  // Known entries need no serializing; a worker holding the lock may be
+  // scanning, so this only checks when it is free
+  {
+    FScopeTryLock Lock(&CodeAnalysisCacheEntries::Lock);
+    if (Lock.IsLocked() &&
+        CodeAnalysisCacheEntries::Entries.Contains(EntryPath)) {
+      return;
+    }
+  }
+
+  TArray<uint8> Payload;
+  {
+    FMemoryWriter Writer(Payload);
+
+    TArray<int32> LineStarts = Lines.LineStarts;
+    TArray<int32> IndentLevels = Lines.IndentLevels;
+    Writer << LineStarts << IndentLevels;
+
+    int32 NumFoldRegions = Lines.FoldRegions.Num();
+    Writer << NumFoldRegions;
+    for (const FCodeFoldRegion &Region : Lines.FoldRegions) {
+      int32 StartLine = Region.StartLine;
+      int32 EndLine = Region.EndLine;
+      int32 IndentLevel = Region.IndentLevel;
+      Writer << StartLine << EndLine << IndentLevel;
+    }
+
+    // Only complete analyses are worth keeping
+    if (!Tokenizer.SaveCachedLines(Writer, Text)) {
+      return;
+    }
+  }
+
+  TArray<uint8> Bytes;
+  {
+    FMemoryWriter Writer(Bytes);
+    uint32 Magic = CodeAnalysisCacheFormat::Magic;
+    uint32 Version = CodeAnalysisCacheFormat::Version;
+    uint64 StoredHash = ContentHash;
+    int32 TextLength = Text.Len();
+    uint32 PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+    Writer << Magic << Version << StoredHash << TextLength << PayloadCrc;
+  }
+  Bytes.Append(Payload);
+
+  const int64 BudgetBytes =
+      static_cast<int64>(
+          FMath::Max(0, CVarICECacheMaxSizeMB.GetValueOnGameThread())) *
+      1024 * 1024;
+  Async(EAsyncExecution::ThreadPool,
+        [EntryPath = MoveTemp(EntryPath), Bytes = MoveTemp(Bytes),
+         BudgetBytes]() { WriteEntry(EntryPath, Bytes, BudgetBytes); });
+}
+
+void FCodeAnalysisCache::WriteEntry(const FString &EntryPath,
+                                    const TArray<uint8> &Bytes,
+                                    int64 BudgetBytes) {
+  using FEntry = CodeAnalysisCacheEntries::FEntry;
+  TMap<FString, FEntry> &Entries = CodeAnalysisCacheEntries::Entries;
+  int64 &TotalBytes = CodeAnalysisCacheEntries::TotalBytes;
+
+  FScopeLock Lock(&CodeAnalysisCacheEntries::Lock);
+  CodeAnalysisCacheEntries::Scan(GetCacheDir());
+  if (FEntry *Existing = Entries.Find(EntryPath)) {
+    Existing->LastUsed = FDateTime::UtcNow();
+    IFileManager::Get().SetTimeStamp(*EntryPath, Existing->LastUsed);
+    return;
+  }
+
+  // Write to a temporary name first so a crash never leaves a torn entry
+  // under a valid key
+  const FString TempPath = EntryPath + TEXT(".tmp");
+  if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) ||
+      !IFileManager::Get().Move(*EntryPath, *TempPath)) {
+    IFileManager::Get().Delete(*TempPath);
+    return;
+  }
+  Entries.Add(EntryPath, {Bytes.Num(), FDateTime::UtcNow()});
+  TotalBytes += Bytes.Num();
+  if (TotalBytes <= BudgetBytes) {
+    return;
+  }
+
+  // Least recently used first
+  TArray<TPair<FString, FEntry>> ByLastUse = Entries.Array();
+  ByLastUse.Sort(
+      [](const TPair<FString, FEntry> &A, const TPair<FString, FEntry> &B) {
+        return A.Value.LastUsed < B.Value.LastUsed;
+      });
+
+  for (const TPair<FString, FEntry> &Entry : ByLastUse) {
+    if (TotalBytes <= BudgetBytes) {
+      break;
+    }
+    if (IFileManager::Get().Delete(*Entry.Key)) {
+      CodeAnalysisCacheEntries::Remove(Entry.Key);
+    }
+  }
+}
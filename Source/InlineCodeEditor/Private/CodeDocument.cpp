@@ -0,0 +1,397 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeDocument.h"
+#include "CodeAnalysisCache.h"
+#include "CodeEditJournal.h"
+#include "FCppSyntaxHighlighter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#define LOCTEXT_NAMESPACE "CodeDocument"
+
+namespace CodeDocumentConstants {
+// Rough bytes a text layout keeps per character of source; an estimate,
+// not a measurement. A shaped glyph entry takes about 40 bytes on 64-bit
+// builds, one per character once a line is shaped, and the line models and
+// runs hold further copies of the text; the sum is rounded up. It only
+// ranks views against ICE.Editor.LayoutBudgetMB.
+constexpr SIZE_T LayoutBytesPerCharacter = 64;
+
+// How long the first analysis waits for the cache entry of the text
+constexpr double MaxCachedAnalysisWaitSeconds = 0.1;
+
+// Undo steps kept per document
+constexpr int32 MaxUndoEdits = 1000;
+} // namespace CodeDocumentConstants
+
+TSharedRef<FCodeDocument> FCodeDocument::Create(const FString &FilePath,
+                                                const FString &Text) {
+  TSharedRef<FCodeDocument> Document =
+      MakeShareable(new FCodeDocument(FilePath, Text, true));
+  Document->LoadAnalysis();
+  return Document;
+}
+
+TSharedRef<FCodeDocument>
+FCodeDocument::CreateTransient(const FString &FilePath, const FString &Text) {
+  TSharedRef<FCodeDocument> Document =
+      MakeShareable(new FCodeDocument(FilePath, Text, false));
+  Document->LoadAnalysis();
+  return Document;
+}
+
+FCodeDocument::FCodeDocument(const FString &InFilePath, const FString &InText,
+                             bool bJournaled)
+    : FilePath(InFilePath), Text(InText),
+      Tokenizer(FCppSyntaxTokenizer::Create()) {
+  if (bJournaled) {
+    Journal = FCodeEditJournal::Create(FilePath, Text);
+  }
+}
+
+void FCodeDocument::LoadAnalysis() {
+  if (IsUntitled()) {
+    return;
+  }
+
+  // An unchanged file comes back with its tokens and folds already known.
+  // The entry is read on a worker while the view is built, and taken by
+  // the first analysis, before anything is laid out.
+  CachedAnalysis = FCodeAnalysisCache::Load(Text);
+}
+
+bool FCodeDocument::ResolveCachedAnalysis() {
+  if (!CachedAnalysis.IsValid()) {
+    return false;
+  }
+
+  // Only the text as opened was looked up; a slow read is not waited out
+  TFuture<FCodeAnalysisCacheHit> Lookup = MoveTemp(CachedAnalysis);
+  if (Revision != 0 ||
+      !Lookup.WaitFor(FTimespan::FromSeconds(
+          CodeDocumentConstants::MaxCachedAnalysisWaitSeconds))) {
+    return false;
+  }
+
+  FCodeAnalysisCacheHit Hit = Lookup.Consume();
+  if (Hit.EntryPath.IsEmpty() ||
+      !FCodeAnalysisCache::Apply(Hit, *Tokenizer)) {
+    return false;
+  }
+  Lines = MoveTemp(Hit.Lines);
+  return true;
+}
+
+FCodeDocument::~FCodeDocument() {
+  // Unsaved buffers keep their journal so they can be recovered later
+  if (Journal.IsValid() && !bIsModified) {
+    Journal->Discard();
+  }
+
+  if (!bIsModified) {
+    StoreAnalysis();
+  }
+}
+
+void FCodeDocument::StoreAnalysis() {
+  if (!IsUntitled()) {
+    FCodeAnalysisCache::Store(Text, GetLines(), *Tokenizer);
+  }
+}
+
+FString FCodeDocument::GetDisplayName() const {
+  return IsUntitled() ? LOCTEXT("Untitled", "Untitled").ToString()
+                      : FPaths::GetCleanFilename(FilePath);
+}
+
+void FCodeDocument::ApplyEdit(const FCodeTextEdit &Edit) {
+  FCodeTextEdit Inverse;
+  if (!ApplyEditAndInvert(Edit, Inverse)) {
+    return;
+  }
+  RedoEdits.Reset();
+
+  // A run of typed characters is undone at once, up to a line break
+  const bool bTypedChar = Edit.RemovedLength == 0 &&
+                          Edit.InsertedText.Len() == 1 &&
+                          Edit.InsertedText[0] != TEXT('\n');
+  if (bTypedChar && bCanMergeUndo && UndoEdits.Num() > 0 &&
+      UndoEdits.Last().Offset + UndoEdits.Last().RemovedLength ==
+          Edit.Offset) {
+    ++UndoEdits.Last().RemovedLength;
+    return;
+  }
+  bCanMergeUndo = bTypedChar;
+
+  if (UndoEdits.Num() >= CodeDocumentConstants::MaxUndoEdits) {
+    UndoEdits.RemoveAt(0);
+  }
+  UndoEdits.Add(MoveTemp(Inverse));
+}
+
+FCodeTextEdit FCodeDocument::Undo() {
+  bCanMergeUndo = false;
+  if (UndoEdits.Num() == 0) {
+    return FCodeTextEdit();
+  }
+  const FCodeTextEdit Edit = UndoEdits.Pop();
+  FCodeTextEdit Inverse;
+  if (!ApplyEditAndInvert(Edit, Inverse)) {
+    return FCodeTextEdit();
+  }
+  RedoEdits.Add(MoveTemp(Inverse));
+  return Edit;
+}
+
+FCodeTextEdit FCodeDocument::Redo() {
+  bCanMergeUndo = false;
+  if (RedoEdits.Num() == 0) {
+    return FCodeTextEdit();
+  }
+  const FCodeTextEdit Edit = RedoEdits.Pop();
+  FCodeTextEdit Inverse;
+  if (!ApplyEditAndInvert(Edit, Inverse)) {
+    return FCodeTextEdit();
+  }
+  UndoEdits.Add(MoveTemp(Inverse));
+  return Edit;
+}
+
+bool FCodeDocument::ApplyEditAndInvert(const FCodeTextEdit &Edit,
+                                       FCodeTextEdit &OutInverse) {
+  OutInverse = FCodeTextEdit(Edit.Offset, Edit.InsertedText.Len(),
+                             Text.Mid(Edit.Offset, Edit.RemovedLength));
+  if (!Edit.ApplyTo(Text)) {
+    UE_LOG(LogTemp, Warning,
+           TEXT("InlineCodeEditor: Ignoring out of range edit in %s"),
+           *GetDisplayName());
+    return false;
+  }
+
+  bIsModified = true;
+  ++Revision;
+  if (Journal.IsValid()) {
+    Journal->Append(Edit);
+  }
+
+  EditedEvent.Broadcast(Edit);
+  return true;
+}
+
+const FCodeDocumentLines &FCodeDocument::GetLines() {
+  if (AnalyzedRevision != Revision) {
+    if (!ResolveCachedAnalysis()) {
+      AnalyzeLines();
+    }
+    AnalyzedRevision = Revision;
+  }
+  return Lines;
+}
+
+FString FCodeDocument::GetLineText(int32 LineIndex) {
+  const FCodeDocumentLines &LineInfo = GetLines();
+  if (!LineInfo.LineStarts.IsValidIndex(LineIndex)) {
+    return FString();
+  }
+
+  const int32 Begin = LineInfo.LineStarts[LineIndex];
+  const int32 End = LineInfo.LineStarts.IsValidIndex(LineIndex + 1)
+                        ? LineInfo.LineStarts[LineIndex + 1] - 1
+                        : Text.Len();
+  return Text.Mid(Begin, End - Begin);
+}
+
+void FCodeDocument::AnalyzeLines() {
+  TArray<FString> SourceLines;
+  Text.ParseIntoArray(SourceLines, TEXT("\n"), false);
+
+  Lines.LineStarts.Reset(SourceLines.Num() + 1);
+  Lines.LineStarts.Add(0);
+  for (int32 Index = 0; Index < Text.Len(); ++Index) {
+    if (Text[Index] == '\n') {
+      Lines.LineStarts.Add(Index + 1);
+    }
+  }
+
+  ParseFoldRegions(SourceLines);
+  CalculateLineIndentLevels(SourceLines);
+}
+
+void FCodeDocument::ParseFoldRegions(const TArray<FString> &SourceLines) {
+  TArray<FCodeFoldRegion> &FoldRegions = Lines.FoldRegions;
+  FoldRegions.Empty();
+
+  TArray<int32> BraceStack;
+
+  for (int32 i = 0; i < SourceLines.Num(); ++i) {
+    const FString &Line = SourceLines[i];
+
+    bool bInString = false;
+    bool bInChar = false;
+    bool bInLineComment = false;
+
+    for (int32 j = 0; j < Line.Len(); ++j) {
+      TCHAR C = Line[j];
+      TCHAR NextC = (j + 1 < Line.Len()) ? Line[j + 1] : 0;
+      TCHAR PrevC = (j > 0) ? Line[j - 1] : 0;
+
+      if (PrevC == '\\') {
+        continue;
+      }
+
+      if (C == '"' && !bInLineComment && !bInChar) {
+        bInString = !bInString;
+        continue;
+      }
+
+      if (C == '\'' && !bInLineComment && !bInString) {
+        bInChar = !bInChar;
+        continue;
+      }
+
+      if (C == '/' && NextC == '/' && !bInString && !bInChar) {
+        bInLineComment = true;
+        continue;
+      }
+
+      if (bInString || bInChar || bInLineComment) {
+        continue;
+      }
+
+      if (C == '{') {
+        BraceStack.Push(i);
+      } else if (C == '}') {
+        if (BraceStack.Num() > 0) {
+          int32 StartLine = BraceStack.Pop();
+          if (i > StartLine) {
+            FoldRegions.Add(FCodeFoldRegion(StartLine, i, BraceStack.Num()));
+          }
+        }
+      }
+    }
+  }
+
+  FoldRegions.Sort([](const FCodeFoldRegion &A, const FCodeFoldRegion &B) {
+    return A.StartLine < B.StartLine;
+  });
+}
+
+void FCodeDocument::CalculateLineIndentLevels(
+    const TArray<FString> &SourceLines) {
+  TArray<int32> &LineIndentLevels = Lines.IndentLevels;
+  LineIndentLevels.Empty(SourceLines.Num());
+
+  for (const FString &Line : SourceLines) {
+    // Count leading whitespace
+    int32 SpaceCount = 0;
+    for (int32 i = 0; i < Line.Len(); ++i) {
+      TCHAR C = Line[i];
+      if (C == ' ') {
+        SpaceCount++;
+      } else if (C == '\t') {
+        // Tab aligns to next tab stop
+        SpaceCount += IndentSize - (SpaceCount % IndentSize);
+      } else {
+        // First non-whitespace character
+        break;
+      }
+    }
+
+    // Convert to indent level
+    // If line is empty or whitespace-only, use 0
+    bool bIsEmptyLine = true;
+    for (TCHAR C : Line) {
+      if (!FChar::IsWhitespace(C)) {
+        bIsEmptyLine = false;
+        break;
+      }
+    }
+
+    int32 IndentLevel = bIsEmptyLine ? 0 : (SpaceCount / IndentSize);
+    LineIndentLevels.Add(IndentLevel);
+  }
+
+  // VS Code behavior: for empty/whitespace-only lines, inherit indent from
+  // context Look at surrounding non-empty lines to determine indent level
+  for (int32 i = 0; i < LineIndentLevels.Num(); ++i) {
+    if (LineIndentLevels[i] == 0) {
+      // Check if the line is truly empty
+      const FString &Line = SourceLines[i];
+      bool bIsEmpty = true;
+      for (TCHAR C : Line) {
+        if (!FChar::IsWhitespace(C)) {
+          bIsEmpty = false;
+          break;
+        }
+      }
+
+      if (bIsEmpty && i > 0) {
+        // Look for the minimum of previous and next non-empty lines
+        int32 PrevIndent = 0;
+        for (int32 j = i - 1; j >= 0; --j) {
+          if (LineIndentLevels[j] > 0 ||
+              !SourceLines[j].TrimStartAndEnd().IsEmpty()) {
+            PrevIndent = LineIndentLevels[j];
+            break;
+          }
+        }
+
+        int32 NextIndent = 0;
+        for (int32 j = i + 1; j < LineIndentLevels.Num(); ++j) {
+          if (LineIndentLevels[j] > 0 ||
+              !SourceLines[j].TrimStartAndEnd().IsEmpty()) {
+            NextIndent = LineIndentLevels[j];
+            break;
+          }
+        }
+
+        // Use the minimum of the two (or just prev if next is 0)
+        if (NextIndent > 0 && PrevIndent > 0) {
+          LineIndentLevels[i] = FMath::Min(PrevIndent, NextIndent);
+        } else if (PrevIndent > 0) {
+          LineIndentLevels[i] = PrevIndent;
+        } else if (NextIndent > 0) {
+          LineIndentLevels[i] = NextIndent;
+        }
+      }
+    }
+  }
+}
+
+bool FCodeDocument::Save() {
+  if (IsUntitled()) {
+    return false;
+  }
+
+  if (!FFileHelper::SaveStringToFile(Text, *FilePath)) {
+    UE_LOG(LogTemp, Error, TEXT("InlineCodeEditor: Failed to save file: %s"),
+           *FilePath);
+    return false;
+  }
+
+  bIsModified = false;
+  if (Journal.IsValid()) {
+    Journal->Reset(FilePath, Text);
+  }
+  StoreAnalysis();
+  return true;
+}
+
+void FCodeDocument::Discard() {
+  if (Journal.IsValid()) {
+    Journal->Discard();
+    Journal.Reset();
+  }
+}
+
+void FCodeDocument::ResumeJournal(TSharedRef<FCodeEditJournal> InJournal) {
+  Journal = InJournal;
+  bIsModified = true;
+}
+
+SIZE_T FCodeDocument::GetLayoutMemoryEstimate() const {
+  return static_cast<SIZE_T>(Text.Len()) *
+         CodeDocumentConstants::LayoutBytesPerCharacter;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,467 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeEditJournal.h"
+#include "Containers/Queue.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/Event.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Hash/CityHash.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace CodeEditJournalFormat {
+constexpr uint32 Magic = 0x4A454349; // "ICEJ"
+constexpr uint32 Version = 1;
+
+/** Size of the [PayloadSize][PayloadCrc] frame in front of every record */
+constexpr int32 RecordFrameSize = sizeof(uint32) * 2;
+
+/** How long the writer coalesces edits before writing and fsyncing them */
+constexpr float BatchIntervalSeconds = 0.25f;
+
+const TCHAR *Extension = TEXT(".icej");
+
+uint64 HashText(const FString &Text) {
+  return CityHash64(reinterpret_cast<const char *>(*Text),
+                    Text.Len() * sizeof(TCHAR));
+}
+} // namespace CodeEditJournalFormat
+
+//////////////////////////////////////////////////////////////////////////
+// FCodeEditJournalWriter - shared background thread that owns all journal
+// file handles. The game thread only ever enqueues commands.
+
+class FCodeEditJournalWriter : public FRunnable {
+public:
+  enum class ECommand : uint8 {
+    Append,   // Append bytes to the journal
+    Truncate, // Replace the journal contents with bytes
+    Close,    // Flush and release the handle, keep the file
+    Delete,   // Release the handle and delete the file
+  };
+
+  struct FCommand {
+    ECommand Type = ECommand::Append;
+    FString JournalPath;
+    TArray<uint8> Bytes;
+  };
+
+  /** Get the running writer, or nullptr once the module has shut down */
+  static FCodeEditJournalWriter *Get();
+
+  /** Allow Get() to start a writer again after Shutdown() */
+  static void Startup();
+
+  /** Drain outstanding commands and stop the thread */
+  static void Shutdown();
+
+  virtual ~FCodeEditJournalWriter() override;
+
+  void Enqueue(ECommand Type, const FString &JournalPath,
+               TArray<uint8> Bytes = TArray<uint8>());
+
+  // FRunnable interface
+  virtual uint32 Run() override;
+  virtual void Stop() override;
+
+private:
+  FCodeEditJournalWriter();
+
+  /** Execute every queued command, then fsync each touched journal once */
+  void ProcessCommands();
+
+  IFileHandle *OpenHandle(const FString &JournalPath, bool bAppend);
+  void CloseHandle(const FString &JournalPath);
+
+  TQueue<FCommand, EQueueMode::Mpsc> Commands;
+  FEvent *WakeEvent = nullptr;
+  FRunnableThread *Thread = nullptr;
+  TAtomic<bool> bStopping{false};
+
+  /** Open journal handles, only touched on the writer thread */
+  TMap<FString, TUniquePtr<IFileHandle>> OpenHandles;
+
+  static FCodeEditJournalWriter *Instance;
+  static bool bHasShutDown;
+};
+
+FCodeEditJournalWriter *FCodeEditJournalWriter::Instance = nullptr;
+bool FCodeEditJournalWriter::bHasShutDown = false;
+
+FCodeEditJournalWriter *FCodeEditJournalWriter::Get() {
+  if (!Instance && !bHasShutDown) {
+    Instance = new FCodeEditJournalWriter();
+  }
+  return Instance;
+}
+
+void FCodeEditJournalWriter::Startup() { bHasShutDown = false; }
+
+void FCodeEditJournalWriter::Shutdown() {
+  bHasShutDown = true;
+  delete Instance;
+  Instance = nullptr;
+}
+
+FCodeEditJournalWriter::FCodeEditJournalWriter() {
+  WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+  Thread = FRunnableThread::Create(this, TEXT("ICEEditJournalWriter"), 0,
+                                   TPri_BelowNormal);
+}
+
+FCodeEditJournalWriter::~FCodeEditJournalWriter() {
+  if (Thread) {
+    Thread->Kill(true);
+    delete Thread;
+    Thread = nullptr;
+  }
+
+  // Anything enqueued after the thread observed the stop request
+  ProcessCommands();
+  OpenHandles.Empty();
+
+  FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+  WakeEvent = nullptr;
+}
+
+void FCodeEditJournalWriter::Enqueue(ECommand Type, const FString &JournalPath,
+                                     TArray<uint8> Bytes) {
+  FCommand Command;
+  Command.Type = Type;
+  Command.JournalPath = JournalPath;
+  Command.Bytes = MoveTemp(Bytes);
+  Commands.Enqueue(MoveTemp(Command));
+  WakeEvent->Trigger();
+}
+
+uint32 FCodeEditJournalWriter::Run() {
+  while (!bStopping) {
+    WakeEvent->Wait();
+
+    // Let a burst of keystrokes accumulate so they share one fsync
+    if (!bStopping) {
+      FPlatformProcess::Sleep(CodeEditJournalFormat::BatchIntervalSeconds);
+    }
+
+    ProcessCommands();
+  }
+  return 0;
+}
+
+void FCodeEditJournalWriter::Stop() {
+  bStopping = true;
+  WakeEvent->Trigger();
+}
+
+IFileHandle *FCodeEditJournalWriter::OpenHandle(const FString &JournalPath,
+                                                bool bAppend) {
+  if (bAppend) {
+    if (TUniquePtr<IFileHandle> *Existing = OpenHandles.Find(JournalPath)) {
+      return Existing->Get();
+    }
+  } else {
+    CloseHandle(JournalPath);
+  }
+
+  IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+  PlatformFile.CreateDirectoryTree(*FPaths::GetPath(JournalPath));
+
+  IFileHandle *Handle = PlatformFile.OpenWrite(*JournalPath, bAppend);
+  if (!Handle) {
+    UE_LOG(LogTemp, Warning,
+           TEXT("InlineCodeEditor: Failed to open edit journal %s"),
+           *JournalPath);
+    return nullptr;
+  }
+
+  OpenHandles.Add(JournalPath, TUniquePtr<IFileHandle>(Handle));
+  return Handle;
+}
+
+void FCodeEditJournalWriter::CloseHandle(const FString &JournalPath) {
+  TUniquePtr<IFileHandle> Handle;
+  if (OpenHandles.RemoveAndCopyValue(JournalPath, Handle) && Handle) {
+    Handle->Flush(true);
+  }
+}
+
+void FCodeEditJournalWriter::ProcessCommands() {
+  TSet<FString> TouchedJournals;
+
+  FCommand Command;
+  while (Commands.Dequeue(Command)) {
+    switch (Command.Type) {
+    case ECommand::Append:
+    case ECommand::Truncate: {
+      IFileHandle *Handle = OpenHandle(Command.JournalPath,
+                                       Command.Type == ECommand::Append);
+      if (Handle && Command.Bytes.Num() > 0) {
+        Handle->Write(Command.Bytes.GetData(), Command.Bytes.Num());
+        TouchedJournals.Add(Command.JournalPath);
+      }
+      break;
+    }
+    case ECommand::Close:
+      CloseHandle(Command.JournalPath);
+      TouchedJournals.Remove(Command.JournalPath);
+      break;
+    case ECommand::Delete:
+      OpenHandles.Remove(Command.JournalPath);
+      TouchedJournals.Remove(Command.JournalPath);
+      FPlatformFileManager::Get().GetPlatformFile().DeleteFile(
+          *Command.JournalPath);
+      break;
+    }
+  }
+
+  // One fsync per journal per batch
+  for (const FString &JournalPath : TouchedJournals) {
+    if (TUniquePtr<IFileHandle> *Handle = OpenHandles.Find(JournalPath)) {
+      (*Handle)->Flush(true);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FCodeEditJournal
+
+FCodeEditJournal::FCodeEditJournal(const FString &InJournalPath)
+    : JournalPath(InJournalPath) {}
+
+FCodeEditJournal::~FCodeEditJournal() {
+  if (bDiscarded || PendingHeader.Num() > 0) {
+    // Nothing was ever written for the current base
+    return;
+  }
+
+  // Keep the journal: the buffer still holds unsaved edits
+  if (FCodeEditJournalWriter *Writer = FCodeEditJournalWriter::Get()) {
+    Writer->Enqueue(FCodeEditJournalWriter::ECommand::Close, JournalPath);
+  }
+}
+
+FString FCodeEditJournal::GetJournalDir() {
+  return FPaths::ProjectSavedDir() / TEXT("ICE") / TEXT("Journal");
+}
+
+TSharedRef<FCodeEditJournal>
+FCodeEditJournal::Create(const FString &FilePath, const FString &BaseText) {
+  const FString Name = FGuid::NewGuid().ToString(EGuidFormats::Digits);
+  TSharedRef<FCodeEditJournal> Journal = MakeShareable(new FCodeEditJournal(
+      GetJournalDir() / Name + CodeEditJournalFormat::Extension));
+  Journal->PendingHeader = MakeHeader(FilePath, BaseText);
+  return Journal;
+}
+
+TSharedRef<FCodeEditJournal>
+FCodeEditJournal::Resume(const FRecoveredCodeDocument &Recovered) {
+  return MakeShareable(new FCodeEditJournal(Recovered.JournalPath));
+}
+
+void FCodeEditJournal::StartupWriter() { FCodeEditJournalWriter::Startup(); }
+
+void FCodeEditJournal::ShutdownWriter() { FCodeEditJournalWriter::Shutdown(); }
+
+TArray<uint8> FCodeEditJournal::MakeHeader(const FString &FilePath,
+                                           const FString &BaseText) {
+  uint32 Magic = CodeEditJournalFormat::Magic;
+  uint32 Version = CodeEditJournalFormat::Version;
+  FString Path = FilePath;
+  uint64 BaseHash = CodeEditJournalFormat::HashText(BaseText);
+
+  // Files on disk are replayed onto their current contents; untitled buffers
+  // have nothing to replay onto, so their (small) base is stored inline
+  FString InlineBase = FilePath.IsEmpty() ? BaseText : FString();
+
+  TArray<uint8> Bytes;
+  FMemoryWriter Writer(Bytes);
+  Writer << Magic << Version << Path << BaseHash << InlineBase;
+  return Bytes;
+}
+
+void FCodeEditJournal::Append(const FCodeTextEdit &Edit) {
+  FCodeEditJournalWriter *Writer = FCodeEditJournalWriter::Get();
+  if (bDiscarded || !Writer || Edit.IsEmpty()) {
+    return;
+  }
+
+  if (PendingHeader.Num() > 0) {
+    Writer->Enqueue(FCodeEditJournalWriter::ECommand::Truncate, JournalPath,
+                    MoveTemp(PendingHeader));
+    PendingHeader.Reset();
+  }
+
+  // [PayloadSize][PayloadCrc][Offset][RemovedLength][InsertedText]
+  TArray<uint8> Record;
+  Record.AddZeroed(CodeEditJournalFormat::RecordFrameSize);
+  {
+    FMemoryWriter RecordWriter(Record);
+    RecordWriter.Seek(CodeEditJournalFormat::RecordFrameSize);
+
+    int32 Offset = Edit.Offset;
+    int32 RemovedLength = Edit.RemovedLength;
+    FString InsertedText = Edit.InsertedText;
+    RecordWriter << Offset << RemovedLength << InsertedText;
+  }
+
+  const uint8 *Payload =
+      Record.GetData() + CodeEditJournalFormat::RecordFrameSize;
+  const uint32 PayloadSize =
+      Record.Num() - CodeEditJournalFormat::RecordFrameSize;
+  const uint32 PayloadCrc = FCrc::MemCrc32(Payload, PayloadSize);
+  FMemory::Memcpy(Record.GetData(), &PayloadSize, sizeof(uint32));
+  FMemory::Memcpy(Record.GetData() + sizeof(uint32), &PayloadCrc,
+                  sizeof(uint32));
+
+  Writer->Enqueue(FCodeEditJournalWriter::ECommand::Append, JournalPath,
+                  MoveTemp(Record));
+}
+
+void FCodeEditJournal::Reset(const FString &FilePath,
+                             const FString &BaseText) {
+  if (bDiscarded) {
+    return;
+  }
+
+  // Drop the old edits now; the new header is only written with the next
+  // edit, so a saved buffer leaves no journal behind
+  if (PendingHeader.Num() == 0) {
+    if (FCodeEditJournalWriter *Writer = FCodeEditJournalWriter::Get()) {
+      Writer->Enqueue(FCodeEditJournalWriter::ECommand::Delete, JournalPath);
+    }
+  }
+  PendingHeader = MakeHeader(FilePath, BaseText);
+}
+
+void FCodeEditJournal::Discard() {
+  if (bDiscarded) {
+    return;
+  }
+  bDiscarded = true;
+
+  if (PendingHeader.Num() == 0) {
+    if (FCodeEditJournalWriter *Writer = FCodeEditJournalWriter::Get()) {
+      Writer->Enqueue(FCodeEditJournalWriter::ECommand::Delete, JournalPath);
+    }
+  }
+}
+
+void FCodeEditJournal::RecoverDocuments(
+    TArray<FRecoveredCodeDocument> &OutDocuments) {
+  const FString JournalDir = GetJournalDir();
+
+  TArray<FString> JournalFiles;
+  IFileManager::Get().FindFiles(
+      JournalFiles,
+      *(JournalDir / FString(TEXT("*")) + CodeEditJournalFormat::Extension),
+      true, false);
+
+  // Most recently edited first
+  TArray<TPair<FDateTime, FString>> SortedJournals;
+  for (const FString &JournalFile : JournalFiles) {
+    const FString JournalPath = JournalDir / JournalFile;
+    SortedJournals.Emplace(IFileManager::Get().GetTimeStamp(*JournalPath),
+                           JournalPath);
+  }
+  SortedJournals.Sort([](const TPair<FDateTime, FString> &A,
+                         const TPair<FDateTime, FString> &B) {
+    return A.Key > B.Key;
+  });
+
+  for (const TPair<FDateTime, FString> &Entry : SortedJournals) {
+    const FString &JournalPath = Entry.Value;
+
+    TArray<uint8> Bytes;
+    if (!FFileHelper::LoadFileToArray(Bytes, *JournalPath)) {
+      continue;
+    }
+
+    FMemoryReader Reader(Bytes);
+    uint32 Magic = 0;
+    uint32 Version = 0;
+    FString FilePath;
+    uint64 BaseHash = 0;
+    FString Text;
+    Reader << Magic << Version;
+    if (Magic == CodeEditJournalFormat::Magic &&
+        Version == CodeEditJournalFormat::Version) {
+      Reader << FilePath << BaseHash << Text;
+    }
+
+    bool bBaseMatches = !Reader.IsError() &&
+                        Magic == CodeEditJournalFormat::Magic &&
+                        Version == CodeEditJournalFormat::Version;
+    if (bBaseMatches && !FilePath.IsEmpty()) {
+      bBaseMatches = FFileHelper::LoadFileToString(Text, *FilePath) &&
+                     CodeEditJournalFormat::HashText(Text) == BaseHash;
+    }
+
+    if (!bBaseMatches) {
+      UE_LOG(LogTemp, Log,
+             TEXT("InlineCodeEditor: Discarding stale edit journal %s"),
+             *JournalPath);
+      IFileManager::Get().Delete(*JournalPath);
+      continue;
+    }
+
+    // Replay records until the first torn or corrupt one
+    int32 NumReplayed = 0;
+    int64 Position = Reader.Tell();
+    while (Position + CodeEditJournalFormat::RecordFrameSize <= Bytes.Num()) {
+      uint32 PayloadSize = 0;
+      uint32 PayloadCrc = 0;
+      FMemory::Memcpy(&PayloadSize, Bytes.GetData() + Position,
+                      sizeof(uint32));
+      FMemory::Memcpy(&PayloadCrc, Bytes.GetData() + Position + sizeof(uint32),
+                      sizeof(uint32));
+
+      const int64 PayloadStart =
+          Position + CodeEditJournalFormat::RecordFrameSize;
+      if (PayloadStart + PayloadSize > Bytes.Num() ||
+          FCrc::MemCrc32(Bytes.GetData() + PayloadStart, PayloadSize) !=
+              PayloadCrc) {
+        break;
+      }
+
+      FMemoryReaderView RecordReader(
+          TArrayView<const uint8>(Bytes.GetData() + PayloadStart, PayloadSize));
+      FCodeTextEdit Edit;
+      RecordReader << Edit.Offset << Edit.RemovedLength << Edit.InsertedText;
+      if (RecordReader.IsError() || !Edit.ApplyTo(Text)) {
+        break;
+      }
+
+      ++NumReplayed;
+      Position = PayloadStart + PayloadSize;
+    }
+
+    if (NumReplayed == 0) {
+      IFileManager::Get().Delete(*JournalPath);
+      continue;
+    }
+
+    // Cut off a torn tail so records appended after recovery stay reachable
+    if (Position < Bytes.Num()) {
+      Bytes.SetNum(Position);
+      FFileHelper::SaveArrayToFile(Bytes, *JournalPath);
+    }
+
+    FRecoveredCodeDocument &Recovered = OutDocuments.AddDefaulted_GetRef();
+    Recovered.FilePath = FilePath;
+    Recovered.Text = MoveTemp(Text);
+    Recovered.JournalPath = JournalPath;
+
+    UE_LOG(LogTemp, Log,
+           TEXT("InlineCodeEditor: Recovered %d unsaved edits for %s"),
+           NumReplayed,
+           FilePath.IsEmpty() ? TEXT("untitled buffer") : *FilePath);
+  }
+}
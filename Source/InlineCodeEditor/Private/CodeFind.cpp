@@ -0,0 +1,388 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeFind.h"
+#include "Algo/BinarySearch.h"
+#include "AsciiCase.h"
+#include "CodeRegex.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+#include <arm_neon.h>
+#endif
+
+namespace CodeFindConstants {
+/**
+ * Characters common in source code, most common first. A literal is found
+ * by scanning for its rarest character, the one latest in this list or not
+ * in it.
+ */
+const TCHAR CommonChars[] = TEXT(" \t\r\netaoinsrlcdhupmfgy_.,;()");
+} // namespace CodeFindConstants
+
+/**
+ * First position in [From, Size) holding A or B, or Size if none does.
+ * Sixteen bytes of characters are compared at once where the CPU allows.
+ */
+static int32 FindEitherChar(const TCHAR *Data, int32 Size, int32 From,
+                            TCHAR A, TCHAR B) {
+  int32 Pos = From;
+#if PLATFORM_CPU_X86_FAMILY
+  if constexpr (sizeof(TCHAR) == 2) {
+    const __m128i SplatA = _mm_set1_epi16(static_cast<int16>(A));
+    const __m128i SplatB = _mm_set1_epi16(static_cast<int16>(B));
+    for (; Pos + 8 <= Size; Pos += 8) {
+      const __m128i Chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(Data + Pos));
+      const int32 Mask = _mm_movemask_epi8(_mm_or_si128(
+          _mm_cmpeq_epi16(Chunk, SplatA), _mm_cmpeq_epi16(Chunk, SplatB)));
+      if (Mask != 0) {
+        return Pos + FMath::CountTrailingZeros(static_cast<uint32>(Mask)) / 2;
+      }
+    }
+  } else {
+    const __m128i SplatA = _mm_set1_epi32(static_cast<int32>(A));
+    const __m128i SplatB = _mm_set1_epi32(static_cast<int32>(B));
+    for (; Pos + 4 <= Size; Pos += 4) {
+      const __m128i Chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(Data + Pos));
+      const int32 Mask = _mm_movemask_epi8(_mm_or_si128(
+          _mm_cmpeq_epi32(Chunk, SplatA), _mm_cmpeq_epi32(Chunk, SplatB)));
+      if (Mask != 0) {
+        return Pos + FMath::CountTrailingZeros(static_cast<uint32>(Mask)) / 4;
+      }
+    }
+  }
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+  if constexpr (sizeof(TCHAR) == 2) {
+    const uint16x8_t SplatA = vdupq_n_u16(static_cast<uint16>(A));
+    const uint16x8_t SplatB = vdupq_n_u16(static_cast<uint16>(B));
+    for (; Pos + 8 <= Size; Pos += 8) {
+      const uint16x8_t Chunk =
+          vld1q_u16(reinterpret_cast<const uint16 *>(Data + Pos));
+      if (vmaxvq_u16(vorrq_u16(vceqq_u16(Chunk, SplatA),
+                               vceqq_u16(Chunk, SplatB))) != 0) {
+        break; // The loop below finds it within this chunk
+      }
+    }
+  } else {
+    const uint32x4_t SplatA = vdupq_n_u32(static_cast<uint32>(A));
+    const uint32x4_t SplatB = vdupq_n_u32(static_cast<uint32>(B));
+    for (; Pos + 4 <= Size; Pos += 4) {
+      const uint32x4_t Chunk =
+          vld1q_u32(reinterpret_cast<const uint32 *>(Data + Pos));
+      if (vmaxvq_u32(vorrq_u32(vceqq_u32(Chunk, SplatA),
+                               vceqq_u32(Chunk, SplatB))) != 0) {
+        break; // The loop below finds it within this chunk
+      }
+    }
+  }
+#endif
+  for (; Pos < Size; ++Pos) {
+    if (Data[Pos] == A || Data[Pos] == B) {
+      return Pos;
+    }
+  }
+  return Size;
+}
+
+/** Whether a character can be part of an identifier */
+static bool IsWordChar(TCHAR C) {
+  return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') ||
+         (C >= '0' && C <= '9') || C == '_' || C >= 0x80;
+}
+
+/** A literal query, and how to scan for it */
+class FCodeFindResults::FLiteral {
+public:
+  FLiteral(const FString &Text, bool bInMatchCase, bool bInWholeWord)
+      : Needle(Text), bMatchCase(bInMatchCase), bWholeWord(bInWholeWord) {
+    if (!bMatchCase) {
+      for (TCHAR &C : Needle.GetCharArray()) {
+        C = ToLowerAscii(C);
+      }
+    }
+
+    // Scan for the character least likely to occur, so candidates are rare
+    const int32 NumCommonChars =
+        UE_ARRAY_COUNT(CodeFindConstants::CommonChars) - 1;
+    int32 BestRarity = -1;
+    for (int32 Index = 0; Index < Needle.Len(); ++Index) {
+      const TCHAR *Common =
+          FCString::Strchr(CodeFindConstants::CommonChars, Needle[Index]);
+      const int32 Rarity = Common
+                               ? int32(Common - CodeFindConstants::CommonChars)
+                               : NumCommonChars;
+      if (Rarity > BestRarity) {
+        BestRarity = Rarity;
+        ScanOffset = Index;
+      }
+    }
+    if (Needle.Len() > 0) {
+      ScanLower = Needle[ScanOffset];
+      ScanUpper = bMatchCase || ScanLower < 'a' || ScanLower > 'z'
+                      ? ScanLower
+                      : ScanLower - ('a' - 'A');
+    }
+  }
+
+  /** Length of a match; 0 if there is nothing to find */
+  int32 Len() const { return Needle.Len(); }
+
+  /** Whether a match could span lines */
+  bool HasLineBreak() const {
+    int32 Unused;
+    return Needle.FindChar('\n', Unused);
+  }
+
+  /**
+   * Whether two occurrences of the literal can overlap, so scanning past
+   * each match may skip some
+   */
+  bool CanOverlap() const {
+    for (int32 Shift = 1; Shift < Needle.Len(); ++Shift) {
+      if (FMemory::Memcmp(*Needle, *Needle + Shift,
+                          (Needle.Len() - Shift) * sizeof(TCHAR)) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Start of the first match at or after From, or INDEX_NONE */
+  int32 Find(const TCHAR *Data, int32 Size, int32 From) const {
+    const int32 Length = Needle.Len();
+    if (Length == 0 || Size - From < Length) {
+      return INDEX_NONE;
+    }
+
+    // Positions of the scanned character that leave room for the match
+    const int32 ScanEnd = Size - Length + ScanOffset + 1;
+    for (int32 Pos = From + ScanOffset;; ++Pos) {
+      Pos = FindEitherChar(Data, ScanEnd, Pos, ScanLower, ScanUpper);
+      if (Pos >= ScanEnd) {
+        return INDEX_NONE;
+      }
+      const int32 Start = Pos - ScanOffset;
+      if (MatchesAt(Data, Size, Start)) {
+        return Start;
+      }
+    }
+  }
+
+  /** Whether a match starts at Start */
+  bool MatchesAt(const TCHAR *Data, int32 Size, int32 Start) const {
+    const int32 Length = Needle.Len();
+    if (Start + Length > Size) {
+      return false;
+    }
+    if (bMatchCase) {
+      if (FMemory::Memcmp(Data + Start, *Needle, Length * sizeof(TCHAR)) !=
+          0) {
+        return false;
+      }
+    } else {
+      for (int32 Index = 0; Index < Length; ++Index) {
+        if (ToLowerAscii(Data[Start + Index]) != Needle[Index]) {
+          return false;
+        }
+      }
+    }
+    return !bWholeWord || IsWholeWord(Data, Size, Start);
+  }
+
+private:
+  /** Whether a match is not part of a longer identifier */
+  bool IsWholeWord(const TCHAR *Data, int32 Size, int32 Start) const {
+    const int32 End = Start + Needle.Len();
+    if (Start > 0 && IsWordChar(Needle[0]) && IsWordChar(Data[Start - 1])) {
+      return false;
+    }
+    return End >= Size || !IsWordChar(Needle[Needle.Len() - 1]) ||
+           !IsWordChar(Data[End]);
+  }
+
+  /** The literal, with ASCII letters lowered unless case must match */
+  FString Needle;
+
+  bool bMatchCase = false;
+  bool bWholeWord = false;
+
+  /** Offset in the literal of the character scanned for, in both cases */
+  int32 ScanOffset = 0;
+  TCHAR ScanLower = 0;
+  TCHAR ScanUpper = 0;
+};
+
+FCodeFindResults::FCodeFindResults() = default;
+
+FCodeFindResults::~FCodeFindResults() = default;
+
+bool FCodeFindResults::SetQuery(const FString &Text,
+                                const FCodeFindQuery &InQuery,
+                                FText &OutError) {
+  // A literal that only got longer can only match where it matched before,
+  // unless its matches could overlap and so were skipped
+  const bool bRefine =
+      Literal.IsValid() && Literal->Len() > 0 && !Query.bRegex &&
+      !InQuery.bRegex && !Query.bWholeWord && !InQuery.bWholeWord &&
+      Query.bMatchCase == InQuery.bMatchCase &&
+      InQuery.Text.Len() > Query.Text.Len() &&
+      InQuery.Text.StartsWith(Query.Text, ESearchCase::CaseSensitive) &&
+      !Literal->CanOverlap();
+
+  Query = InQuery;
+  Matcher.Reset();
+  Regex.Reset();
+  if (Query.bRegex) {
+    const FString Pattern =
+        Query.bWholeWord ? FString::Printf(TEXT("\\b(?:%s)\\b"), *Query.Text)
+                         : Query.Text;
+    Regex = FCodeRegex::Compile(Pattern, !Query.bMatchCase, OutError);
+    if (!Regex.IsValid()) {
+      Literal.Reset();
+      Matches.Reset();
+      return false;
+    }
+    Matcher = MakeUnique<FCodeRegexMatcher>(Regex.ToSharedRef());
+  }
+
+  // A pattern's required literal finds the lines worth matching
+  Literal = Regex.IsValid()
+                ? MakeUnique<FLiteral>(Regex->GetRequiredLiteral(),
+                                       Query.bMatchCase, false)
+                : MakeUnique<FLiteral>(Query.Text, Query.bMatchCase,
+                                       Query.bWholeWord);
+
+  if (bRefine) {
+    Refine(Text);
+  } else {
+    Matches.Reset();
+    Scan(Text, 0, Text.Len(), Matches);
+  }
+  return true;
+}
+
+void FCodeFindResults::Reset() {
+  Query = FCodeFindQuery();
+  Literal.Reset();
+  Matcher.Reset();
+  Regex.Reset();
+  Matches.Reset();
+}
+
+void FCodeFindResults::HandleEdit(const FString &Text,
+                                  const FCodeTextEdit &Edit) {
+  if (!Literal.IsValid() || (Literal->Len() == 0 && !Regex.IsValid())) {
+    return;
+  }
+  if (Literal->HasLineBreak()) {
+    Matches.Reset();
+    Scan(Text, 0, Text.Len(), Matches);
+    return;
+  }
+
+  // Matches never span lines, so only the lines the edit touched can have
+  // gained or lost any
+  const TCHAR *Data = *Text;
+  int32 From = FMath::Clamp(Edit.Offset, 0, Text.Len());
+  while (From > 0 && Data[From - 1] != '\n') {
+    --From;
+  }
+  const int32 To = FindEitherChar(
+      Data, Text.Len(),
+      FMath::Min(Edit.Offset + Edit.InsertedText.Len(), Text.Len()), '\n',
+      '\n');
+  const int32 Delta = Edit.InsertedText.Len() - Edit.RemovedLength;
+
+  const int32 First = Algo::LowerBoundBy(Matches, From, &FCodeFindMatch::Start);
+  const int32 Last =
+      Algo::LowerBoundBy(Matches, To - Delta, &FCodeFindMatch::Start);
+  for (int32 Index = Last; Index < Matches.Num(); ++Index) {
+    Matches[Index].Start += Delta;
+    Matches[Index].End += Delta;
+  }
+
+  TArray<FCodeFindMatch> Rescanned;
+  Scan(Text, From, To, Rescanned);
+  Matches.RemoveAt(First, Last - First);
+  Matches.Insert(Rescanned, First);
+}
+
+int32 FCodeFindResults::FindFirstEndingAfter(int32 Offset) const {
+  return Algo::UpperBoundBy(Matches, Offset, &FCodeFindMatch::End);
+}
+
+int32 FCodeFindResults::FindNext(int32 Offset) const {
+  if (Matches.Num() == 0) {
+    return INDEX_NONE;
+  }
+  const int32 Index =
+      Algo::LowerBoundBy(Matches, Offset, &FCodeFindMatch::Start);
+  return Index < Matches.Num() ? Index : 0;
+}
+
+int32 FCodeFindResults::FindPrevious(int32 Offset) const {
+  if (Matches.Num() == 0) {
+    return INDEX_NONE;
+  }
+  const int32 Index =
+      Algo::LowerBoundBy(Matches, Offset, &FCodeFindMatch::Start) - 1;
+  return Index >= 0 ? Index : Matches.Num() - 1;
+}
+
+FCodeTextEdit
+FCodeFindResults::MakeReplaceAllEdit(const FString &Text,
+                                     const FString &Replacement) const {
+  return FCodeTextEdit::FromReplacements(Text, Matches, Replacement);
+}
+
+void FCodeFindResults::Scan(const FString &Text, int32 From, int32 To,
+                            TArray<FCodeFindMatch> &OutMatches) {
+  const TCHAR *Data = *Text;
+  if (!Regex.IsValid()) {
+    for (int32 Start = Literal->Find(Data, To, From); Start != INDEX_NONE;
+         Start = Literal->Find(Data, To, Start + Literal->Len())) {
+      OutMatches.Add({Start, Start + Literal->Len()});
+    }
+    return;
+  }
+
+  for (int32 LineStart = From; LineStart <= To;) {
+    if (Literal->Len() > 0) {
+      const int32 Hit = Literal->Find(Data, To, LineStart);
+      if (Hit == INDEX_NONE) {
+        return;
+      }
+      for (int32 Pos = Hit; Pos > LineStart; --Pos) {
+        if (Data[Pos - 1] == '\n') {
+          LineStart = Pos;
+          break;
+        }
+      }
+    }
+
+    const int32 Break = FindEitherChar(Data, To, LineStart, '\n', '\n');
+    const int32 LineEnd =
+        Break > LineStart && Data[Break - 1] == '\r' ? Break - 1 : Break;
+    Matcher->FindAll(FStringView(Data + LineStart, LineEnd - LineStart),
+                     [&OutMatches, LineStart](int32 Start, int32 End) {
+                       OutMatches.Add({LineStart + Start, LineStart + End});
+                       return true;
+                     });
+    LineStart = Break + 1;
+  }
+}
+
+void FCodeFindResults::Refine(const FString &Text) {
+  int32 Kept = 0;
+  int32 PreviousEnd = 0;
+  for (const FCodeFindMatch &Match : Matches) {
+    if (Match.Start >= PreviousEnd &&
+        Literal->MatchesAt(*Text, Text.Len(), Match.Start)) {
+      PreviousEnd = Match.Start + Literal->Len();
+      Matches[Kept++] = {Match.Start, PreviousEnd};
+    }
+  }
+  Matches.SetNum(Kept);
+}
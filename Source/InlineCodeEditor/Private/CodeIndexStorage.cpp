@@ -0,0 +1,119 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeIndexStorage.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace CodeIndexStorage {
+uint64 HashPath(FStringView Path) {
+  return CityHash64(reinterpret_cast<const char *>(Path.GetData()),
+                    Path.Len() * sizeof(TCHAR));
+}
+
+FString MakeIndexName(const FString &RootPath) {
+  const FString Key = RootPath.ToLower();
+  return FString::Printf(TEXT("%016llx"),
+                         CityHash64(reinterpret_cast<const char *>(*Key),
+                                    Key.Len() * sizeof(TCHAR)));
+}
+
+FString GetGenerationPath(const FString &Directory, const FString &Name,
+                          int32 Generation, const TCHAR *Extension) {
+  return Directory / FString::Printf(TEXT("%s.%d"), *Name, Generation) +
+         Extension;
+}
+
+void WriteVarint(TArray<uint8> &Out, uint32 Value) {
+  while (Value >= 0x80) {
+    Out.Add(uint8(Value) | 0x80);
+    Value >>= 7;
+  }
+  Out.Add(uint8(Value));
+}
+
+bool ReadVarint(const uint8 *&Data, const uint8 *End, uint32 &Value) {
+  Value = 0;
+  for (int32 Shift = 0; Shift < 32 && Data < End; Shift += 7) {
+    const uint8 Byte = *Data++;
+    Value |= uint32(Byte & 0x7F) << Shift;
+    if ((Byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SaveImage(const TArray<uint8> &Bytes, const FString &FilePath) {
+  // Readers only ever find whole generations
+  const FString TempPath = FilePath + TEXT(".tmp");
+  if (FFileHelper::SaveArrayToFile(Bytes, *TempPath) &&
+      IFileManager::Get().Move(*FilePath, *TempPath)) {
+    return true;
+  }
+  IFileManager::Get().Delete(*TempPath);
+  return false;
+}
+
+TArray<TPair<int32, FString>> FindGenerations(const FString &Directory,
+                                              const FString &Name,
+                                              const TCHAR *Extension) {
+  TArray<FString> FileNames;
+  IFileManager::Get().FindFiles(
+      FileNames, *(Directory / Name + TEXT(".*") + Extension), true, false);
+
+  TArray<TPair<int32, FString>> Generations;
+  for (const FString &FileName : FileNames) {
+    const FString Generation =
+        FPaths::GetExtension(FPaths::GetBaseFilename(FileName));
+    if (Generation.IsNumeric()) {
+      Generations.Emplace(FCString::Atoi(*Generation), Directory / FileName);
+    }
+  }
+  Generations.Sort(
+      [](const TPair<int32, FString> &A, const TPair<int32, FString> &B) {
+        return A.Key > B.Key;
+      });
+  return Generations;
+}
+
+FImage::~FImage() {
+  MappedRegion.Reset();
+  MappedFile.Reset();
+  if (bSuperseded && !FilePath.IsEmpty()) {
+    IFileManager::Get().Delete(*FilePath, false, false, true);
+  }
+}
+
+bool FImage::Map(const FString &InFilePath, int32 InGeneration) {
+  IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+  MappedFile.Reset(PlatformFile.OpenMapped(*InFilePath));
+  if (MappedFile.IsValid()) {
+    MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+  }
+
+  if (MappedRegion.IsValid()) {
+    Data = MappedRegion->GetMappedPtr();
+    Size = MappedRegion->GetMappedSize();
+  } else if (FFileHelper::LoadFileToArray(Bytes, *InFilePath,
+                                          FILEREAD_Silent)) {
+    // Where mapping is not supported the image is read instead
+    Data = Bytes.GetData();
+    Size = Bytes.Num();
+  } else {
+    return false;
+  }
+
+  FilePath = InFilePath;
+  Generation = InGeneration;
+  return true;
+}
+
+void FImage::Adopt(TArray<uint8> &&InBytes, int32 InGeneration) {
+  Bytes = MoveTemp(InBytes);
+  Data = Bytes.GetData();
+  Size = Bytes.Num();
+  Generation = InGeneration;
+}
+} // namespace CodeIndexStorage
@@ -0,0 +1,1210 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeRegex.h"
+#include "Algo/Unique.h"
+#include "Misc/Parse.h"
+
+#define LOCTEXT_NAMESPACE "CodeRegex"
+
+namespace CodeRegexConstants {
+constexpr uint32 MaxCodePoint = 0x10FFFF;
+
+/** Largest count of a {n,m} repeat */
+constexpr int32 MaxRepeat = 1000;
+
+/** Deepest nesting of groups */
+constexpr int32 MaxNesting = 200;
+
+/** Most NFA instructions a pattern may compile to */
+constexpr int32 MaxInstructions = 20000;
+
+/** Memory the states of one DFA may take before they are thrown away */
+constexpr int64 DfaBudgetBytes = 2 * 1024 * 1024;
+
+/** States a DFA may always keep, however large they are */
+constexpr int32 MinDfaStates = 16;
+} // namespace CodeRegexConstants
+
+/** Inclusive range of code points */
+struct FCodeRegexRange {
+  uint32 First;
+  uint32 Last;
+};
+
+enum class ECodeRegexAssert : uint8 {
+  LineStart,
+  LineEnd,
+  WordBoundary,
+  NotWordBoundary
+};
+
+/** Node of a parsed pattern */
+struct FCodeRegexNode {
+  enum class EKind : uint8 { Empty, Set, Concat, Alternate, Repeat, Assert };
+
+  EKind Kind = EKind::Empty;
+  ECodeRegexAssert Assert = ECodeRegexAssert::LineStart;
+
+  /** Character set matched by a Set node */
+  int32 Set = INDEX_NONE;
+
+  /** The character a Set node was written as, if it was a single one */
+  int32 Char = INDEX_NONE;
+
+  /** Repeat counts; Max is INDEX_NONE when unbounded */
+  int32 Min = 0;
+  int32 Max = 0;
+
+  TArray<int32> Children;
+};
+
+enum class ECodeRegexOp : uint8 { Set, Split, Jump, Assert, Match };
+
+/** NFA instruction */
+struct FCodeRegexInst {
+  ECodeRegexOp Op = ECodeRegexOp::Match;
+  ECodeRegexAssert Assert = ECodeRegexAssert::LineStart;
+
+  /** Set of Set, target of Jump, first target of Split */
+  int32 X = 0;
+
+  /** Second target of Split */
+  int32 Y = 0;
+};
+
+struct FCodeRegex::FProgram {
+  /** Instructions; matching starts at the first */
+  TArray<FCodeRegexInst> Insts;
+};
+
+static void AppendCodePoint(FString &Text, uint32 CodePoint) {
+  if (sizeof(TCHAR) == 2 && CodePoint > 0xFFFF) {
+    Text.AppendChar(TCHAR(0xD800 + ((CodePoint - 0x10000) >> 10)));
+    Text.AppendChar(TCHAR(0xDC00 + ((CodePoint - 0x10000) & 0x3FF)));
+  } else {
+    Text.AppendChar(TCHAR(CodePoint));
+  }
+}
+
+/** Sort ranges and merge the ones that overlap or touch */
+static void NormalizeRanges(TArray<FCodeRegexRange> &Ranges) {
+  Ranges.Sort([](const FCodeRegexRange &A, const FCodeRegexRange &B) {
+    return A.First < B.First;
+  });
+  int32 Num = 0;
+  for (int32 Index = 0; Index < Ranges.Num(); ++Index) {
+    const FCodeRegexRange Range = Ranges[Index];
+    if (Num > 0 && Range.First <= Ranges[Num - 1].Last + 1) {
+      Ranges[Num - 1].Last = FMath::Max(Ranges[Num - 1].Last, Range.Last);
+    } else {
+      Ranges[Num++] = Range;
+    }
+  }
+  Ranges.SetNum(Num);
+}
+
+/** Every character the ranges leave out, but for the line break */
+static void NegateRanges(TArray<FCodeRegexRange> &Ranges) {
+  Ranges.Add({'\n', '\n'});
+  NormalizeRanges(Ranges);
+
+  TArray<FCodeRegexRange> Negated;
+  uint32 Next = 0;
+  for (const FCodeRegexRange &Range : Ranges) {
+    if (Range.First > Next) {
+      Negated.Add({Next, Range.First - 1});
+    }
+    Next = Range.Last + 1;
+  }
+  if (Next <= CodeRegexConstants::MaxCodePoint) {
+    Negated.Add({Next, CodeRegexConstants::MaxCodePoint});
+  }
+  Ranges = MoveTemp(Negated);
+}
+
+/** Add the other case of every ASCII letter in the ranges */
+static void FoldRanges(TArray<FCodeRegexRange> &Ranges) {
+  const int32 Num = Ranges.Num();
+  for (int32 Index = 0; Index < Num; ++Index) {
+    const FCodeRegexRange Range = Ranges[Index];
+    const uint32 Lower = FMath::Max<uint32>(Range.First, 'a');
+    const uint32 LowerLast = FMath::Min<uint32>(Range.Last, 'z');
+    if (Lower <= LowerLast) {
+      Ranges.Add({Lower - ('a' - 'A'), LowerLast - ('a' - 'A')});
+    }
+    const uint32 Upper = FMath::Max<uint32>(Range.First, 'A');
+    const uint32 UpperLast = FMath::Min<uint32>(Range.Last, 'Z');
+    if (Upper <= UpperLast) {
+      Ranges.Add({Upper + ('a' - 'A'), UpperLast + ('a' - 'A')});
+    }
+  }
+  NormalizeRanges(Ranges);
+}
+
+static void AddWordRanges(TArray<FCodeRegexRange> &Ranges) {
+  Ranges.Add({'0', '9'});
+  Ranges.Add({'A', 'Z'});
+  Ranges.Add({'_', '_'});
+  Ranges.Add({'a', 'z'});
+  Ranges.Add({0x80, CodeRegexConstants::MaxCodePoint});
+}
+
+/** Whether sorted, merged ranges hold a character */
+static bool RangesContain(const TArray<FCodeRegexRange> &Ranges,
+                          uint32 CodePoint) {
+  const int32 Index =
+      Algo::UpperBoundBy(Ranges, CodePoint,
+                         [](const FCodeRegexRange &Range) {
+                           return Range.First;
+                         }) -
+      1;
+  return Index >= 0 && CodePoint <= Ranges[Index].Last;
+}
+
+/** Recursive descent parser of the syntax FCodeRegex takes */
+class FCodeRegexParser {
+public:
+  FCodeRegexParser(const FString &InPattern, bool bInIgnoreCase)
+      : Pattern(InPattern), bIgnoreCase(bInIgnoreCase) {}
+
+  /** Parse the whole pattern; INDEX_NONE if it is invalid, see Error */
+  int32 Parse() {
+    const int32 Root = ParseAlternate();
+    if (Root != INDEX_NONE && !AtEnd()) {
+      return Fail(LOCTEXT("UnmatchedParen", "Unmatched )"));
+    }
+    return Root;
+  }
+
+  TArray<FCodeRegexNode> Nodes;
+
+  /** Character sets, as sorted, merged ranges */
+  TArray<TArray<FCodeRegexRange>> Sets;
+
+  FText Error;
+
+private:
+  int32 Fail(const FText &InError) {
+    if (Error.IsEmpty()) {
+      Error = InError;
+    }
+    return INDEX_NONE;
+  }
+
+  bool AtEnd() const { return Pos >= Pattern.Len(); }
+  TCHAR Peek() const { return Pattern[Pos]; }
+
+  /** Read a character, joining surrogate pairs */
+  uint32 ReadCodePoint() {
+    uint32 CodePoint = Pattern[Pos++];
+    if (CodePoint >= 0xD800 && CodePoint < 0xDC00 && !AtEnd() &&
+        Peek() >= 0xDC00 && Peek() < 0xE000) {
+      CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Peek() - 0xDC00);
+      ++Pos;
+    }
+    return CodePoint;
+  }
+
+  int32 AddNode(FCodeRegexNode &&Node) { return Nodes.Add(MoveTemp(Node)); }
+
+  int32 AddSet(TArray<FCodeRegexRange> &&Ranges, int32 Char = INDEX_NONE) {
+    if (bIgnoreCase) {
+      FoldRanges(Ranges);
+    } else {
+      NormalizeRanges(Ranges);
+    }
+    FCodeRegexNode Node;
+    Node.Kind = FCodeRegexNode::EKind::Set;
+    Node.Set = Sets.Add(MoveTemp(Ranges));
+    Node.Char = Char;
+    return AddNode(MoveTemp(Node));
+  }
+
+  int32 AddChar(uint32 CodePoint) {
+    TArray<FCodeRegexRange> Ranges;
+    Ranges.Add({CodePoint, CodePoint});
+    return AddSet(MoveTemp(Ranges), int32(CodePoint));
+  }
+
+  int32 AddAssert(ECodeRegexAssert Assert) {
+    FCodeRegexNode Node;
+    Node.Kind = FCodeRegexNode::EKind::Assert;
+    Node.Assert = Assert;
+    return AddNode(MoveTemp(Node));
+  }
+
+  int32 ParseAlternate() {
+    if (++Depth > CodeRegexConstants::MaxNesting) {
+      return Fail(LOCTEXT("TooDeep", "Groups are nested too deeply"));
+    }
+
+    FCodeRegexNode Node;
+    Node.Kind = FCodeRegexNode::EKind::Alternate;
+    for (;;) {
+      const int32 Branch = ParseConcat();
+      if (Branch == INDEX_NONE) {
+        return INDEX_NONE;
+      }
+      Node.Children.Add(Branch);
+      if (AtEnd() || Peek() != '|') {
+        break;
+      }
+      ++Pos;
+    }
+
+    --Depth;
+    return Node.Children.Num() == 1 ? Node.Children[0]
+                                    : AddNode(MoveTemp(Node));
+  }
+
+  int32 ParseConcat() {
+    FCodeRegexNode Node;
+    Node.Kind = FCodeRegexNode::EKind::Concat;
+    while (!AtEnd() && Peek() != '|' && Peek() != ')') {
+      const int32 Item = ParseRepeat();
+      if (Item == INDEX_NONE) {
+        return INDEX_NONE;
+      }
+      Node.Children.Add(Item);
+    }
+    return AddNode(MoveTemp(Node));
+  }
+
+  int32 ParseRepeat() {
+    int32 Item = ParseAtom();
+    while (Item != INDEX_NONE && !AtEnd()) {
+      FCodeRegexNode Node;
+      Node.Kind = FCodeRegexNode::EKind::Repeat;
+      const TCHAR C = Peek();
+      if (C == '*' || C == '+' || C == '?') {
+        Node.Min = C == '+' ? 1 : 0;
+        Node.Max = C == '?' ? 1 : INDEX_NONE;
+        ++Pos;
+      } else if (C != '{' || !ParseCount(Node.Min, Node.Max)) {
+        break;
+      }
+      if (!Error.IsEmpty()) {
+        return INDEX_NONE;
+      }
+
+      // Lazy repeats find the same matches when the longest one wins
+      if (!AtEnd() && Peek() == '?') {
+        ++Pos;
+      }
+      Node.Children.Add(Item);
+      Item = AddNode(MoveTemp(Node));
+    }
+    return Item;
+  }
+
+  /** Parse {n}, {n,} or {n,m} at Pos; false, reading nothing, if not one */
+  bool ParseCount(int32 &OutMin, int32 &OutMax) {
+    int32 At = Pos + 1;
+    auto ReadNumber = [this, &At](int32 &Out) {
+      const int32 From = At;
+      Out = 0;
+      while (At < Pattern.Len() && FChar::IsDigit(Pattern[At])) {
+        Out = FMath::Min(Out * 10 + (Pattern[At] - '0'),
+                         CodeRegexConstants::MaxRepeat + 1);
+        ++At;
+      }
+      return At > From;
+    };
+
+    if (!ReadNumber(OutMin)) {
+      return false;
+    }
+    OutMax = OutMin;
+    if (At < Pattern.Len() && Pattern[At] == ',') {
+      ++At;
+      if (!ReadNumber(OutMax)) {
+        OutMax = INDEX_NONE;
+      }
+    }
+    if (At >= Pattern.Len() || Pattern[At] != '}') {
+      return false;
+    }
+
+    Pos = At + 1;
+    if (OutMin > CodeRegexConstants::MaxRepeat ||
+        OutMax > CodeRegexConstants::MaxRepeat ||
+        (OutMax != INDEX_NONE && OutMax < OutMin)) {
+      Fail(LOCTEXT("BadCount", "Invalid repeat count"));
+    }
+    return true;
+  }
+
+  int32 ParseAtom() {
+    switch (Peek()) {
+    case '(': {
+      ++Pos;
+      if (Pos + 1 < Pattern.Len() && Peek() == '?' && Pattern[Pos + 1] == ':') {
+        Pos += 2;
+      } else if (!AtEnd() && Peek() == '?') {
+        return Fail(LOCTEXT("UnsupportedGroup",
+                            "Only (...) and (?:...) groups are supported"));
+      }
+      const int32 Inner = ParseAlternate();
+      if (Inner == INDEX_NONE) {
+        return INDEX_NONE;
+      }
+      if (AtEnd() || Peek() != ')') {
+        return Fail(LOCTEXT("MissingParen", "Missing )"));
+      }
+      ++Pos;
+      return Inner;
+    }
+    case '[':
+      return ParseClass();
+    case '.': {
+      ++Pos;
+      TArray<FCodeRegexRange> Ranges;
+      NegateRanges(Ranges);
+      return AddSet(MoveTemp(Ranges));
+    }
+    case '^':
+      ++Pos;
+      return AddAssert(ECodeRegexAssert::LineStart);
+    case '$':
+      ++Pos;
+      return AddAssert(ECodeRegexAssert::LineEnd);
+    case '*':
+    case '+':
+    case '?':
+      return Fail(LOCTEXT("NothingToRepeat", "Nothing to repeat"));
+    case '\\': {
+      ++Pos;
+      if (AtEnd()) {
+        return Fail(LOCTEXT("TrailingBackslash", "Pattern ends with \\"));
+      }
+      if (Peek() == 'b' || Peek() == 'B') {
+        return AddAssert(Pattern[Pos++] == 'b'
+                             ? ECodeRegexAssert::WordBoundary
+                             : ECodeRegexAssert::NotWordBoundary);
+      }
+      TArray<FCodeRegexRange> Ranges;
+      if (ParseClassEscape(Ranges)) {
+        return AddSet(MoveTemp(Ranges));
+      }
+      uint32 CodePoint = 0;
+      return ParseCharEscape(CodePoint) ? AddChar(CodePoint) : INDEX_NONE;
+    }
+    default:
+      return AddChar(ReadCodePoint());
+    }
+  }
+
+  /** Parse [...] or [^...] at Pos */
+  int32 ParseClass() {
+    ++Pos;
+    const bool bNegated = !AtEnd() && Peek() == '^';
+    if (bNegated) {
+      ++Pos;
+    }
+
+    TArray<FCodeRegexRange> Ranges;
+    for (bool bFirst = true;; bFirst = false) {
+      if (AtEnd()) {
+        return Fail(LOCTEXT("MissingBracket", "Missing ]"));
+      }
+      // A ] first in the class is a literal
+      if (Peek() == ']' && !bFirst) {
+        ++Pos;
+        break;
+      }
+
+      uint32 First = 0;
+      if (!ReadClassChar(Ranges, First)) {
+        if (!Error.IsEmpty()) {
+          return INDEX_NONE;
+        }
+        continue;
+      }
+      uint32 Last = First;
+
+      // A - before the closing ] is a literal
+      if (Pos + 1 < Pattern.Len() && Peek() == '-' &&
+          Pattern[Pos + 1] != ']') {
+        ++Pos;
+        if (!ReadClassChar(Ranges, Last)) {
+          return Fail(LOCTEXT("BadRange", "Invalid range in [...]"));
+        }
+        if (Last < First) {
+          return Fail(LOCTEXT("BadRange", "Invalid range in [...]"));
+        }
+      }
+      Ranges.Add({First, Last});
+    }
+
+    // Folding first keeps both cases of a letter out of [^...]
+    if (bIgnoreCase) {
+      FoldRanges(Ranges);
+    }
+    if (bNegated) {
+      NegateRanges(Ranges);
+    }
+    return AddSet(MoveTemp(Ranges));
+  }
+
+  /**
+   * Read one character of a class at Pos. Returns false, having added to
+   * Ranges instead, for \d \w \s and their negations, or if it is invalid.
+   */
+  bool ReadClassChar(TArray<FCodeRegexRange> &Ranges, uint32 &OutChar) {
+    if (Peek() != '\\') {
+      OutChar = ReadCodePoint();
+      return true;
+    }
+    ++Pos;
+    if (AtEnd()) {
+      Fail(LOCTEXT("MissingBracket", "Missing ]"));
+      return false;
+    }
+    return !ParseClassEscape(Ranges) && ParseCharEscape(OutChar);
+  }
+
+  /** Parse the d, w or s of \d \w \s or their negations at Pos, if there */
+  bool ParseClassEscape(TArray<FCodeRegexRange> &Ranges) {
+    const TCHAR C = Peek();
+    const TCHAR Lower = FChar::ToLower(C);
+    if (Lower != 'd' && Lower != 'w' && Lower != 's') {
+      return false;
+    }
+    ++Pos;
+
+    TArray<FCodeRegexRange> Class;
+    if (Lower == 'd') {
+      Class.Add({'0', '9'});
+    } else if (Lower == 'w') {
+      AddWordRanges(Class);
+    } else {
+      Class.Add({'\t', '\r'});
+      Class.Add({' ', ' '});
+    }
+    if (C != Lower) {
+      NegateRanges(Class);
+    }
+    Ranges.Append(Class);
+    return true;
+  }
+
+  /** Parse the character of an escape after its backslash */
+  bool ParseCharEscape(uint32 &OutChar) {
+    const TCHAR C = Pattern[Pos++];
+    switch (C) {
+    case 't':
+      OutChar = '\t';
+      return true;
+    case 'r':
+      OutChar = '\r';
+      return true;
+    case 'n':
+      OutChar = '\n';
+      return true;
+    case 'f':
+      OutChar = '\f';
+      return true;
+    case 'v':
+      OutChar = '\v';
+      return true;
+    case '0':
+      OutChar = 0;
+      return true;
+    case 'x':
+    case 'u':
+      return ParseHex(C == 'x' ? 2 : 4, OutChar);
+    default:
+      if (FChar::IsAlnum(C)) {
+        Fail(FText::Format(LOCTEXT("UnknownEscape", "Unknown escape \\{0}"),
+                           FText::FromString(FString(1, &C))));
+        return false;
+      }
+      --Pos;
+      OutChar = ReadCodePoint();
+      return true;
+    }
+  }
+
+  /** Parse the digits of \xHH, \x{H...} or \uHHHH */
+  bool ParseHex(int32 Digits, uint32 &OutChar) {
+    const bool bBraced = !AtEnd() && Peek() == '{';
+    if (bBraced) {
+      ++Pos;
+      Digits = 6;
+    }
+
+    OutChar = 0;
+    int32 NumRead = 0;
+    while (NumRead < Digits && !AtEnd() && FChar::IsHexDigit(Peek())) {
+      OutChar = OutChar * 16 + FParse::HexDigit(Pattern[Pos++]);
+      ++NumRead;
+    }
+    const bool bClosed = !bBraced || (!AtEnd() && Pattern[Pos++] == '}');
+    if (!bClosed || NumRead == 0 || (!bBraced && NumRead != Digits) ||
+        OutChar > CodeRegexConstants::MaxCodePoint) {
+      Fail(LOCTEXT("BadHexEscape", "Invalid hexadecimal escape"));
+      return false;
+    }
+    return true;
+  }
+
+  const FString &Pattern;
+  bool bIgnoreCase;
+  int32 Pos = 0;
+  int32 Depth = 0;
+};
+
+/** Emits the NFA of a parsed pattern, forwards or reversed */
+class FCodeRegexCompiler {
+public:
+  FCodeRegexCompiler(const TArray<FCodeRegexNode> &InNodes, bool bInReverse,
+                     TArray<FCodeRegexInst> &OutInsts)
+      : Nodes(InNodes), bReverse(bInReverse), Insts(OutInsts) {}
+
+  /** False if the program would be too large */
+  bool Compile(int32 Root) {
+    if (!Emit(Root)) {
+      return false;
+    }
+    Add(ECodeRegexOp::Match);
+    return Insts.Num() <= CodeRegexConstants::MaxInstructions;
+  }
+
+private:
+  int32 Add(ECodeRegexOp Op, int32 X = 0) {
+    FCodeRegexInst &Inst = Insts.AddDefaulted_GetRef();
+    Inst.Op = Op;
+    Inst.X = X;
+    return Insts.Num() - 1;
+  }
+
+  bool Emit(int32 Index) {
+    if (Insts.Num() > CodeRegexConstants::MaxInstructions) {
+      return false;
+    }
+
+    const FCodeRegexNode &Node = Nodes[Index];
+    const int32 NumChildren = Node.Children.Num();
+    switch (Node.Kind) {
+    case FCodeRegexNode::EKind::Empty:
+      return true;
+
+    case FCodeRegexNode::EKind::Set:
+      Add(ECodeRegexOp::Set, Node.Set);
+      return true;
+
+    case FCodeRegexNode::EKind::Assert: {
+      // Read backwards, a line starts where it ended
+      ECodeRegexAssert Assert = Node.Assert;
+      if (bReverse && Assert == ECodeRegexAssert::LineStart) {
+        Assert = ECodeRegexAssert::LineEnd;
+      } else if (bReverse && Assert == ECodeRegexAssert::LineEnd) {
+        Assert = ECodeRegexAssert::LineStart;
+      }
+      Insts[Add(ECodeRegexOp::Assert)].Assert = Assert;
+      return true;
+    }
+
+    case FCodeRegexNode::EKind::Concat:
+      for (int32 Child = 0; Child < NumChildren; ++Child) {
+        if (!Emit(Node.Children[bReverse ? NumChildren - 1 - Child : Child])) {
+          return false;
+        }
+      }
+      return true;
+
+    case FCodeRegexNode::EKind::Alternate: {
+      TArray<int32> Jumps;
+      for (int32 Child = 0; Child + 1 < NumChildren; ++Child) {
+        const int32 Split = Add(ECodeRegexOp::Split, Insts.Num() + 1);
+        if (!Emit(Node.Children[Child])) {
+          return false;
+        }
+        Jumps.Add(Add(ECodeRegexOp::Jump));
+        Insts[Split].Y = Insts.Num();
+      }
+      if (!Emit(Node.Children.Last())) {
+        return false;
+      }
+      for (const int32 Jump : Jumps) {
+        Insts[Jump].X = Insts.Num();
+      }
+      return true;
+    }
+
+    case FCodeRegexNode::EKind::Repeat: {
+      const int32 Child = Node.Children[0];
+      for (int32 Count = 0; Count < Node.Min; ++Count) {
+        if (!Emit(Child)) {
+          return false;
+        }
+      }
+
+      if (Node.Max == INDEX_NONE) {
+        const int32 Split = Add(ECodeRegexOp::Split, Insts.Num() + 1);
+        if (!Emit(Child)) {
+          return false;
+        }
+        Add(ECodeRegexOp::Jump, Split);
+        Insts[Split].Y = Insts.Num();
+        return true;
+      }
+
+      TArray<int32> Splits;
+      for (int32 Count = Node.Min; Count < Node.Max; ++Count) {
+        Splits.Add(Add(ECodeRegexOp::Split, Insts.Num() + 1));
+        if (!Emit(Child)) {
+          return false;
+        }
+      }
+      for (const int32 Split : Splits) {
+        Insts[Split].Y = Insts.Num();
+      }
+      return true;
+    }
+    }
+    return false;
+  }
+
+  const TArray<FCodeRegexNode> &Nodes;
+  bool bReverse;
+  TArray<FCodeRegexInst> &Insts;
+};
+
+/** What a node tells about the text of its matches */
+struct FCodeRegexLiteral {
+  /** Whether every match of the node is exactly Text */
+  bool bExact = false;
+
+  /** That text, or else the longest text every match contains */
+  FString Text;
+};
+
+static FCodeRegexLiteral FindRequiredLiteral(
+    const TArray<FCodeRegexNode> &Nodes, int32 Index) {
+  const FCodeRegexNode &Node = Nodes[Index];
+  FCodeRegexLiteral Literal;
+  auto KeepLonger = [&Literal](const FString &Text) {
+    if (Text.Len() > Literal.Text.Len()) {
+      Literal.Text = Text;
+    }
+  };
+
+  switch (Node.Kind) {
+  case FCodeRegexNode::EKind::Empty:
+  case FCodeRegexNode::EKind::Assert:
+    Literal.bExact = true;
+    break;
+
+  case FCodeRegexNode::EKind::Set:
+    if (Node.Char != INDEX_NONE) {
+      Literal.bExact = true;
+      AppendCodePoint(Literal.Text, Node.Char);
+    }
+    break;
+
+  case FCodeRegexNode::EKind::Concat: {
+    // Runs of exact children are contiguous in every match
+    FString Run;
+    bool bExact = true;
+    for (const int32 Child : Node.Children) {
+      const FCodeRegexLiteral ChildLiteral = FindRequiredLiteral(Nodes, Child);
+      if (ChildLiteral.bExact) {
+        Run += ChildLiteral.Text;
+        continue;
+      }
+      bExact = false;
+      KeepLonger(Run);
+      KeepLonger(ChildLiteral.Text);
+      Run.Reset();
+    }
+    KeepLonger(Run);
+    Literal.bExact = bExact;
+    break;
+  }
+
+  case FCodeRegexNode::EKind::Repeat:
+    if (Node.Min > 0) {
+      const FCodeRegexLiteral ChildLiteral =
+          FindRequiredLiteral(Nodes, Node.Children[0]);
+      const int32 Copies = ChildLiteral.bExact ? Node.Min : 1;
+      for (int32 Copy = 0; Copy < Copies; ++Copy) {
+        Literal.Text += ChildLiteral.Text;
+      }
+      Literal.bExact = ChildLiteral.bExact && Node.Min == Node.Max;
+    }
+    break;
+
+  case FCodeRegexNode::EKind::Alternate:
+    break;
+  }
+  return Literal;
+}
+
+FCodeRegex::FCodeRegex() = default;
+FCodeRegex::~FCodeRegex() = default;
+
+TSharedPtr<const FCodeRegex, ESPMode::ThreadSafe>
+FCodeRegex::Compile(const FString &Pattern, bool bIgnoreCase,
+                    FText &OutError) {
+  FCodeRegexParser Parser(Pattern, bIgnoreCase);
+  const int32 Root = Parser.Parse();
+  if (Root == INDEX_NONE) {
+    OutError = Parser.Error;
+    return nullptr;
+  }
+
+  TSharedRef<FCodeRegex, ESPMode::ThreadSafe> Regex =
+      MakeShareable(new FCodeRegex());
+  Regex->Forward = MakeUnique<FProgram>();
+  Regex->Reverse = MakeUnique<FProgram>();
+  if (!FCodeRegexCompiler(Parser.Nodes, false, Regex->Forward->Insts)
+           .Compile(Root) ||
+      !FCodeRegexCompiler(Parser.Nodes, true, Regex->Reverse->Insts)
+           .Compile(Root)) {
+    OutError = LOCTEXT("TooComplex", "Pattern is too complex");
+    return nullptr;
+  }
+
+  // Characters no set tells apart share a class, so DFA states need one
+  // transition per class rather than per character
+  TArray<FCodeRegexRange> WordRanges;
+  AddWordRanges(WordRanges);
+  TArray<uint32> &Starts = Regex->ClassStarts;
+  Starts.Add(0);
+  auto AddBounds = [&Starts](const TArray<FCodeRegexRange> &Ranges) {
+    for (const FCodeRegexRange &Range : Ranges) {
+      Starts.Add(Range.First);
+      if (Range.Last < CodeRegexConstants::MaxCodePoint) {
+        Starts.Add(Range.Last + 1);
+      }
+    }
+  };
+  for (const TArray<FCodeRegexRange> &Set : Parser.Sets) {
+    AddBounds(Set);
+  }
+  AddBounds(WordRanges);
+  Starts.Sort();
+  Starts.SetNum(Algo::Unique(Starts));
+
+  for (uint32 CodePoint = 0; CodePoint < 128; ++CodePoint) {
+    Regex->AsciiClasses[CodePoint] =
+        Algo::UpperBound(Starts, CodePoint) - 1;
+  }
+
+  auto GetClasses = [&Starts](const TArray<FCodeRegexRange> &Ranges) {
+    TBitArray<> Classes(false, Starts.Num());
+    for (int32 Class = 0; Class < Starts.Num(); ++Class) {
+      Classes[Class] = RangesContain(Ranges, Starts[Class]);
+    }
+    return Classes;
+  };
+  Regex->SetClasses.Reserve(Parser.Sets.Num());
+  for (const TArray<FCodeRegexRange> &Set : Parser.Sets) {
+    Regex->SetClasses.Add(GetClasses(Set));
+  }
+  NormalizeRanges(WordRanges);
+  Regex->WordClasses = GetClasses(WordRanges);
+
+  Regex->RequiredLiteral = FindRequiredLiteral(Parser.Nodes, Root).Text;
+  return Regex;
+}
+
+/** A line of TCHARs, UTF-16 where TCHAR takes two bytes */
+struct FCodeRegexTCharLine {
+  const TCHAR *Data;
+  int32 Len;
+
+  uint32 Decode(int32 Pos, int32 &OutNext) const {
+    const uint32 C = uint32(Data[Pos]);
+    OutNext = Pos + 1;
+    if (C >= 0xD800 && C < 0xDC00 && OutNext < Len &&
+        uint32(Data[OutNext]) >= 0xDC00 && uint32(Data[OutNext]) < 0xE000) {
+      return 0x10000 + ((C - 0xD800) << 10) + (Data[OutNext++] - 0xDC00);
+    }
+    return C;
+  }
+
+  uint32 DecodeBack(int32 Pos, int32 &OutPrev) const {
+    const uint32 C = uint32(Data[Pos - 1]);
+    OutPrev = Pos - 1;
+    if (C >= 0xDC00 && C < 0xE000 && OutPrev > 0 &&
+        uint32(Data[OutPrev - 1]) >= 0xD800 &&
+        uint32(Data[OutPrev - 1]) < 0xDC00) {
+      return 0x10000 + ((Data[--OutPrev] - 0xD800) << 10) + (C - 0xDC00);
+    }
+    return C;
+  }
+};
+
+/** A line of UTF-8; malformed bytes read as U+FFFD one at a time */
+struct FCodeRegexUtf8Line {
+  const uint8 *Data;
+  int32 Len;
+
+  uint32 Decode(int32 Pos, int32 &OutNext) const {
+    const uint8 Lead = Data[Pos];
+    OutNext = Pos + 1;
+    if (Lead < 0x80) {
+      return Lead;
+    }
+
+    const int32 Num = Lead >= 0xF0   ? 4
+                      : Lead >= 0xE0 ? 3
+                      : Lead >= 0xC0 ? 2
+                                     : 0;
+    if (Num == 0 || Pos + Num > Len) {
+      return 0xFFFD;
+    }
+    uint32 C = Lead & (0x7F >> Num);
+    for (int32 Index = 1; Index < Num; ++Index) {
+      if ((Data[Pos + Index] & 0xC0) != 0x80) {
+        return 0xFFFD;
+      }
+      C = (C << 6) | (Data[Pos + Index] & 0x3F);
+    }
+    if (C > CodeRegexConstants::MaxCodePoint) {
+      return 0xFFFD;
+    }
+    OutNext = Pos + Num;
+    return C;
+  }
+
+  uint32 DecodeBack(int32 Pos, int32 &OutPrev) const {
+    int32 Start = Pos - 1;
+    while (Start > 0 && Pos - Start < 4 && (Data[Start] & 0xC0) == 0x80) {
+      --Start;
+    }
+    int32 Next = 0;
+    const uint32 C = Decode(Start, Next);
+    if (Next == Pos) {
+      OutPrev = Start;
+      return C;
+    }
+    OutPrev = Pos - 1;
+    return 0xFFFD;
+  }
+};
+
+/**
+ * DFA of a program, built lazily. A state is the set of instructions
+ * threads wait at, not yet followed through jumps, splits and assertions:
+ * the assertions are only decided once the next character is known. So a
+ * state also records whether the previous character was a word character
+ * and whether it is at the start of the line, and a match shows one
+ * character late, as a flag of the state after it.
+ */
+struct FCodeRegexMatcher::FDfa {
+  enum : uint8 { FlagAfterWord = 1, FlagLineStart = 2, FlagMatch = 4 };
+
+  FDfa(const FCodeRegex &InRegex, const FCodeRegex::FProgram &InProgram,
+       bool bInUnanchored)
+      : Regex(InRegex), Program(InProgram), bUnanchored(bInUnanchored),
+        NumClasses(InRegex.ClassStarts.Num()) {
+    const int32 NumInsts = Program.Insts.Num();
+    Sparse.SetNumZeroed(NumInsts);
+    Dense.Reserve(NumInsts);
+    Stack.Reserve(NumInsts);
+    NextPcs.Reserve(NumInsts);
+    Reset();
+  }
+
+  /** State at a line position, after a word character or not */
+  int32 GetStart(bool bLineStart, bool bAfterWord) {
+    const uint8 Flags =
+        (bLineStart ? FlagLineStart : 0) | (bAfterWord ? FlagAfterWord : 0);
+    if (StartStates[Flags] == INDEX_NONE) {
+      const int32 StartPc = 0;
+      const int32 State = AddState(Flags, MakeArrayView(&StartPc, 1));
+      StartStates[Flags] = State;
+    }
+    return StartStates[Flags];
+  }
+
+  /** State after a character of class Class */
+  int32 GetNext(int32 State, int32 Class) {
+    const int32 Next = Transitions[State * NumClasses + Class];
+    return Next != INDEX_NONE ? Next : ComputeNext(State, Class);
+  }
+
+  /** Whether a match ended before the character that led to State */
+  bool IsMatch(int32 State) const {
+    return (States[State].Flags & FlagMatch) != 0;
+  }
+
+  /** Whether no thread is left, so no later match can end */
+  bool IsDead(int32 State) const { return States[State].NumPcs == 0; }
+
+  /** Whether a match ends if the line ends in State */
+  bool MatchesAtEnd(int32 State) {
+    if (States[State].EndMatch == INDEX_NONE) {
+      States[State].EndMatch = Close(State, INDEX_NONE) ? 1 : 0;
+    }
+    return States[State].EndMatch == 1;
+  }
+
+private:
+  struct FState {
+    int32 FirstPc = 0;
+    int32 NumPcs = 0;
+    uint8 Flags = 0;
+    int8 EndMatch = INDEX_NONE;
+  };
+
+  void Reset() {
+    States.Reset();
+    Pcs.Reset();
+    Transitions.Reset();
+    StateByHash.Reset();
+    UsedBytes = 0;
+    for (int32 &State : StartStates) {
+      State = INDEX_NONE;
+    }
+    ++NumResets;
+  }
+
+  /** Memory a state waiting at NumPcs instructions takes */
+  int64 GetStateBytes(int32 NumPcs) const {
+    return sizeof(FState) + sizeof(TPair<uint32, int32>) +
+           (int64(NumClasses) + NumPcs) * sizeof(int32);
+  }
+
+  int32 AddState(uint8 Flags, TArrayView<const int32> StatePcs) {
+    uint32 Hash = Flags;
+    for (const int32 Pc : StatePcs) {
+      Hash = HashCombine(Hash, GetTypeHash(Pc));
+    }
+    for (auto It = StateByHash.CreateConstKeyIterator(Hash); It; ++It) {
+      const FState &State = States[It.Value()];
+      if (State.Flags == Flags && State.NumPcs == StatePcs.Num() &&
+          FMemory::Memcmp(&Pcs[State.FirstPc], StatePcs.GetData(),
+                          StatePcs.Num() * sizeof(int32)) == 0) {
+        return It.Value();
+      }
+    }
+
+    const int64 StateBytes = GetStateBytes(StatePcs.Num());
+    if (States.Num() >= CodeRegexConstants::MinDfaStates &&
+        UsedBytes + StateBytes > CodeRegexConstants::DfaBudgetBytes) {
+      Reset();
+    }
+    UsedBytes += StateBytes;
+    const int32 Index = States.AddDefaulted();
+    States[Index].FirstPc = Pcs.Num();
+    States[Index].NumPcs = StatePcs.Num();
+    States[Index].Flags = Flags;
+    Pcs.Append(StatePcs.GetData(), StatePcs.Num());
+    const int32 FirstTransition = Transitions.AddUninitialized(NumClasses);
+    FMemory::Memset(&Transitions[FirstTransition], 0xFF,
+                    NumClasses * sizeof(int32));
+    StateByHash.Add(Hash, Index);
+    return Index;
+  }
+
+  /**
+   * Follow a state's threads through everything but characters, before a
+   * character of class NextClass or the line end (INDEX_NONE). Leaves the
+   * instructions reached in Dense; returns whether Match is among them.
+   */
+  bool Close(int32 State, int32 NextClass) {
+    const FState &From = States[State];
+    const bool bLineStart = (From.Flags & FlagLineStart) != 0;
+    const bool bAfterWord = (From.Flags & FlagAfterWord) != 0;
+    const bool bLineEnd = NextClass == INDEX_NONE;
+    const bool bBeforeWord = !bLineEnd && Regex.WordClasses[NextClass];
+
+    Dense.Reset();
+    Stack.Reset();
+    Stack.Append(&Pcs[From.FirstPc], From.NumPcs);
+    bool bMatch = false;
+    while (Stack.Num() > 0) {
+      const int32 Pc = Stack.Pop();
+      if (Sparse[Pc] < Dense.Num() && Dense[Sparse[Pc]] == Pc) {
+        continue;
+      }
+      Sparse[Pc] = Dense.Add(Pc);
+
+      const FCodeRegexInst &Inst = Program.Insts[Pc];
+      switch (Inst.Op) {
+      case ECodeRegexOp::Split:
+        Stack.Add(Inst.Y);
+        Stack.Add(Inst.X);
+        break;
+      case ECodeRegexOp::Jump:
+        Stack.Add(Inst.X);
+        break;
+      case ECodeRegexOp::Assert: {
+        bool bHolds = false;
+        switch (Inst.Assert) {
+        case ECodeRegexAssert::LineStart:
+          bHolds = bLineStart;
+          break;
+        case ECodeRegexAssert::LineEnd:
+          bHolds = bLineEnd;
+          break;
+        case ECodeRegexAssert::WordBoundary:
+          bHolds = bAfterWord != bBeforeWord;
+          break;
+        case ECodeRegexAssert::NotWordBoundary:
+          bHolds = bAfterWord == bBeforeWord;
+          break;
+        }
+        if (bHolds) {
+          Stack.Add(Pc + 1);
+        }
+        break;
+      }
+      case ECodeRegexOp::Match:
+        bMatch = true;
+        break;
+      case ECodeRegexOp::Set:
+        break;
+      }
+    }
+    return bMatch;
+  }
+
+  int32 ComputeNext(int32 State, int32 Class) {
+    const int32 ResetsBefore = NumResets;
+    const bool bMatch = Close(State, Class);
+
+    NextPcs.Reset();
+    for (const int32 Pc : Dense) {
+      const FCodeRegexInst &Inst = Program.Insts[Pc];
+      if (Inst.Op == ECodeRegexOp::Set && Regex.SetClasses[Inst.X][Class]) {
+        NextPcs.Add(Pc + 1);
+      }
+    }
+    // Unanchored, a new match may start at every character. Instructions
+    // after distinct ones are distinct, so the set only needs sorting.
+    if (bUnanchored) {
+      NextPcs.Add(0);
+    }
+    NextPcs.Sort();
+
+    const uint8 Flags = (Regex.WordClasses[Class] ? FlagAfterWord : 0) |
+                        (bMatch ? FlagMatch : 0);
+    const int32 Next = AddState(Flags, NextPcs);
+    if (NumResets == ResetsBefore) {
+      Transitions[State * NumClasses + Class] = Next;
+    }
+    return Next;
+  }
+
+  const FCodeRegex &Regex;
+  const FCodeRegex::FProgram &Program;
+  bool bUnanchored;
+  int32 NumClasses;
+
+  /** Memory taken by the states, their instructions and transitions */
+  int64 UsedBytes = 0;
+
+  TArray<FState> States;
+
+  /** Instructions of every state, sorted per state */
+  TArray<int32> Pcs;
+
+  /** Next state per state and class; INDEX_NONE until computed */
+  TArray<int32> Transitions;
+
+  TMultiMap<uint32, int32> StateByHash;
+
+  /** States at a line position, by flags */
+  int32 StartStates[4];
+
+  /** Times the states were thrown away */
+  int32 NumResets = 0;
+
+  /** Scratch sparse set, stack and state, sized to the program */
+  TArray<int32> Sparse;
+  TArray<int32> Dense;
+  TArray<int32> Stack;
+  TArray<int32> NextPcs;
+};
+
+FCodeRegexMatcher::FCodeRegexMatcher(
+    TSharedRef<const FCodeRegex, ESPMode::ThreadSafe> InRegex)
+    : Regex(MoveTemp(InRegex)),
+      Search(MakeUnique<FDfa>(*Regex, *Regex->Forward, true)),
+      Starts(MakeUnique<FDfa>(*Regex, *Regex->Reverse, true)),
+      Extent(MakeUnique<FDfa>(*Regex, *Regex->Forward, false)) {}
+
+FCodeRegexMatcher::~FCodeRegexMatcher() = default;
+
+template <typename LineType>
+void FCodeRegexMatcher::FindAllIn(const LineType &Line, FVisitor Visitor) {
+  // Most lines hold no match, which one pass tells
+  int32 State = Search->GetStart(true, false);
+  bool bFound = false;
+  for (int32 Pos = 0; Pos < Line.Len && !bFound;) {
+    int32 Next = 0;
+    State = Search->GetNext(State, Regex->GetClass(Line.Decode(Pos, Next)));
+    bFound = Search->IsMatch(State);
+    Pos = Next;
+  }
+  if (!bFound && !Search->MatchesAtEnd(State)) {
+    return;
+  }
+
+  // Read backwards, the reversed pattern matches wherever a match starts
+  StartMarks.Reset();
+  StartMarks.AddZeroed(Line.Len + 1);
+  State = Starts->GetStart(true, false);
+  for (int32 Pos = Line.Len; Pos > 0;) {
+    int32 Prev = 0;
+    State = Starts->GetNext(State, Regex->GetClass(Line.DecodeBack(Pos, Prev)));
+    StartMarks[Pos] = Starts->IsMatch(State);
+    Pos = Prev;
+  }
+  StartMarks[0] = Starts->MatchesAtEnd(State);
+
+  // The longest match from each start not inside an earlier match
+  for (int32 Start = 0; Start < Line.Len; ++Start) {
+    if (!StartMarks[Start]) {
+      continue;
+    }
+    const int32 End = FindLongest(Line, Start);
+    if (End > Start) {
+      if (!Visitor(Start, End)) {
+        return;
+      }
+      Start = End - 1;
+    }
+  }
+}
+
+template <typename LineType>
+int32 FCodeRegexMatcher::FindLongest(const LineType &Line, int32 Start) {
+  bool bAfterWord = false;
+  if (Start > 0) {
+    int32 Prev = 0;
+    const uint32 Before = Line.DecodeBack(Start, Prev);
+    bAfterWord = Regex->WordClasses[Regex->GetClass(Before)];
+  }
+
+  int32 State = Extent->GetStart(Start == 0, bAfterWord);
+  int32 End = INDEX_NONE;
+  for (int32 Pos = Start; Pos < Line.Len;) {
+    int32 Next = 0;
+    State = Extent->GetNext(State, Regex->GetClass(Line.Decode(Pos, Next)));
+    if (Extent->IsMatch(State)) {
+      End = Pos;
+    }
+    if (Extent->IsDead(State)) {
+      return End;
+    }
+    Pos = Next;
+  }
+  return Extent->MatchesAtEnd(State) ? Line.Len : End;
+}
+
+void FCodeRegexMatcher::FindAll(FStringView Line, FVisitor Visitor) {
+  FindAllIn(FCodeRegexTCharLine{Line.GetData(), Line.Len()}, Visitor);
+}
+
+void FCodeRegexMatcher::FindAll(const uint8 *Line, int32 Length,
+                                FVisitor Visitor) {
+  FindAllIn(FCodeRegexUtf8Line{Line, Length}, Visitor);
+}
+
+#undef LOCTEXT_NAMESPACE
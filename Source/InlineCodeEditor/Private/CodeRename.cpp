@@ -0,0 +1,209 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeRename.h"
+#include "Algo/Unique.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Containers/StringConv.h"
+#include "FindInFiles.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+namespace CodeRenameConstants {
+/** Appended to a file's path for the temporary file replacing it */
+const TCHAR *TempExtension = TEXT(".icerename");
+} // namespace CodeRenameConstants
+
+/**
+ * Replace FilePath with NewPath in one step, so the file is either still
+ * the old one or already the new one, never missing. IFileManager::Move
+ * deletes the destination before renaming onto it instead.
+ */
+static bool ReplaceFile(const FString &FilePath, const FString &NewPath) {
+#if PLATFORM_WINDOWS
+  return ::MoveFileExW(*FPaths::ConvertRelativePathToFull(NewPath),
+                       *FPaths::ConvertRelativePathToFull(FilePath),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) !=
+         0;
+#else
+  // rename(), which replaces the destination atomically
+  return FPlatformFileManager::Get().GetPlatformFile().MoveFile(*FilePath,
+                                                                *NewPath);
+#endif
+}
+
+static bool IsNameChar(TCHAR Char) {
+  return FChar::IsAlnum(Char) || Char == TEXT('_');
+}
+
+bool FCodeRename::IsValidName(FStringView Name) {
+  if (Name.IsEmpty() || FChar::IsDigit(Name[0])) {
+    return false;
+  }
+  for (const TCHAR Char : Name) {
+    if (!IsNameChar(Char)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FCodeTextEdit FCodeRename::MakeEdit(const FString &Text,
+                                    const TArray<int32> &LineStarts,
+                                    const FString &OldName,
+                                    const FString &NewName,
+                                    const TArray<FFindInFilesMatch> &Sites,
+                                    int32 &OutNumEdits) {
+  OutNumEdits = 0;
+  const int32 Length = OldName.Len();
+  auto IsUseAt = [&Text, &OldName, Length](int32 Offset, int32 LineEnd) {
+    return Offset >= 0 && Offset + Length <= LineEnd &&
+           FCString::Strncmp(*Text + Offset, *OldName, Length) == 0 &&
+           (Offset == 0 || !IsNameChar(Text[Offset - 1])) &&
+           (Offset + Length == Text.Len() ||
+            !IsNameChar(Text[Offset + Length]));
+  };
+
+  TArray<FCodeTextRange> Uses;
+  Uses.Reserve(Sites.Num());
+  for (const FFindInFilesMatch &Site : Sites) {
+    if (Length == 0 || !LineStarts.IsValidIndex(Site.Line - 1)) {
+      continue;
+    }
+    const int32 LineStart = LineStarts[Site.Line - 1];
+    const int32 LineEnd = LineStarts.IsValidIndex(Site.Line)
+                              ? LineStarts[Site.Line]
+                              : Text.Len();
+    int32 Offset = LineStart + Site.Column - 1;
+    if (!IsUseAt(Offset, LineEnd)) {
+      Offset = INDEX_NONE;
+      for (int32 Pos = LineStart; Pos + Length <= LineEnd; ++Pos) {
+        if (IsUseAt(Pos, LineEnd)) {
+          Offset = Pos;
+          break;
+        }
+      }
+    }
+    if (Offset != INDEX_NONE) {
+      Uses.Add({Offset, Offset + Length});
+    }
+  }
+  Uses.Sort([](const FCodeTextRange &A, const FCodeTextRange &B) {
+    return A.Start < B.Start;
+  });
+  Uses.SetNum(Algo::Unique(Uses, [](const FCodeTextRange &A,
+                                    const FCodeTextRange &B) {
+    return A.Start == B.Start;
+  }));
+  OutNumEdits = Uses.Num();
+  return FCodeTextEdit::FromReplacements(Text, Uses, NewName);
+}
+
+void FCodeRename::Start(const FString &RootPath, const FString &OldName,
+                        const FString &NewName,
+                        TArray<FFindInFilesResult> &&Files,
+                        FOnFinished OnFinished) {
+  Async(EAsyncExecution::ThreadPool, [RootPath, OldName, NewName,
+                                      Files = MoveTemp(Files),
+                                      OnFinished = MoveTemp(OnFinished)]() {
+    const double StartTime = FPlatformTime::Seconds();
+    const FTCHARToUTF8 Utf8OldName(*OldName);
+    const FTCHARToUTF8 Utf8NewName(*NewName);
+    const int64 OldLength = Utf8OldName.Length();
+    const uint8 *NewBytes = reinterpret_cast<const uint8 *>(Utf8NewName.Get());
+    const int32 NewLength = Utf8NewName.Length();
+
+    // Uses renamed in each file; INDEX_NONE where the file failed
+    TArray<int32> NumEdits;
+    NumEdits.SetNumZeroed(Files.Num());
+    ParallelFor(
+        Files.Num(),
+        [&](int32 Index) {
+          const FString FilePath = RootPath / Files[Index].Path;
+          TArray<FFindInFilesMatch> Uses;
+          TArray<uint8> Renamed;
+          const bool bRead = FFindInFilesSearch::VisitTextFile(
+              FilePath, [&](const uint8 *Data, int64 Size) {
+                FFindInFilesSearch::FindWordAt(Data, Size, OldName,
+                                               Files[Index].Matches, Uses);
+                Uses.Sort([](const FFindInFilesMatch &A,
+                             const FFindInFilesMatch &B) {
+                  return A.Offset < B.Offset;
+                });
+
+                Renamed.Reserve(Size + Uses.Num() * (NewLength - OldLength));
+                int64 Pos = 0;
+                for (const FFindInFilesMatch &Use : Uses) {
+                  if (Use.Offset < Pos) {
+                    continue;
+                  }
+                  Renamed.Append(Data + Pos, int32(Use.Offset - Pos));
+                  Renamed.Append(NewBytes, NewLength);
+                  Pos = Use.Offset + OldLength;
+                  ++NumEdits[Index];
+                }
+                Renamed.Append(Data + Pos, int32(Size - Pos));
+              });
+          if (!bRead) {
+            NumEdits[Index] = INDEX_NONE;
+            return;
+          }
+          if (NumEdits[Index] == 0) {
+            return;
+          }
+
+          // The file is only replaced once its new contents are written
+          const FString TempPath =
+              FilePath + CodeRenameConstants::TempExtension;
+          if (!FFileHelper::SaveArrayToFile(Renamed, *TempPath)) {
+            IFileManager::Get().Delete(*TempPath, false, false, true);
+            NumEdits[Index] = INDEX_NONE;
+          } else if (!ReplaceFile(FilePath, TempPath)) {
+            // Without the original, the temporary file is all that is left
+            if (IFileManager::Get().FileExists(*FilePath)) {
+              IFileManager::Get().Delete(*TempPath, false, false, true);
+            } else {
+              UE_LOG(LogTemp, Error,
+                     TEXT("InlineCodeEditor: %s is missing; its renamed ")
+                         TEXT("contents are kept in %s"),
+                     *FilePath, *TempPath);
+            }
+            NumEdits[Index] = INDEX_NONE;
+          }
+        },
+        EParallelForFlags::Unbalanced);
+
+    FCodeRenameResult Result;
+    for (int32 Index = 0; Index < Files.Num(); ++Index) {
+      if (NumEdits[Index] == INDEX_NONE) {
+        UE_LOG(LogTemp, Warning,
+               TEXT("InlineCodeEditor: Failed to rename in %s"),
+               *Files[Index].Path);
+        Result.FailedFiles.Add(Files[Index].Path);
+      } else if (NumEdits[Index] > 0) {
+        Result.ChangedFiles.Add(Files[Index].Path);
+        Result.NumEdits += NumEdits[Index];
+      }
+    }
+    UE_LOG(LogTemp, Log,
+           TEXT("InlineCodeEditor: Renamed %s to %s %d times in %d files ")
+               TEXT("in %.2fs"),
+           *OldName, *NewName, Result.NumEdits, Result.ChangedFiles.Num(),
+           FPlatformTime::Seconds() - StartTime);
+
+    AsyncTask(ENamedThreads::GameThread,
+              [OnFinished, Result = MoveTemp(Result)]() mutable {
+                if (OnFinished) {
+                  OnFinished(MoveTemp(Result));
+                }
+              });
+  });
+}
@@ -0,0 +1,1604 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeSymbolIndex.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "CaseSensitiveKeyFuncs.h"
+#include "CodeIndexStorage.h"
+#include "Containers/StringConv.h"
+#include "FCppSyntaxHighlighter.h"
+#include "FileTreePathIndex.h"
+#include "FindInFiles.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/PathViews.h"
+#include "Misc/Paths.h"
+
+namespace CodeSymbolIndexFormat {
+constexpr uint32 Magic = 0x53454349; // "ICES"
+constexpr uint32 Version = 3;
+
+const TCHAR *Extension = TEXT(".icesym");
+
+// [Header][FileRecord x NumFiles][Paths][Names][NameRecord x NumNames]
+// [SymbolRecord x NumSymbols][Bucket x NumBuckets][Postings]. Paths and
+// names are UTF-8, each name stored once. A bucket holds one plus the
+// number of a name, or 0, and a name's bucket is found by linear probing
+// from its hash. Each name's symbols are together, sorted by file and line.
+// Its postings list every use as three varints: the file number, line and
+// column, each less those of the use before. Line and column count from 0
+// again in another file, and the column does on another line.
+
+struct FHeader {
+  uint32 Magic;
+  uint32 Version;
+  int32 NumFiles;
+  int32 NumNames;
+  int32 NumSymbols;
+  int32 NumBuckets;
+  int64 PathsSize;
+  int64 NamesSize;
+  int64 PostingsSize;
+};
+
+struct FFileRecord {
+  int64 Size;
+  int64 Ticks;
+  uint64 PathHash;
+  uint32 PathOffset;
+  uint32 PathLength;
+};
+
+struct FNameRecord {
+  uint64 NameHash;
+  int64 PostingsOffset;
+  uint32 NameOffset;
+  uint32 PostingsSize;
+  int32 FirstSymbol;
+  int32 NumSymbols;
+  int32 NumUses;
+  uint16 NameLength;
+  uint16 Reserved;
+};
+
+struct FSymbolRecord {
+  int32 Name;
+  int32 File;
+  int32 Line;
+  uint8 Kind;
+  uint8 Flags;
+  uint16 Reserved;
+};
+
+/** Symbol flag set for definitions */
+constexpr uint8 DefinitionFlag = 1;
+
+static_assert(sizeof(FHeader) == 48, "Symbol index header layout changed");
+static_assert(sizeof(FFileRecord) == 32,
+              "Symbol index file record layout changed");
+static_assert(sizeof(FNameRecord) == 40,
+              "Symbol index name record layout changed");
+static_assert(sizeof(FSymbolRecord) == 16,
+              "Symbol index symbol record layout changed");
+
+using CodeIndexStorage::ReadVarint;
+using CodeIndexStorage::WriteVarint;
+
+/** Postings of a name while an index is built */
+struct FPostingWriter {
+  /** Add a use; uses come in file, line and column order */
+  void Add(int32 InFile, int32 InLine, int32 InColumn) {
+    if (InFile != File) {
+      Line = 0;
+      Column = 0;
+    }
+    if (InLine != Line) {
+      Column = 0;
+    }
+    WriteVarint(Bytes, uint32(InFile - File));
+    WriteVarint(Bytes, uint32(InLine - Line));
+    WriteVarint(Bytes, uint32(InColumn - Column));
+    File = InFile;
+    Line = InLine;
+    Column = InColumn;
+    ++NumUses;
+  }
+
+  TArray<uint8> Bytes;
+  int32 NumUses = 0;
+  int32 File = 0;
+  int32 Line = 0;
+  int32 Column = 0;
+};
+
+/** Reads the uses in the postings of a name, in order */
+class FPostingReader {
+public:
+  FPostingReader(const uint8 *InData, int64 Size)
+      : Data(InData), End(InData + Size) {}
+
+  /** Read the next use; false at the end, or if the postings are broken */
+  bool Next(int32 &OutFile, int32 &OutLine, int32 &OutColumn) {
+    uint32 FileDelta;
+    uint32 LineDelta;
+    uint32 ColumnDelta;
+    if (Data >= End || !ReadVarint(Data, End, FileDelta) ||
+        !ReadVarint(Data, End, LineDelta) ||
+        !ReadVarint(Data, End, ColumnDelta)) {
+      return false;
+    }
+    if (FileDelta != 0) {
+      Line = 0;
+      Column = 0;
+    }
+    if (LineDelta != 0) {
+      Column = 0;
+    }
+    File += FileDelta;
+    Line += LineDelta;
+    Column += ColumnDelta;
+    OutFile = int32(File);
+    OutLine = int32(Line);
+    OutColumn = int32(Column);
+    return true;
+  }
+
+private:
+  const uint8 *Data;
+  const uint8 *End;
+  uint32 File = 0;
+  uint32 Line = 0;
+  uint32 Column = 0;
+};
+} // namespace CodeSymbolIndexFormat
+
+namespace CodeSymbolIndexConstants {
+/** Extensions of the files parsed for symbols */
+const TCHAR *const SourceExtensions[] = {
+    TEXT("h"),  TEXT("hh"),  TEXT("hpp"), TEXT("hxx"), TEXT("inl"),
+    TEXT("c"),  TEXT("cc"),  TEXT("cpp"), TEXT("cxx"),
+};
+
+/** Files each worker task parses with one tokenizer */
+constexpr int32 FilesPerTask = 16;
+
+/** Longest name indexed, in characters, so its UTF-8 fits a name record */
+constexpr int32 MaxNameLength = MAX_uint16 / 3;
+} // namespace CodeSymbolIndexConstants
+
+static TAutoConsoleVariable<int32> CVarICESymbolIndex(
+    TEXT("ICE.Symbols.Index"), 1,
+    TEXT("Whether ICE keeps an index of the declarations in the C++ source ")
+        TEXT("below the root. Applies to roots opened afterwards."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarICESymbolIndexMergeThreshold(
+    TEXT("ICE.Symbols.IndexMergeThreshold"), 256,
+    TEXT("Source files that may change below the root before the ICE ")
+        TEXT("symbol index is written again; until then they are held in ")
+        TEXT("memory."),
+    ECVF_Default);
+
+using CodeIndexStorage::HashPath;
+
+static uint64 HashName(const ANSICHAR *Utf8, int32 Length) {
+  return CityHash64(Utf8, Length);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Declaration recognizer
+
+/** Token of a source text that can take part in a declaration */
+struct FDeclarationToken {
+  ECppTokenType Type;
+  FStringView Text;
+  int32 Line;
+};
+
+/** Name of the directive on a line starting with one, such as "if" */
+static FStringView GetDirective(const FString &Text,
+                                const ISyntaxTokenizer::FToken &Token) {
+  FStringView Directive(*Text + Token.Range.BeginIndex, Token.Range.Len());
+  Directive.RightChopInline(1);
+  return Directive.TrimStart();
+}
+
+/**
+ * Tokens of Text outside comments and preprocessor directives. Only the
+ * first branch of a conditional is kept, so branches that each open a
+ * brace do not unbalance the rest of the file.
+ */
+static void
+GetDeclarationTokens(const FString &Text,
+                     const TArray<ISyntaxTokenizer::FTokenizedLine> &Lines,
+                     TArray<FDeclarationToken> &OutTokens) {
+  OutTokens.Reset();
+  bool bInDirective = false;
+  int32 ConditionalDepth = 0;
+  int32 SkippedDepth = INDEX_NONE;
+  for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex) {
+    const ISyntaxTokenizer::FTokenizedLine &Line = Lines[LineIndex];
+
+    // Directives declare nothing the recognizer understands; a trailing
+    // backslash continues one onto the next line
+    const bool bContinued = bInDirective;
+    const bool bDirective =
+        !bContinued && Line.Tokens.Num() > 0 &&
+        static_cast<ECppTokenType>(Line.Tokens[0].Type) ==
+            ECppTokenType::PreProcessor;
+    if (bContinued || bDirective) {
+      bInDirective = !Line.Range.IsEmpty() &&
+                     Text[Line.Range.EndIndex - 1] == TEXT('\\');
+    }
+    if (bDirective) {
+      const FStringView Directive = GetDirective(Text, Line.Tokens[0]);
+      if (Directive.StartsWith(TEXT("if"))) {
+        ++ConditionalDepth;
+      } else if (Directive.StartsWith(TEXT("el"))) {
+        if (SkippedDepth == INDEX_NONE) {
+          SkippedDepth = ConditionalDepth;
+        }
+      } else if (Directive.StartsWith(TEXT("endif"))) {
+        if (SkippedDepth == ConditionalDepth) {
+          SkippedDepth = INDEX_NONE;
+        }
+        ConditionalDepth = FMath::Max(ConditionalDepth - 1, 0);
+      }
+    }
+    if (bContinued || bDirective || SkippedDepth != INDEX_NONE) {
+      continue;
+    }
+
+    for (const ISyntaxTokenizer::FToken &Token : Line.Tokens) {
+      const ECppTokenType Type = static_cast<ECppTokenType>(Token.Type);
+      if (Type != ECppTokenType::Comment &&
+          Type != ECppTokenType::IncludePath) {
+        OutTokens.Add({Type,
+                       FStringView(*Text + Token.Range.BeginIndex,
+                                   Token.Range.Len()),
+                       LineIndex + 1});
+      }
+    }
+  }
+}
+
+/** Whether a token is an identifier, rather than a keyword, literal,
+ *  comment or punctuation */
+static bool IsIdentifierToken(ECppTokenType Type, FStringView Text) {
+  switch (Type) {
+  case ECppTokenType::Normal:
+  case ECppTokenType::Type:
+  case ECppTokenType::UnrealMacro:
+  case ECppTokenType::FunctionCall:
+  case ECppTokenType::ClassName:
+  case ECppTokenType::Namespace:
+  case ECppTokenType::TemplateParam:
+    break;
+  default:
+    return false;
+  }
+  if (Text.IsEmpty() || !(FChar::IsAlpha(Text[0]) || Text[0] == TEXT('_'))) {
+    return false;
+  }
+  for (const TCHAR Char : Text) {
+    if (!FChar::IsAlnum(Char) && Char != TEXT('_')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Where each identifier of Text is used. Unlike declarations, uses in
+ * every branch of a conditional and in directives count.
+ */
+static void
+GetOccurrences(const FString &Text,
+               const TArray<ISyntaxTokenizer::FTokenizedLine> &Lines,
+               FCodeOccurrences &OutOccurrences) {
+  struct FUse {
+    FStringView Name;
+    FIntPoint Position;
+  };
+  TArray<FUse> Uses;
+  for (int32 LineIndex = 0; LineIndex < Lines.Num(); ++LineIndex) {
+    const ISyntaxTokenizer::FTokenizedLine &Line = Lines[LineIndex];
+    for (const ISyntaxTokenizer::FToken &Token : Line.Tokens) {
+      const FStringView Name(*Text + Token.Range.BeginIndex,
+                             Token.Range.Len());
+      if (IsIdentifierToken(static_cast<ECppTokenType>(Token.Type), Name)) {
+        const int32 Column =
+            Token.Range.BeginIndex - Line.Range.BeginIndex + 1;
+        Uses.Add({Name, FIntPoint(LineIndex + 1, Column)});
+      }
+    }
+  }
+
+  // Grouped by name, each name's uses staying in text order
+  Algo::StableSort(Uses, [](const FUse &A, const FUse &B) {
+    return A.Name.Compare(B.Name, ESearchCase::CaseSensitive) < 0;
+  });
+  OutOccurrences.Names.Reset();
+  OutOccurrences.FirstPositions.Reset();
+  OutOccurrences.Positions.Reset(Uses.Num());
+  for (int32 Index = 0; Index < Uses.Num(); ++Index) {
+    if (Index == 0 || !Uses[Index].Name.Equals(Uses[Index - 1].Name,
+                                               ESearchCase::CaseSensitive)) {
+      OutOccurrences.Names.Emplace(Uses[Index].Name);
+      OutOccurrences.FirstPositions.Add(OutOccurrences.Positions.Num());
+    }
+    OutOccurrences.Positions.Add(Uses[Index].Position);
+  }
+  OutOccurrences.FirstPositions.Add(OutOccurrences.Positions.Num());
+}
+
+/**
+ * Finds declarations in a token stream by their shape, without resolving
+ * types: a class key followed by a name and a body or base list, a name
+ * followed by a parameter list at namespace or class scope, and the last
+ * name declared after UPROPERTY. Braces are only matched to know which
+ * scope a token is in; function bodies are skipped.
+ */
+class FDeclarationRecognizer {
+public:
+  FDeclarationRecognizer(const TArray<FDeclarationToken> &InTokens,
+                         TArray<FCodeSymbol> &InSymbols)
+      : Tokens(InTokens), Symbols(InSymbols) {}
+
+  void Run();
+
+private:
+  /** Scope a brace opens, as far as declarations go */
+  enum class EScope : uint8 { Namespace, Class, Block };
+
+  bool Is(int32 Index, const TCHAR *Text) const {
+    return Index >= 0 && Index < Tokens.Num() &&
+           Tokens[Index].Text.Equals(Text, ESearchCase::CaseSensitive);
+  }
+
+  bool IsIdentifier(int32 Index) const;
+
+  /** Whether a keyword can come right before a declared function's name */
+  bool IsDeclarationKeyword(int32 Index) const;
+
+  /** Index of the parenthesis closing the one at Open, or of the brace or
+   *  semicolon showing it is not closed */
+  int32 FindClosingParen(int32 Open) const;
+
+  /** Whether the parentheses from Open to Close hold call arguments rather
+   *  than parameters */
+  bool HoldsArguments(int32 Open, int32 Close) const;
+
+  /** Whether the first brace or semicolon from Index is a brace */
+  bool HasBody(int32 Index) const;
+
+  /** Recognize a class, struct or enum declared at its class key; returns
+   *  the index to carry on after */
+  int32 ParseClass(int32 Index);
+
+  /** Recognize a function declared at the name at Index; returns the
+   *  index to carry on after */
+  int32 ParseFunction(int32 Index);
+
+  void AddSymbol(int32 Index, ECodeSymbolKind Kind, bool bDefinition);
+
+  const TArray<FDeclarationToken> &Tokens;
+  TArray<FCodeSymbol> &Symbols;
+
+  /** Open scopes, and the name of each class scope */
+  TArray<EScope> Scopes;
+  TArray<FStringView> ClassNames;
+
+  /** Scope the next brace opens, and its class name */
+  EScope PendingScope = EScope::Block;
+  FStringView PendingClassName;
+};
+
+bool FDeclarationRecognizer::IsIdentifier(int32 Index) const {
+  if (Index < 0 || Index >= Tokens.Num()) {
+    return false;
+  }
+  const FDeclarationToken &Token = Tokens[Index];
+  switch (Token.Type) {
+  case ECppTokenType::Normal:
+  case ECppTokenType::Type:
+  case ECppTokenType::ClassName:
+  case ECppTokenType::Namespace:
+  case ECppTokenType::FunctionCall:
+  case ECppTokenType::TemplateParam:
+    return FChar::IsAlpha(Token.Text[0]) || Token.Text[0] == TEXT('_');
+  default:
+    return false;
+  }
+}
+
+bool FDeclarationRecognizer::IsDeclarationKeyword(int32 Index) const {
+  static const TCHAR *const ExpressionKeywords[] = {
+      TEXT("new"),      TEXT("delete"),   TEXT("sizeof"), TEXT("alignof"),
+      TEXT("decltype"), TEXT("typeid"),   TEXT("this"),   TEXT("nullptr"),
+      TEXT("true"),     TEXT("false"),    TEXT("not"),    TEXT("operator"),
+      TEXT("and"),      TEXT("or"),       TEXT("static_assert"),
+  };
+  if (Tokens[Index].Type != ECppTokenType::Keyword) {
+    return false;
+  }
+  for (const TCHAR *Keyword : ExpressionKeywords) {
+    if (Is(Index, Keyword)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int32 FDeclarationRecognizer::FindClosingParen(int32 Open) const {
+  int32 Depth = 0;
+  for (int32 Index = Open; Index < Tokens.Num(); ++Index) {
+    if (Tokens[Index].Type != ECppTokenType::Punctuation) {
+      continue;
+    }
+    if (Is(Index, TEXT("("))) {
+      ++Depth;
+    } else if (Is(Index, TEXT(")"))) {
+      if (--Depth == 0) {
+        return Index;
+      }
+    } else if (Is(Index, TEXT("{")) || Is(Index, TEXT("}")) ||
+               Is(Index, TEXT(";"))) {
+      return Index;
+    }
+  }
+  return Tokens.Num();
+}
+
+bool FDeclarationRecognizer::HoldsArguments(int32 Open, int32 Close) const {
+  // Only what is directly inside counts: template arguments, array bounds
+  // and default values may hold anything
+  int32 Depth = 0;
+  int32 AngleDepth = 0;
+  bool bInDefault = false;
+  for (int32 Index = Open; Index < Close; ++Index) {
+    const FDeclarationToken &Token = Tokens[Index];
+    if (Is(Index, TEXT("(")) || Is(Index, TEXT("["))) {
+      ++Depth;
+      continue;
+    }
+    if (Is(Index, TEXT(")")) || Is(Index, TEXT("]"))) {
+      --Depth;
+      continue;
+    }
+    if (Depth != 1) {
+      continue;
+    }
+    if (Is(Index, TEXT("<"))) {
+      ++AngleDepth;
+      continue;
+    }
+    if (Is(Index, TEXT(">")) || Is(Index, TEXT(">>"))) {
+      AngleDepth = FMath::Max(AngleDepth - Token.Text.Len(), 0);
+      continue;
+    }
+    if (AngleDepth > 0) {
+      continue;
+    }
+    if (Is(Index, TEXT(","))) {
+      bInDefault = false;
+      continue;
+    }
+    if (Is(Index, TEXT("="))) {
+      bInDefault = true;
+      continue;
+    }
+    if (bInDefault) {
+      continue;
+    }
+
+    switch (Token.Type) {
+    case ECppTokenType::String:
+    case ECppTokenType::Number:
+      return true;
+    case ECppTokenType::MemberAccess:
+      // Dots of a parameter pack are not member access
+      if (!Is(Index - 1, TEXT(".")) && !Is(Index + 1, TEXT("."))) {
+        return true;
+      }
+      break;
+    case ECppTokenType::FunctionCall:
+    case ECppTokenType::UnrealMacro:
+      if (!Is(Index, TEXT("UPARAM"))) {
+        return true;
+      }
+      break;
+    case ECppTokenType::Keyword:
+      if (!IsDeclarationKeyword(Index)) {
+        return true;
+      }
+      break;
+    case ECppTokenType::Operator:
+      // Parameters never start with an operator other than ::
+      if ((Is(Index - 1, TEXT("(")) || Is(Index - 1, TEXT(","))) &&
+          !Is(Index, TEXT("::"))) {
+        return true;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  return false;
+}
+
+bool FDeclarationRecognizer::HasBody(int32 Index) const {
+  for (; Index < Tokens.Num(); ++Index) {
+    if (Is(Index, TEXT("("))) {
+      Index = FindClosingParen(Index);
+      if (Index >= Tokens.Num() || !Is(Index, TEXT(")"))) {
+        return Is(Index, TEXT("{"));
+      }
+    } else if (Is(Index, TEXT("{"))) {
+      return true;
+    } else if (Is(Index, TEXT(";")) || Is(Index, TEXT("}"))) {
+      return false;
+    }
+  }
+  return false;
+}
+
+void FDeclarationRecognizer::AddSymbol(int32 Index, ECodeSymbolKind Kind,
+                                       bool bDefinition) {
+  FCodeSymbol &Symbol = Symbols.AddDefaulted_GetRef();
+  Symbol.Name = FString(Tokens[Index].Text);
+  Symbol.Line = Tokens[Index].Line;
+  Symbol.Kind = Kind;
+  Symbol.bDefinition = bDefinition;
+}
+
+int32 FDeclarationRecognizer::ParseClass(int32 Index) {
+  const ECodeSymbolKind Kind = Is(Index, TEXT("class")) ? ECodeSymbolKind::Class
+                               : Is(Index, TEXT("enum"))
+                                   ? ECodeSymbolKind::Enum
+                                   : ECodeSymbolKind::Struct;
+  int32 Next = Index + 1;
+  if (Kind == ECodeSymbolKind::Enum &&
+      (Is(Next, TEXT("class")) || Is(Next, TEXT("struct")))) {
+    ++Next;
+  }
+
+  // The name is the last one before the body or base list; API macros,
+  // attributes and qualifiers come before it
+  int32 Name = INDEX_NONE;
+  while (Next < Tokens.Num()) {
+    if (Is(Next, TEXT("::"))) {
+      Name = INDEX_NONE;
+      ++Next;
+    } else if (Is(Next + 1, TEXT("(")) &&
+               (IsIdentifier(Next) || Is(Next, TEXT("alignas")))) {
+      Next = FindClosingParen(Next + 1) + 1;
+    } else if (IsIdentifier(Next)) {
+      Name = Next++;
+    } else if (Is(Next, TEXT("final"))) {
+      ++Next;
+    } else {
+      break;
+    }
+  }
+
+  // Anything else is a forward declaration, a specialization, or a class
+  // key naming a type in some other declaration
+  const bool bBody = Is(Next, TEXT("{"));
+  if (!bBody && !(Is(Next, TEXT(":")) && HasBody(Next))) {
+    return Next - 1;
+  }
+  if (Name != INDEX_NONE) {
+    AddSymbol(Name, Kind, true);
+  }
+  PendingScope = Kind == ECodeSymbolKind::Enum ? EScope::Block : EScope::Class;
+  PendingClassName =
+      Name != INDEX_NONE ? Tokens[Name].Text : FStringView();
+  return Next - 1;
+}
+
+int32 FDeclarationRecognizer::ParseFunction(int32 Index) {
+  const int32 Close = FindClosingParen(Index + 1);
+  if (!Is(Close, TEXT(")"))) {
+    return Index;
+  }
+
+  // A declaration has a return type, a qualifier or a specifier before its
+  // name, except for a constructor
+  const int32 Previous = Index - 1;
+  bool bReturnType = false;
+  if (Previous >= 0) {
+    if (Is(Previous, TEXT("~"))) {
+      return Index;
+    }
+    bReturnType = IsIdentifier(Previous) || IsDeclarationKeyword(Previous) ||
+                  Is(Previous, TEXT("::")) || Is(Previous, TEXT("*")) ||
+                  Is(Previous, TEXT("&")) || Is(Previous, TEXT("&&")) ||
+                  Is(Previous, TEXT(">")) || Is(Previous, TEXT(">>"));
+  }
+  if (!bReturnType &&
+      !(Scopes.Last() == EScope::Class &&
+        Tokens[Index].Text.Equals(ClassNames.Last(),
+                                  ESearchCase::CaseSensitive))) {
+    return Index;
+  }
+  if (HoldsArguments(Index + 1, Close)) {
+    return Index;
+  }
+
+  // After the parameters come a body, a terminator, an initializer list or
+  // qualifiers; anything else makes it an expression
+  const int32 After = Close + 1;
+  if (After >= Tokens.Num()) {
+    return Close;
+  }
+  const FDeclarationToken &Token = Tokens[After];
+  const bool bDeclaration =
+      Is(After, TEXT("{")) || Is(After, TEXT(";")) || Is(After, TEXT(":")) ||
+      Is(After, TEXT("=")) || Is(After, TEXT("->")) || Is(After, TEXT("&")) ||
+      Is(After, TEXT("&&")) || Token.Type == ECppTokenType::UnrealMacro ||
+      (Token.Type == ECppTokenType::Keyword && IsDeclarationKeyword(After)) ||
+      Is(After, TEXT("throw"));
+  if (bDeclaration) {
+    AddSymbol(Index, ECodeSymbolKind::Function, HasBody(After));
+  }
+  return Close;
+}
+
+void FDeclarationRecognizer::Run() {
+  Scopes.Add(EScope::Namespace);
+  ClassNames.AddDefaulted();
+
+  // Name most recently seen after UPROPERTY, while its declaration lasts
+  bool bInProperty = false;
+  int32 PropertyName = INDEX_NONE;
+  auto EndProperty = [this, &bInProperty, &PropertyName]() {
+    if (bInProperty && PropertyName != INDEX_NONE) {
+      AddSymbol(PropertyName, ECodeSymbolKind::Property, true);
+    }
+    bInProperty = false;
+    PropertyName = INDEX_NONE;
+  };
+
+  for (int32 Index = 0; Index < Tokens.Num(); ++Index) {
+    const FDeclarationToken &Token = Tokens[Index];
+    if (Token.Type == ECppTokenType::Punctuation) {
+      if (Is(Index, TEXT("{"))) {
+        EndProperty();
+        Scopes.Add(PendingScope);
+        ClassNames.Add(PendingClassName);
+        PendingScope = EScope::Block;
+        PendingClassName = FStringView();
+      } else if (Is(Index, TEXT("}"))) {
+        // Unbalanced braces, as #if branches can leave, never close the
+        // file itself
+        bInProperty = false;
+        if (Scopes.Num() > 1) {
+          Scopes.Pop();
+          ClassNames.Pop();
+        }
+        PendingScope = EScope::Block;
+      } else if (Is(Index, TEXT(";")) || Is(Index, TEXT("["))) {
+        EndProperty();
+        PendingScope = EScope::Block;
+      }
+      continue;
+    }
+    if (Scopes.Last() == EScope::Block) {
+      continue;
+    }
+
+    if (bInProperty) {
+      if (IsIdentifier(Index)) {
+        PropertyName = Index;
+      } else if (Is(Index, TEXT("=")) || Is(Index, TEXT(":"))) {
+        EndProperty();
+      }
+      continue;
+    }
+
+    if (Token.Type == ECppTokenType::UnrealMacro) {
+      // Names colored as macros, such as GetName, can still be declared
+      const int32 NumSymbols = Symbols.Num();
+      if (Is(Index + 1, TEXT("("))) {
+        const int32 Next = ParseFunction(Index);
+        if (Symbols.Num() > NumSymbols) {
+          Index = Next;
+          continue;
+        }
+      }
+
+      // Specifiers of reflection macros are not declarations
+      bInProperty = Is(Index, TEXT("UPROPERTY"));
+      if (Is(Index + 1, TEXT("("))) {
+        Index = FindClosingParen(Index + 1);
+        if (!Is(Index, TEXT(")"))) {
+          --Index;
+        }
+      }
+    } else if (Is(Index, TEXT("namespace"))) {
+      PendingScope = EScope::Namespace;
+    } else if (Is(Index, TEXT("extern")) && Index + 1 < Tokens.Num() &&
+               Tokens[Index + 1].Type == ECppTokenType::String) {
+      PendingScope = EScope::Namespace;
+    } else if ((Token.Type == ECppTokenType::Keyword ||
+                Token.Type == ECppTokenType::ClassName) &&
+               (Is(Index, TEXT("class")) || Is(Index, TEXT("struct")) ||
+                Is(Index, TEXT("union")) || Is(Index, TEXT("enum")))) {
+      Index = ParseClass(Index);
+    } else if ((Token.Type == ECppTokenType::FunctionCall ||
+                Token.Type == ECppTokenType::Normal) &&
+               IsIdentifier(Index) && Is(Index + 1, TEXT("("))) {
+      Index = ParseFunction(Index);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Index image
+
+struct FCodeSymbolIndex::FSnapshot : CodeIndexStorage::FImage {
+  /** Read the header and check every record; false if malformed */
+  bool Parse() {
+    using namespace CodeSymbolIndexFormat;
+    if (Size < int64(sizeof(FHeader))) {
+      return false;
+    }
+    FMemory::Memcpy(&Header, Data, sizeof(FHeader));
+    if (Header.Magic != Magic || Header.Version != Version ||
+        Header.NumFiles < 0 || Header.NumNames < 0 || Header.NumSymbols < 0 ||
+        Header.PathsSize < 0 || Header.NamesSize < 0 ||
+        Header.PostingsSize < 0 || Header.NumBuckets < 0 ||
+        (Header.NumBuckets & (Header.NumBuckets - 1)) != 0) {
+      return false;
+    }
+
+    FilesOffset = sizeof(FHeader);
+    PathsOffset = FilesOffset + int64(Header.NumFiles) * sizeof(FFileRecord);
+    NamesOffset = PathsOffset + Header.PathsSize;
+    NameRecordsOffset = Align(NamesOffset + Header.NamesSize, 8);
+    SymbolsOffset =
+        NameRecordsOffset + int64(Header.NumNames) * sizeof(FNameRecord);
+    BucketsOffset =
+        SymbolsOffset + int64(Header.NumSymbols) * sizeof(FSymbolRecord);
+    PostingsOffset = BucketsOffset + int64(Header.NumBuckets) * sizeof(uint32);
+    if (PostingsOffset + Header.PostingsSize != Size) {
+      return false;
+    }
+
+    FileByPathHash.Reserve(Header.NumFiles);
+    for (int32 Index = 0; Index < Header.NumFiles; ++Index) {
+      const FFileRecord File = GetFile(Index);
+      if (int64(File.PathOffset) + File.PathLength > Header.PathsSize) {
+        return false;
+      }
+      FileByPathHash.Add(File.PathHash, Index);
+    }
+
+    // Postings are checked as they are read
+    for (int32 Index = 0; Index < Header.NumNames; ++Index) {
+      const FNameRecord Name = GetName(Index);
+      if (int64(Name.NameOffset) + Name.NameLength > Header.NamesSize ||
+          Name.PostingsOffset < 0 ||
+          Name.PostingsOffset + Name.PostingsSize > Header.PostingsSize ||
+          Name.FirstSymbol < 0 || Name.NumSymbols < 0 ||
+          int64(Name.FirstSymbol) + Name.NumSymbols > Header.NumSymbols ||
+          Name.NumUses < 0) {
+        return false;
+      }
+    }
+
+    for (int32 Index = 0; Index < Header.NumSymbols; ++Index) {
+      const FSymbolRecord Symbol = GetSymbol(Index);
+      if (Symbol.Name < 0 || Symbol.Name >= Header.NumNames ||
+          Symbol.File < 0 || Symbol.File >= Header.NumFiles ||
+          Symbol.Kind > uint8(ECodeSymbolKind::Property)) {
+        return false;
+      }
+    }
+
+    for (int32 Index = 0; Index < Header.NumBuckets; ++Index) {
+      if (GetBucket(Index) > uint32(Header.NumNames)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int32 NumFiles() const { return Header.NumFiles; }
+  int32 NumNames() const { return Header.NumNames; }
+  int32 NumSymbols() const { return Header.NumSymbols; }
+  int64 GetPostingsSize() const { return Header.PostingsSize; }
+
+  CodeSymbolIndexFormat::FFileRecord GetFile(int32 Index) const {
+    CodeSymbolIndexFormat::FFileRecord File;
+    FMemory::Memcpy(&File, Data + FilesOffset + Index * sizeof(File),
+                    sizeof(File));
+    return File;
+  }
+
+  CodeSymbolIndexFormat::FNameRecord GetName(int32 Index) const {
+    CodeSymbolIndexFormat::FNameRecord Name;
+    FMemory::Memcpy(&Name, Data + NameRecordsOffset + Index * sizeof(Name),
+                    sizeof(Name));
+    return Name;
+  }
+
+  CodeSymbolIndexFormat::FSymbolRecord GetSymbol(int32 Index) const {
+    CodeSymbolIndexFormat::FSymbolRecord Symbol;
+    FMemory::Memcpy(&Symbol, Data + SymbolsOffset + Index * sizeof(Symbol),
+                    sizeof(Symbol));
+    return Symbol;
+  }
+
+  uint32 GetBucket(int32 Index) const {
+    uint32 Bucket;
+    FMemory::Memcpy(&Bucket, Data + BucketsOffset + Index * sizeof(Bucket),
+                    sizeof(Bucket));
+    return Bucket;
+  }
+
+  /** UTF-8 path of an indexed file */
+  const uint8 *
+  GetPathBytes(const CodeSymbolIndexFormat::FFileRecord &File) const {
+    return Data + PathsOffset + File.PathOffset;
+  }
+
+  FString GetPath(int32 Index) const {
+    const CodeSymbolIndexFormat::FFileRecord File = GetFile(Index);
+    const FUTF8ToTCHAR Path(
+        reinterpret_cast<const ANSICHAR *>(GetPathBytes(File)),
+        File.PathLength);
+    return FString(Path.Length(), Path.Get());
+  }
+
+  /** UTF-8 text of a name */
+  const ANSICHAR *
+  GetNameBytes(const CodeSymbolIndexFormat::FNameRecord &Name) const {
+    return reinterpret_cast<const ANSICHAR *>(Data + NamesOffset +
+                                              Name.NameOffset);
+  }
+
+  /** Reader of the uses of a name */
+  CodeSymbolIndexFormat::FPostingReader
+  GetPostings(const CodeSymbolIndexFormat::FNameRecord &Name) const {
+    return CodeSymbolIndexFormat::FPostingReader(
+        Data + PostingsOffset + Name.PostingsOffset, Name.PostingsSize);
+  }
+
+  /** Number of a UTF-8 name, or INDEX_NONE */
+  int32 FindName(const ANSICHAR *Name, int32 Length) const {
+    if (Header.NumBuckets == 0) {
+      return INDEX_NONE;
+    }
+
+    const uint64 Hash = HashName(Name, Length);
+    const uint32 Mask = uint32(Header.NumBuckets) - 1;
+    uint32 Bucket = uint32(Hash) & Mask;
+    for (int32 Probe = 0; Probe < Header.NumBuckets; ++Probe) {
+      const uint32 Entry = GetBucket(Bucket);
+      if (Entry == 0) {
+        break;
+      }
+      const CodeSymbolIndexFormat::FNameRecord Record = GetName(Entry - 1);
+      if (Record.NameHash == Hash && Record.NameLength == Length &&
+          FMemory::Memcmp(GetNameBytes(Record), Name, Length) == 0) {
+        return Entry - 1;
+      }
+      Bucket = (Bucket + 1) & Mask;
+    }
+    return INDEX_NONE;
+  }
+
+  CodeSymbolIndexFormat::FHeader Header;
+  int64 FilesOffset = 0;
+  int64 PathsOffset = 0;
+  int64 NamesOffset = 0;
+  int64 NameRecordsOffset = 0;
+  int64 SymbolsOffset = 0;
+  int64 BucketsOffset = 0;
+  int64 PostingsOffset = 0;
+
+  /** Indexed file numbers by path hash */
+  TMap<uint64, int32> FileByPathHash;
+};
+
+/** A source file read and parsed on a worker thread */
+struct FParsedSource {
+  FFileStatData Stat;
+  TArray<FCodeSymbol> Symbols;
+  FCodeOccurrences Occurrences;
+};
+
+/** Parse root-relative source files in parallel, a tokenizer per task */
+static void ParseSources(const FString &RootPath, const TArray<FString> &Paths,
+                         const FThreadSafeBool &Cancelled,
+                         TArray<FParsedSource> &OutSources) {
+  OutSources.SetNum(Paths.Num());
+  const int32 NumTasks = FMath::DivideAndRoundUp(
+      Paths.Num(), CodeSymbolIndexConstants::FilesPerTask);
+  ParallelFor(
+      NumTasks,
+      [&](int32 Task) {
+        const int32 First = Task * CodeSymbolIndexConstants::FilesPerTask;
+        const int32 Last = FMath::Min(
+            First + CodeSymbolIndexConstants::FilesPerTask, Paths.Num());
+
+        TSharedRef<FCppSyntaxTokenizer> Tokenizer =
+            FCppSyntaxTokenizer::Create();
+        for (int32 Index = First; Index < Last && !Cancelled; ++Index) {
+          const FString FilePath = RootPath / Paths[Index];
+          FParsedSource &Source = OutSources[Index];
+          Source.Stat = IFileManager::Get().GetStatData(*FilePath);
+          FFindInFilesSearch::VisitTextFile(
+              FilePath, [&](const uint8 *Data, int64 Size) {
+                const FUTF8ToTCHAR Converted(
+                    reinterpret_cast<const ANSICHAR *>(Data), int32(Size));
+                const FString Text(Converted.Length(), Converted.Get());
+                FCodeSymbolIndex::ParseSymbols(*Tokenizer, Text,
+                                               Source.Symbols,
+                                               Source.Occurrences);
+              });
+        }
+      },
+      EParallelForFlags::Unbalanced);
+}
+
+/** Symbol of a file while an index is built, its name interned */
+struct FSymbolEntry {
+  int32 Name;
+  int32 File;
+  int32 Line;
+  uint8 Kind;
+  uint8 Flags;
+};
+
+/**
+ * Build an index image holding the symbols and uses of Kept files of Old,
+ * in that order, then of Parsed files read from below RootPath. Kept must
+ * be sorted. Returns false if cancelled.
+ */
+static bool BuildIndex(const FString &RootPath,
+                       const FCodeSymbolIndex::FSnapshot *Old,
+                       const TArray<int32> &Kept,
+                       const TArray<FString> &Parsed,
+                       const FThreadSafeBool &Cancelled,
+                       TArray<uint8> &OutBytes) {
+  using namespace CodeSymbolIndexFormat;
+
+  TArray<FFileRecord> Files;
+  TArray<uint8> Paths;
+  Files.Reserve(Kept.Num() + Parsed.Num());
+
+  // Names too long for a record are dropped
+  TMap<FString, int32, FDefaultSetAllocator, TCaseSensitiveKeyFuncs<int32>>
+      NameIds;
+  TArray<FString> Names;
+  TArray<FPostingWriter> Postings;
+  TArray<FSymbolEntry> Entries;
+  auto AddName = [&NameIds, &Names, &Postings](FString &&Name) {
+    if (Name.Len() > CodeSymbolIndexConstants::MaxNameLength) {
+      return int32(INDEX_NONE);
+    }
+    int32 &NameId = NameIds.FindOrAdd(Name, INDEX_NONE);
+    if (NameId == INDEX_NONE) {
+      NameId = Names.Add(MoveTemp(Name));
+      Postings.AddDefaulted();
+    }
+    return NameId;
+  };
+
+  // Carry the kept files, their symbols and their uses over. Kept files
+  // keep their order, so each name's uses stay in file order
+  if (Old && Kept.Num() > 0) {
+    TArray<int32> OldToNew;
+    OldToNew.Init(INDEX_NONE, Old->NumFiles());
+    for (int32 Index = 0; Index < Kept.Num(); ++Index) {
+      OldToNew[Kept[Index]] = Index;
+
+      FFileRecord File = Old->GetFile(Kept[Index]);
+      const uint8 *Path = Old->GetPathBytes(File);
+      File.PathOffset = Paths.Num();
+      Paths.Append(Path, File.PathLength);
+      Files.Add(File);
+    }
+
+    for (int32 Index = 0; Index < Old->NumNames(); ++Index) {
+      if ((Index & 0xFFF) == 0 && Cancelled) {
+        return false;
+      }
+      const FNameRecord Record = Old->GetName(Index);
+      const FUTF8ToTCHAR Utf8Name(Old->GetNameBytes(Record),
+                                  Record.NameLength);
+      const int32 Name = AddName(FString(Utf8Name.Length(), Utf8Name.Get()));
+      if (Name == INDEX_NONE) {
+        continue;
+      }
+
+      for (int32 Symbol = Record.FirstSymbol;
+           Symbol < Record.FirstSymbol + Record.NumSymbols; ++Symbol) {
+        const FSymbolRecord Entry = Old->GetSymbol(Symbol);
+        if (OldToNew[Entry.File] != INDEX_NONE) {
+          Entries.Add({Name, OldToNew[Entry.File], Entry.Line, Entry.Kind,
+                       Entry.Flags});
+        }
+      }
+
+      FPostingReader Reader = Old->GetPostings(Record);
+      int32 File;
+      int32 Line;
+      int32 Column;
+      while (Reader.Next(File, Line, Column) && File >= 0 &&
+             File < Old->NumFiles()) {
+        if (OldToNew[File] != INDEX_NONE) {
+          Postings[Name].Add(OldToNew[File], Line, Column);
+        }
+      }
+    }
+  }
+
+  // Parse the other files in parallel, then add them in order. Unreadable
+  // files are kept without symbols, so they are known
+  TArray<FParsedSource> Sources;
+  ParseSources(RootPath, Parsed, Cancelled, Sources);
+  if (Cancelled) {
+    return false;
+  }
+  for (int32 Index = 0; Index < Parsed.Num(); ++Index) {
+    const FString &Path = Parsed[Index];
+    const FTCHARToUTF8 Utf8Path(*Path);
+
+    FFileRecord File;
+    File.Size = Sources[Index].Stat.FileSize;
+    File.Ticks = Sources[Index].Stat.ModificationTime.GetTicks();
+    File.PathHash = HashPath(Path);
+    File.PathOffset = Paths.Num();
+    File.PathLength = Utf8Path.Length();
+    Paths.Append(reinterpret_cast<const uint8 *>(Utf8Path.Get()),
+                 Utf8Path.Length());
+
+    const int32 FileNumber = Files.Add(File);
+    for (FCodeSymbol &Symbol : Sources[Index].Symbols) {
+      const int32 Name = AddName(MoveTemp(Symbol.Name));
+      if (Name != INDEX_NONE) {
+        Entries.Add({Name, FileNumber, Symbol.Line, uint8(Symbol.Kind),
+                     uint8(Symbol.bDefinition ? DefinitionFlag : 0)});
+      }
+    }
+
+    FCodeOccurrences &Occurrences = Sources[Index].Occurrences;
+    for (int32 Used = 0; Used < Occurrences.Names.Num(); ++Used) {
+      const int32 Name = AddName(MoveTemp(Occurrences.Names[Used]));
+      if (Name == INDEX_NONE) {
+        continue;
+      }
+      for (int32 Position = Occurrences.FirstPositions[Used];
+           Position < Occurrences.FirstPositions[Used + 1]; ++Position) {
+        const FIntPoint &Use = Occurrences.Positions[Position];
+        Postings[Name].Add(FileNumber, Use.X, Use.Y);
+      }
+    }
+  }
+  if (Cancelled) {
+    return false;
+  }
+
+  // Names neither declared nor used any more are dropped; the others are
+  // numbered in the order they were added
+  TArray<int32> SymbolCounts;
+  SymbolCounts.SetNumZeroed(Names.Num());
+  for (const FSymbolEntry &Entry : Entries) {
+    ++SymbolCounts[Entry.Name];
+  }
+  TArray<int32> NameNumbers;
+  NameNumbers.Init(INDEX_NONE, Names.Num());
+  int32 NumNames = 0;
+  for (int32 Name = 0; Name < Names.Num(); ++Name) {
+    if (SymbolCounts[Name] > 0 || Postings[Name].NumUses > 0) {
+      NameNumbers[Name] = NumNames++;
+    }
+  }
+
+  Entries.Sort([](const FSymbolEntry &A, const FSymbolEntry &B) {
+    if (A.Name != B.Name) {
+      return A.Name < B.Name;
+    }
+    return A.File != B.File ? A.File < B.File : A.Line < B.Line;
+  });
+
+  // Name records point at each name's symbols and postings, and each name
+  // is entered in the hash table
+  TArray<FNameRecord> NameRecords;
+  NameRecords.Reserve(NumNames);
+  TArray<uint8> NameBytes;
+  const int32 NumBuckets =
+      NumNames > 0 ? int32(FMath::RoundUpToPowerOfTwo(NumNames * 2)) : 0;
+  TArray<uint32> Buckets;
+  Buckets.SetNumZeroed(NumBuckets);
+  int32 FirstSymbol = 0;
+  int64 PostingsSize = 0;
+  for (int32 Name = 0; Name < Names.Num(); ++Name) {
+    if (NameNumbers[Name] == INDEX_NONE) {
+      continue;
+    }
+
+    const FTCHARToUTF8 Utf8Name(*Names[Name]);
+    FNameRecord &Record = NameRecords.AddZeroed_GetRef();
+    Record.NameHash = HashName(
+        reinterpret_cast<const ANSICHAR *>(Utf8Name.Get()), Utf8Name.Length());
+    Record.PostingsOffset = PostingsSize;
+    Record.NameOffset = NameBytes.Num();
+    Record.PostingsSize = Postings[Name].Bytes.Num();
+    Record.FirstSymbol = FirstSymbol;
+    Record.NumSymbols = SymbolCounts[Name];
+    Record.NumUses = Postings[Name].NumUses;
+    Record.NameLength = uint16(Utf8Name.Length());
+    NameBytes.Append(reinterpret_cast<const uint8 *>(Utf8Name.Get()),
+                     Utf8Name.Length());
+    FirstSymbol += Record.NumSymbols;
+    PostingsSize += Record.PostingsSize;
+
+    uint32 Bucket = uint32(Record.NameHash) & (NumBuckets - 1);
+    while (Buckets[Bucket] != 0) {
+      Bucket = (Bucket + 1) & (NumBuckets - 1);
+    }
+    Buckets[Bucket] = NameNumbers[Name] + 1;
+  }
+
+  FHeader Header;
+  Header.Magic = Magic;
+  Header.Version = Version;
+  Header.NumFiles = Files.Num();
+  Header.NumNames = NumNames;
+  Header.NumSymbols = Entries.Num();
+  Header.NumBuckets = NumBuckets;
+  Header.PathsSize = Paths.Num();
+  Header.NamesSize = NameBytes.Num();
+  Header.PostingsSize = PostingsSize;
+
+  const int64 PathsOffset = sizeof(FHeader) + Files.Num() * sizeof(FFileRecord);
+  const int64 NamesOffset = PathsOffset + Paths.Num();
+  const int64 NameRecordsOffset = Align(NamesOffset + NameBytes.Num(), 8);
+  const int64 SymbolsOffset =
+      NameRecordsOffset + NumNames * sizeof(FNameRecord);
+  const int64 BucketsOffset =
+      SymbolsOffset + Entries.Num() * sizeof(FSymbolRecord);
+  const int64 PostingsOffset = BucketsOffset + NumBuckets * sizeof(uint32);
+  OutBytes.SetNumZeroed(PostingsOffset + PostingsSize);
+
+  uint8 *Out = OutBytes.GetData();
+  FMemory::Memcpy(Out, &Header, sizeof(Header));
+  FMemory::Memcpy(Out + sizeof(FHeader), Files.GetData(),
+                  Files.Num() * sizeof(FFileRecord));
+  FMemory::Memcpy(Out + PathsOffset, Paths.GetData(), Paths.Num());
+  FMemory::Memcpy(Out + NamesOffset, NameBytes.GetData(), NameBytes.Num());
+  FMemory::Memcpy(Out + NameRecordsOffset, NameRecords.GetData(),
+                  NumNames * sizeof(FNameRecord));
+  for (int32 Index = 0; Index < Entries.Num(); ++Index) {
+    const FSymbolEntry &Entry = Entries[Index];
+    FSymbolRecord Symbol;
+    Symbol.Name = NameNumbers[Entry.Name];
+    Symbol.File = Entry.File;
+    Symbol.Line = Entry.Line;
+    Symbol.Kind = Entry.Kind;
+    Symbol.Flags = Entry.Flags;
+    Symbol.Reserved = 0;
+    FMemory::Memcpy(Out + SymbolsOffset + Index * sizeof(FSymbolRecord),
+                    &Symbol, sizeof(Symbol));
+  }
+  FMemory::Memcpy(Out + BucketsOffset, Buckets.GetData(),
+                  NumBuckets * sizeof(uint32));
+  for (int32 Name = 0; Name < Names.Num(); ++Name) {
+    if (NameNumbers[Name] != INDEX_NONE) {
+      const FNameRecord &Record = NameRecords[NameNumbers[Name]];
+      FMemory::Memcpy(Out + PostingsOffset + Record.PostingsOffset,
+                      Postings[Name].Bytes.GetData(), Record.PostingsSize);
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FCodeSymbolIndex
+
+TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe>
+FCodeSymbolIndex::Create(const FString &RootPath) {
+  if (CVarICESymbolIndex.GetValueOnGameThread() == 0 || RootPath.IsEmpty()) {
+    return nullptr;
+  }
+
+  TSharedRef<FCodeSymbolIndex, ESPMode::ThreadSafe> Index =
+      MakeShareable(new FCodeSymbolIndex(RootPath));
+  Index->Load();
+  return Index;
+}
+
+FCodeSymbolIndex::FCodeSymbolIndex(const FString &InRootPath)
+    : RootPath(FPaths::ConvertRelativePathToFull(InRootPath)),
+      Cancelled(MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false)) {
+  FPaths::NormalizeDirectoryName(RootPath);
+  IndexName = CodeIndexStorage::MakeIndexName(RootPath);
+}
+
+FCodeSymbolIndex::~FCodeSymbolIndex() { *Cancelled = true; }
+
+FString FCodeSymbolIndex::GetIndexPath(int32 Generation) const {
+  return CodeIndexStorage::GetGenerationPath(
+      FPaths::ProjectSavedDir() / TEXT("ICE") / TEXT("Symbols"), IndexName,
+      Generation, CodeSymbolIndexFormat::Extension);
+}
+
+bool FCodeSymbolIndex::IsSourceFile(FStringView RelativePath) {
+  const FStringView Extension = FPathViews::GetExtension(RelativePath);
+  for (const TCHAR *SourceExtension :
+       CodeSymbolIndexConstants::SourceExtensions) {
+    if (Extension.Equals(SourceExtension, ESearchCase::IgnoreCase)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FCodeSymbolIndex::ParseSymbols(FCppSyntaxTokenizer &Tokenizer,
+                                    const FString &Text,
+                                    TArray<FCodeSymbol> &OutSymbols,
+                                    FCodeOccurrences &OutOccurrences) {
+  OutSymbols.Reset();
+
+  TArray<ISyntaxTokenizer::FTokenizedLine> Lines;
+  Tokenizer.Process(Lines, Text);
+  TArray<FDeclarationToken> Tokens;
+  GetDeclarationTokens(Text, Lines, Tokens);
+  FDeclarationRecognizer(Tokens, OutSymbols).Run();
+  GetOccurrences(Text, Lines, OutOccurrences);
+}
+
+TConstArrayView<FIntPoint> FCodeOccurrences::Find(FStringView Name) const {
+  const int32 Index =
+      Algo::LowerBound(Names, Name, [](const FString &A, FStringView B) {
+        return FStringView(A).Compare(B, ESearchCase::CaseSensitive) < 0;
+      });
+  if (Index == Names.Num() ||
+      !Name.Equals(Names[Index], ESearchCase::CaseSensitive)) {
+    return TConstArrayView<FIntPoint>();
+  }
+  return TConstArrayView<FIntPoint>(Positions).Slice(
+      FirstPositions[Index], FirstPositions[Index + 1] - FirstPositions[Index]);
+}
+
+void FCodeSymbolIndex::SetPathIndex(
+    TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index) {
+  PathIndex = Index;
+  Update();
+}
+
+void FCodeSymbolIndex::HandleFilesChanged(
+    const TArray<FString> &RelativePaths) {
+  bool bSourceChanged = false;
+  for (const FString &Path : RelativePaths) {
+    if (!IsSourceFile(Path)) {
+      continue;
+    }
+    bSourceChanged = true;
+    ChangedFiles.Add(HashPath(Path));
+    if (bUpdating) {
+      ChangedDuringUpdate.Add(HashPath(Path));
+    }
+  }
+
+  if (bSourceChanged) {
+    Update();
+  }
+}
+
+void FCodeSymbolIndex::Find(FStringView Name,
+                            TArray<FCodeSymbolLocation> &OutLocations) const {
+  OutLocations.Reset();
+  if (Name.IsEmpty()) {
+    return;
+  }
+
+  if (Snapshot.IsValid()) {
+    const FTCHARToUTF8 Utf8Name(Name.GetData(), Name.Len());
+    const int32 Found = Snapshot->FindName(
+        reinterpret_cast<const ANSICHAR *>(Utf8Name.Get()), Utf8Name.Length());
+    if (Found != INDEX_NONE) {
+      const CodeSymbolIndexFormat::FNameRecord Record =
+          Snapshot->GetName(Found);
+      for (int32 Index = Record.FirstSymbol;
+           Index < Record.FirstSymbol + Record.NumSymbols; ++Index) {
+        const CodeSymbolIndexFormat::FSymbolRecord Symbol =
+            Snapshot->GetSymbol(Index);
+
+        // Files parsed since the index was written hide what it holds
+        if (ParsedFiles.Contains(Snapshot->GetFile(Symbol.File).PathHash)) {
+          continue;
+        }
+        FCodeSymbolLocation &Location = OutLocations.AddDefaulted_GetRef();
+        Location.Path = Snapshot->GetPath(Symbol.File);
+        Location.Line = Symbol.Line;
+        Location.Kind = static_cast<ECodeSymbolKind>(Symbol.Kind);
+        Location.bDefinition =
+            (Symbol.Flags & CodeSymbolIndexFormat::DefinitionFlag) != 0;
+      }
+    }
+  }
+
+  TArray<uint64> PathHashes;
+  ParsedFilesByName.MultiFind(FString(Name), PathHashes);
+  for (const uint64 PathHash : PathHashes) {
+    const FParsedFile &File = ParsedFiles.FindChecked(PathHash);
+    for (const FCodeSymbol &Symbol : File.Symbols) {
+      if (Name.Equals(Symbol.Name, ESearchCase::CaseSensitive)) {
+        FCodeSymbolLocation &Location = OutLocations.AddDefaulted_GetRef();
+        Location.Path = File.Path;
+        Location.Line = Symbol.Line;
+        Location.Kind = Symbol.Kind;
+        Location.bDefinition = Symbol.bDefinition;
+      }
+    }
+  }
+}
+
+void FCodeSymbolIndex::FindReferences(
+    FStringView Name, TArray<FCodeReferences> &OutReferences) const {
+  OutReferences.Reset();
+  if (Name.IsEmpty()) {
+    return;
+  }
+
+  if (Snapshot.IsValid()) {
+    const FTCHARToUTF8 Utf8Name(Name.GetData(), Name.Len());
+    const int32 Found = Snapshot->FindName(
+        reinterpret_cast<const ANSICHAR *>(Utf8Name.Get()), Utf8Name.Length());
+    if (Found != INDEX_NONE) {
+      const CodeSymbolIndexFormat::FNameRecord Record =
+          Snapshot->GetName(Found);
+      CodeSymbolIndexFormat::FPostingReader Reader =
+          Snapshot->GetPostings(Record);
+      FCodeReferences *References = nullptr;
+      int32 CurrentFile = INDEX_NONE;
+      int32 File;
+      int32 Line;
+      int32 Column;
+      while (Reader.Next(File, Line, Column) && File >= 0 &&
+             File < Snapshot->NumFiles()) {
+        if (File != CurrentFile) {
+          // Files parsed since the index was written hide what it holds
+          CurrentFile = File;
+          References = nullptr;
+          if (!ParsedFiles.Contains(Snapshot->GetFile(File).PathHash)) {
+            References = &OutReferences.AddDefaulted_GetRef();
+            References->Path = Snapshot->GetPath(File);
+          }
+        }
+        if (References) {
+          References->Positions.Emplace(Line, Column);
+        }
+      }
+    }
+  }
+
+  for (const TPair<uint64, FParsedFile> &File : ParsedFiles) {
+    const TConstArrayView<FIntPoint> Positions =
+        File.Value.Occurrences.Find(Name);
+    if (Positions.Num() > 0) {
+      FCodeReferences &References = OutReferences.AddDefaulted_GetRef();
+      References.Path = File.Value.Path;
+      References.Positions.Append(Positions.GetData(), Positions.Num());
+    }
+  }
+
+  OutReferences.Sort([](const FCodeReferences &A, const FCodeReferences &B) {
+    return A.Path < B.Path;
+  });
+}
+
+void FCodeSymbolIndex::SetParsedFile(uint64 PathHash, FParsedFile &&File) {
+  if (const FParsedFile *Previous = ParsedFiles.Find(PathHash)) {
+    for (const FCodeSymbol &Symbol : Previous->Symbols) {
+      ParsedFilesByName.Remove(Symbol.Name, PathHash);
+    }
+  }
+  for (const FCodeSymbol &Symbol : File.Symbols) {
+    ParsedFilesByName.AddUnique(Symbol.Name, PathHash);
+  }
+  ParsedFiles.Add(PathHash, MoveTemp(File));
+}
+
+void FCodeSymbolIndex::Load() {
+  bLoading = true;
+
+  TWeakPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> WeakIndex = AsShared();
+  const FString Directory = FPaths::GetPath(GetIndexPath(0));
+  Async(EAsyncExecution::ThreadPool, [WeakIndex, Directory,
+                                      Name = IndexName, Root = RootPath,
+                                      Cancelled = Cancelled]() {
+    // Generations are numbered; the newest readable one is used
+    TSharedPtr<FSnapshot, ESPMode::ThreadSafe> Snapshot =
+        CodeIndexStorage::MapNewestGeneration<FSnapshot>(
+            Directory, Name, CodeSymbolIndexFormat::Extension);
+
+    // Files changed while nobody watched have a new size or time
+    TArray<uint64> Stale;
+    if (Snapshot.IsValid()) {
+      Stale = CodeIndexStorage::FindStaleFiles(Root, *Snapshot, *Cancelled);
+    }
+
+    AsyncTask(ENamedThreads::GameThread, [WeakIndex, Snapshot,
+                                          Stale = MoveTemp(Stale)]() {
+      TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> Index =
+          WeakIndex.Pin();
+      if (!Index.IsValid()) {
+        return;
+      }
+
+      Index->Snapshot = Snapshot;
+      Index->ChangedFiles.Append(Stale);
+      Index->bLoading = false;
+      Index->Update();
+    });
+  });
+}
+
+void FCodeSymbolIndex::Update() {
+  if (bLoading || !PathIndex.IsValid()) {
+    return;
+  }
+  if (bUpdating) {
+    bUpdateAgain = true;
+    return;
+  }
+  bUpdating = true;
+  ChangedDuringUpdate.Reset();
+
+  TSet<uint64> Parsed;
+  ParsedFiles.GetKeys(Parsed);
+
+  TWeakPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> WeakIndex = AsShared();
+  const int32 Generation = Snapshot.IsValid() ? Snapshot->Generation + 1 : 1;
+  Async(
+      EAsyncExecution::ThreadPool,
+      [WeakIndex, Old = Snapshot, Files = PathIndex.ToSharedRef(),
+       Changed = ChangedFiles, Parsed = MoveTemp(Parsed), Root = RootPath,
+       IndexPath = GetIndexPath(Generation), Generation,
+       Threshold = CVarICESymbolIndexMergeThreshold.GetValueOnGameThread(),
+       Cancelled = Cancelled]() {
+        const double StartTime = FPlatformTime::Seconds();
+
+        // Sources the index holds unchanged are kept and those parsed since
+        // it was written stay parsed; changed and new ones are parsed now
+        TArray<int32> Kept;
+        TArray<FString> Stale;
+        TArray<FString> Held;
+        TSet<uint64> Present;
+        for (int32 Index = 0; Index < Files->Num(); ++Index) {
+          const FStringView Path = Files->GetPath(Index);
+          if (!IsSourceFile(Path)) {
+            continue;
+          }
+          const uint64 PathHash = HashPath(Path);
+          Present.Add(PathHash);
+          const int32 *OldFile =
+              Old.IsValid() ? Old->FileByPathHash.Find(PathHash) : nullptr;
+          if (Changed.Contains(PathHash) ||
+              (!OldFile && !Parsed.Contains(PathHash))) {
+            Stale.Emplace(Path);
+          } else if (Parsed.Contains(PathHash)) {
+            Held.Emplace(Path);
+          } else {
+            Kept.Add(*OldFile);
+          }
+        }
+
+        // Removed sources are held without symbols until the next merge
+        TArray<uint64> Removed;
+        int32 NumRemovedIndexed = 0;
+        if (Old.IsValid()) {
+          for (int32 Index = 0; Index < Old->NumFiles(); ++Index) {
+            const uint64 PathHash = Old->GetFile(Index).PathHash;
+            if (!Present.Contains(PathHash) && !Parsed.Contains(PathHash)) {
+              Removed.Add(PathHash);
+              ++NumRemovedIndexed;
+            }
+          }
+        }
+        for (const uint64 PathHash : Parsed) {
+          if (!Present.Contains(PathHash)) {
+            Removed.Add(PathHash);
+          }
+        }
+
+        TSharedPtr<FSnapshot, ESPMode::ThreadSafe> Snapshot;
+        TArray<TPair<uint64, FParsedFile>> ParsedNow;
+        const bool bMerge =
+            !Old.IsValid() ||
+            Parsed.Num() + Stale.Num() + NumRemovedIndexed >= Threshold;
+        if (bMerge) {
+          Kept.Sort();
+          Stale.Append(MoveTemp(Held));
+          TArray<uint8> Bytes;
+          if (BuildIndex(Root, Old.Get(), Kept, Stale, *Cancelled, Bytes)) {
+            // Save a new generation and map it, keeping it in memory if
+            // that fails
+            if (CodeIndexStorage::SaveImage(Bytes, IndexPath)) {
+              Snapshot =
+                  CodeIndexStorage::MapImage<FSnapshot>(IndexPath, Generation);
+            } else {
+              UE_LOG(LogTemp, Warning,
+                     TEXT("InlineCodeEditor: Failed to save the symbol ")
+                         TEXT("index %s"),
+                     *IndexPath);
+            }
+            if (!Snapshot.IsValid()) {
+              Snapshot = CodeIndexStorage::AdoptImage<FSnapshot>(
+                  MoveTemp(Bytes), Generation);
+            }
+
+            UE_LOG(LogTemp, Log,
+                   TEXT("InlineCodeEditor: Indexed %d symbols and %d names ")
+                       TEXT("(%lld bytes of uses) in %d files (%d parsed) ")
+                       TEXT("in %.2fs"),
+                   Snapshot.IsValid() ? Snapshot->NumSymbols() : 0,
+                   Snapshot.IsValid() ? Snapshot->NumNames() : 0,
+                   Snapshot.IsValid() ? Snapshot->GetPostingsSize() : 0,
+                   Kept.Num() + Stale.Num(), Stale.Num(),
+                   FPlatformTime::Seconds() - StartTime);
+          }
+        } else {
+          TArray<FParsedSource> Sources;
+          ParseSources(Root, Stale, *Cancelled, Sources);
+          for (int32 Index = 0; Index < Stale.Num(); ++Index) {
+            FParsedFile File;
+            File.Path = MoveTemp(Stale[Index]);
+            File.Symbols = MoveTemp(Sources[Index].Symbols);
+            File.Occurrences = MoveTemp(Sources[Index].Occurrences);
+            const uint64 PathHash = HashPath(File.Path);
+            ParsedNow.Emplace(PathHash, MoveTemp(File));
+          }
+          for (const uint64 PathHash : Removed) {
+            ParsedNow.Emplace(PathHash, FParsedFile());
+          }
+        }
+
+        const bool bUpdated = !bMerge || Snapshot.IsValid();
+        AsyncTask(ENamedThreads::GameThread,
+                  [WeakIndex, Snapshot, bUpdated,
+                   ParsedNow = MoveTemp(ParsedNow)]() mutable {
+                    TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> Index =
+                        WeakIndex.Pin();
+                    if (!Index.IsValid()) {
+                      return;
+                    }
+
+                    if (Snapshot.IsValid()) {
+                      if (Index->Snapshot.IsValid()) {
+                        Index->Snapshot->bSuperseded = true;
+                      }
+                      Index->Snapshot = Snapshot;
+                      Index->ParsedFiles.Reset();
+                      Index->ParsedFilesByName.Reset();
+                    }
+                    for (TPair<uint64, FParsedFile> &File : ParsedNow) {
+                      Index->SetParsedFile(File.Key, MoveTemp(File.Value));
+                    }
+
+                    // Files changed during the update were not necessarily
+                    // read
+                    if (bUpdated) {
+                      Index->ChangedFiles =
+                          MoveTemp(Index->ChangedDuringUpdate);
+                    }
+                    Index->ChangedDuringUpdate.Reset();
+
+                    Index->bUpdating = false;
+                    if (Index->bUpdateAgain) {
+                      Index->bUpdateAgain = false;
+                      Index->Update();
+                    }
+                  });
+      });
+}
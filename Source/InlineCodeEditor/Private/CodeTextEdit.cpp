@@ -0,0 +1,65 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeTextEdit.h"
+
+FCodeTextEdit FCodeTextEdit::FromDiff(const FString &OldText,
+                                      const FString &NewText) {
+  const int32 OldLen = OldText.Len();
+  const int32 NewLen = NewText.Len();
+  const TCHAR *OldData = *OldText;
+  const TCHAR *NewData = *NewText;
+
+  // Common prefix
+  const int32 MaxPrefix = FMath::Min(OldLen, NewLen);
+  int32 Prefix = 0;
+  while (Prefix < MaxPrefix && OldData[Prefix] == NewData[Prefix]) {
+    ++Prefix;
+  }
+
+  // Common suffix (never overlapping the prefix)
+  const int32 MaxSuffix = MaxPrefix - Prefix;
+  int32 Suffix = 0;
+  while (Suffix < MaxSuffix &&
+         OldData[OldLen - 1 - Suffix] == NewData[NewLen - 1 - Suffix]) {
+    ++Suffix;
+  }
+
+  return FCodeTextEdit(Prefix, OldLen - Prefix - Suffix,
+                       NewText.Mid(Prefix, NewLen - Prefix - Suffix));
+}
+
+FCodeTextEdit
+FCodeTextEdit::FromReplacements(const FString &Text,
+                                TConstArrayView<FCodeTextRange> Ranges,
+                                const FString &Replacement) {
+  FCodeTextEdit Edit;
+  if (Ranges.Num() == 0) {
+    return Edit;
+  }
+
+  Edit.Offset = Ranges[0].Start;
+  Edit.RemovedLength = Ranges.Last().End - Edit.Offset;
+  Edit.InsertedText.Reserve(Edit.RemovedLength +
+                            Ranges.Num() * Replacement.Len());
+  int32 Pos = Edit.Offset;
+  for (const FCodeTextRange &Range : Ranges) {
+    Edit.InsertedText.AppendChars(*Text + Pos, Range.Start - Pos);
+    Edit.InsertedText += Replacement;
+    Pos = Range.End;
+  }
+  return Edit;
+}
+
+bool FCodeTextEdit::ApplyTo(FString &Text) const {
+  if (Offset < 0 || RemovedLength < 0 || Offset + RemovedLength > Text.Len()) {
+    return false;
+  }
+
+  if (RemovedLength > 0) {
+    Text.RemoveAt(Offset, RemovedLength);
+  }
+  if (!InsertedText.IsEmpty()) {
+    Text.InsertAt(Offset, InsertedText);
+  }
+  return true;
+}
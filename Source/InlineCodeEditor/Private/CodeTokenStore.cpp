@@ -0,0 +1,75 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "CodeTokenStore.h"
+
+FCodeTokenSpan
+FCodeTokenStore::Add(const TArray<ISyntaxTokenizer::FToken> &Tokens,
+                     int32 LineBegin) {
+  FCodeTokenSpan Span;
+  Span.First = Types.Num();
+  Span.Num = Tokens.Num();
+
+  Types.Reserve(Types.Num() + Tokens.Num());
+  Begins.Reserve(Begins.Num() + Tokens.Num());
+  Ends.Reserve(Ends.Num() + Tokens.Num());
+  for (const ISyntaxTokenizer::FToken &Token : Tokens) {
+    Types.Add(static_cast<uint8>(Token.Type));
+    Begins.Add(static_cast<uint16>(Token.Range.BeginIndex - LineBegin));
+    Ends.Add(static_cast<uint16>(Token.Range.EndIndex - LineBegin));
+  }
+  return Span;
+}
+
+void FCodeTokenStore::AddToken(uint8 Type, uint16 Begin, uint16 End) {
+  Types.Add(Type);
+  Begins.Add(Begin);
+  Ends.Add(End);
+}
+
+void FCodeTokenStore::CopyTo(
+    const FCodeTokenSpan &Span, int32 LineBegin,
+    TArray<ISyntaxTokenizer::FToken> &OutTokens) const {
+  OutTokens.Reserve(OutTokens.Num() + Span.Num);
+  const int32 Last = Span.First + Span.Num;
+  for (int32 Index = Span.First; Index < Last; ++Index) {
+    OutTokens.Add(ISyntaxTokenizer::FToken(
+        static_cast<ISyntaxTokenizer::ETokenType>(Types[Index]),
+        FTextRange(LineBegin + Begins[Index], LineBegin + Ends[Index])));
+  }
+}
+
+void FCodeTokenStore::Compact(const TArray<FCodeTokenSpan *> &LiveSpans) {
+  TArray<uint8> NewTypes;
+  TArray<uint16> NewBegins;
+  TArray<uint16> NewEnds;
+  const int32 NumLive = Types.Num() - NumReleased;
+  NewTypes.Reserve(NumLive);
+  NewBegins.Reserve(NumLive);
+  NewEnds.Reserve(NumLive);
+
+  for (FCodeTokenSpan *Span : LiveSpans) {
+    const int32 NewFirst = NewTypes.Num();
+    NewTypes.Append(Types.GetData() + Span->First, Span->Num);
+    NewBegins.Append(Begins.GetData() + Span->First, Span->Num);
+    NewEnds.Append(Ends.GetData() + Span->First, Span->Num);
+    Span->First = NewFirst;
+  }
+
+  Types = MoveTemp(NewTypes);
+  Begins = MoveTemp(NewBegins);
+  Ends = MoveTemp(NewEnds);
+  NumReleased = 0;
+}
+
+void FCodeTokenStore::Reset() {
+  Types.Empty();
+  Begins.Empty();
+  Ends.Empty();
+  NumReleased = 0;
+}
+
+void FCodeTokenStore::Truncate(int32 NumTokens) {
+  Types.SetNum(NumTokens);
+  Begins.SetNum(NumTokens);
+  Ends.SetNum(NumTokens);
+}
@@ -4,6 +4,7 @@
 #include "Framework/Text/IRun.h"
 #include "Framework/Text/SlateTextRun.h"
 #include "Framework/Text/TextLayout.h"
+#include "Hash/CityHash.h"
 
 //////////////////////////////////////////////////////////////////////////
 // FCppSyntaxTokenizer
@@ -312,396 +313,574 @@ void FCppSyntaxTokenizer::Process(TArray<FTokenizedLine> &OutTokenizedLines,
   // Split input into lines
   TArray<FTextRange> LineRanges;
   FTextRange::CalculateLineRangesFromString(Input, LineRanges);
+  OutTokenizedLines.Reserve(LineRanges.Num());
 
   // Reset block comment state at start of full parse
   bInBlockComment = false;
 
+  // Lines are cached by content and entry state rather than by index, so
+  // edits that shift the rest of the document up or down stay cheap
+  ++ProcessPass;
+
   for (const FTextRange &LineRange : LineRanges) {
-    FTokenizedLine TokenizedLine;
+    FTokenizedLine &TokenizedLine = OutTokenizedLines.AddDefaulted_GetRef();
     TokenizedLine.Range = LineRange;
 
-    if (LineRange.IsEmpty()) {
-      OutTokenizedLines.Add(TokenizedLine);
+    const uint64 LineKey = HashLine(Input, LineRange, bInBlockComment);
+    FCachedLine *Cached = CachedLines.Find(LineKey);
+    if (Cached && Cached->Length == LineRange.Len()) {
+      Cached->LastUsedPass = ProcessPass;
+      CopyCachedTokens(*Cached, LineRange.BeginIndex, TokenizedLine);
       continue;
     }
 
-    int32 CurrentPos = LineRange.BeginIndex;
-    int32 LineEnd = LineRange.EndIndex;
-
-    // Context tracking for better tokenization
-    bool bAfterClassKeyword = false;
-    bool bAfterNamespaceKeyword = false;
-    bool bAfterScopeResolution = false;
-    bool bIsPreprocessorLine = false;
-
-    while (CurrentPos < LineEnd) {
-      TCHAR CurrentChar = Input[CurrentPos];
-      TCHAR NextChar = (CurrentPos + 1 < LineEnd) ? Input[CurrentPos + 1] : 0;
-      int32 TokenStart = CurrentPos;
-
-      //=====================================================================
-      // 1. BLOCK COMMENT (continued from previous line)
-      //=====================================================================
-      if (bInBlockComment) {
-        int32 CommentEnd = Input.Find(TEXT("*/"), ESearchCase::CaseSensitive,
-                                      ESearchDir::FromStart, CurrentPos);
-        if (CommentEnd != INDEX_NONE && CommentEnd < LineEnd) {
-          TokenizedLine.Tokens.Add(
-              FToken(static_cast<ETokenType>(ECppTokenType::Comment),
-                     FTextRange(TokenStart, CommentEnd + 2)));
-          CurrentPos = CommentEnd + 2;
-          bInBlockComment = false;
-        } else {
-          TokenizedLine.Tokens.Add(
-              FToken(static_cast<ETokenType>(ECppTokenType::Comment),
-                     FTextRange(TokenStart, LineEnd)));
-          CurrentPos = LineEnd;
-        }
-        continue;
-      }
+    TokenizeLine(Input, LineRange, TokenizedLine);
 
-      //=====================================================================
-      // 2. WHITESPACE - skip but preserve position
-      //=====================================================================
-      if (FChar::IsWhitespace(CurrentChar)) {
-        CurrentPos++;
-        continue;
-      }
+    // Offsets are stored in 16 bits; absurdly long lines are just re-lexed
+    if (LineRange.Len() > FCodeTokenStore::MaxLineLength) {
+      continue;
+    }
 
-      //=====================================================================
-      // 3. BLOCK COMMENT START
-      //=====================================================================
-      if (CurrentChar == '/' && NextChar == '*') {
-        bInBlockComment = true;
-        int32 CommentEnd = Input.Find(TEXT("*/"), ESearchCase::CaseSensitive,
-                                      ESearchDir::FromStart, CurrentPos + 2);
-        if (CommentEnd != INDEX_NONE && CommentEnd < LineEnd) {
-          TokenizedLine.Tokens.Add(
-              FToken(static_cast<ETokenType>(ECppTokenType::Comment),
-                     FTextRange(TokenStart, CommentEnd + 2)));
-          CurrentPos = CommentEnd + 2;
-          bInBlockComment = false;
-        } else {
-          TokenizedLine.Tokens.Add(
-              FToken(static_cast<ETokenType>(ECppTokenType::Comment),
-                     FTextRange(TokenStart, LineEnd)));
-          CurrentPos = LineEnd;
-        }
-        continue;
+    if (Cached) {
+      TokenStore.Release(Cached->Tokens);
+    }
+
+    FCachedLine CachedLine;
+    CachedLine.Length = LineRange.Len();
+    CachedLine.bEndsInBlockComment = bInBlockComment;
+    CachedLine.LastUsedPass = ProcessPass;
+    CachedLine.Tokens =
+        TokenStore.Add(TokenizedLine.Tokens, LineRange.BeginIndex);
+    CachedLines.Add(LineKey, CachedLine);
+  }
+
+  // Drop lines no recent pass has seen
+  for (auto It = CachedLines.CreateIterator(); It; ++It) {
+    if (ProcessPass - It.Value().LastUsedPass > CacheRetainPasses) {
+      TokenStore.Release(It.Value().Tokens);
+      It.RemoveCurrent();
+    }
+  }
+
+  if (TokenStore.NeedsCompaction()) {
+    CompactTokenStore();
+  }
+}
+
+void FCppSyntaxTokenizer::ResetCache() {
+  CachedLines.Empty();
+  TokenStore.Reset();
+}
+
+void FCppSyntaxTokenizer::CompactTokenStore() {
+  TArray<FCodeTokenSpan *> LiveSpans;
+  LiveSpans.Reserve(CachedLines.Num());
+  for (TPair<uint64, FCachedLine> &Pair : CachedLines) {
+    LiveSpans.Add(&Pair.Value.Tokens);
+  }
+  TokenStore.Compact(LiveSpans);
+}
+
+bool FCppSyntaxTokenizer::SaveCachedLines(FArchive &Ar,
+                                          const FString &Input) const {
+  TArray<FTextRange> LineRanges;
+  FTextRange::CalculateLineRangesFromString(Input, LineRanges);
+
+  // Walk the lines with the lexer state they start in, as Process does
+  TArray<TPair<uint64, const FCachedLine *>> Entries;
+  TSet<uint64> SeenKeys;
+  bool bStartsInBlockComment = false;
+  for (const FTextRange &LineRange : LineRanges) {
+    const uint64 LineKey = HashLine(Input, LineRange, bStartsInBlockComment);
+    const FCachedLine *Cached = CachedLines.Find(LineKey);
+    if (!Cached || Cached->Length != LineRange.Len()) {
+      return false;
+    }
+
+    bool bAlreadySeen = false;
+    SeenKeys.Add(LineKey, &bAlreadySeen);
+    if (!bAlreadySeen) {
+      Entries.Emplace(LineKey, Cached);
+    }
+    bStartsInBlockComment = Cached->bEndsInBlockComment;
+  }
+
+  // [NumLines] then per line [Key][Length][EndsInBlockComment][NumTokens]
+  // followed by [Type][Begin][End] per token, in store format
+  int32 NumEntries = Entries.Num();
+  Ar << NumEntries;
+  for (const TPair<uint64, const FCachedLine *> &Entry : Entries) {
+    uint64 LineKey = Entry.Key;
+    int32 Length = Entry.Value->Length;
+    bool bEndsInBlockComment = Entry.Value->bEndsInBlockComment;
+    const FCodeTokenSpan &Span = Entry.Value->Tokens;
+    int32 NumTokens = Span.Num;
+    Ar << LineKey << Length << bEndsInBlockComment << NumTokens;
+
+    for (int32 Index = Span.First; Index < Span.First + Span.Num; ++Index) {
+      uint8 Type = TokenStore.GetType(Index);
+      uint16 Begin = TokenStore.GetBegin(Index);
+      uint16 End = TokenStore.GetEnd(Index);
+      Ar << Type << Begin << End;
+    }
+  }
+  return !Ar.IsError();
+}
+
+bool FCppSyntaxTokenizer::LoadCachedLines(FArchive &Ar) {
+  int32 NumEntries = 0;
+  Ar << NumEntries;
+  if (NumEntries < 0) {
+    return false;
+  }
+
+  // Lines are cached once all of them are read; a read failing partway
+  // drops the tokens already added
+  const int32 FirstToken = TokenStore.Num();
+  auto Fail = [this, FirstToken]() {
+    TokenStore.Truncate(FirstToken);
+    return false;
+  };
+  TArray<TPair<uint64, FCachedLine>> Loaded;
+  for (int32 EntryIndex = 0; EntryIndex < NumEntries; ++EntryIndex) {
+    uint64 LineKey = 0;
+    int32 NumTokens = 0;
+    FCachedLine CachedLine;
+    Ar << LineKey << CachedLine.Length << CachedLine.bEndsInBlockComment
+       << NumTokens;
+    if (Ar.IsError() || NumTokens < 0 || NumTokens > CachedLine.Length ||
+        CachedLine.Length > FCodeTokenStore::MaxLineLength) {
+      return Fail();
+    }
+
+    CachedLine.Tokens.First = TokenStore.Num();
+    CachedLine.Tokens.Num = NumTokens;
+    for (int32 TokenIndex = 0; TokenIndex < NumTokens; ++TokenIndex) {
+      uint8 Type = 0;
+      uint16 Begin = 0;
+      uint16 End = 0;
+      Ar << Type << Begin << End;
+      if (End < Begin || End > CachedLine.Length) {
+        return Fail();
       }
+      TokenStore.AddToken(Type, Begin, End);
+    }
+
+    // Counts as seen by the current pass so the next one keeps it
+    CachedLine.LastUsedPass = ProcessPass;
+    Loaded.Emplace(LineKey, CachedLine);
+  }
+  if (Ar.IsError()) {
+    return Fail();
+  }
+
+  for (const TPair<uint64, FCachedLine> &Line : Loaded) {
+    if (const FCachedLine *Existing = CachedLines.Find(Line.Key)) {
+      TokenStore.Release(Existing->Tokens);
+    }
+    CachedLines.Add(Line.Key, Line.Value);
+  }
+  return true;
+}
 
-      //=====================================================================
-      // 4. LINE COMMENT
-      //=====================================================================
-      if (CurrentChar == '/' && NextChar == '/') {
+uint64 FCppSyntaxTokenizer::HashLine(const FString &Input,
+                                     const FTextRange &LineRange,
+                                     bool bStartsInBlockComment) {
+  return CityHash64WithSeed(
+      reinterpret_cast<const char *>(*Input + LineRange.BeginIndex),
+      LineRange.Len() * sizeof(TCHAR), bStartsInBlockComment ? 1 : 0);
+}
+
+void FCppSyntaxTokenizer::CopyCachedTokens(const FCachedLine &CachedLine,
+                                           int32 LineBegin,
+                                           FTokenizedLine &OutTokenizedLine) {
+  TokenStore.CopyTo(CachedLine.Tokens, LineBegin, OutTokenizedLine.Tokens);
+  bInBlockComment = CachedLine.bEndsInBlockComment;
+}
+
+void FCppSyntaxTokenizer::TokenizeLine(const FString &Input,
+                                       const FTextRange &LineRange,
+                                       FTokenizedLine &TokenizedLine) {
+  if (LineRange.IsEmpty()) {
+    return;
+  }
+
+  int32 CurrentPos = LineRange.BeginIndex;
+  int32 LineEnd = LineRange.EndIndex;
+
+  // Context tracking for better tokenization
+  bool bAfterClassKeyword = false;
+  bool bAfterNamespaceKeyword = false;
+  bool bAfterScopeResolution = false;
+  bool bIsPreprocessorLine = false;
+
+  while (CurrentPos < LineEnd) {
+    TCHAR CurrentChar = Input[CurrentPos];
+    TCHAR NextChar = (CurrentPos + 1 < LineEnd) ? Input[CurrentPos + 1] : 0;
+    int32 TokenStart = CurrentPos;
+
+    //=====================================================================
+    // 1. BLOCK COMMENT (continued from previous line)
+    //=====================================================================
+    if (bInBlockComment) {
+      int32 CommentEnd = Input.Find(TEXT("*/"), ESearchCase::CaseSensitive,
+                                    ESearchDir::FromStart, CurrentPos);
+      if (CommentEnd != INDEX_NONE && CommentEnd < LineEnd) {
+        TokenizedLine.Tokens.Add(
+            FToken(static_cast<ETokenType>(ECppTokenType::Comment),
+                   FTextRange(TokenStart, CommentEnd + 2)));
+        CurrentPos = CommentEnd + 2;
+        bInBlockComment = false;
+      } else {
         TokenizedLine.Tokens.Add(
             FToken(static_cast<ETokenType>(ECppTokenType::Comment),
                    FTextRange(TokenStart, LineEnd)));
         CurrentPos = LineEnd;
-        continue;
       }
+      continue;
+    }
 
-      //=====================================================================
-      // 5. PREPROCESSOR DIRECTIVE
-      //=====================================================================
-      if (CurrentChar == '#') {
-        bIsPreprocessorLine = true;
-        CurrentPos++; // Skip #
+    //=====================================================================
+    // 2. WHITESPACE - skip but preserve position
+    //=====================================================================
+    if (FChar::IsWhitespace(CurrentChar)) {
+      CurrentPos++;
+      continue;
+    }
 
-        // Skip whitespace after #
-        while (CurrentPos < LineEnd && FChar::IsWhitespace(Input[CurrentPos])) {
-          CurrentPos++;
-        }
+    //=====================================================================
+    // 3. BLOCK COMMENT START
+    //=====================================================================
+    if (CurrentChar == '/' && NextChar == '*') {
+      bInBlockComment = true;
+      int32 CommentEnd = Input.Find(TEXT("*/"), ESearchCase::CaseSensitive,
+                                    ESearchDir::FromStart, CurrentPos + 2);
+      if (CommentEnd != INDEX_NONE && CommentEnd < LineEnd) {
+        TokenizedLine.Tokens.Add(
+            FToken(static_cast<ETokenType>(ECppTokenType::Comment),
+                   FTextRange(TokenStart, CommentEnd + 2)));
+        CurrentPos = CommentEnd + 2;
+        bInBlockComment = false;
+      } else {
+        TokenizedLine.Tokens.Add(
+            FToken(static_cast<ETokenType>(ECppTokenType::Comment),
+                   FTextRange(TokenStart, LineEnd)));
+        CurrentPos = LineEnd;
+      }
+      continue;
+    }
 
-        // Read directive name
-        int32 DirectiveStart = CurrentPos;
-        while (CurrentPos < LineEnd && FChar::IsAlpha(Input[CurrentPos])) {
-          CurrentPos++;
-        }
+    //=====================================================================
+    // 4. LINE COMMENT
+    //=====================================================================
+    if (CurrentChar == '/' && NextChar == '/') {
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::Comment),
+                 FTextRange(TokenStart, LineEnd)));
+      CurrentPos = LineEnd;
+      continue;
+    }
 
-        FString Directive =
-            Input.Mid(DirectiveStart, CurrentPos - DirectiveStart).ToLower();
+    //=====================================================================
+    // 5. PREPROCESSOR DIRECTIVE
+    //=====================================================================
+    if (CurrentChar == '#') {
+      bIsPreprocessorLine = true;
+      CurrentPos++; // Skip #
 
-        // Add the # and directive as preprocessor token
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::PreProcessor),
-                   FTextRange(TokenStart, CurrentPos)));
-
-        // Check if it's #include
-        if (Directive == TEXT("include")) {
-          // Skip whitespace
-          while (CurrentPos < LineEnd &&
-                 FChar::IsWhitespace(Input[CurrentPos])) {
-            CurrentPos++;
-          }
-          // Capture the include path (either <...> or "...")
-          if (CurrentPos < LineEnd) {
-            TCHAR PathDelim = Input[CurrentPos];
-            if (PathDelim == '<' || PathDelim == '"') {
-              TCHAR EndDelim = (PathDelim == '<') ? '>' : '"';
-              int32 PathStart = CurrentPos;
-              CurrentPos++;
-              while (CurrentPos < LineEnd && Input[CurrentPos] != EndDelim) {
-                CurrentPos++;
-              }
-              if (CurrentPos < LineEnd) {
-                CurrentPos++; // Include the closing delimiter
-              }
-              TokenizedLine.Tokens.Add(
-                  FToken(static_cast<ETokenType>(ECppTokenType::IncludePath),
-                         FTextRange(PathStart, CurrentPos)));
-            }
-          }
-        }
-        // Rest of preprocessor line is normal (for now)
-        continue;
+      // Skip whitespace after #
+      while (CurrentPos < LineEnd && FChar::IsWhitespace(Input[CurrentPos])) {
+        CurrentPos++;
       }
 
-      //=====================================================================
-      // 6. STRING LITERALS
-      //=====================================================================
-      if (CurrentChar == '"' || CurrentChar == '\'') {
-        TCHAR Delimiter = CurrentChar;
+      // Read directive name
+      int32 DirectiveStart = CurrentPos;
+      while (CurrentPos < LineEnd && FChar::IsAlpha(Input[CurrentPos])) {
         CurrentPos++;
-        while (CurrentPos < LineEnd) {
-          TCHAR C = Input[CurrentPos];
-          if (C == '\\' && CurrentPos + 1 < LineEnd) {
-            CurrentPos += 2; // Skip escape sequence
-          } else if (C == Delimiter) {
-            CurrentPos++;
-            break;
-          } else {
+      }
+
+      FString Directive =
+          Input.Mid(DirectiveStart, CurrentPos - DirectiveStart).ToLower();
+
+      // Add the # and directive as preprocessor token
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::PreProcessor),
+                 FTextRange(TokenStart, CurrentPos)));
+
+      // Check if it's #include
+      if (Directive == TEXT("include")) {
+        // Skip whitespace
+        while (CurrentPos < LineEnd &&
+               FChar::IsWhitespace(Input[CurrentPos])) {
+          CurrentPos++;
+        }
+        // Capture the include path (either <...> or "...")
+        if (CurrentPos < LineEnd) {
+          TCHAR PathDelim = Input[CurrentPos];
+          if (PathDelim == '<' || PathDelim == '"') {
+            TCHAR EndDelim = (PathDelim == '<') ? '>' : '"';
+            int32 PathStart = CurrentPos;
             CurrentPos++;
+            while (CurrentPos < LineEnd && Input[CurrentPos] != EndDelim) {
+              CurrentPos++;
+            }
+            if (CurrentPos < LineEnd) {
+              CurrentPos++; // Include the closing delimiter
+            }
+            TokenizedLine.Tokens.Add(
+                FToken(static_cast<ETokenType>(ECppTokenType::IncludePath),
+                       FTextRange(PathStart, CurrentPos)));
           }
         }
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::String),
-                   FTextRange(TokenStart, CurrentPos)));
-        continue;
       }
+      // Rest of preprocessor line is normal (for now)
+      continue;
+    }
 
-      //=====================================================================
-      // 7. RAW STRING LITERALS (R"(...)")
-      //=====================================================================
-      if (CurrentChar == 'R' && NextChar == '"') {
-        CurrentPos += 2; // Skip R"
-        // Find delimiter (text between R" and ()
-        int32 DelimStart = CurrentPos;
-        while (CurrentPos < LineEnd && Input[CurrentPos] != '(') {
+    //=====================================================================
+    // 6. STRING LITERALS
+    //=====================================================================
+    if (CurrentChar == '"' || CurrentChar == '\'') {
+      TCHAR Delimiter = CurrentChar;
+      CurrentPos++;
+      while (CurrentPos < LineEnd) {
+        TCHAR C = Input[CurrentPos];
+        if (C == '\\' && CurrentPos + 1 < LineEnd) {
+          CurrentPos += 2; // Skip escape sequence
+        } else if (C == Delimiter) {
           CurrentPos++;
-        }
-        FString Delim = Input.Mid(DelimStart, CurrentPos - DelimStart);
-        FString EndPattern = TEXT(")") + Delim + TEXT("\"");
-        CurrentPos++; // Skip (
-
-        // Find end of raw string
-        int32 EndPos = Input.Find(EndPattern, ESearchCase::CaseSensitive,
-                                  ESearchDir::FromStart, CurrentPos);
-        if (EndPos != INDEX_NONE) {
-          CurrentPos = EndPos + EndPattern.Len();
+          break;
         } else {
-          CurrentPos = LineEnd; // Unterminated, take rest of line
+          CurrentPos++;
         }
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::String),
-                   FTextRange(TokenStart, CurrentPos)));
-        continue;
       }
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::String),
+                 FTextRange(TokenStart, CurrentPos)));
+      continue;
+    }
 
-      //=====================================================================
-      // 8. NUMBERS
-      //=====================================================================
-      if (FChar::IsDigit(CurrentChar) ||
-          (CurrentChar == '.' && CurrentPos + 1 < LineEnd &&
-           FChar::IsDigit(Input[CurrentPos + 1]))) {
-        // Hex (0x) or binary (0b)
-        if (CurrentChar == '0' && CurrentPos + 1 < LineEnd) {
-          TCHAR Prefix = FChar::ToLower(Input[CurrentPos + 1]);
-          if (Prefix == 'x' || Prefix == 'b') {
-            CurrentPos += 2;
-            while (CurrentPos < LineEnd) {
-              TCHAR C = Input[CurrentPos];
-              if (FChar::IsAlnum(C) || C == '\'') {
-                CurrentPos++;
-              } else {
-                break;
-              }
+    //=====================================================================
+    // 7. RAW STRING LITERALS (R"(...)")
+    //=====================================================================
+    if (CurrentChar == 'R' && NextChar == '"') {
+      CurrentPos += 2; // Skip R"
+      // Find delimiter (text between R" and ()
+      int32 DelimStart = CurrentPos;
+      while (CurrentPos < LineEnd && Input[CurrentPos] != '(') {
+        CurrentPos++;
+      }
+      FString Delim = Input.Mid(DelimStart, CurrentPos - DelimStart);
+      FString EndPattern = TEXT(")") + Delim + TEXT("\"");
+      CurrentPos++; // Skip (
+
+      // Find end of raw string
+      int32 EndPos = Input.Find(EndPattern, ESearchCase::CaseSensitive,
+                                ESearchDir::FromStart, CurrentPos);
+      if (EndPos != INDEX_NONE) {
+        // Lines are tokenized (and cached) independently, so a raw string
+        // that continues past this line is clipped to it
+        CurrentPos = FMath::Min(EndPos + EndPattern.Len(), LineEnd);
+      } else {
+        CurrentPos = LineEnd; // Unterminated, take rest of line
+      }
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::String),
+                 FTextRange(TokenStart, CurrentPos)));
+      continue;
+    }
+
+    //=====================================================================
+    // 8. NUMBERS
+    //=====================================================================
+    if (FChar::IsDigit(CurrentChar) ||
+        (CurrentChar == '.' && CurrentPos + 1 < LineEnd &&
+         FChar::IsDigit(Input[CurrentPos + 1]))) {
+      // Hex (0x) or binary (0b)
+      if (CurrentChar == '0' && CurrentPos + 1 < LineEnd) {
+        TCHAR Prefix = FChar::ToLower(Input[CurrentPos + 1]);
+        if (Prefix == 'x' || Prefix == 'b') {
+          CurrentPos += 2;
+          while (CurrentPos < LineEnd) {
+            TCHAR C = Input[CurrentPos];
+            if (FChar::IsAlnum(C) || C == '\'') {
+              CurrentPos++;
+            } else {
+              break;
             }
-            TokenizedLine.Tokens.Add(
-                FToken(static_cast<ETokenType>(ECppTokenType::Number),
-                       FTextRange(TokenStart, CurrentPos)));
-            continue;
           }
+          TokenizedLine.Tokens.Add(
+              FToken(static_cast<ETokenType>(ECppTokenType::Number),
+                     FTextRange(TokenStart, CurrentPos)));
+          continue;
         }
-        // Decimal/Float
-        bool bHasDot = false;
-        bool bHasExp = false;
-        while (CurrentPos < LineEnd) {
-          TCHAR C = Input[CurrentPos];
-          if (FChar::IsDigit(C) || C == '\'') {
-            CurrentPos++;
-          } else if (C == '.' && !bHasDot) {
-            bHasDot = true;
-            CurrentPos++;
-          } else if ((C == 'e' || C == 'E') && !bHasExp) {
-            bHasExp = true;
-            CurrentPos++;
-            if (CurrentPos < LineEnd &&
-                (Input[CurrentPos] == '+' || Input[CurrentPos] == '-')) {
-              CurrentPos++;
-            }
-          } else if (C == 'f' || C == 'F' || C == 'l' || C == 'L' || C == 'u' ||
-                     C == 'U') {
+      }
+      // Decimal/Float
+      bool bHasDot = false;
+      bool bHasExp = false;
+      while (CurrentPos < LineEnd) {
+        TCHAR C = Input[CurrentPos];
+        if (FChar::IsDigit(C) || C == '\'') {
+          CurrentPos++;
+        } else if (C == '.' && !bHasDot) {
+          bHasDot = true;
+          CurrentPos++;
+        } else if ((C == 'e' || C == 'E') && !bHasExp) {
+          bHasExp = true;
+          CurrentPos++;
+          if (CurrentPos < LineEnd &&
+              (Input[CurrentPos] == '+' || Input[CurrentPos] == '-')) {
             CurrentPos++;
-          } else {
-            break;
           }
+        } else if (C == 'f' || C == 'F' || C == 'l' || C == 'L' || C == 'u' ||
+                   C == 'U') {
+          CurrentPos++;
+        } else {
+          break;
         }
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::Number),
-                   FTextRange(TokenStart, CurrentPos)));
-        continue;
       }
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::Number),
+                 FTextRange(TokenStart, CurrentPos)));
+      continue;
+    }
 
-      //=====================================================================
-      // 9. SCOPE RESOLUTION ::
-      //=====================================================================
-      if (CurrentChar == ':' && NextChar == ':') {
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::Operator),
-                   FTextRange(TokenStart, CurrentPos + 2)));
-        CurrentPos += 2;
-        bAfterScopeResolution = true;
-        continue;
-      }
+    //=====================================================================
+    // 9. SCOPE RESOLUTION ::
+    //=====================================================================
+    if (CurrentChar == ':' && NextChar == ':') {
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::Operator),
+                 FTextRange(TokenStart, CurrentPos + 2)));
+      CurrentPos += 2;
+      bAfterScopeResolution = true;
+      continue;
+    }
 
-      //=====================================================================
-      // 10. MEMBER ACCESS (. and ->)
-      //=====================================================================
-      if (CurrentChar == '.' || (CurrentChar == '-' && NextChar == '>')) {
-        int32 TokenEnd = CurrentPos + (CurrentChar == '-' ? 2 : 1);
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::MemberAccess),
-                   FTextRange(TokenStart, TokenEnd)));
-        CurrentPos = TokenEnd;
-        continue;
-      }
+    //=====================================================================
+    // 10. MEMBER ACCESS (. and ->)
+    //=====================================================================
+    if (CurrentChar == '.' || (CurrentChar == '-' && NextChar == '>')) {
+      int32 TokenEnd = CurrentPos + (CurrentChar == '-' ? 2 : 1);
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::MemberAccess),
+                 FTextRange(TokenStart, TokenEnd)));
+      CurrentPos = TokenEnd;
+      continue;
+    }
 
-      //=====================================================================
-      // 11. IDENTIFIERS (keywords, types, functions, etc.)
-      //=====================================================================
-      if (FChar::IsAlpha(CurrentChar) || CurrentChar == '_') {
-        while (CurrentPos < LineEnd) {
-          TCHAR C = Input[CurrentPos];
-          if (FChar::IsAlnum(C) || C == '_') {
-            CurrentPos++;
-          } else {
-            break;
-          }
+    //=====================================================================
+    // 11. IDENTIFIERS (keywords, types, functions, etc.)
+    //=====================================================================
+    if (FChar::IsAlpha(CurrentChar) || CurrentChar == '_') {
+      while (CurrentPos < LineEnd) {
+        TCHAR C = Input[CurrentPos];
+        if (FChar::IsAlnum(C) || C == '_') {
+          CurrentPos++;
+        } else {
+          break;
         }
+      }
 
-        FString TokenText = Input.Mid(TokenStart, CurrentPos - TokenStart);
+      FString TokenText = Input.Mid(TokenStart, CurrentPos - TokenStart);
 
-        // Look ahead to determine if this is a function call
-        int32 LookAhead = CurrentPos;
-        while (LookAhead < LineEnd && FChar::IsWhitespace(Input[LookAhead])) {
-          LookAhead++;
-        }
-        bool bFollowedByParen =
-            (LookAhead < LineEnd && Input[LookAhead] == '(');
-        bool bFollowedByTemplate =
-            (LookAhead < LineEnd && Input[LookAhead] == '<');
-
-        // Get token type with context
-        ECppTokenType TokenType =
-            GetTokenType(TokenText, bFollowedByParen, bAfterClassKeyword,
-                         bAfterNamespaceKeyword, bAfterScopeResolution);
-
-        // Update context for next token
-        bool bWasClassKeyword =
-            (TokenText == TEXT("class") || TokenText == TEXT("struct") ||
-             TokenText == TEXT("enum"));
-        bool bWasNamespaceKeyword = (TokenText == TEXT("namespace"));
-
-        bAfterClassKeyword = bWasClassKeyword;
-        bAfterNamespaceKeyword = bWasNamespaceKeyword;
-        bAfterScopeResolution = false;
-
-        TokenizedLine.Tokens.Add(FToken(static_cast<ETokenType>(TokenType),
-                                        FTextRange(TokenStart, CurrentPos)));
-        continue;
+      // Look ahead to determine if this is a function call
+      int32 LookAhead = CurrentPos;
+      while (LookAhead < LineEnd && FChar::IsWhitespace(Input[LookAhead])) {
+        LookAhead++;
       }
+      bool bFollowedByParen =
+          (LookAhead < LineEnd && Input[LookAhead] == '(');
+      bool bFollowedByTemplate =
+          (LookAhead < LineEnd && Input[LookAhead] == '<');
+
+      // Get token type with context
+      ECppTokenType TokenType =
+          GetTokenType(TokenText, bFollowedByParen, bAfterClassKeyword,
+                       bAfterNamespaceKeyword, bAfterScopeResolution);
+
+      // Update context for next token
+      bool bWasClassKeyword =
+          (TokenText == TEXT("class") || TokenText == TEXT("struct") ||
+           TokenText == TEXT("enum"));
+      bool bWasNamespaceKeyword = (TokenText == TEXT("namespace"));
+
+      bAfterClassKeyword = bWasClassKeyword;
+      bAfterNamespaceKeyword = bWasNamespaceKeyword;
+      bAfterScopeResolution = false;
+
+      TokenizedLine.Tokens.Add(FToken(static_cast<ETokenType>(TokenType),
+                                      FTextRange(TokenStart, CurrentPos)));
+      continue;
+    }
 
-      //=====================================================================
-      // 12. MULTI-CHARACTER OPERATORS
-      //=====================================================================
-      if (IsOperatorChar(CurrentChar)) {
-        // Try to match multi-char operators
-        int32 OpEnd = CurrentPos + 1;
-        if (OpEnd < LineEnd) {
-          FString TwoChar = Input.Mid(CurrentPos, 2);
-          if (TwoChar == TEXT("<<") || TwoChar == TEXT(">>") ||
-              TwoChar == TEXT("<=") || TwoChar == TEXT(">=") ||
-              TwoChar == TEXT("==") || TwoChar == TEXT("!=") ||
-              TwoChar == TEXT("&&") || TwoChar == TEXT("||") ||
-              TwoChar == TEXT("+=") || TwoChar == TEXT("-=") ||
-              TwoChar == TEXT("*=") || TwoChar == TEXT("/=") ||
-              TwoChar == TEXT("%=") || TwoChar == TEXT("&=") ||
-              TwoChar == TEXT("|=") || TwoChar == TEXT("^=") ||
-              TwoChar == TEXT("++") || TwoChar == TEXT("--")) {
-            OpEnd = CurrentPos + 2;
-            // Check for three-char operators
-            if (OpEnd < LineEnd) {
-              FString ThreeChar = Input.Mid(CurrentPos, 3);
-              if (ThreeChar == TEXT("<<=") || ThreeChar == TEXT(">>=") ||
-                  ThreeChar == TEXT("<=>")) {
-                OpEnd = CurrentPos + 3;
-              }
+    //=====================================================================
+    // 12. MULTI-CHARACTER OPERATORS
+    //=====================================================================
+    if (IsOperatorChar(CurrentChar)) {
+      // Try to match multi-char operators
+      int32 OpEnd = CurrentPos + 1;
+      if (OpEnd < LineEnd) {
+        FString TwoChar = Input.Mid(CurrentPos, 2);
+        if (TwoChar == TEXT("<<") || TwoChar == TEXT(">>") ||
+            TwoChar == TEXT("<=") || TwoChar == TEXT(">=") ||
+            TwoChar == TEXT("==") || TwoChar == TEXT("!=") ||
+            TwoChar == TEXT("&&") || TwoChar == TEXT("||") ||
+            TwoChar == TEXT("+=") || TwoChar == TEXT("-=") ||
+            TwoChar == TEXT("*=") || TwoChar == TEXT("/=") ||
+            TwoChar == TEXT("%=") || TwoChar == TEXT("&=") ||
+            TwoChar == TEXT("|=") || TwoChar == TEXT("^=") ||
+            TwoChar == TEXT("++") || TwoChar == TEXT("--")) {
+          OpEnd = CurrentPos + 2;
+          // Check for three-char operators
+          if (OpEnd < LineEnd) {
+            FString ThreeChar = Input.Mid(CurrentPos, 3);
+            if (ThreeChar == TEXT("<<=") || ThreeChar == TEXT(">>=") ||
+                ThreeChar == TEXT("<=>")) {
+              OpEnd = CurrentPos + 3;
             }
           }
         }
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::Operator),
-                   FTextRange(CurrentPos, OpEnd)));
-        CurrentPos = OpEnd;
-        continue;
-      }
-
-      //=====================================================================
-      // 13. PUNCTUATION ( { } [ ] ( ) ; , )
-      //=====================================================================
-      if (CurrentChar == '{' || CurrentChar == '}' || CurrentChar == '[' ||
-          CurrentChar == ']' || CurrentChar == '(' || CurrentChar == ')' ||
-          CurrentChar == ';' || CurrentChar == ',') {
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::Punctuation),
-                   FTextRange(CurrentPos, CurrentPos + 1)));
-        CurrentPos++;
-        continue;
       }
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::Operator),
+                 FTextRange(CurrentPos, OpEnd)));
+      CurrentPos = OpEnd;
+      continue;
+    }
 
-      //=====================================================================
-      // 14. TEMPLATE ANGLE BRACKETS (< and >)
-      //=====================================================================
-      if (CurrentChar == '<' || CurrentChar == '>') {
-        // Could be comparison or template - treat as operator for simplicity
-        TokenizedLine.Tokens.Add(
-            FToken(static_cast<ETokenType>(ECppTokenType::Operator),
-                   FTextRange(CurrentPos, CurrentPos + 1)));
-        CurrentPos++;
-        continue;
-      }
+    //=====================================================================
+    // 13. PUNCTUATION ( { } [ ] ( ) ; , )
+    //=====================================================================
+    if (CurrentChar == '{' || CurrentChar == '}' || CurrentChar == '[' ||
+        CurrentChar == ']' || CurrentChar == '(' || CurrentChar == ')' ||
+        CurrentChar == ';' || CurrentChar == ',') {
+      TokenizedLine.Tokens.Add(
+          FToken(static_cast<ETokenType>(ECppTokenType::Punctuation),
+                 FTextRange(CurrentPos, CurrentPos + 1)));
+      CurrentPos++;
+      continue;
+    }
 
-      //=====================================================================
-      // 15. ANY OTHER CHARACTER
-      //=====================================================================
+    //=====================================================================
+    // 14. TEMPLATE ANGLE BRACKETS (< and >)
+    //=====================================================================
+    if (CurrentChar == '<' || CurrentChar == '>') {
+      // Could be comparison or template - treat as operator for simplicity
       TokenizedLine.Tokens.Add(
-          FToken(static_cast<ETokenType>(ECppTokenType::Normal),
+          FToken(static_cast<ETokenType>(ECppTokenType::Operator),
                  FTextRange(CurrentPos, CurrentPos + 1)));
       CurrentPos++;
+      continue;
     }
 
-    OutTokenizedLines.Add(TokenizedLine);
+    //=====================================================================
+    // 15. ANY OTHER CHARACTER
+    //=====================================================================
+    TokenizedLine.Tokens.Add(
+        FToken(static_cast<ETokenType>(ECppTokenType::Normal),
+               FTextRange(CurrentPos, CurrentPos + 1)));
+    CurrentPos++;
   }
 }
 
@@ -775,6 +954,11 @@ TSharedRef<FCppSyntaxHighlighter> FCppSyntaxHighlighter::Create() {
       new FCppSyntaxHighlighter(FCppSyntaxTokenizer::Create()));
 }
 
+TSharedRef<FCppSyntaxHighlighter>
+FCppSyntaxHighlighter::Create(TSharedRef<FCppSyntaxTokenizer> InTokenizer) {
+  return MakeShareable(new FCppSyntaxHighlighter(InTokenizer));
+}
+
 FCppSyntaxHighlighter::FCppSyntaxHighlighter(
     TSharedPtr<ISyntaxTokenizer> InTokenizer)
     : FSyntaxHighlighterTextLayoutMarshaller(InTokenizer) {
@@ -0,0 +1,328 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "FileTreeExclusions.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace FileTreeIgnoreFiles {
+const TCHAR *Names[] = {TEXT(".gitignore"), TEXT(".p4ignore")};
+} // namespace FileTreeIgnoreFiles
+
+static TAutoConsoleVariable<FString> CVarICEExcludePatterns(
+    TEXT("ICE.FileTree.ExcludePatterns"),
+    TEXT("Binaries;Intermediate;DerivedDataCache;Saved/Autosaves"),
+    TEXT("Semicolon-separated .gitignore-style globs the ICE file tree never ")
+        TEXT("lists. Patterns with a '/' are relative to the tree root."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarICEUseIgnoreFiles(
+    TEXT("ICE.FileTree.UseIgnoreFiles"), 1,
+    TEXT("Whether the ICE file tree also excludes what .gitignore and ")
+        TEXT(".p4ignore files ignore."),
+    ECVF_Default);
+
+/**
+ * Match a lowercase glob against lowercase text. "*" and "?" stop at "/",
+ * "**" does not, and "**" followed by "/" also matches no directory.
+ */
+static bool MatchGlob(const TCHAR *Pattern, const TCHAR *Text) {
+  while (*Pattern) {
+    if (Pattern[0] == '*' && Pattern[1] == '*') {
+      Pattern += 2;
+      if (*Pattern == '/' && MatchGlob(Pattern + 1, Text)) {
+        return true;
+      }
+      for (; *Text; ++Text) {
+        if (MatchGlob(Pattern, Text)) {
+          return true;
+        }
+      }
+      return MatchGlob(Pattern, Text);
+    }
+
+    if (*Pattern == '*') {
+      ++Pattern;
+      for (;; ++Text) {
+        if (MatchGlob(Pattern, Text)) {
+          return true;
+        }
+        if (!*Text || *Text == '/') {
+          return false;
+        }
+      }
+    }
+
+    if (!*Text) {
+      return false;
+    }
+
+    if (*Pattern == '?') {
+      if (*Text == '/') {
+        return false;
+      }
+      ++Pattern;
+      ++Text;
+      continue;
+    }
+
+    if (*Pattern == '[') {
+      const TCHAR *Class = Pattern + 1;
+      const bool bInvert = *Class == '!' || *Class == '^';
+      if (bInvert) {
+        ++Class;
+      }
+
+      // "]" right after the opening bracket is a literal member
+      const TCHAR *End = Class + (*Class == ']' ? 1 : 0);
+      while (*End && *End != ']') {
+        ++End;
+      }
+
+      // An unterminated class is a literal "["
+      if (*End) {
+        bool bMatched = false;
+        for (const TCHAR *Member = Class; Member < End; ++Member) {
+          if (Member + 2 < End && Member[1] == '-') {
+            bMatched |= *Text >= Member[0] && *Text <= Member[2];
+            Member += 2;
+          } else {
+            bMatched |= *Text == *Member;
+          }
+        }
+        if (bMatched == bInvert || *Text == '/') {
+          return false;
+        }
+        Pattern = End + 1;
+        ++Text;
+        continue;
+      }
+    }
+
+    if (*Pattern == '\\' && Pattern[1]) {
+      ++Pattern;
+    }
+    if (*Pattern != *Text) {
+      return false;
+    }
+    ++Pattern;
+    ++Text;
+  }
+  return !*Text;
+}
+
+/** Whether a pattern has no wildcard or escape characters */
+static bool IsLiteralPattern(const FString &Pattern) {
+  for (TCHAR C : Pattern) {
+    if (C == '*' || C == '?' || C == '[' || C == '\\') {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FFileTreeIgnoreRules::AddPattern(const FString &Line) {
+  FString Pattern = Line.TrimEnd().ToLower();
+  if (Pattern.IsEmpty() || Pattern[0] == '#') {
+    return;
+  }
+
+  FRule Rule;
+  if (Pattern[0] == '!') {
+    Rule.bNegated = true;
+    Pattern.RightChopInline(1);
+  } else if (Pattern.StartsWith(TEXT("\\#")) ||
+             Pattern.StartsWith(TEXT("\\!"))) {
+    Pattern.RightChopInline(1);
+  }
+
+  if (Pattern.EndsWith(TEXT("/"))) {
+    Rule.bDirectoryOnly = true;
+    Pattern.LeftChopInline(1);
+  }
+
+  // A "/" anywhere but at the end anchors the pattern to the base directory;
+  // a leading "**/" means any depth, the same as no "/" at all
+  if (Pattern.StartsWith(TEXT("**/"))) {
+    Pattern.RightChopInline(3);
+    Rule.bAnchored = Pattern.Contains(TEXT("/"));
+    if (Rule.bAnchored) {
+      Pattern = TEXT("**/") + Pattern;
+    }
+  } else {
+    Rule.bAnchored = Pattern.Contains(TEXT("/"));
+    if (Pattern.StartsWith(TEXT("/"))) {
+      Pattern.RightChopInline(1);
+    }
+  }
+
+  if (Pattern.IsEmpty()) {
+    return;
+  }
+
+  if (!Rule.bAnchored && IsLiteralPattern(Pattern)) {
+    Rule.Kind = ERuleKind::Literal;
+  } else if (!Rule.bAnchored && Pattern[0] == '*' &&
+             IsLiteralPattern(Pattern.RightChop(1))) {
+    Rule.Kind = ERuleKind::Suffix;
+    Pattern.RightChopInline(1);
+  }
+  Rule.Pattern = MoveTemp(Pattern);
+
+  const int32 Index = Rules.Add(MoveTemp(Rule));
+  if (Rules[Index].Kind == ERuleKind::Literal) {
+    LiteralRules.FindOrAdd(Rules[Index].Pattern).Add(Index);
+  } else {
+    PatternRules.Add(Index);
+  }
+}
+
+bool FFileTreeIgnoreRules::AddPatternsFromFile(const FString &FilePath) {
+  TArray<FString> Lines;
+  if (!FFileHelper::LoadFileToStringArray(Lines, *FilePath)) {
+    return false;
+  }
+
+  for (const FString &Line : Lines) {
+    AddPattern(Line);
+  }
+  return true;
+}
+
+bool FFileTreeIgnoreRules::RuleMatches(const FRule &Rule,
+                                       const FString &LowerPath,
+                                       const FString &LowerName,
+                                       bool bIsDirectory) {
+  if (Rule.bDirectoryOnly && !bIsDirectory) {
+    return false;
+  }
+
+  switch (Rule.Kind) {
+  case ERuleKind::Literal:
+    return LowerName == Rule.Pattern;
+  case ERuleKind::Suffix:
+    return LowerName.EndsWith(Rule.Pattern, ESearchCase::CaseSensitive);
+  default:
+    return MatchGlob(*Rule.Pattern, Rule.bAnchored ? *LowerPath : *LowerName);
+  }
+}
+
+EFileTreeIgnoreMatch FFileTreeIgnoreRules::Match(const FString &RelativePath,
+                                                 const FString &Name,
+                                                 bool bIsDirectory) const {
+  if (Rules.Num() == 0) {
+    return EFileTreeIgnoreMatch::None;
+  }
+
+  const FString LowerPath = RelativePath.ToLower();
+  const FString LowerName = Name.ToLower();
+
+  // The last matching rule wins: find the highest matching index, starting
+  // with the hashed literals and then scanning the other rules downwards
+  int32 MatchIndex = INDEX_NONE;
+  if (const TArray<int32, TInlineAllocator<1>> *Literals =
+          LiteralRules.Find(LowerName)) {
+    for (int32 Index = Literals->Num() - 1; Index >= 0; --Index) {
+      const int32 RuleIndex = (*Literals)[Index];
+      if (RuleMatches(Rules[RuleIndex], LowerPath, LowerName, bIsDirectory)) {
+        MatchIndex = RuleIndex;
+        break;
+      }
+    }
+  }
+
+  for (int32 Index = PatternRules.Num() - 1; Index >= 0; --Index) {
+    const int32 RuleIndex = PatternRules[Index];
+    if (RuleIndex < MatchIndex) {
+      break;
+    }
+    if (RuleMatches(Rules[RuleIndex], LowerPath, LowerName, bIsDirectory)) {
+      MatchIndex = RuleIndex;
+      break;
+    }
+  }
+
+  if (MatchIndex == INDEX_NONE) {
+    return EFileTreeIgnoreMatch::None;
+  }
+  return Rules[MatchIndex].bNegated ? EFileTreeIgnoreMatch::Included
+                                    : EFileTreeIgnoreMatch::Excluded;
+}
+
+bool FFileTreeIgnoreScope::IsExcluded(const FString &DirectoryPath,
+                                      const FString &Name,
+                                      bool bIsDirectory) const {
+  const FString Path = DirectoryPath / Name;
+
+  // Nearer ignore files override farther ones
+  for (const FFileTreeIgnoreScope *Scope = this; Scope;
+       Scope = Scope->Parent.Get()) {
+    const FString RelativePath =
+        Path.StartsWith(Scope->BaseDir + TEXT("/"))
+            ? Path.RightChop(Scope->BaseDir.Len() + 1)
+            : Name;
+    switch (Scope->Rules.Match(RelativePath, Name, bIsDirectory)) {
+    case EFileTreeIgnoreMatch::Excluded:
+      return true;
+    case EFileTreeIgnoreMatch::Included:
+      return false;
+    default:
+      break;
+    }
+  }
+  return false;
+}
+
+TSharedRef<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+FFileTreeIgnoreScope::CreateDefault(const FString &RootPath) {
+  TSharedRef<FFileTreeIgnoreScope, ESPMode::ThreadSafe> Scope =
+      MakeShared<FFileTreeIgnoreScope, ESPMode::ThreadSafe>();
+  Scope->BaseDir = RootPath;
+
+  TArray<FString> Patterns;
+  CVarICEExcludePatterns.GetValueOnGameThread().ParseIntoArray(Patterns,
+                                                               TEXT(";"));
+  for (const FString &Pattern : Patterns) {
+    Scope->Rules.AddPattern(Pattern.TrimStartAndEnd());
+  }
+  return Scope;
+}
+
+TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+FFileTreeIgnoreScope::LoadForDirectory(
+    const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe> &Parent,
+    const FString &DirectoryPath) {
+  if (CVarICEUseIgnoreFiles.GetValueOnAnyThread() == 0) {
+    return nullptr;
+  }
+
+  TSharedPtr<FFileTreeIgnoreScope, ESPMode::ThreadSafe> Scope;
+  for (const TCHAR *FileName : FileTreeIgnoreFiles::Names) {
+    const FString FilePath = DirectoryPath / FileName;
+    if (!IFileManager::Get().FileExists(*FilePath)) {
+      continue;
+    }
+
+    if (!Scope.IsValid()) {
+      Scope = MakeShared<FFileTreeIgnoreScope, ESPMode::ThreadSafe>();
+      Scope->Parent = Parent;
+      Scope->BaseDir = DirectoryPath;
+    }
+    Scope->Rules.AddPatternsFromFile(FilePath);
+  }
+
+  if (!Scope.IsValid() || Scope->Rules.IsEmpty()) {
+    return nullptr;
+  }
+  return Scope;
+}
+
+bool FFileTreeIgnoreScope::IsIgnoreFileName(const FString &Name) {
+  for (const TCHAR *FileName : FileTreeIgnoreFiles::Names) {
+    if (Name == FileName) {
+      return true;
+    }
+  }
+  return false;
+}
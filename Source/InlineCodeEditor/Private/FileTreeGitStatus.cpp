@@ -0,0 +1,657 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "FileTreeGitStatus.h"
+#include "Algo/BinarySearch.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Containers/StringConv.h"
+#include "DirectoryWatcherModule.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "IDirectoryWatcher.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Modules/ModuleManager.h"
+
+namespace FileTreeGitConstants {
+/** Size of a SHA-1 object name */
+constexpr int32 Sha1Size = 20;
+
+/** Size of a SHA-256 object name */
+constexpr int32 Sha256Size = 32;
+
+/** Tracked files each worker task checks */
+constexpr int32 CheckChunkSize = 1024;
+
+/** Read size when hashing a file */
+constexpr int32 HashBufferSize = 64 * 1024;
+
+/** Entry mode types, the top four bits of the mode */
+constexpr uint32 ModeTypeFile = 0x8;
+constexpr uint32 ModeTypeSymlink = 0xA;
+constexpr uint32 ModeTypeGitlink = 0xE;
+
+/** Entry flags */
+constexpr uint16 FlagExtended = 0x4000;
+constexpr uint16 FlagStageMask = 0x3000;
+constexpr uint16 ExtendedFlagIntentToAdd = 0x2000;
+constexpr uint16 ExtendedFlagSkipWorktree = 0x4000;
+} // namespace FileTreeGitConstants
+
+static TAutoConsoleVariable<int32> CVarICEGitStatus(
+    TEXT("ICE.FileTree.GitStatus"), 1,
+    TEXT("Whether the ICE file tree colors files by their git status, read ")
+        TEXT("from the repository's index without running git."),
+    ECVF_Default);
+
+/** Whether a file's contents hash to a blob name, as git would name it */
+static bool MatchesBlobHash(const FString &FilePath, const uint8 *Expected) {
+  TUniquePtr<FArchive> Reader(
+      IFileManager::Get().CreateFileReader(*FilePath, FILEREAD_Silent));
+  if (!Reader.IsValid()) {
+    return false;
+  }
+
+  // Git hashes "blob <size>" and a NUL, then the contents
+  const int64 Size = Reader->TotalSize();
+  const FTCHARToUTF8 Header(*FString::Printf(TEXT("blob %lld"), Size));
+  FSHA1 Sha;
+  Sha.Update(reinterpret_cast<const uint8 *>(Header.Get()),
+             Header.Length() + 1);
+
+  TArray<uint8> Buffer;
+  Buffer.SetNumUninitialized(FileTreeGitConstants::HashBufferSize);
+  for (int64 Remaining = Size; Remaining > 0;) {
+    const int64 Chunk = FMath::Min<int64>(Remaining, Buffer.Num());
+    Reader->Serialize(Buffer.GetData(), Chunk);
+    if (Reader->IsError()) {
+      return false;
+    }
+    Sha.Update(Buffer.GetData(), Chunk);
+    Remaining -= Chunk;
+  }
+  Sha.Final();
+
+  uint8 Hash[FileTreeGitConstants::Sha1Size];
+  Sha.GetHash(Hash);
+  return FMemory::Memcmp(Hash, Expected, sizeof(Hash)) == 0;
+}
+
+/**
+ * The tracked files of a git index (versions 2 to 4), with the stat data
+ * git cached for them. Immutable once read, so workers share it.
+ */
+struct FFileTreeGitStatus::FIndex {
+  enum class EKind : uint8 { File, Symlink, Gitlink };
+
+  struct FEntry {
+    /** Work tree relative path */
+    FString Path;
+
+    /** Modification time in seconds, and the low 32 bits of the size */
+    int64 ModificationTime = 0;
+    uint32 Size = 0;
+
+    /** Object name of the staged contents; SHA-1 repositories only */
+    uint8 Hash[FileTreeGitConstants::Sha1Size] = {};
+
+    EKind Kind = EKind::File;
+
+    /** Conflicted or intent-to-add entries never match the work tree */
+    bool bAlwaysChanged = false;
+  };
+
+  /** Entries sorted by path, one per path */
+  TArray<FEntry> Entries;
+
+  /** Folders holding tracked files */
+  TSet<FString> Directories;
+
+  /** When the index was written, in seconds */
+  int64 Timestamp = 0;
+
+  /** Size of object names in this repository */
+  int32 HashSize = FileTreeGitConstants::Sha1Size;
+
+  /** Read the index of a repository; null if it is missing or malformed */
+  static TSharedPtr<FIndex, ESPMode::ThreadSafe> Read(const FString &GitDir);
+
+  /** Entry of a path, if tracked */
+  const FEntry *Find(const FString &Path) const {
+    const int32 Found = LowerBound(Path);
+    return Found < Entries.Num() &&
+                   Entries[Found].Path.Equals(Path, ESearchCase::CaseSensitive)
+               ? &Entries[Found]
+               : nullptr;
+  }
+
+  /** Call Visit for every entry below a folder */
+  template <typename FunctorType>
+  void ForEachBelow(const FString &Directory, FunctorType &&Visit) const {
+    const FString Prefix = Directory + TEXT("/");
+    for (int32 Index = LowerBound(Prefix); Index < Entries.Num(); ++Index) {
+      if (!Entries[Index].Path.StartsWith(Prefix, ESearchCase::CaseSensitive)) {
+        break;
+      }
+      Visit(Entries[Index]);
+    }
+  }
+
+  /** Whether a tracked file differs from its entry, or is gone */
+  bool IsChanged(const FString &WorkTree, const FEntry &Entry) const;
+
+private:
+  int32 LowerBound(const FString &Path) const {
+    return Algo::LowerBound(Entries, Path,
+                            [](const FEntry &Entry, const FString &Value) {
+                              return Entry.Path.Compare(
+                                         Value, ESearchCase::CaseSensitive) < 0;
+                            });
+  }
+};
+
+TSharedPtr<FFileTreeGitStatus::FIndex, ESPMode::ThreadSafe>
+FFileTreeGitStatus::FIndex::Read(const FString &GitDir) {
+  using namespace FileTreeGitConstants;
+
+  const FString IndexPath = GitDir / TEXT("index");
+  TArray<uint8> Bytes;
+  if (!FFileHelper::LoadFileToArray(Bytes, *IndexPath, FILEREAD_Silent)) {
+    return nullptr;
+  }
+
+  TSharedRef<FIndex, ESPMode::ThreadSafe> Index =
+      MakeShared<FIndex, ESPMode::ThreadSafe>();
+  Index->Timestamp =
+      IFileManager::Get().GetTimeStamp(*IndexPath).ToUnixTimestamp();
+
+  // Only the object format matters from the config
+  TArray<FString> ConfigLines;
+  if (FFileHelper::LoadFileToStringArray(ConfigLines,
+                                         *(GitDir / TEXT("config")))) {
+    for (const FString &Line : ConfigLines) {
+      if (Line.Replace(TEXT(" "), TEXT(""))
+              .Replace(TEXT("\t"), TEXT(""))
+              .Equals(TEXT("objectformat=sha256"))) {
+        Index->HashSize = Sha256Size;
+      }
+    }
+  }
+
+  const int64 NumBytes = Bytes.Num();
+  auto Read16 = [&Bytes](int64 Offset) -> uint16 {
+    return (uint16(Bytes[Offset]) << 8) | Bytes[Offset + 1];
+  };
+  auto Read32 = [&Bytes](int64 Offset) -> uint32 {
+    return (uint32(Bytes[Offset]) << 24) | (uint32(Bytes[Offset + 1]) << 16) |
+           (uint32(Bytes[Offset + 2]) << 8) | Bytes[Offset + 3];
+  };
+
+  // [DIRC][Version][NumEntries][Entries...][Extensions...][Checksum]
+  if (NumBytes < 12 || FMemory::Memcmp(Bytes.GetData(), "DIRC", 4) != 0) {
+    return nullptr;
+  }
+  const uint32 Version = Read32(4);
+  const uint32 NumEntries = Read32(8);
+  if (Version < 2 || Version > 4) {
+    return nullptr;
+  }
+
+  // ctime, mtime, dev, ino, mode, uid, gid and size are 32 bits each
+  const int64 FixedSize = 40 + Index->HashSize + 2;
+  TArray<ANSICHAR> Name;
+  Index->Entries.Reserve(FMath::Min<int64>(NumEntries, NumBytes / FixedSize));
+
+  int64 Offset = 12;
+  for (uint32 EntryIndex = 0; EntryIndex < NumEntries; ++EntryIndex) {
+    if (Offset + FixedSize > NumBytes) {
+      return nullptr;
+    }
+
+    const uint32 Mode = Read32(Offset + 24);
+    const uint16 Flags = Read16(Offset + 40 + Index->HashSize);
+    int64 NameStart = Offset + FixedSize;
+    uint16 ExtendedFlags = 0;
+    if (Flags & FlagExtended) {
+      if (Version < 3 || NameStart + 2 > NumBytes) {
+        return nullptr;
+      }
+      ExtendedFlags = Read16(NameStart);
+      NameStart += 2;
+    }
+
+    // Version 4 strips a number of bytes off the previous name and appends
+    // the rest; earlier versions store the whole name, padded to 8 bytes
+    if (Version == 4) {
+      uint64 Strip = 0;
+      uint8 Byte = 0;
+      do {
+        if (NameStart >= NumBytes) {
+          return nullptr;
+        }
+        Byte = Bytes[NameStart++];
+        Strip = (Strip << 7) | (Byte & 0x7F);
+        if (Byte & 0x80) {
+          ++Strip;
+        }
+      } while (Byte & 0x80);
+      if (Strip > uint64(Name.Num())) {
+        return nullptr;
+      }
+      Name.SetNum(Name.Num() - int32(Strip));
+    } else {
+      Name.Reset();
+    }
+
+    int64 NameEnd = NameStart;
+    while (NameEnd < NumBytes && Bytes[NameEnd] != 0) {
+      ++NameEnd;
+    }
+    if (NameEnd >= NumBytes) {
+      return nullptr;
+    }
+    Name.Append(reinterpret_cast<const ANSICHAR *>(Bytes.GetData() + NameStart),
+                int32(NameEnd - NameStart));
+
+    const int64 EntryOffset = Offset;
+    Offset = Version == 4
+                 ? NameEnd + 1
+                 : Offset + ((NameEnd - Offset + 8) & ~int64(7));
+
+    // Sparse checkouts list folders and files that are not on disk
+    const uint32 ModeType = Mode >> 12;
+    if ((ExtendedFlags & ExtendedFlagSkipWorktree) ||
+        (ModeType != ModeTypeFile && ModeType != ModeTypeSymlink &&
+         ModeType != ModeTypeGitlink)) {
+      continue;
+    }
+
+    const FUTF8ToTCHAR Path(Name.GetData(), Name.Num());
+    FEntry &Entry = Index->Entries.AddDefaulted_GetRef();
+    Entry.Path = FString(Path.Length(), Path.Get());
+    Entry.ModificationTime = Read32(EntryOffset + 8);
+    Entry.Size = Read32(EntryOffset + 36);
+    FMemory::Memcpy(Entry.Hash, Bytes.GetData() + EntryOffset + 40,
+                    sizeof(Entry.Hash));
+    Entry.Kind = ModeType == ModeTypeSymlink   ? EKind::Symlink
+                 : ModeType == ModeTypeGitlink ? EKind::Gitlink
+                                               : EKind::File;
+    Entry.bAlwaysChanged = (Flags & FlagStageMask) != 0 ||
+                           (ExtendedFlags & ExtendedFlagIntentToAdd) != 0;
+  }
+
+  // Git sorts by bytes, which UTF-16 order matches outside surrogates; sort
+  // anyway, and fold the stages of a conflicted path into one entry
+  Index->Entries.StableSort([](const FEntry &A, const FEntry &B) {
+    return A.Path.Compare(B.Path, ESearchCase::CaseSensitive) < 0;
+  });
+  int32 NumUnique = 0;
+  for (int32 EntryIndex = 0; EntryIndex < Index->Entries.Num(); ++EntryIndex) {
+    FEntry &Entry = Index->Entries[EntryIndex];
+    if (NumUnique > 0 && Index->Entries[NumUnique - 1].Path.Equals(
+                             Entry.Path, ESearchCase::CaseSensitive)) {
+      Index->Entries[NumUnique - 1].bAlwaysChanged = true;
+      continue;
+    }
+    if (EntryIndex != NumUnique) {
+      Index->Entries[NumUnique] = MoveTemp(Entry);
+    }
+    ++NumUnique;
+  }
+  Index->Entries.SetNum(NumUnique);
+
+  // Ancestors are added deepest first, so stop at one already known
+  for (const FEntry &Entry : Index->Entries) {
+    int32 Slash = INDEX_NONE;
+    FString Directory = Entry.Path;
+    while (Directory.FindLastChar('/', Slash)) {
+      Directory.LeftInline(Slash);
+      bool bAlreadyKnown = false;
+      Index->Directories.Add(Directory, &bAlreadyKnown);
+      if (bAlreadyKnown) {
+        break;
+      }
+    }
+  }
+  return Index;
+}
+
+bool FFileTreeGitStatus::FIndex::IsChanged(const FString &WorkTree,
+                                           const FEntry &Entry) const {
+  if (Entry.bAlwaysChanged) {
+    return true;
+  }
+
+  const FString FilePath = WorkTree / Entry.Path;
+  const FFileStatData StatData = IFileManager::Get().GetStatData(*FilePath);
+  if (!StatData.bIsValid) {
+    return true;
+  }
+
+  // Submodules have their own status, and links are not followed
+  if (Entry.Kind != EKind::File) {
+    return false;
+  }
+  if (StatData.bIsDirectory || uint32(StatData.FileSize) != Entry.Size) {
+    return true;
+  }
+
+  // A file written in the same second as the index may have changed after
+  // git looked at it, so only an older one is trusted on its time alone
+  const int64 ModificationTime = StatData.ModificationTime.ToUnixTimestamp();
+  if (ModificationTime == Entry.ModificationTime &&
+      ModificationTime < Timestamp) {
+    return false;
+  }
+
+  if (HashSize != FileTreeGitConstants::Sha1Size) {
+    return true;
+  }
+  return !MatchesBlobHash(FilePath, Entry.Hash);
+}
+
+FFileTreeGitStatus::FFileTreeGitStatus(const FString &InWorkTree,
+                                       const FString &InGitDir)
+    : WorkTree(InWorkTree), GitDir(InGitDir),
+      Cancelled(MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false)) {}
+
+FFileTreeGitStatus::~FFileTreeGitStatus() {
+  *Cancelled = true;
+
+  if (GitDirWatchHandle.IsValid()) {
+    FDirectoryWatcherModule *WatcherModule =
+        FModuleManager::GetModulePtr<FDirectoryWatcherModule>(
+            TEXT("DirectoryWatcher"));
+    if (IDirectoryWatcher *Watcher =
+            WatcherModule ? WatcherModule->Get() : nullptr) {
+      Watcher->UnregisterDirectoryChangedCallback_Handle(GitDir,
+                                                         GitDirWatchHandle);
+    }
+  }
+}
+
+TSharedPtr<FFileTreeGitStatus, ESPMode::ThreadSafe>
+FFileTreeGitStatus::Create(const FString &RootPath) {
+  if (CVarICEGitStatus.GetValueOnGameThread() == 0) {
+    return nullptr;
+  }
+
+  FString Directory = FPaths::ConvertRelativePathToFull(RootPath);
+  FPaths::NormalizeDirectoryName(Directory);
+
+  FString FoundGitDir;
+  while (!Directory.IsEmpty()) {
+    const FString DotGit = Directory / TEXT(".git");
+    if (IFileManager::Get().DirectoryExists(*DotGit)) {
+      FoundGitDir = DotGit;
+      break;
+    }
+
+    // Linked work trees and submodules name their repository in a file
+    FString Contents;
+    if (IFileManager::Get().FileExists(*DotGit) &&
+        FFileHelper::LoadFileToString(Contents, *DotGit) &&
+        Contents.TrimStartAndEnd().StartsWith(TEXT("gitdir:"))) {
+      FoundGitDir = Contents.TrimStartAndEnd().RightChop(7).TrimStart();
+      if (FPaths::IsRelative(FoundGitDir)) {
+        FoundGitDir = Directory / FoundGitDir;
+      }
+      FoundGitDir = FPaths::ConvertRelativePathToFull(FoundGitDir);
+      FPaths::NormalizeDirectoryName(FoundGitDir);
+      break;
+    }
+
+    const FString Parent = FPaths::GetPath(Directory);
+    if (Parent == Directory) {
+      break;
+    }
+    Directory = Parent;
+  }
+
+  if (FoundGitDir.IsEmpty()) {
+    return nullptr;
+  }
+
+  TSharedPtr<FFileTreeGitStatus, ESPMode::ThreadSafe> Status(
+      new FFileTreeGitStatus(Directory, FoundGitDir));
+
+  // Git replaces the index on every commit, checkout and add
+  FDirectoryWatcherModule *WatcherModule =
+      FModuleManager::Get().LoadModulePtr<FDirectoryWatcherModule>(
+          TEXT("DirectoryWatcher"));
+  if (IDirectoryWatcher *Watcher =
+          WatcherModule ? WatcherModule->Get() : nullptr) {
+    Watcher->RegisterDirectoryChangedCallback_Handle(
+        FoundGitDir,
+        IDirectoryWatcher::FDirectoryChanged::CreateSP(
+            Status.ToSharedRef(), &FFileTreeGitStatus::OnGitDirChanged),
+        Status->GitDirWatchHandle,
+        IDirectoryWatcher::WatchOptions::IgnoreChangesInSubtree);
+  }
+  return Status;
+}
+
+void FFileTreeGitStatus::Refresh() {
+  if (bRefreshing) {
+    bRefreshAgain = true;
+    return;
+  }
+  bRefreshing = true;
+  bRefreshAgain = false;
+
+  TWeakPtr<FFileTreeGitStatus, ESPMode::ThreadSafe> WeakStatus = AsShared();
+  Async(EAsyncExecution::ThreadPool, [WeakStatus, WorkTree = WorkTree,
+                                      GitDir = GitDir,
+                                      Cancelled = Cancelled]() {
+    TSharedPtr<FIndex, ESPMode::ThreadSafe> NewIndex = FIndex::Read(GitDir);
+
+    // Stat every tracked file; only the suspicious ones are hashed
+    TArray<TArray<FString>> ChunkChanges;
+    if (NewIndex.IsValid()) {
+      const TArray<FIndex::FEntry> &Entries = NewIndex->Entries;
+      ChunkChanges.SetNum(FMath::DivideAndRoundUp(
+          Entries.Num(), FileTreeGitConstants::CheckChunkSize));
+      ParallelFor(ChunkChanges.Num(), [&](int32 Chunk) {
+        const int32 First = Chunk * FileTreeGitConstants::CheckChunkSize;
+        const int32 Last = FMath::Min(
+            First + FileTreeGitConstants::CheckChunkSize, Entries.Num());
+        for (int32 Index = First; Index < Last && !*Cancelled; ++Index) {
+          if (NewIndex->IsChanged(WorkTree, Entries[Index])) {
+            ChunkChanges[Chunk].Add(Entries[Index].Path);
+          }
+        }
+      });
+    }
+
+    TArray<TPair<FString, bool>> Checks;
+    for (TArray<FString> &Changes : ChunkChanges) {
+      for (FString &Path : Changes) {
+        Checks.Emplace(MoveTemp(Path), true);
+      }
+    }
+
+    AsyncTask(ENamedThreads::GameThread, [WeakStatus, NewIndex,
+                                          Checks = MoveTemp(Checks)]() {
+      TSharedPtr<FFileTreeGitStatus, ESPMode::ThreadSafe> Status =
+          WeakStatus.Pin();
+      if (!Status.IsValid()) {
+        return;
+      }
+
+      Status->bRefreshing = false;
+      Status->Index = NewIndex;
+      Status->ChangedFiles.Reset();
+      Status->ChangedDirectories.Reset();
+      Status->ApplyChecks(Checks);
+      Status->ChangedEvent.Broadcast();
+
+      // Changes seen during the refresh may predate what it read
+      if (Status->bRefreshAgain) {
+        Status->Refresh();
+      } else {
+        Status->CheckPaths();
+      }
+    });
+  });
+}
+
+void FFileTreeGitStatus::HandleChanges(const TArray<FFileChangeData> &Changes) {
+  if (!Index.IsValid() && !bRefreshing) {
+    return;
+  }
+
+  for (const FFileChangeData &Change : Changes) {
+    if (Change.Action == FFileChangeData::FCA_RescanRequired) {
+      Refresh();
+      return;
+    }
+
+    FString RelativePath;
+    if (MakeRelative(Change.Filename, RelativePath)) {
+      bool &bRecurse = PendingPaths.FindOrAdd(RelativePath);
+      bRecurse |= Change.Action != FFileChangeData::FCA_Modified;
+    }
+  }
+  CheckPaths();
+}
+
+void FFileTreeGitStatus::CheckPaths() {
+  if (bRefreshing || bChecking || !Index.IsValid() || PendingPaths.Num() == 0) {
+    return;
+  }
+  bChecking = true;
+
+  TWeakPtr<FFileTreeGitStatus, ESPMode::ThreadSafe> WeakStatus = AsShared();
+  Async(EAsyncExecution::ThreadPool, [WeakStatus, WorkTree = WorkTree,
+                                      CheckedIndex = Index.ToSharedRef(),
+                                      Paths = MoveTemp(PendingPaths)]() {
+    TArray<TPair<FString, bool>> Checks;
+    for (const TPair<FString, bool> &Pair : Paths) {
+      if (const FIndex::FEntry *Entry = CheckedIndex->Find(Pair.Key)) {
+        Checks.Emplace(Entry->Path, CheckedIndex->IsChanged(WorkTree, *Entry));
+      }
+
+      // A folder removed or moved takes its tracked files with it
+      if (Pair.Value) {
+        CheckedIndex->ForEachBelow(
+            Pair.Key, [&Checks, &WorkTree,
+                       &CheckedIndex](const FIndex::FEntry &Entry) {
+              Checks.Emplace(Entry.Path,
+                             CheckedIndex->IsChanged(WorkTree, Entry));
+            });
+      }
+    }
+
+    AsyncTask(ENamedThreads::GameThread, [WeakStatus, CheckedIndex,
+                                          Checks = MoveTemp(Checks)]() {
+      TSharedPtr<FFileTreeGitStatus, ESPMode::ThreadSafe> Status =
+          WeakStatus.Pin();
+      if (!Status.IsValid()) {
+        return;
+      }
+
+      // A refresh that finished meanwhile has checked every file anew
+      Status->bChecking = false;
+      if (Status->Index == CheckedIndex && Status->ApplyChecks(Checks)) {
+        Status->ChangedEvent.Broadcast();
+      }
+      Status->CheckPaths();
+    });
+  });
+  PendingPaths.Reset();
+}
+
+bool FFileTreeGitStatus::ApplyChecks(
+    const TArray<TPair<FString, bool>> &Checks) {
+  bool bAnyChanged = false;
+  for (const TPair<FString, bool> &Check : Checks) {
+    if (ChangedFiles.Contains(Check.Key) == Check.Value) {
+      continue;
+    }
+    bAnyChanged = true;
+
+    if (Check.Value) {
+      ChangedFiles.Add(Check.Key);
+    } else {
+      ChangedFiles.Remove(Check.Key);
+    }
+
+    // Count the file in every folder above it, up to the work tree root
+    const int32 Delta = Check.Value ? 1 : -1;
+    FString Directory = Check.Key;
+    do {
+      int32 Slash = INDEX_NONE;
+      if (Directory.FindLastChar('/', Slash)) {
+        Directory.LeftInline(Slash);
+      } else {
+        Directory.Reset();
+      }
+      int32 &Count = ChangedDirectories.FindOrAdd(Directory);
+      Count += Delta;
+      if (Count <= 0) {
+        ChangedDirectories.Remove(Directory);
+      }
+    } while (!Directory.IsEmpty());
+  }
+  return bAnyChanged;
+}
+
+EFileTreeGitState FFileTreeGitStatus::GetState(const FString &Path,
+                                               bool bIsDirectory,
+                                               bool bIsExcluded) const {
+  FString RelativePath;
+  if (!Index.IsValid() || !MakeRelative(Path, RelativePath)) {
+    return EFileTreeGitState::None;
+  }
+
+  if (bIsDirectory) {
+    if (ChangedDirectories.Contains(RelativePath)) {
+      return EFileTreeGitState::Modified;
+    }
+    if (RelativePath.IsEmpty() || Index->Directories.Contains(RelativePath)) {
+      return EFileTreeGitState::Clean;
+    }
+  } else {
+    if (ChangedFiles.Contains(RelativePath)) {
+      return EFileTreeGitState::Modified;
+    }
+    if (Index->Find(RelativePath)) {
+      return EFileTreeGitState::Clean;
+    }
+  }
+  return bIsExcluded ? EFileTreeGitState::Ignored
+                     : EFileTreeGitState::Untracked;
+}
+
+bool FFileTreeGitStatus::MakeRelative(const FString &Path,
+                                      FString &OutRelativePath) const {
+  FString FullPath = FPaths::ConvertRelativePathToFull(Path);
+  FPaths::NormalizeDirectoryName(FullPath);
+
+  // The repository's own files are not part of the work tree
+  if (FullPath.Equals(GitDir) || FullPath.StartsWith(GitDir + TEXT("/"))) {
+    return false;
+  }
+
+  if (FullPath.Equals(WorkTree)) {
+    OutRelativePath.Reset();
+    return true;
+  }
+  if (!FullPath.StartsWith(WorkTree + TEXT("/"))) {
+    return false;
+  }
+  OutRelativePath = FullPath.RightChop(WorkTree.Len() + 1);
+  return true;
+}
+
+void FFileTreeGitStatus::OnGitDirChanged(
+    const TArray<FFileChangeData> &Changes) {
+  for (const FFileChangeData &Change : Changes) {
+    if (Change.Action == FFileChangeData::FCA_RescanRequired ||
+        FPaths::GetCleanFilename(Change.Filename) == TEXT("index")) {
+      Refresh();
+      return;
+    }
+  }
+}
@@ -1,221 +1,200 @@
 // Copyright Yureka. All Rights Reserved.
 
 #include "FileTreeIconManager.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
 #include "Interfaces/IPluginManager.h"
+#include "Misc/FileHelper.h"
 #include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace FileTreeIcons {
+/** Every icon is drawn at this size */
+const FVector2D IconSize(16.0f, 16.0f);
+
+/** Manifest of the icon pack, in the icon folder */
+const TCHAR *ManifestName = TEXT("IconPack.json");
+} // namespace FileTreeIcons
 
 FFileTreeIconManager &FFileTreeIconManager::Get() {
   static FFileTreeIconManager Instance;
   return Instance;
 }
 
-FString FFileTreeIconManager::GetIconBasePath() const {
-  // Get the plugin's base directory
-  FString PluginBaseDir = FPaths::ConvertRelativePathToFull(
-      FPaths::Combine(FPaths::ProjectPluginsDir(), TEXT("InlineCodeEditor")));
-
-  // Return the path to the Icons folder
-  return FPaths::Combine(PluginBaseDir, TEXT("Resources"), TEXT("Icons"));
-}
-
-TSharedPtr<FSlateVectorImageBrush>
-FFileTreeIconManager::LoadSVGIcon(const FString &IconName,
-                                  const FVector2D &IconSize) {
-  FString IconPath =
-      FPaths::Combine(GetIconBasePath(), IconName + TEXT(".svg"));
-
-  if (!FPaths::FileExists(IconPath)) {
-    UE_LOG(LogTemp, Warning, TEXT("FileTreeIconManager: Icon not found at %s"),
-           *IconPath);
-    return nullptr;
+FString FFileTreeIconManager::GetIconBasePath() {
+  // The plugin can live in the project or in the engine
+  FString PluginBaseDir;
+  if (TSharedPtr<IPlugin> Plugin =
+          IPluginManager::Get().FindPlugin(TEXT("InlineCodeEditor"))) {
+    PluginBaseDir = Plugin->GetBaseDir();
+  } else {
+    PluginBaseDir = FPaths::Combine(FPaths::ProjectPluginsDir(),
+                                    TEXT("InlineCodeEditor"));
   }
 
-  return MakeShared<FSlateVectorImageBrush>(IconPath, IconSize);
+  // Return the path to the Icons folder
+  return FPaths::Combine(FPaths::ConvertRelativePathToFull(PluginBaseDir),
+                         TEXT("Resources"), TEXT("Icons"));
 }
 
 void FFileTreeIconManager::Initialize() {
-  if (bIsInitialized) {
+  if (bIsLoading) {
     return;
   }
+  bIsLoading = true;
+
+  Async(EAsyncExecution::ThreadPool, [BasePath = GetIconBasePath()]() {
+    // One listing of the icon folder instead of a check per icon
+    TArray<FString> FileNames;
+    IFileManager::Get().FindFiles(FileNames, *(BasePath / TEXT("*.svg")),
+                                  true, false);
+    TSet<FString> Available;
+    for (const FString &FileName : FileNames) {
+      Available.Add(FPaths::GetBaseFilename(FileName));
+    }
+
+    TArray<FIcon> Icons;
+    TMap<FString, FIconIndex> IconIndices;
+    auto AddIcon = [&](const FString &IconName) -> FIconIndex {
+      if (const FIconIndex *Index = IconIndices.Find(IconName)) {
+        return *Index;
+      }
+      if (IconName.IsEmpty() || Icons.Num() >= NoIcon) {
+        return NoIcon;
+      }
+      if (!Available.Contains(IconName)) {
+        UE_LOG(LogTemp, Warning,
+               TEXT("FileTreeIconManager: Icon %s not found at %s"),
+               *IconName, *BasePath);
+      }
+
+      FIcon &Icon = Icons.AddDefaulted_GetRef();
+      if (Available.Contains(IconName)) {
+        Icon.Path = BasePath / IconName + TEXT(".svg");
+      }
+      return IconIndices.Add(IconName, FIconIndex(Icons.Num() - 1));
+    };
+
+    // {"folder": ..., "folderOpen": ..., "file": ...,
+    //  "extensions": {"<extension>": "<icon>", ...}}
+    const FString ManifestPath = BasePath / FileTreeIcons::ManifestName;
+    FString ManifestText;
+    TSharedPtr<FJsonObject> Manifest;
+    if (!FFileHelper::LoadFileToString(ManifestText, *ManifestPath) ||
+        !FJsonSerializer::Deserialize(
+            TJsonReaderFactory<>::Create(ManifestText), Manifest) ||
+        !Manifest.IsValid()) {
+      UE_LOG(LogTemp, Warning,
+             TEXT("FileTreeIconManager: Could not read icon pack %s"),
+             *ManifestPath);
+      Manifest = MakeShared<FJsonObject>();
+    }
 
-  const FVector2D IconSize(16.0f, 16.0f);
-
-  // Load folder icons
-  FolderIcon = LoadSVGIcon(TEXT("folder"), IconSize);
-  FolderOpenIcon = LoadSVGIcon(TEXT("folder_open"), IconSize);
-
-  // Load file type icons
-  DefaultFileIcon = LoadSVGIcon(TEXT("file_default"), IconSize);
-  CppIcon = LoadSVGIcon(TEXT("file_cpp"), IconSize);
-  CIcon = LoadSVGIcon(TEXT("file_c"), IconSize);
-  HeaderIcon = LoadSVGIcon(TEXT("file_header"), IconSize);
-  CHeaderIcon = LoadSVGIcon(TEXT("file_cheader"), IconSize);
-  CSharpIcon = LoadSVGIcon(TEXT("file_csharp"), IconSize);
-  JsonIcon = LoadSVGIcon(TEXT("file_json"), IconSize);
-  ConfigIcon = LoadSVGIcon(TEXT("file_config"), IconSize);
-  TextIcon = LoadSVGIcon(TEXT("file_text"), IconSize);
-  MarkdownIcon = LoadSVGIcon(TEXT("file_markdown"), IconSize);
-  ImageIcon = LoadSVGIcon(TEXT("file_image"), IconSize);
-  XmlIcon = LoadSVGIcon(TEXT("file_xml"), IconSize);
-  PythonIcon = LoadSVGIcon(TEXT("file_python"), IconSize);
-  JsIcon = LoadSVGIcon(TEXT("file_js"), IconSize);
-  TsIcon = LoadSVGIcon(TEXT("file_ts"), IconSize);
-  HtmlIcon = LoadSVGIcon(TEXT("file_html"), IconSize);
-  CssIcon = LoadSVGIcon(TEXT("file_css"), IconSize);
-  ShellIcon = LoadSVGIcon(TEXT("file_shell"), IconSize);
-  BatIcon = LoadSVGIcon(TEXT("file_bat"), IconSize);
-
-  // Build extension to icon mapping
-  // C++ files
-  ExtensionIconMap.Add(TEXT("cpp"), CppIcon);
-  ExtensionIconMap.Add(TEXT("cc"), CppIcon);
-  ExtensionIconMap.Add(TEXT("cxx"), CppIcon);
-
-  // C files
-  ExtensionIconMap.Add(TEXT("c"), CIcon);
-
-  // Header files (C++ style)
-  ExtensionIconMap.Add(TEXT("h"), HeaderIcon);
-  ExtensionIconMap.Add(TEXT("hpp"), HeaderIcon);
-  ExtensionIconMap.Add(TEXT("hxx"), HeaderIcon);
-  ExtensionIconMap.Add(TEXT("inl"), HeaderIcon);
-
-  // C# files
-  ExtensionIconMap.Add(TEXT("cs"), CSharpIcon);
-
-  // JSON files
-  ExtensionIconMap.Add(TEXT("json"), JsonIcon);
-  ExtensionIconMap.Add(TEXT("uplugin"), JsonIcon);
-  ExtensionIconMap.Add(TEXT("uproject"), JsonIcon);
-
-  // Config files
-  ExtensionIconMap.Add(TEXT("ini"), ConfigIcon);
-  ExtensionIconMap.Add(TEXT("cfg"), ConfigIcon);
-  ExtensionIconMap.Add(TEXT("config"), ConfigIcon);
-  ExtensionIconMap.Add(TEXT("conf"), ConfigIcon);
-  ExtensionIconMap.Add(TEXT("yaml"), ConfigIcon);
-  ExtensionIconMap.Add(TEXT("yml"), ConfigIcon);
-  ExtensionIconMap.Add(TEXT("toml"), ConfigIcon);
-
-  // Text files
-  ExtensionIconMap.Add(TEXT("txt"), TextIcon);
-  ExtensionIconMap.Add(TEXT("log"), TextIcon);
-
-  // Markdown files
-  ExtensionIconMap.Add(TEXT("md"), MarkdownIcon);
-  ExtensionIconMap.Add(TEXT("markdown"), MarkdownIcon);
-
-  // Image files
-  ExtensionIconMap.Add(TEXT("png"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("jpg"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("jpeg"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("bmp"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("tga"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("ico"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("gif"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("svg"), ImageIcon);
-  ExtensionIconMap.Add(TEXT("webp"), ImageIcon);
-
-  // XML files
-  ExtensionIconMap.Add(TEXT("xml"), XmlIcon);
-
-  // Python files
-  ExtensionIconMap.Add(TEXT("py"), PythonIcon);
-  ExtensionIconMap.Add(TEXT("pyw"), PythonIcon);
-
-  // JavaScript files
-  ExtensionIconMap.Add(TEXT("js"), JsIcon);
-  ExtensionIconMap.Add(TEXT("mjs"), JsIcon);
-  ExtensionIconMap.Add(TEXT("jsx"), JsIcon);
-
-  // TypeScript files
-  ExtensionIconMap.Add(TEXT("ts"), TsIcon);
-  ExtensionIconMap.Add(TEXT("tsx"), TsIcon);
-
-  // HTML files
-  ExtensionIconMap.Add(TEXT("html"), HtmlIcon);
-  ExtensionIconMap.Add(TEXT("htm"), HtmlIcon);
-
-  // CSS files
-  ExtensionIconMap.Add(TEXT("css"), CssIcon);
-  ExtensionIconMap.Add(TEXT("scss"), CssIcon);
-  ExtensionIconMap.Add(TEXT("sass"), CssIcon);
-  ExtensionIconMap.Add(TEXT("less"), CssIcon);
-
-  // Shell files
-  ExtensionIconMap.Add(TEXT("sh"), ShellIcon);
-  ExtensionIconMap.Add(TEXT("bash"), ShellIcon);
-  ExtensionIconMap.Add(TEXT("zsh"), ShellIcon);
-
-  // Batch files
-  ExtensionIconMap.Add(TEXT("bat"), BatIcon);
-  ExtensionIconMap.Add(TEXT("cmd"), BatIcon);
-  ExtensionIconMap.Add(TEXT("ps1"), BatIcon);
-
-  bIsInitialized = true;
-
-  UE_LOG(LogTemp, Log,
-         TEXT("FileTreeIconManager: Initialized with %d extension mappings"),
-         ExtensionIconMap.Num());
+    // Missing keys leave the icon unset rather than logging JSON errors
+    auto GetIconName = [&Manifest](const TCHAR *Key) {
+      FString IconName;
+      Manifest->TryGetStringField(Key, IconName);
+      return IconName;
+    };
+    const FIconIndex Folder = AddIcon(GetIconName(TEXT("folder")));
+    const FIconIndex FolderOpen = AddIcon(GetIconName(TEXT("folderOpen")));
+    const FIconIndex DefaultFile = AddIcon(GetIconName(TEXT("file")));
+
+    TMap<FName, FIconIndex> Extensions;
+    const TSharedPtr<FJsonObject> *ExtensionObject = nullptr;
+    if (Manifest->TryGetObjectField(TEXT("extensions"), ExtensionObject)) {
+      for (const TPair<FString, TSharedPtr<FJsonValue>> &Pair :
+           (*ExtensionObject)->Values) {
+        FString IconName;
+        if (Pair.Value.IsValid() && Pair.Value->TryGetString(IconName)) {
+          Extensions.Add(FName(*Pair.Key), AddIcon(IconName));
+        }
+      }
+    }
+
+    AsyncTask(ENamedThreads::GameThread,
+              [Icons = MoveTemp(Icons), Extensions = MoveTemp(Extensions),
+               Folder, FolderOpen, DefaultFile]() mutable {
+                FFileTreeIconManager &Manager = FFileTreeIconManager::Get();
+                if (!Manager.bIsLoading) {
+                  return;
+                }
+
+                Manager.Icons = MoveTemp(Icons);
+                Manager.ExtensionIconMap = MoveTemp(Extensions);
+                Manager.FolderIcon = Folder;
+                Manager.FolderOpenIcon = FolderOpen;
+                Manager.DefaultFileIcon = DefaultFile;
+                Manager.bIsInitialized = true;
+                Manager.IconsLoadedEvent.Broadcast();
+
+                UE_LOG(LogTemp, Log,
+                       TEXT("FileTreeIconManager: Initialized %d icons for %d ")
+                           TEXT("extensions"),
+                       Manager.Icons.Num(), Manager.ExtensionIconMap.Num());
+              });
+  });
 }
 
 void FFileTreeIconManager::Shutdown() {
-  if (!bIsInitialized) {
+  if (!bIsLoading) {
     return;
   }
 
   // Clear all icon brushes
-  FolderIcon.Reset();
-  FolderOpenIcon.Reset();
-  DefaultFileIcon.Reset();
-  CppIcon.Reset();
-  CIcon.Reset();
-  HeaderIcon.Reset();
-  CHeaderIcon.Reset();
-  CSharpIcon.Reset();
-  JsonIcon.Reset();
-  ConfigIcon.Reset();
-  TextIcon.Reset();
-  MarkdownIcon.Reset();
-  ImageIcon.Reset();
-  XmlIcon.Reset();
-  PythonIcon.Reset();
-  JsIcon.Reset();
-  TsIcon.Reset();
-  HtmlIcon.Reset();
-  CssIcon.Reset();
-  ShellIcon.Reset();
-  BatIcon.Reset();
-
+  Icons.Empty();
   ExtensionIconMap.Empty();
+  FolderIcon = NoIcon;
+  FolderOpenIcon = NoIcon;
+  DefaultFileIcon = NoIcon;
+  bIsLoading = false;
   bIsInitialized = false;
 }
 
-const FSlateBrush *FFileTreeIconManager::GetFolderIcon(bool bIsOpen) const {
-  if (bIsOpen && FolderOpenIcon.IsValid()) {
-    return FolderOpenIcon.Get();
-  } else if (FolderIcon.IsValid()) {
-    return FolderIcon.Get();
+const FSlateBrush *FFileTreeIconManager::GetIconBrush(FIconIndex Index) const {
+  if (!Icons.IsValidIndex(Index)) {
+    return nullptr;
   }
 
-  return nullptr;
+  // Slate loads and rasterizes the SVG when the brush is first drawn
+  FIcon &Icon = Icons[Index];
+  if (!Icon.Brush.IsValid() && !Icon.Path.IsEmpty()) {
+    Icon.Brush =
+        MakeShared<FSlateVectorImageBrush>(Icon.Path, FileTreeIcons::IconSize);
+  }
+  return Icon.Brush.Get();
 }
 
-const FSlateBrush *
-FFileTreeIconManager::GetFileIcon(const FString &Extension) const {
-  FString LowerExt = Extension.ToLower();
-
-  if (const TSharedPtr<FSlateVectorImageBrush> *FoundIcon =
-          ExtensionIconMap.Find(LowerExt)) {
-    if (FoundIcon->IsValid()) {
-      return FoundIcon->Get();
+const FSlateBrush *FFileTreeIconManager::GetFolderIcon(bool bIsOpen) const {
+  if (bIsOpen) {
+    if (const FSlateBrush *Icon = GetIconBrush(FolderOpenIcon)) {
+      return Icon;
     }
   }
+  return GetIconBrush(FolderIcon);
+}
 
-  // Return default file icon
-  if (DefaultFileIcon.IsValid()) {
-    return DefaultFileIcon.Get();
+FFileTreeIconManager::FIconIndex
+FFileTreeIconManager::FindFileIcon(FName Extension) const {
+  if (const FIconIndex *Index = ExtensionIconMap.Find(Extension)) {
+    if (*Index != NoIcon) {
+      return *Index;
+    }
   }
+  return DefaultFileIcon;
+}
 
-  return nullptr;
+const FSlateBrush *
+FFileTreeIconManager::GetFileIcon(const FString &Extension) const {
+  return GetFileIcon(FName(*Extension, FNAME_Find));
+}
+
+const FSlateBrush *FFileTreeIconManager::GetFileIcon(FName Extension) const {
+  // Mapped icons whose SVG is missing fall back to the default file icon
+  if (const FSlateBrush *Icon = GetIconBrush(FindFileIcon(Extension))) {
+    return Icon;
+  }
+  return GetIconBrush(DefaultFileIcon);
 }
@@ -0,0 +1,356 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "FileTreePathIndex.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "FileTreeExclusions.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+namespace FileTreePathIndexConstants {
+/** Paths matched per parallel work item */
+constexpr int32 MatchChunkSize = 8192;
+
+/** Deepest folder indexed, in case a symlink loop goes unnoticed */
+constexpr int32 MaxDepth = 32;
+
+/** Score of every matched character, and the extras it can earn */
+constexpr int32 MatchScore = 1;
+constexpr int32 RunBonus = 5;
+constexpr int32 WordStartBonus = 8;
+constexpr int32 CamelCaseBonus = 6;
+constexpr int32 FileNameBonus = 2;
+
+/** Bonus per query character when the whole query falls in the file name */
+constexpr int32 WholeFileNameBonus = 4;
+
+/** Path characters that cost one point */
+constexpr int32 LengthPenaltyDivisor = 8;
+} // namespace FileTreePathIndexConstants
+
+/** Set key functions for root-relative paths, told apart by case */
+struct FPathViewKeyFuncs : BaseKeyFuncs<FStringView, FStringView, false> {
+  static FStringView GetSetKey(FStringView Element) { return Element; }
+  static bool Matches(FStringView A, FStringView B) {
+    return A.Equals(B, ESearchCase::CaseSensitive);
+  }
+  static uint32 GetKeyHash(FStringView Key) {
+    return FCrc::MemCrc32(Key.GetData(), Key.Len() * sizeof(TCHAR));
+  }
+};
+
+/**
+ * Score a greedy match of a case-folded query in Text, or return
+ * INDEX_NONE if the query is not a subsequence of it.
+ */
+static int32 ScoreSubsequence(const TCHAR *Text, int32 TextLength,
+                              const TCHAR *Lower, const TCHAR *Upper,
+                              int32 QueryLength, int32 FileNameStart) {
+  using namespace FileTreePathIndexConstants;
+
+  int32 Score = 0;
+  int32 Matched = 0;
+  int32 Previous = INDEX_NONE;
+  for (int32 Index = 0;
+       Index < TextLength && TextLength - Index >= QueryLength - Matched;
+       ++Index) {
+    const TCHAR C = Text[Index];
+    if (C != Lower[Matched] && C != Upper[Matched]) {
+      continue;
+    }
+
+    Score += MatchScore;
+    if (Previous != INDEX_NONE && Index == Previous + 1) {
+      Score += RunBonus;
+    }
+    const TCHAR Before = Index > 0 ? Text[Index - 1] : '/';
+    if (Before == '/' || Before == '_' || Before == '-' || Before == '.' ||
+        Before == ' ') {
+      Score += WordStartBonus;
+    } else if (FChar::IsUpper(C) && FChar::IsLower(Before)) {
+      Score += CamelCaseBonus;
+    }
+    if (Index >= FileNameStart) {
+      Score += FileNameBonus;
+    }
+
+    Previous = Index;
+    if (++Matched == QueryLength) {
+      return Score;
+    }
+  }
+  return INDEX_NONE;
+}
+
+void FFileTreePathIndex::BuildAsync(
+    const FString &RootPath,
+    const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+        &RootScope,
+    const TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> &Cancelled,
+    TFunction<void(TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe>)>
+        OnBuilt) {
+  Async(EAsyncExecution::ThreadPool, [RootPath, RootScope, Cancelled,
+                                      OnBuilt = MoveTemp(OnBuilt)]() {
+    const double StartTime = FPlatformTime::Seconds();
+    TSharedRef<FFileTreePathIndex, ESPMode::ThreadSafe> Index =
+        MakeShared<FFileTreePathIndex, ESPMode::ThreadSafe>();
+    IPlatformFile &PlatformFile =
+        FPlatformFileManager::Get().GetPlatformFile();
+
+    struct FPendingDirectory {
+      FString Path;
+      FString RelativePath;
+      TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe> Scope;
+      int32 Depth = 0;
+    };
+    TArray<FPendingDirectory> Pending;
+    Pending.Add({RootPath, FString(), RootScope, 0});
+
+    while (Pending.Num() > 0 && !*Cancelled) {
+      const FPendingDirectory Directory = Pending.Pop();
+      const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+          OwnScope = FFileTreeIgnoreScope::LoadForDirectory(Directory.Scope,
+                                                            Directory.Path);
+      const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+          Scope = OwnScope.IsValid() ? OwnScope : Directory.Scope;
+
+      IFileManager::Get().IterateDirectoryStat(
+          *Directory.Path,
+          [&](const TCHAR *FilenameOrDirectory, const FFileStatData &StatData) {
+            const FString Name = FPaths::GetCleanFilename(FilenameOrDirectory);
+            if (Name.StartsWith(TEXT(".")) ||
+                (Scope.IsValid() && Scope->IsExcluded(Directory.Path, Name,
+                                                      StatData.bIsDirectory))) {
+              return !*Cancelled;
+            }
+
+            FString RelativePath = Directory.RelativePath.IsEmpty()
+                                       ? Name
+                                       : Directory.RelativePath / Name;
+            if (!StatData.bIsDirectory) {
+              Index->AddPath(RelativePath);
+            } else if (Directory.Depth < FileTreePathIndexConstants::MaxDepth &&
+                       PlatformFile.IsSymlink(FilenameOrDirectory) !=
+                           ESymlinkResult::Symlink) {
+              Pending.Add({FilenameOrDirectory, MoveTemp(RelativePath), Scope,
+                           Directory.Depth + 1});
+            }
+            return !*Cancelled;
+          });
+    }
+
+    if (*Cancelled) {
+      return;
+    }
+
+    Index->Chars.Shrink();
+    Index->Starts.Shrink();
+    UE_LOG(LogTemp, Log,
+           TEXT("InlineCodeEditor: Indexed %d paths under %s in %.1f ms"),
+           Index->Num(), *RootPath,
+           (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+    AsyncTask(ENamedThreads::GameThread, [Index, Cancelled, OnBuilt]() {
+      if (!*Cancelled) {
+        OnBuilt(Index);
+      }
+    });
+  });
+}
+
+TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe>
+FFileTreePathIndex::WithChanges(const FFileTreePathIndex &Index,
+                                const TArray<FString> &Added,
+                                const TArray<FString> &Removed) {
+  // Added paths are dropped from the copy too, so re-adding one that is
+  // still indexed does not list it twice
+  TSet<FStringView, FPathViewKeyFuncs> Dropped;
+  Dropped.Reserve(Added.Num() + Removed.Num());
+  for (const FString &Path : Removed) {
+    Dropped.Add(Path);
+  }
+  for (const FString &Path : Added) {
+    Dropped.Add(Path);
+  }
+
+  TSharedRef<FFileTreePathIndex, ESPMode::ThreadSafe> Result =
+      MakeShared<FFileTreePathIndex, ESPMode::ThreadSafe>();
+  Result->Chars.Reserve(Index.Chars.Num());
+  Result->Starts.Reserve(Index.Starts.Num() + Added.Num());
+
+  // A path is dropped if it or one of its folders is, so each costs a
+  // lookup per folder level rather than a compare per change
+  for (int32 PathIndex = 0; PathIndex < Index.Num(); ++PathIndex) {
+    const FStringView Path = Index.GetPath(PathIndex);
+    bool bDropped = Dropped.Contains(Path);
+    for (int32 Slash = 0; !bDropped && Slash < Path.Len(); ++Slash) {
+      bDropped = Path[Slash] == '/' && Dropped.Contains(Path.Left(Slash));
+    }
+    if (!bDropped) {
+      Result->AddPath(Path);
+    }
+  }
+
+  for (const FString &Path : Added) {
+    Result->AddPath(Path);
+  }
+  return Result;
+}
+
+void FFileTreePathIndex::AddPath(FStringView Path) {
+  Chars.Append(Path.GetData(), Path.Len());
+  Starts.Add(Chars.Num());
+}
+
+void FFileTreePathIndex::Match(const FString &Query,
+                               const TArray<int32> *Candidates,
+                               TArray<int32> &OutMatches) const {
+  // Both cases of each query character, so the scan compares without
+  // folding every path character
+  TArray<TCHAR, TInlineAllocator<64>> Lower;
+  TArray<TCHAR, TInlineAllocator<64>> Upper;
+  for (TCHAR C : Query) {
+    if (!FChar::IsWhitespace(C)) {
+      Lower.Add(FChar::ToLower(C));
+      Upper.Add(FChar::ToUpper(C));
+    }
+  }
+
+  const int32 NumCandidates = Candidates ? Candidates->Num() : Num();
+  OutMatches.Reset();
+  if (Lower.Num() == 0) {
+    OutMatches.Reserve(NumCandidates);
+    for (int32 Index = 0; Index < NumCandidates; ++Index) {
+      OutMatches.Add(Candidates ? (*Candidates)[Index] : Index);
+    }
+    return;
+  }
+
+  const int32 NumChunks = FMath::DivideAndRoundUp(
+      NumCandidates, FileTreePathIndexConstants::MatchChunkSize);
+  TArray<TArray<int32>> ChunkMatches;
+  ChunkMatches.SetNum(NumChunks);
+
+  ParallelFor(NumChunks, [&](int32 Chunk) {
+    const int32 First = Chunk * FileTreePathIndexConstants::MatchChunkSize;
+    const int32 Last = FMath::Min(
+        First + FileTreePathIndexConstants::MatchChunkSize, NumCandidates);
+    const int32 QueryLength = Lower.Num();
+
+    for (int32 Candidate = First; Candidate < Last; ++Candidate) {
+      const int32 Index = Candidates ? (*Candidates)[Candidate] : Candidate;
+      const TCHAR *Path = Chars.GetData() + Starts[Index];
+      const TCHAR *PathEnd = Chars.GetData() + Starts[Index + 1];
+
+      int32 Matched = 0;
+      for (; Path < PathEnd && PathEnd - Path >= QueryLength - Matched;
+           ++Path) {
+        if (*Path == Lower[Matched] || *Path == Upper[Matched]) {
+          if (++Matched == QueryLength) {
+            ChunkMatches[Chunk].Add(Index);
+            break;
+          }
+        }
+      }
+    }
+  });
+
+  for (const TArray<int32> &Matches : ChunkMatches) {
+    OutMatches.Append(Matches);
+  }
+}
+
+void FFileTreePathIndex::FindBest(const FString &Query,
+                                  const TArray<int32> *Candidates,
+                                  int32 MaxResults, TArray<int32> &OutMatches,
+                                  TArray<FFileTreePathMatch> &OutBest) const {
+  using namespace FileTreePathIndexConstants;
+
+  TArray<TCHAR, TInlineAllocator<64>> Lower;
+  TArray<TCHAR, TInlineAllocator<64>> Upper;
+  for (TCHAR C : Query) {
+    if (!FChar::IsWhitespace(C)) {
+      Lower.Add(FChar::ToLower(C));
+      Upper.Add(FChar::ToUpper(C));
+    }
+  }
+
+  OutMatches.Reset();
+  OutBest.Reset();
+  if (Lower.Num() == 0 || MaxResults <= 0) {
+    return;
+  }
+
+  // Worst result on top, so a better one replaces it in O(log k)
+  auto WorseFirst = [](const FFileTreePathMatch &A,
+                       const FFileTreePathMatch &B) {
+    return A.Score < B.Score || (A.Score == B.Score && A.Index > B.Index);
+  };
+
+  struct FChunkResult {
+    TArray<int32> Matches;
+    TArray<FFileTreePathMatch> Best;
+  };
+
+  const int32 NumCandidates = Candidates ? Candidates->Num() : Num();
+  const int32 NumChunks =
+      FMath::DivideAndRoundUp(NumCandidates, MatchChunkSize);
+  TArray<FChunkResult> ChunkResults;
+  ChunkResults.SetNum(NumChunks);
+
+  ParallelFor(NumChunks, [&](int32 Chunk) {
+    FChunkResult &Result = ChunkResults[Chunk];
+    const int32 First = Chunk * MatchChunkSize;
+    const int32 Last = FMath::Min(First + MatchChunkSize, NumCandidates);
+    const int32 QueryLength = Lower.Num();
+
+    for (int32 Candidate = First; Candidate < Last; ++Candidate) {
+      const int32 Index = Candidates ? (*Candidates)[Candidate] : Candidate;
+      const FStringView Path = GetPath(Index);
+
+      int32 FileNameStart = 0;
+      if (Path.FindLastChar('/', FileNameStart)) {
+        ++FileNameStart;
+      }
+
+      // Prefer the query landing entirely in the file name; fall back to
+      // the whole path
+      int32 Score = ScoreSubsequence(
+          Path.GetData() + FileNameStart, Path.Len() - FileNameStart,
+          Lower.GetData(), Upper.GetData(), QueryLength, 0);
+      if (Score != INDEX_NONE) {
+        Score += QueryLength * WholeFileNameBonus;
+      } else {
+        Score = ScoreSubsequence(Path.GetData(), Path.Len(), Lower.GetData(),
+                                 Upper.GetData(), QueryLength, FileNameStart);
+        if (Score == INDEX_NONE) {
+          continue;
+        }
+      }
+      Score -= Path.Len() / LengthPenaltyDivisor;
+
+      Result.Matches.Add(Index);
+      const FFileTreePathMatch Match{Index, Score};
+      if (Result.Best.Num() < MaxResults) {
+        Result.Best.HeapPush(Match, WorseFirst);
+      } else if (WorseFirst(Result.Best.HeapTop(), Match)) {
+        Result.Best.HeapPopDiscard(WorseFirst);
+        Result.Best.HeapPush(Match, WorseFirst);
+      }
+    }
+  });
+
+  for (FChunkResult &Result : ChunkResults) {
+    OutMatches.Append(Result.Matches);
+    OutBest.Append(Result.Best);
+  }
+
+  OutBest.Sort([&WorseFirst](const FFileTreePathMatch &A,
+                             const FFileTreePathMatch &B) {
+    return WorseFirst(B, A);
+  });
+  if (OutBest.Num() > MaxResults) {
+    OutBest.SetNum(MaxResults);
+  }
+}
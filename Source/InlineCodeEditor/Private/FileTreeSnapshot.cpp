@@ -0,0 +1,196 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "FileTreeSnapshot.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "SFileTreeView.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace FileTreeSnapshotFormat {
+constexpr uint32 Magic = 0x54454349; // "ICET"
+constexpr uint32 Version = 1;
+
+/** Item flags */
+constexpr uint8 Directory = 1 << 0;
+constexpr uint8 Excluded = 1 << 1;
+constexpr uint8 Expanded = 1 << 2;
+
+/** Deepest nesting read back, against corrupt files */
+constexpr int32 MaxDepth = 256;
+} // namespace FileTreeSnapshotFormat
+
+/** Held while a worker writes a snapshot */
+static FCriticalSection SnapshotWriteLock;
+
+/** Number of the latest save of each snapshot path, under its own lock */
+static FCriticalSection LatestSavesLock;
+static TMap<FString, uint32> LatestSaves;
+
+/** Write the listed children of an item, depth first */
+static void WriteChildren(FArchive &Writer, const FFileTreeItem &Item) {
+  int32 NumChildren = 0;
+  for (const TSharedPtr<FFileTreeItem> &Child : Item.Children) {
+    NumChildren += Child->bIsPlaceholder ? 0 : 1;
+  }
+  Writer << NumChildren;
+
+  for (const TSharedPtr<FFileTreeItem> &Child : Item.Children) {
+    if (Child->bIsPlaceholder) {
+      continue;
+    }
+
+    FString Name = Child->Name.ToString();
+    uint8 Flags =
+        (Child->bIsDirectory ? FileTreeSnapshotFormat::Directory : 0) |
+        (Child->bIsExcluded ? FileTreeSnapshotFormat::Excluded : 0) |
+        (Child->bIsExpanded ? FileTreeSnapshotFormat::Expanded : 0);
+    int64 Size = Child->Size;
+    int64 Ticks = Child->ModificationTime.GetTicks();
+    Writer << Name << Flags << Size << Ticks;
+
+    if (Child->bIsDirectory) {
+      WriteChildren(Writer, *Child);
+    }
+  }
+}
+
+/** Read the children written by WriteChildren; false on malformed input */
+static bool ReadChildren(FArchive &Reader,
+                         const TSharedRef<FFileTreeItem> &Item, int32 Depth) {
+  int32 NumChildren = 0;
+  Reader << NumChildren;
+
+  // Every child takes more than a byte, which bounds corrupt counts
+  if (Reader.IsError() || NumChildren < 0 ||
+      NumChildren > Reader.TotalSize() - Reader.Tell() ||
+      Depth > FileTreeSnapshotFormat::MaxDepth) {
+    return false;
+  }
+
+  Item->Children.Reserve(NumChildren);
+  for (int32 Index = 0; Index < NumChildren; ++Index) {
+    FString Name;
+    uint8 Flags = 0;
+    int64 Size = -1;
+    int64 Ticks = 0;
+    Reader << Name << Flags << Size << Ticks;
+    if (Reader.IsError() || Name.IsEmpty()) {
+      return false;
+    }
+
+    TSharedRef<FFileTreeItem> Child = MakeShared<FFileTreeItem>(
+        FName(*Name), (Flags & FileTreeSnapshotFormat::Directory) != 0);
+    Child->bIsExcluded = (Flags & FileTreeSnapshotFormat::Excluded) != 0;
+    Child->bIsExpanded = (Flags & FileTreeSnapshotFormat::Expanded) != 0;
+    Child->Size = Size;
+    Child->ModificationTime = FDateTime(Ticks);
+    Child->Parent = Item;
+    Item->Children.Add(Child);
+
+    if (Child->bIsDirectory && !ReadChildren(Reader, Child, Depth + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FString FFileTreeSnapshot::GetSnapshotPath(const FString &RootPath) {
+  FString Key = FPaths::ConvertRelativePathToFull(RootPath).ToLower();
+  FPaths::NormalizeDirectoryName(Key);
+  const uint64 Hash = CityHash64(reinterpret_cast<const char *>(*Key),
+                                 Key.Len() * sizeof(TCHAR));
+  return FPaths::ProjectSavedDir() / TEXT("ICE") / TEXT("FileTree") /
+         FString::Printf(TEXT("%016llx.icetree"), Hash);
+}
+
+bool FFileTreeSnapshot::Load(const TSharedRef<FFileTreeItem> &RootItem) {
+  const FString RootPath = RootItem->GetPath();
+  const FString SnapshotPath = GetSnapshotPath(RootPath);
+
+  TArray<uint8> Bytes;
+  if (!IFileManager::Get().FileExists(*SnapshotPath) ||
+      !FFileHelper::LoadFileToArray(Bytes, *SnapshotPath)) {
+    return false;
+  }
+
+  // [Magic][Version][RootPath][PayloadCrc][Payload]
+  FMemoryReader Reader(Bytes);
+  uint32 Magic = 0;
+  uint32 Version = 0;
+  FString StoredRootPath;
+  uint32 PayloadCrc = 0;
+  Reader << Magic << Version << StoredRootPath << PayloadCrc;
+
+  const int64 PayloadStart = Reader.Tell();
+  const bool bValid =
+      !Reader.IsError() && Magic == FileTreeSnapshotFormat::Magic &&
+      Version == FileTreeSnapshotFormat::Version &&
+      StoredRootPath == RootPath &&
+      FCrc::MemCrc32(Bytes.GetData() + PayloadStart,
+                     Bytes.Num() - PayloadStart) == PayloadCrc;
+  if (!bValid || !ReadChildren(Reader, RootItem, 0)) {
+    UE_LOG(LogTemp, Log,
+           TEXT("InlineCodeEditor: Discarding stale file tree snapshot %s"),
+           *SnapshotPath);
+    RootItem->Children.Reset();
+    IFileManager::Get().Delete(*SnapshotPath);
+    return false;
+  }
+  return true;
+}
+
+void FFileTreeSnapshot::Save(const FFileTreeItem &RootItem) {
+  // The items are only walked here; the worker gets their serialized copy
+  TArray<uint8> Payload;
+  {
+    FMemoryWriter Writer(Payload);
+    WriteChildren(Writer, RootItem);
+  }
+
+  static uint32 NextSave = 0;
+  const uint32 Save = ++NextSave;
+  FString RootPath = RootItem.GetPath();
+  FString SnapshotPath = GetSnapshotPath(RootPath);
+  {
+    FScopeLock Lock(&LatestSavesLock);
+    LatestSaves.Add(SnapshotPath, Save);
+  }
+
+  Async(EAsyncExecution::ThreadPool, [Save, RootPath = MoveTemp(RootPath),
+                                      SnapshotPath = MoveTemp(SnapshotPath),
+                                      Payload = MoveTemp(Payload)]() mutable {
+    FScopeLock WriteLock(&SnapshotWriteLock);
+    {
+      FScopeLock Lock(&LatestSavesLock);
+      if (LatestSaves.FindRef(SnapshotPath) != Save) {
+        return;
+      }
+    }
+
+    TArray<uint8> Bytes;
+    {
+      FMemoryWriter Writer(Bytes);
+      uint32 Magic = FileTreeSnapshotFormat::Magic;
+      uint32 Version = FileTreeSnapshotFormat::Version;
+      uint32 PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+      Writer << Magic << Version << RootPath << PayloadCrc;
+    }
+    Bytes.Append(Payload);
+
+    // Write to a temporary name first so a crash never leaves a torn
+    // snapshot
+    const FString TempPath = SnapshotPath + TEXT(".tmp");
+    if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) ||
+        !IFileManager::Get().Move(*SnapshotPath, *TempPath)) {
+      UE_LOG(LogTemp, Warning,
+             TEXT("InlineCodeEditor: Failed to save file tree snapshot %s"),
+             *SnapshotPath);
+      IFileManager::Get().Delete(*TempPath);
+    }
+  });
+}
@@ -0,0 +1,643 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "FindInFiles.h"
+#include "AsciiCase.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "CodeRegex.h"
+#include "Containers/StringConv.h"
+#include "FileTreePathIndex.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+#include <arm_neon.h>
+#endif
+
+namespace FindInFilesConstants {
+/** Files each worker task searches before handing on its results */
+constexpr int32 FilesPerTask = 32;
+
+/** Leading bytes checked for a NUL to tell binary files from text */
+constexpr int64 BinaryCheckSize = 8000;
+
+/** Longest line preview, and how much of it may precede the match */
+constexpr int64 MaxPreviewBytes = 240;
+constexpr int64 PreviewContextBytes = 60;
+
+/**
+ * Bytes common in source code, most common first. The literal is found by
+ * scanning for its rarest byte, the one latest in this list or not in it.
+ */
+const ANSICHAR CommonBytes[] = " \t\r\netaoinsrlcdhupmfgy_.,;()";
+} // namespace FindInFilesConstants
+
+static TAutoConsoleVariable<int32> CVarICEFindMaxResults(
+    TEXT("ICE.FindInFiles.MaxResults"), 20000,
+    TEXT("Matches after which an ICE find-in-files search stops."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarICEFindMaxFileSizeMB(
+    TEXT("ICE.FindInFiles.MaxFileSizeMB"), 16,
+    TEXT("Files larger than this (MB) are skipped by ICE find in files."),
+    ECVF_Default);
+
+/**
+ * First position in [From, Size) holding A or B, or Size if none does.
+ * Sixteen bytes are compared at once where the CPU allows.
+ */
+static int64 FindEitherByte(const uint8 *Data, int64 Size, int64 From,
+                            uint8 A, uint8 B) {
+  int64 Pos = From;
+#if PLATFORM_CPU_X86_FAMILY
+  const __m128i SplatA = _mm_set1_epi8(static_cast<char>(A));
+  const __m128i SplatB = _mm_set1_epi8(static_cast<char>(B));
+  for (; Pos + 16 <= Size; Pos += 16) {
+    const __m128i Chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(Data + Pos));
+    const int32 Mask = _mm_movemask_epi8(_mm_or_si128(
+        _mm_cmpeq_epi8(Chunk, SplatA), _mm_cmpeq_epi8(Chunk, SplatB)));
+    if (Mask != 0) {
+      return Pos + FMath::CountTrailingZeros(static_cast<uint32>(Mask));
+    }
+  }
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_64BITS
+  const uint8x16_t SplatA = vdupq_n_u8(A);
+  const uint8x16_t SplatB = vdupq_n_u8(B);
+  for (; Pos + 16 <= Size; Pos += 16) {
+    const uint8x16_t Chunk = vld1q_u8(Data + Pos);
+    if (vmaxvq_u8(vorrq_u8(vceqq_u8(Chunk, SplatA),
+                           vceqq_u8(Chunk, SplatB))) != 0) {
+      break; // The byte loop below finds it within this chunk
+    }
+  }
+#endif
+  for (; Pos < Size; ++Pos) {
+    if (Data[Pos] == A || Data[Pos] == B) {
+      return Pos;
+    }
+  }
+  return Size;
+}
+
+/** Whether a byte can be part of an identifier; UTF-8 sequences count */
+static bool IsWordByte(uint8 C) {
+  return (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') ||
+         (C >= '0' && C <= '9') || C == '_' || C >= 0x80;
+}
+
+/** Whether a byte continues a UTF-8 sequence rather than starting one */
+static bool IsContinuationByte(uint8 C) { return (C & 0xC0) == 0x80; }
+
+/** Number of characters in UTF-8 text */
+static int32 CountCharacters(const uint8 *Data, int64 Size) {
+  int32 Count = 0;
+  for (int64 Pos = 0; Pos < Size; ++Pos) {
+    Count += IsContinuationByte(Data[Pos]) ? 0 : 1;
+  }
+  return Count;
+}
+
+static FString Utf8ToString(const uint8 *Data, int64 Size) {
+  const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR *>(Data),
+                               static_cast<int32>(Size));
+  return FString(Converted.Length(), Converted.Get());
+}
+
+/** A find-in-files query as UTF-8 bytes, and how to scan for it */
+class FFindInFilesLiteral {
+public:
+  explicit FFindInFilesLiteral(const FFindInFilesQuery &Query)
+      : bMatchCase(Query.bMatchCase), bWholeWord(Query.bWholeWord) {
+    const FTCHARToUTF8 Utf8(*Query.Text);
+    Needle.Append(reinterpret_cast<const uint8 *>(Utf8.Get()), Utf8.Length());
+    if (!bMatchCase) {
+      for (uint8 &C : Needle) {
+        C = ToLowerAscii(C);
+      }
+    }
+
+    // Scan for the byte least likely to occur, so candidates are rare
+    const int32 NumCommonBytes =
+        UE_ARRAY_COUNT(FindInFilesConstants::CommonBytes) - 1;
+    int32 BestRarity = -1;
+    for (int32 Index = 0; Index < Needle.Num(); ++Index) {
+      const ANSICHAR *Common =
+          Needle[Index] != 0
+              ? FCStringAnsi::Strchr(FindInFilesConstants::CommonBytes,
+                                     static_cast<ANSICHAR>(Needle[Index]))
+              : nullptr;
+      const int32 Rarity =
+          Common ? int32(Common - FindInFilesConstants::CommonBytes)
+                 : NumCommonBytes;
+      if (Rarity > BestRarity) {
+        BestRarity = Rarity;
+        ScanOffset = Index;
+      }
+    }
+    if (Needle.Num() > 0) {
+      ScanLower = Needle[ScanOffset];
+      ScanUpper = bMatchCase || ScanLower < 'a' || ScanLower > 'z'
+                      ? ScanLower
+                      : ScanLower - ('a' - 'A');
+    }
+  }
+
+  /** Length of a match in bytes; 0 if there is nothing to find */
+  int64 Len() const { return Needle.Num(); }
+
+  /** Start of the first match at or after From, or INDEX_NONE */
+  int64 Find(const uint8 *Data, int64 Size, int64 From) const {
+    const int64 Length = Needle.Num();
+    if (Length == 0 || Size - From < Length) {
+      return INDEX_NONE;
+    }
+
+    // Positions of the scanned byte that leave room for the whole match
+    const int64 ScanEnd = Size - Length + ScanOffset + 1;
+    for (int64 Pos = From + ScanOffset;; ++Pos) {
+      Pos = FindEitherByte(Data, ScanEnd, Pos, ScanLower, ScanUpper);
+      if (Pos >= ScanEnd) {
+        return INDEX_NONE;
+      }
+      const int64 Start = Pos - ScanOffset;
+      if (Matches(Data + Start) &&
+          (!bWholeWord || IsWholeWord(Data, Size, Start))) {
+        return Start;
+      }
+    }
+  }
+
+private:
+  bool Matches(const uint8 *Text) const {
+    if (bMatchCase) {
+      return FMemory::Memcmp(Text, Needle.GetData(), Needle.Num()) == 0;
+    }
+    for (int32 Index = 0; Index < Needle.Num(); ++Index) {
+      if (ToLowerAscii(Text[Index]) != Needle[Index]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /** Whether a match is not part of a longer identifier */
+  bool IsWholeWord(const uint8 *Data, int64 Size, int64 Start) const {
+    const int64 End = Start + Needle.Num();
+    if (Start > 0 && IsWordByte(Needle[0]) && IsWordByte(Data[Start - 1])) {
+      return false;
+    }
+    return End >= Size || !IsWordByte(Needle.Last()) || !IsWordByte(Data[End]);
+  }
+
+  /** The query, lowercased if case is ignored */
+  TArray<uint8> Needle;
+
+  bool bMatchCase;
+  bool bWholeWord;
+
+  /** Offset in Needle of the byte scanned for, in both cases */
+  int32 ScanOffset = 0;
+  uint8 ScanLower = 0;
+  uint8 ScanUpper = 0;
+};
+
+/** Position of a match in a file, while its line is known */
+struct FFindInFilesSpan {
+  int64 LineStart;
+  int64 LineEnd;
+  int64 Start;
+  int64 End;
+};
+
+/** Record a match, with a preview of its line */
+static void AddMatch(const uint8 *Data, int32 Line,
+                     const FFindInFilesSpan &Span,
+                     TArray<FFindInFilesMatch> &OutMatches) {
+  const int64 Start = Span.Start;
+  const int64 MatchEnd = FMath::Min(Span.End, Span.LineEnd);
+
+  // Preview the line without its indentation, and only around the match
+  // if it is long
+  int64 PreviewFrom = Span.LineStart;
+  while (PreviewFrom < Start &&
+         (Data[PreviewFrom] == ' ' || Data[PreviewFrom] == '\t')) {
+    ++PreviewFrom;
+  }
+  if (Start - PreviewFrom > FindInFilesConstants::PreviewContextBytes) {
+    PreviewFrom = Start - FindInFilesConstants::PreviewContextBytes;
+    while (PreviewFrom < Start && IsContinuationByte(Data[PreviewFrom])) {
+      ++PreviewFrom;
+    }
+  }
+  int64 PreviewTo = FMath::Max(
+      MatchEnd, PreviewFrom + FindInFilesConstants::MaxPreviewBytes);
+  PreviewTo = FMath::Min(PreviewTo, Span.LineEnd);
+  while (PreviewTo < Span.LineEnd && IsContinuationByte(Data[PreviewTo])) {
+    ++PreviewTo;
+  }
+
+  FFindInFilesMatch &Match = OutMatches.AddDefaulted_GetRef();
+  Match.Line = Line;
+  Match.Column =
+      CountCharacters(Data + Span.LineStart, Start - Span.LineStart) + 1;
+  Match.Offset = Start;
+  Match.Preview = Utf8ToString(Data + PreviewFrom, Start - PreviewFrom);
+  Match.PreviewStart = Match.Preview.Len();
+  Match.Preview += Utf8ToString(Data + Start, MatchEnd - Start);
+  Match.PreviewLength = Match.Preview.Len() - Match.PreviewStart;
+  Match.Preview += Utf8ToString(Data + MatchEnd, PreviewTo - MatchEnd);
+}
+
+/** Start of a file's text, past a UTF-8 byte order mark */
+static int64 SkipByteOrderMark(const uint8 *Data, int64 Size) {
+  return Size >= 3 && Data[0] == 0xEF && Data[1] == 0xBB && Data[2] == 0xBF
+             ? 3
+             : 0;
+}
+
+/** End of the line holding Pos, before its line break */
+static int64 FindLineEnd(const uint8 *Data, int64 Size, int64 LineStart,
+                         int64 Pos) {
+  int64 LineEnd = FindEitherByte(Data, Size, Pos, '\n', '\n');
+  if (LineEnd > LineStart && Data[LineEnd - 1] == '\r') {
+    --LineEnd;
+  }
+  return LineEnd;
+}
+
+/** Find the matches in a file's contents */
+static void SearchText(const uint8 *Data, int64 Size,
+                       const FFindInFilesLiteral &Literal, int32 MaxMatches,
+                       TArray<FFindInFilesMatch> &OutMatches) {
+  int64 LineStart = SkipByteOrderMark(Data, Size);
+  int32 Line = 1;
+  int64 Counted = LineStart;
+  int64 Start = Literal.Find(Data, Size, LineStart);
+  while (Start != INDEX_NONE && OutMatches.Num() < MaxMatches) {
+    // Count the lines passed since the previous match
+    for (int64 Pos = FindEitherByte(Data, Start, Counted, '\n', '\n');
+         Pos < Start; Pos = FindEitherByte(Data, Start, Pos + 1, '\n', '\n')) {
+      ++Line;
+      LineStart = Pos + 1;
+    }
+    Counted = Start;
+
+    const int64 End = Start + Literal.Len();
+    AddMatch(Data, Line,
+             {LineStart, FindLineEnd(Data, Size, LineStart, Start), Start, End},
+             OutMatches);
+    Start = Literal.Find(Data, Size, End);
+  }
+}
+
+/**
+ * Find the matches of a regular expression in a file's contents. Only the
+ * lines holding its required literal, if it has one, are matched.
+ */
+static void SearchTextRegex(const uint8 *Data, int64 Size,
+                            FCodeRegexMatcher &Matcher,
+                            const FFindInFilesLiteral &Required,
+                            int32 MaxMatches,
+                            TArray<FFindInFilesMatch> &OutMatches) {
+  int64 LineStart = SkipByteOrderMark(Data, Size);
+  int32 Line = 1;
+  while (LineStart <= Size && OutMatches.Num() < MaxMatches) {
+    if (Required.Len() > 0) {
+      const int64 Hit = Required.Find(Data, Size, LineStart);
+      if (Hit == INDEX_NONE) {
+        return;
+      }
+      for (int64 Pos = FindEitherByte(Data, Hit, LineStart, '\n', '\n');
+           Pos < Hit; Pos = FindEitherByte(Data, Hit, Pos + 1, '\n', '\n')) {
+        ++Line;
+        LineStart = Pos + 1;
+      }
+    }
+
+    const int64 LineEnd = FindLineEnd(Data, Size, LineStart, LineStart);
+    Matcher.FindAll(Data + LineStart, int32(LineEnd - LineStart),
+                    [&](int32 Start, int32 End) {
+                      AddMatch(Data, Line,
+                               {LineStart, LineEnd, LineStart + Start,
+                                LineStart + End},
+                               OutMatches);
+                      return OutMatches.Num() < MaxMatches;
+                    });
+
+    LineStart = FindEitherByte(Data, Size, LineEnd, '\n', '\n') + 1;
+    ++Line;
+  }
+}
+
+/**
+ * Fill in the previews of matches known by line and column, in file order.
+ * A match no longer at its column is looked for on its line.
+ */
+static void ReadMatchesAt(const uint8 *Data, int64 Size,
+                          const FFindInFilesLiteral &Literal,
+                          const TArray<FFindInFilesMatch> &Targets,
+                          TArray<FFindInFilesMatch> &OutMatches) {
+  int64 LineStart = SkipByteOrderMark(Data, Size);
+  int32 Line = 1;
+  int64 PreviousStart = INDEX_NONE;
+  for (const FFindInFilesMatch &Target : Targets) {
+    while (Line < Target.Line) {
+      const int64 Break = FindEitherByte(Data, Size, LineStart, '\n', '\n');
+      if (Break >= Size) {
+        return;
+      }
+      LineStart = Break + 1;
+      ++Line;
+    }
+    const int64 LineEnd = FindLineEnd(Data, Size, LineStart, LineStart);
+
+    int64 Start = LineStart;
+    for (int32 Column = 1; Column < Target.Column && Start < LineEnd;
+         ++Column) {
+      ++Start;
+      while (Start < LineEnd && IsContinuationByte(Data[Start])) {
+        ++Start;
+      }
+    }
+    int64 Found = Literal.Find(Data, LineEnd, Start);
+    if (Found != Start) {
+      Found = Literal.Find(Data, LineEnd, LineStart);
+    }
+    if (Found == INDEX_NONE || Found == PreviousStart) {
+      continue;
+    }
+    PreviousStart = Found;
+    AddMatch(Data, Line, {LineStart, LineEnd, Found, Found + Literal.Len()},
+             OutMatches);
+  }
+}
+
+void FFindInFilesSearch::FindWordAt(const uint8 *Data, int64 Size,
+                                    const FString &Word,
+                                    const TArray<FFindInFilesMatch> &Targets,
+                                    TArray<FFindInFilesMatch> &OutMatches) {
+  FFindInFilesQuery Query;
+  Query.Text = Word;
+  Query.bMatchCase = true;
+  Query.bWholeWord = true;
+  ReadMatchesAt(Data, Size, FFindInFilesLiteral(Query), Targets, OutMatches);
+}
+
+bool FFindInFilesSearch::VisitTextFile(
+    const FString &FilePath,
+    TFunctionRef<void(const uint8 *Data, int64 Size)> Visitor) {
+  const int64 MaxFileSize =
+      int64(FMath::Max(1, CVarICEFindMaxFileSizeMB.GetValueOnAnyThread())) *
+      1024 * 1024;
+
+  // Text files have no NUL near the start
+  auto VisitIfText = [&Visitor](const uint8 *Data, int64 Size) {
+    const int64 CheckSize =
+        FMath::Min(Size, FindInFilesConstants::BinaryCheckSize);
+    if (FindEitherByte(Data, CheckSize, 0, 0, 0) < CheckSize) {
+      return false;
+    }
+    Visitor(Data, Size);
+    return true;
+  };
+
+  IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+  TUniquePtr<IMappedFileHandle> Handle(PlatformFile.OpenMapped(*FilePath));
+  if (Handle.IsValid()) {
+    const int64 Size = Handle->GetFileSize();
+    if (Size <= 0 || Size > MaxFileSize) {
+      return false;
+    }
+    TUniquePtr<IMappedFileRegion> Region(Handle->MapRegion(0, Size));
+    if (Region.IsValid()) {
+      return VisitIfText(Region->GetMappedPtr(), Region->GetMappedSize());
+    }
+  }
+
+  // Where mapping is not supported the file is read instead
+  const int64 Size = PlatformFile.FileSize(*FilePath);
+  TArray<uint8> Data;
+  return Size > 0 && Size <= MaxFileSize &&
+         FFileHelper::LoadFileToArray(Data, *FilePath, FILEREAD_Silent) &&
+         VisitIfText(Data.GetData(), Data.Num());
+}
+
+FFindInFilesSearch::FFindInFilesSearch(
+    const FString &InRootPath,
+    TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> InPathIndex,
+    FFindInFilesFilter InFilter, const FFindInFilesQuery &InQuery)
+    : RootPath(InRootPath), PathIndex(MoveTemp(InPathIndex)),
+      Filter(MoveTemp(InFilter)), Query(InQuery) {}
+
+TSharedRef<FFindInFilesSearch, ESPMode::ThreadSafe> FFindInFilesSearch::Start(
+    const FString &RootPath,
+    TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex,
+    FFindInFilesFilter Filter, const FFindInFilesQuery &Query,
+    FOnResults OnResults, FOnFinished OnFinished) {
+  TSharedRef<FFindInFilesSearch, ESPMode::ThreadSafe> Search =
+      MakeShareable(new FFindInFilesSearch(RootPath, MoveTemp(PathIndex),
+                                           MoveTemp(Filter), Query));
+  Search->OnResults = MoveTemp(OnResults);
+  Search->OnFinished = MoveTemp(OnFinished);
+
+  Async(EAsyncExecution::ThreadPool, [Search]() { Search->Run(); });
+  return Search;
+}
+
+TSharedRef<FFindInFilesSearch, ESPMode::ThreadSafe>
+FFindInFilesSearch::StartAt(const FString &RootPath, const FString &Word,
+                            TArray<FFindInFilesResult> &&Files,
+                            FOnResults OnResults, FOnFinished OnFinished) {
+  FFindInFilesQuery Query;
+  Query.Text = Word;
+  Query.bMatchCase = true;
+  Query.bWholeWord = true;
+
+  TSharedRef<FFindInFilesSearch, ESPMode::ThreadSafe> Search =
+      MakeShareable(new FFindInFilesSearch(RootPath, nullptr,
+                                           FFindInFilesFilter(), Query));
+  Search->Targets = MoveTemp(Files);
+  Search->OnResults = MoveTemp(OnResults);
+  Search->OnFinished = MoveTemp(OnFinished);
+
+  Async(EAsyncExecution::ThreadPool, [Search]() { Search->Run(); });
+  return Search;
+}
+
+void FFindInFilesSearch::Cancel() {
+  bCancelled = true;
+  bRunning = false;
+}
+
+int32 FFindInFilesSearch::GetNumFiles() const {
+  return PathIndex.IsValid() ? PathIndex->Num() : Targets.Num();
+}
+
+TSharedPtr<const FCodeRegex, ESPMode::ThreadSafe>
+FFindInFilesSearch::CompileRegex(const FFindInFilesQuery &Query,
+                                 FText &OutError) {
+  const FString Pattern =
+      Query.bWholeWord ? FString::Printf(TEXT("\\b(?:%s)\\b"), *Query.Text)
+                       : Query.Text;
+  return FCodeRegex::Compile(Pattern, !Query.bMatchCase, OutError);
+}
+
+void FFindInFilesSearch::Run() {
+  if (PathIndex.IsValid()) {
+    SearchFiles();
+  } else {
+    ReadTargets();
+  }
+
+  AsyncTask(ENamedThreads::GameThread, [This = AsShared()]() {
+    This->FlushResults();
+    if (!This->bCancelled) {
+      This->bRunning = false;
+      if (This->OnFinished) {
+        This->OnFinished(This->bReachedMaxResults);
+      }
+    }
+  });
+}
+
+void FFindInFilesSearch::SearchFiles() {
+  const int32 MaxResults =
+      FMath::Max(1, CVarICEFindMaxResults.GetValueOnAnyThread());
+
+  // A regular expression is prefiltered by the text all its matches hold
+  FText RegexError;
+  const TSharedPtr<const FCodeRegex, ESPMode::ThreadSafe> Regex =
+      Query.bRegex ? CompileRegex(Query, RegexError) : nullptr;
+  FFindInFilesQuery LiteralQuery = Query;
+  if (Regex.IsValid()) {
+    LiteralQuery.Text = Regex->GetRequiredLiteral();
+    LiteralQuery.bWholeWord = false;
+  }
+  const FFindInFilesLiteral Literal(LiteralQuery);
+  Filter.Narrow(LiteralQuery.Text);
+
+  const bool bCanMatch = Query.bRegex ? Regex.IsValid() : Literal.Len() > 0;
+  const int32 NumFiles = bCanMatch ? PathIndex->Num() : 0;
+  const int32 NumTasks =
+      FMath::DivideAndRoundUp(NumFiles, FindInFilesConstants::FilesPerTask);
+  ParallelFor(
+      NumTasks,
+      [&](int32 Task) {
+        const int32 First = Task * FindInFilesConstants::FilesPerTask;
+        const int32 Last =
+            FMath::Min(First + FindInFilesConstants::FilesPerTask, NumFiles);
+
+        TUniquePtr<FCodeRegexMatcher> Matcher;
+        if (Regex.IsValid()) {
+          Matcher = MakeUnique<FCodeRegexMatcher>(Regex.ToSharedRef());
+        }
+
+        TArray<FFindInFilesResult> Results;
+        for (int32 Index = First;
+             Index < Last && !bCancelled && !bReachedMaxResults; ++Index) {
+          const FStringView PathView = PathIndex->GetPath(Index);
+          NumFilesSearched.Increment();
+          if (!Filter.MayContain(PathView)) {
+            continue;
+          }
+
+          const FString Path(PathView);
+          TArray<FFindInFilesMatch> Matches;
+          VisitTextFile(RootPath / Path, [&](const uint8 *Data, int64 Size) {
+            if (Matcher.IsValid()) {
+              SearchTextRegex(Data, Size, *Matcher, Literal, MaxResults,
+                              Matches);
+            } else {
+              SearchText(Data, Size, Literal, MaxResults, Matches);
+            }
+          });
+
+          if (Matches.Num() > 0) {
+            if (NumMatches.Add(Matches.Num()) + Matches.Num() >= MaxResults) {
+              bReachedMaxResults = true;
+            }
+            FFindInFilesResult &Result = Results.AddDefaulted_GetRef();
+            Result.Path = Path;
+            Result.Matches = MoveTemp(Matches);
+          }
+        }
+
+        if (Results.Num() > 0) {
+          AddResults(MoveTemp(Results));
+        }
+      },
+      EParallelForFlags::Unbalanced);
+}
+
+void FFindInFilesSearch::ReadTargets() {
+  const FFindInFilesLiteral Literal(Query);
+  const int32 NumTasks = FMath::DivideAndRoundUp(
+      Targets.Num(), FindInFilesConstants::FilesPerTask);
+  ParallelFor(
+      NumTasks,
+      [&](int32 Task) {
+        const int32 First = Task * FindInFilesConstants::FilesPerTask;
+        const int32 Last = FMath::Min(
+            First + FindInFilesConstants::FilesPerTask, Targets.Num());
+
+        TArray<FFindInFilesResult> Results;
+        for (int32 Index = First; Index < Last && !bCancelled; ++Index) {
+          const FFindInFilesResult &Target = Targets[Index];
+          NumFilesSearched.Increment();
+
+          TArray<FFindInFilesMatch> Matches;
+          VisitTextFile(RootPath / Target.Path,
+                        [&](const uint8 *Data, int64 Size) {
+                          ReadMatchesAt(Data, Size, Literal, Target.Matches,
+                                        Matches);
+                        });
+
+          if (Matches.Num() > 0) {
+            NumMatches.Add(Matches.Num());
+            FFindInFilesResult &Result = Results.AddDefaulted_GetRef();
+            Result.Path = Target.Path;
+            Result.Matches = MoveTemp(Matches);
+          }
+        }
+
+        if (Results.Num() > 0) {
+          AddResults(MoveTemp(Results));
+        }
+      },
+      EParallelForFlags::Unbalanced);
+}
+
+void FFindInFilesSearch::AddResults(TArray<FFindInFilesResult> &&Results) {
+  // One flush is queued at a time; results arriving meanwhile join it
+  bool bQueueFlush = false;
+  {
+    FScopeLock Lock(&PendingLock);
+    PendingResults.Append(MoveTemp(Results));
+    bQueueFlush = !bFlushQueued;
+    bFlushQueued = true;
+  }
+
+  if (bQueueFlush) {
+    AsyncTask(ENamedThreads::GameThread,
+              [This = AsShared()]() { This->FlushResults(); });
+  }
+}
+
+void FFindInFilesSearch::FlushResults() {
+  TArray<FFindInFilesResult> Results;
+  {
+    FScopeLock Lock(&PendingLock);
+    Results = MoveTemp(PendingResults);
+    bFlushQueued = false;
+  }
+
+  if (!bCancelled && Results.Num() > 0 && OnResults) {
+    OnResults(MoveTemp(Results));
+  }
+}
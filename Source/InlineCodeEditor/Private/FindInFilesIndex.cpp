@@ -0,0 +1,625 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "FindInFilesIndex.h"
+#include "Algo/Unique.h"
+#include "AsciiCase.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "CodeIndexStorage.h"
+#include "Containers/StringConv.h"
+#include "FileTreePathIndex.h"
+#include "FindInFiles.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+namespace FindInFilesIndexFormat {
+constexpr uint32 Magic = 0x58454349; // "ICEX"
+constexpr uint32 Version = 1;
+
+const TCHAR *Extension = TEXT(".iceidx");
+
+// [Header][FileRecord x NumFiles][Paths][TrigramRecord x NumTrigrams]
+// [Postings]. Paths are UTF-8; each posting list holds the LEB128-encoded
+// gaps between ascending file numbers, the first one counted from -1.
+
+struct FHeader {
+  uint32 Magic;
+  uint32 Version;
+  int32 NumFiles;
+  int32 NumTrigrams;
+  int64 PathsSize;
+  int64 PostingsSize;
+};
+
+struct FFileRecord {
+  int64 Size;
+  int64 Ticks;
+  uint64 PathHash;
+  uint32 PathOffset;
+  uint32 PathLength;
+};
+
+struct FTrigramRecord {
+  uint32 Trigram;
+  int32 NumFiles;
+  int64 PostingsOffset;
+};
+
+static_assert(sizeof(FHeader) == 32, "Index header layout changed");
+static_assert(sizeof(FFileRecord) == 32, "Index file record layout changed");
+static_assert(sizeof(FTrigramRecord) == 16, "Index trigram layout changed");
+} // namespace FindInFilesIndexFormat
+
+namespace FindInFilesIndexConstants {
+/** Files read at once while building, before their postings are added */
+constexpr int32 BuildBatchSize = 256;
+} // namespace FindInFilesIndexConstants
+
+static TAutoConsoleVariable<int32> CVarICEFindIndex(
+    TEXT("ICE.FindInFiles.Index"), 1,
+    TEXT("Whether ICE keeps a trigram index of the files below the root, so ")
+        TEXT("find in files only reads the files that can match. Applies to ")
+        TEXT("roots opened afterwards."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarICEFindIndexMergeThreshold(
+    TEXT("ICE.FindInFiles.IndexMergeThreshold"), 256,
+    TEXT("Files that may change below the root before the ICE find-in-files ")
+        TEXT("index re-reads them; until then they are always searched."),
+    ECVF_Default);
+
+using CodeIndexStorage::HashPath;
+
+/** Distinct trigrams of a text, ASCII letters folded to lower case */
+static void ExtractTrigrams(const uint8 *Data, int64 Size,
+                            TArray<uint32> &OutTrigrams) {
+  OutTrigrams.Reset();
+  if (Size < 3) {
+    return;
+  }
+
+  OutTrigrams.Reserve(Size - 2);
+  uint32 Trigram = (ToLowerAscii(Data[0]) << 8) | ToLowerAscii(Data[1]);
+  for (int64 Pos = 2; Pos < Size; ++Pos) {
+    Trigram = ((Trigram << 8) | ToLowerAscii(Data[Pos])) & 0xFFFFFF;
+    OutTrigrams.Add(Trigram);
+  }
+  OutTrigrams.Sort();
+  OutTrigrams.SetNum(Algo::Unique(OutTrigrams));
+}
+
+struct FFindInFilesIndex::FSnapshot : CodeIndexStorage::FImage {
+  /** Read the header and every file record; false if malformed */
+  bool Parse() {
+    using namespace FindInFilesIndexFormat;
+    if (Size < int64(sizeof(FHeader))) {
+      return false;
+    }
+    FMemory::Memcpy(&Header, Data, sizeof(FHeader));
+    if (Header.Magic != Magic || Header.Version != Version ||
+        Header.NumFiles < 0 || Header.NumTrigrams < 0 ||
+        Header.PathsSize < 0 || Header.PostingsSize < 0) {
+      return false;
+    }
+
+    FilesOffset = sizeof(FHeader);
+    PathsOffset = FilesOffset + int64(Header.NumFiles) * sizeof(FFileRecord);
+    TrigramsOffset = Align(PathsOffset + Header.PathsSize, 8);
+    PostingsOffset =
+        TrigramsOffset + int64(Header.NumTrigrams) * sizeof(FTrigramRecord);
+    if (PostingsOffset + Header.PostingsSize != Size) {
+      return false;
+    }
+
+    FileByPathHash.Reserve(Header.NumFiles);
+    for (int32 Index = 0; Index < Header.NumFiles; ++Index) {
+      const FFileRecord File = GetFile(Index);
+      if (int64(File.PathOffset) + File.PathLength > Header.PathsSize) {
+        return false;
+      }
+      FileByPathHash.Add(File.PathHash, Index);
+    }
+
+    int64 LastOffset = 0;
+    for (int32 Index = 0; Index < Header.NumTrigrams; ++Index) {
+      const FTrigramRecord Record = GetTrigram(Index);
+      if (Record.PostingsOffset < LastOffset ||
+          Record.PostingsOffset > Header.PostingsSize) {
+        return false;
+      }
+      LastOffset = Record.PostingsOffset;
+    }
+    return true;
+  }
+
+  int32 NumFiles() const { return Header.NumFiles; }
+
+  FindInFilesIndexFormat::FFileRecord GetFile(int32 Index) const {
+    FindInFilesIndexFormat::FFileRecord File;
+    FMemory::Memcpy(&File, Data + FilesOffset + Index * sizeof(File),
+                    sizeof(File));
+    return File;
+  }
+
+  FindInFilesIndexFormat::FTrigramRecord GetTrigram(int32 Index) const {
+    FindInFilesIndexFormat::FTrigramRecord Record;
+    FMemory::Memcpy(&Record, Data + TrigramsOffset + Index * sizeof(Record),
+                    sizeof(Record));
+    return Record;
+  }
+
+  /** UTF-8 path of an indexed file */
+  const uint8 *
+  GetPathBytes(const FindInFilesIndexFormat::FFileRecord &File) const {
+    return Data + PathsOffset + File.PathOffset;
+  }
+
+  FString GetPath(int32 Index) const {
+    const FindInFilesIndexFormat::FFileRecord File = GetFile(Index);
+    const FUTF8ToTCHAR Path(
+        reinterpret_cast<const ANSICHAR *>(GetPathBytes(File)),
+        File.PathLength);
+    return FString(Path.Length(), Path.Get());
+  }
+
+  /** Number of the record of a trigram, or INDEX_NONE */
+  int32 FindTrigram(uint32 Trigram) const {
+    int32 Low = 0;
+    int32 High = Header.NumTrigrams;
+    while (Low < High) {
+      const int32 Mid = Low + (High - Low) / 2;
+      if (GetTrigram(Mid).Trigram < Trigram) {
+        Low = Mid + 1;
+      } else {
+        High = Mid;
+      }
+    }
+    return Low < Header.NumTrigrams && GetTrigram(Low).Trigram == Trigram
+               ? Low
+               : INDEX_NONE;
+  }
+
+  /** Files holding the trigram of a record, ascending */
+  void DecodePostings(int32 RecordIndex, TArray<int32> &OutFiles) const {
+    const int64 Begin = GetTrigram(RecordIndex).PostingsOffset;
+    const int64 End = RecordIndex + 1 < Header.NumTrigrams
+                          ? GetTrigram(RecordIndex + 1).PostingsOffset
+                          : Header.PostingsSize;
+
+    OutFiles.Reset();
+    const uint8 *It = Data + PostingsOffset + Begin;
+    const uint8 *const Last = Data + PostingsOffset + End;
+    int64 File = -1;
+    uint32 Gap;
+    while (It < Last && CodeIndexStorage::ReadVarint(It, Last, Gap)) {
+      File += Gap;
+      if (Gap == 0 || File >= Header.NumFiles) {
+        break;
+      }
+      OutFiles.Add(int32(File));
+    }
+  }
+
+  FindInFilesIndexFormat::FHeader Header;
+  int64 FilesOffset = 0;
+  int64 PathsOffset = 0;
+  int64 TrigramsOffset = 0;
+  int64 PostingsOffset = 0;
+
+  /** Indexed file numbers by path hash */
+  TMap<uint64, int32> FileByPathHash;
+};
+
+/** Postings of one trigram while an index is built */
+struct FPostingListBuilder {
+  uint32 Trigram = 0;
+  int32 NumFiles = 0;
+  int32 LastFile = -1;
+  TArray<uint8> Bytes;
+
+  /** Add a file numbered above every file added so far */
+  void Add(int32 File) {
+    CodeIndexStorage::WriteVarint(Bytes, uint32(File - LastFile));
+    LastFile = File;
+    ++NumFiles;
+  }
+};
+
+/**
+ * Build an index image holding Kept files of Old, in that order, then
+ * Added files read from below RootPath. Returns false if cancelled.
+ */
+static bool BuildIndex(const FString &RootPath,
+                       const FFindInFilesIndex::FSnapshot *Old,
+                       const TArray<int32> &Kept, const TArray<FString> &Added,
+                       const FThreadSafeBool &Cancelled,
+                       TArray<uint8> &OutBytes) {
+  using namespace FindInFilesIndexFormat;
+
+  TArray<FFileRecord> Files;
+  TArray<uint8> Paths;
+  Files.Reserve(Kept.Num() + Added.Num());
+
+  TMap<uint32, int32> ListByTrigram;
+  TArray<FPostingListBuilder> Lists;
+  auto AddPosting = [&ListByTrigram, &Lists](uint32 Trigram, int32 File) {
+    int32 &ListIndex = ListByTrigram.FindOrAdd(Trigram, INDEX_NONE);
+    if (ListIndex == INDEX_NONE) {
+      ListIndex = Lists.AddDefaulted();
+      Lists[ListIndex].Trigram = Trigram;
+    }
+    Lists[ListIndex].Add(File);
+  };
+
+  // Carry the kept files and their postings over; keeping their order
+  // keeps every list ascending
+  if (Old && Kept.Num() > 0) {
+    TArray<int32> OldToNew;
+    OldToNew.Init(INDEX_NONE, Old->NumFiles());
+    for (int32 Index = 0; Index < Kept.Num(); ++Index) {
+      OldToNew[Kept[Index]] = Index;
+
+      FFileRecord File = Old->GetFile(Kept[Index]);
+      const uint8 *Path = Old->GetPathBytes(File);
+      File.PathOffset = Paths.Num();
+      Paths.Append(Path, File.PathLength);
+      Files.Add(File);
+    }
+
+    TArray<int32> OldFiles;
+    for (int32 Record = 0; Record < Old->Header.NumTrigrams; ++Record) {
+      if (Cancelled) {
+        return false;
+      }
+      Old->DecodePostings(Record, OldFiles);
+      const uint32 Trigram = Old->GetTrigram(Record).Trigram;
+      for (const int32 OldFile : OldFiles) {
+        if (OldToNew[OldFile] != INDEX_NONE) {
+          AddPosting(Trigram, OldToNew[OldFile]);
+        }
+      }
+    }
+  }
+
+  // Read the added files in parallel batches, adding their postings in
+  // file order
+  struct FReadFile {
+    FFileStatData Stat;
+    TArray<uint32> Trigrams;
+  };
+  TArray<FReadFile> Batch;
+  for (int32 First = 0; First < Added.Num();
+       First += FindInFilesIndexConstants::BuildBatchSize) {
+    if (Cancelled) {
+      return false;
+    }
+
+    const int32 Count = FMath::Min(FindInFilesIndexConstants::BuildBatchSize,
+                                   Added.Num() - First);
+    Batch.SetNum(Count);
+    ParallelFor(Count, [&](int32 Index) {
+      const FString FilePath = RootPath / Added[First + Index];
+      FReadFile &Read = Batch[Index];
+      Read.Stat = IFileManager::Get().GetStatData(*FilePath);
+      Read.Trigrams.Reset();
+      FFindInFilesSearch::VisitTextFile(
+          FilePath, [&Read](const uint8 *Data, int64 Size) {
+            ExtractTrigrams(Data, Size, Read.Trigrams);
+          });
+    });
+
+    for (int32 Index = 0; Index < Count; ++Index) {
+      const FString &Path = Added[First + Index];
+      const FTCHARToUTF8 Utf8Path(*Path);
+
+      // Unreadable and binary files are kept without postings, so they
+      // are known and never searched
+      FFileRecord File;
+      File.Size = Batch[Index].Stat.FileSize;
+      File.Ticks = Batch[Index].Stat.ModificationTime.GetTicks();
+      File.PathHash = HashPath(Path);
+      File.PathOffset = Paths.Num();
+      File.PathLength = Utf8Path.Length();
+      Paths.Append(reinterpret_cast<const uint8 *>(Utf8Path.Get()),
+                   Utf8Path.Length());
+
+      const int32 FileNumber = Files.Add(File);
+      for (const uint32 Trigram : Batch[Index].Trigrams) {
+        AddPosting(Trigram, FileNumber);
+      }
+    }
+  }
+
+  Lists.Sort([](const FPostingListBuilder &A, const FPostingListBuilder &B) {
+    return A.Trigram < B.Trigram;
+  });
+
+  FHeader Header;
+  Header.Magic = Magic;
+  Header.Version = Version;
+  Header.NumFiles = Files.Num();
+  Header.NumTrigrams = Lists.Num();
+  Header.PathsSize = Paths.Num();
+  Header.PostingsSize = 0;
+  for (const FPostingListBuilder &List : Lists) {
+    Header.PostingsSize += List.Bytes.Num();
+  }
+
+  const int64 PathsOffset = sizeof(FHeader) + Files.Num() * sizeof(FFileRecord);
+  const int64 TrigramsOffset = Align(PathsOffset + Paths.Num(), 8);
+  const int64 PostingsOffset =
+      TrigramsOffset + Lists.Num() * sizeof(FTrigramRecord);
+  OutBytes.SetNumZeroed(PostingsOffset + Header.PostingsSize);
+
+  uint8 *Out = OutBytes.GetData();
+  FMemory::Memcpy(Out, &Header, sizeof(Header));
+  FMemory::Memcpy(Out + sizeof(FHeader), Files.GetData(),
+                  Files.Num() * sizeof(FFileRecord));
+  FMemory::Memcpy(Out + PathsOffset, Paths.GetData(), Paths.Num());
+
+  int64 PostingsSize = 0;
+  for (int32 Index = 0; Index < Lists.Num(); ++Index) {
+    const FPostingListBuilder &List = Lists[Index];
+    const FTrigramRecord Record{List.Trigram, List.NumFiles, PostingsSize};
+    FMemory::Memcpy(Out + TrigramsOffset + Index * sizeof(FTrigramRecord),
+                    &Record, sizeof(Record));
+    FMemory::Memcpy(Out + PostingsOffset + PostingsSize, List.Bytes.GetData(),
+                    List.Bytes.Num());
+    PostingsSize += List.Bytes.Num();
+  }
+  return true;
+}
+
+TSharedPtr<FFindInFilesIndex, ESPMode::ThreadSafe>
+FFindInFilesIndex::Create(const FString &RootPath) {
+  if (CVarICEFindIndex.GetValueOnGameThread() == 0 || RootPath.IsEmpty()) {
+    return nullptr;
+  }
+
+  TSharedRef<FFindInFilesIndex, ESPMode::ThreadSafe> Index =
+      MakeShareable(new FFindInFilesIndex(RootPath));
+  Index->Load();
+  return Index;
+}
+
+FFindInFilesIndex::FFindInFilesIndex(const FString &InRootPath)
+    : RootPath(FPaths::ConvertRelativePathToFull(InRootPath)),
+      Cancelled(MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false)) {
+  FPaths::NormalizeDirectoryName(RootPath);
+  IndexName = CodeIndexStorage::MakeIndexName(RootPath);
+}
+
+FFindInFilesIndex::~FFindInFilesIndex() { *Cancelled = true; }
+
+FString FFindInFilesIndex::GetIndexPath(int32 Generation) const {
+  return CodeIndexStorage::GetGenerationPath(
+      FPaths::ProjectSavedDir() / TEXT("ICE") / TEXT("Index"), IndexName,
+      Generation, FindInFilesIndexFormat::Extension);
+}
+
+void FFindInFilesIndex::SetPathIndex(
+    TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index) {
+  PathIndex = Index;
+  Update();
+}
+
+void FFindInFilesIndex::HandleFilesChanged(
+    const TArray<FString> &RelativePaths) {
+  for (const FString &Path : RelativePaths) {
+    ChangedFiles.Add(HashPath(Path));
+    if (bUpdating) {
+      ChangedDuringUpdate.Add(HashPath(Path));
+    }
+  }
+
+  if (ChangedFiles.Num() >=
+      CVarICEFindIndexMergeThreshold.GetValueOnGameThread()) {
+    Update();
+  }
+}
+
+FFindInFilesFilter FFindInFilesIndex::GetFilter() const {
+  FFindInFilesFilter Filter;
+  if (IsReady()) {
+    Filter.Snapshot = Snapshot;
+    Filter.ChangedFiles = ChangedFiles;
+  }
+  return Filter;
+}
+
+void FFindInFilesIndex::Load() {
+  bLoading = true;
+
+  TWeakPtr<FFindInFilesIndex, ESPMode::ThreadSafe> WeakIndex = AsShared();
+  const FString Directory = FPaths::GetPath(GetIndexPath(0));
+  Async(EAsyncExecution::ThreadPool, [WeakIndex, Directory,
+                                      Name = IndexName, Root = RootPath,
+                                      Cancelled = Cancelled]() {
+    // Generations are numbered; the newest readable one is used
+    TSharedPtr<FSnapshot, ESPMode::ThreadSafe> Snapshot =
+        CodeIndexStorage::MapNewestGeneration<FSnapshot>(
+            Directory, Name, FindInFilesIndexFormat::Extension);
+
+    // Files changed while nobody watched have a new size or time
+    TArray<uint64> Stale;
+    if (Snapshot.IsValid()) {
+      Stale = CodeIndexStorage::FindStaleFiles(Root, *Snapshot, *Cancelled);
+    }
+
+    AsyncTask(ENamedThreads::GameThread, [WeakIndex, Snapshot,
+                                          Stale = MoveTemp(Stale)]() {
+      TSharedPtr<FFindInFilesIndex, ESPMode::ThreadSafe> Index =
+          WeakIndex.Pin();
+      if (!Index.IsValid()) {
+        return;
+      }
+
+      Index->Snapshot = Snapshot;
+      Index->ChangedFiles.Append(Stale);
+      Index->bLoading = false;
+      Index->Update();
+    });
+  });
+}
+
+void FFindInFilesIndex::Update() {
+  if (bLoading || !PathIndex.IsValid()) {
+    return;
+  }
+  if (bUpdating) {
+    bUpdateAgain = true;
+    return;
+  }
+  bUpdating = true;
+  ChangedDuringUpdate.Reset();
+
+  TWeakPtr<FFindInFilesIndex, ESPMode::ThreadSafe> WeakIndex = AsShared();
+  const int32 Generation = Snapshot.IsValid() ? Snapshot->Generation + 1 : 1;
+  Async(EAsyncExecution::ThreadPool,
+        [WeakIndex, Old = Snapshot, Files = PathIndex.ToSharedRef(),
+         Changed = ChangedFiles, Root = RootPath,
+         IndexPath = GetIndexPath(Generation), Generation,
+         Threshold = CVarICEFindIndexMergeThreshold.GetValueOnGameThread(),
+         Cancelled = Cancelled]() {
+          const double StartTime = FPlatformTime::Seconds();
+
+          // Files the index holds unchanged are kept; the rest are read
+          TArray<int32> Kept;
+          TArray<FString> Added;
+          for (int32 Index = 0; Index < Files->Num(); ++Index) {
+            const FStringView Path = Files->GetPath(Index);
+            const uint64 PathHash = HashPath(Path);
+            const int32 *OldFile =
+                Old.IsValid() ? Old->FileByPathHash.Find(PathHash) : nullptr;
+            if (OldFile && !Changed.Contains(PathHash)) {
+              Kept.Add(*OldFile);
+            } else {
+              Added.Emplace(Path);
+            }
+          }
+
+          // Until enough changed, searching the changed files costs less
+          // than merging
+          const int32 NumRemoved =
+              Old.IsValid() ? Old->NumFiles() - Kept.Num() : 0;
+          TSharedPtr<FSnapshot, ESPMode::ThreadSafe> Snapshot;
+          if (!Old.IsValid() || Added.Num() + NumRemoved >= Threshold) {
+            Kept.Sort();
+            TArray<uint8> Bytes;
+            if (BuildIndex(Root, Old.Get(), Kept, Added, *Cancelled, Bytes)) {
+              // Save a new generation and map it, keeping it in memory if
+              // that fails
+              if (CodeIndexStorage::SaveImage(Bytes, IndexPath)) {
+                Snapshot = CodeIndexStorage::MapImage<FSnapshot>(IndexPath,
+                                                                 Generation);
+              } else {
+                UE_LOG(LogTemp, Warning,
+                       TEXT("InlineCodeEditor: Failed to save the find ")
+                           TEXT("in files index %s"),
+                       *IndexPath);
+              }
+              if (!Snapshot.IsValid()) {
+                Snapshot = CodeIndexStorage::AdoptImage<FSnapshot>(
+                    MoveTemp(Bytes), Generation);
+              }
+
+              UE_LOG(LogTemp, Log,
+                     TEXT("InlineCodeEditor: Find in files indexed %d ")
+                         TEXT("files (%d read) in %.1fs"),
+                     Kept.Num() + Added.Num(), Added.Num(),
+                     FPlatformTime::Seconds() - StartTime);
+            }
+          }
+
+          AsyncTask(ENamedThreads::GameThread, [WeakIndex, Snapshot]() {
+            TSharedPtr<FFindInFilesIndex, ESPMode::ThreadSafe> Index =
+                WeakIndex.Pin();
+            if (!Index.IsValid()) {
+              return;
+            }
+
+            // Files changed during the update were not necessarily read
+            if (Snapshot.IsValid()) {
+              if (Index->Snapshot.IsValid()) {
+                Index->Snapshot->bSuperseded = true;
+              }
+              Index->Snapshot = Snapshot;
+              Index->ChangedFiles = MoveTemp(Index->ChangedDuringUpdate);
+            }
+            Index->ChangedDuringUpdate.Reset();
+
+            Index->bUpdating = false;
+            if (Index->bUpdateAgain) {
+              Index->bUpdateAgain = false;
+              Index->Update();
+            }
+          });
+        });
+}
+
+void FFindInFilesFilter::Narrow(const FString &Text) {
+  if (!Snapshot.IsValid()) {
+    return;
+  }
+
+  const FTCHARToUTF8 Utf8(*Text);
+  TArray<uint32> Trigrams;
+  ExtractTrigrams(reinterpret_cast<const uint8 *>(Utf8.Get()), Utf8.Length(),
+                  Trigrams);
+  if (Trigrams.Num() == 0) {
+    return;
+  }
+
+  bNarrowed = true;
+  Candidates.Init(false, Snapshot->NumFiles());
+
+  // A trigram no file holds rules out every indexed file
+  TArray<int32> Records;
+  for (const uint32 Trigram : Trigrams) {
+    const int32 Record = Snapshot->FindTrigram(Trigram);
+    if (Record == INDEX_NONE) {
+      return;
+    }
+    Records.Add(Record);
+  }
+
+  // Intersect the shortest lists first
+  Records.Sort([this](int32 A, int32 B) {
+    return Snapshot->GetTrigram(A).NumFiles < Snapshot->GetTrigram(B).NumFiles;
+  });
+  TArray<int32> Files;
+  TArray<int32> ListFiles;
+  Snapshot->DecodePostings(Records[0], Files);
+  for (int32 Index = 1; Index < Records.Num() && Files.Num() > 0; ++Index) {
+    Snapshot->DecodePostings(Records[Index], ListFiles);
+    int32 Kept = 0;
+    for (int32 A = 0, B = 0; A < Files.Num() && B < ListFiles.Num();) {
+      if (Files[A] < ListFiles[B]) {
+        ++A;
+      } else if (ListFiles[B] < Files[A]) {
+        ++B;
+      } else {
+        Files[Kept++] = Files[A];
+        ++A;
+        ++B;
+      }
+    }
+    Files.SetNum(Kept);
+  }
+
+  for (const int32 File : Files) {
+    Candidates[File] = true;
+  }
+}
+
+bool FFindInFilesFilter::MayContain(FStringView RelativePath) const {
+  if (!bNarrowed) {
+    return true;
+  }
+
+  // Files added or changed since the index was written are unknown to it
+  const uint64 PathHash = HashPath(RelativePath);
+  const int32 *File = Snapshot->FileByPathHash.Find(PathHash);
+  return !File || ChangedFiles.Contains(PathHash) || Candidates[*File];
+}
@@ -1,6 +1,7 @@
 // Copyright Yureka. All Rights Reserved.
 
 #include "InlineCodeEditorModule.h"
+#include "CodeEditJournal.h"
 #include "SIDEPanel.h"
 
 #include "Framework/Docking/TabManager.h"
@@ -19,6 +20,7 @@ void FInlineCodeEditorModule::StartupModule() {
   FLevelEditorModule &LevelEditorModule =
       FModuleManager::LoadModuleChecked<FLevelEditorModule>("LevelEditor");
 
+  FCodeEditJournal::StartupWriter();
   RegisterTabSpawner();
 
   UE_LOG(
@@ -28,6 +30,7 @@ void FInlineCodeEditorModule::StartupModule() {
 
 void FInlineCodeEditorModule::ShutdownModule() {
   UnregisterTabSpawner();
+  FCodeEditJournal::ShutdownWriter();
   UE_LOG(LogTemp, Log, TEXT("InlineCodeEditor: Module shut down"));
 }
 
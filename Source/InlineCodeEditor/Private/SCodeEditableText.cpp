@@ -1,9 +1,13 @@
 // Copyright Yureka. All Rights Reserved.
 
 #include "SCodeEditableText.h"
+#include "Algo/BinarySearch.h"
+#include "CodeFind.h"
 #include "FCppSyntaxHighlighter.h"
 #include "Fonts/FontMeasure.h"
 #include "Framework/Application/SlateApplication.h"
+#include "Framework/MultiBox/MultiBoxBuilder.h"
+#include "HAL/PlatformApplicationMisc.h"
 #include "Rendering/DrawElements.h"
 #include "Widgets/Images/SImage.h"
 #include "Widgets/Input/SButton.h"
@@ -35,6 +39,12 @@ const FLinearColor IndentGuideColor =
 const FLinearColor TextColor =
     FLinearColor::FromSRGBColor(FColor::FromHex("D4D4D4FF"));
 
+// Find match highlights, the current match stronger (VS Code Dark+)
+const FLinearColor FindMatchColor =
+    FLinearColor::FromSRGBColor(FColor::FromHex("EA5C0055"));
+const FLinearColor CurrentFindMatchColor =
+    FLinearColor::FromSRGBColor(FColor::FromHex("515C6AFF"));
+
 constexpr int32 FontSize = 10;
 constexpr float LineHeight = 15.0f;
 } // namespace CodeEditorStyle
@@ -102,18 +112,109 @@ int32 SIndentGuides::OnPaint(const FPaintArgs &Args,
   return LayerId + 1;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// SCodeFindHighlights - Find matches on the lines in view
+
+void SCodeFindHighlights::Construct(const FArguments &InArgs) {
+  LineHeight = InArgs._LineHeight;
+  CharWidth = InArgs._CharWidth;
+}
+
+FVector2D SCodeFindHighlights::ComputeDesiredSize(float) const {
+  return FVector2D::ZeroVector;
+}
+
+void SCodeFindHighlights::SetDisplayedLines(TArray<int32> &&InLineStarts,
+                                            TArray<int32> &&InLineEnds) {
+  LineStarts = MoveTemp(InLineStarts);
+  LineEnds = MoveTemp(InLineEnds);
+  Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SCodeFindHighlights::SetResults(
+    TSharedPtr<const FCodeFindResults> InResults, int32 InCurrentMatch) {
+  Results = InResults;
+  CurrentMatch = InCurrentMatch;
+  Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+int32 SCodeFindHighlights::OnPaint(const FPaintArgs &Args,
+                                   const FGeometry &AllottedGeometry,
+                                   const FSlateRect &MyCullingRect,
+                                   FSlateWindowElementList &OutDrawElements,
+                                   int32 LayerId,
+                                   const FWidgetStyle &InWidgetStyle,
+                                   bool bParentEnabled) const {
+  if (!Results.IsValid() || Results->Num() == 0 || LineStarts.Num() == 0 ||
+      LineHeight <= 0.0f) {
+    return LayerId;
+  }
+
+  // The scroll box clips to what is on screen, so the culling rect tells
+  // which lines can be seen
+  const FVector2D VisibleTop = AllottedGeometry.AbsoluteToLocal(
+      FVector2D(MyCullingRect.Left, MyCullingRect.Top));
+  const FVector2D VisibleBottom = AllottedGeometry.AbsoluteToLocal(
+      FVector2D(MyCullingRect.Right, MyCullingRect.Bottom));
+  const int32 FirstLine = FMath::Max(
+      0, FMath::FloorToInt(static_cast<float>(VisibleTop.Y) / LineHeight));
+  const int32 LastLine = FMath::Min(
+      LineStarts.Num() - 1,
+      FMath::CeilToInt(static_cast<float>(VisibleBottom.Y) / LineHeight));
+
+  const FSlateBrush *WhiteBrush = FCoreStyle::Get().GetBrush("WhiteBrush");
+  const TArray<FCodeFindMatch> &Matches = Results->GetMatches();
+  for (int32 Line = FirstLine; Line <= LastLine; ++Line) {
+    const int32 LineStart = LineStarts[Line];
+    const int32 LineEnd = LineEnds[Line];
+    for (int32 Index = Results->FindFirstEndingAfter(LineStart);
+         Index < Matches.Num() && Matches[Index].Start < LineEnd; ++Index) {
+      const int32 From = FMath::Max(Matches[Index].Start, LineStart);
+      const int32 To = FMath::Min(Matches[Index].End, LineEnd);
+      FSlateDrawElement::MakeBox(
+          OutDrawElements, LayerId,
+          AllottedGeometry.ToPaintGeometry(
+              FVector2D((To - From) * CharWidth, LineHeight),
+              FSlateLayoutTransform(FVector2D((From - LineStart) * CharWidth,
+                                              Line * LineHeight))),
+          WhiteBrush, ESlateDrawEffect::None,
+          Index == CurrentMatch ? CodeEditorStyle::CurrentFindMatchColor
+                                : CodeEditorStyle::FindMatchColor);
+    }
+  }
+
+  return LayerId + 1;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // SCodeEditableText Implementation
 
 void SCodeEditableText::Construct(const FArguments &InArgs) {
   FilePath = InArgs._FilePath;
   OnTextChangedCallback = InArgs._OnTextChanged;
+  OnTextEditedCallback = InArgs._OnTextEdited;
   OnCursorMovedCallback = InArgs._OnCursorMoved;
+  OnGoToDefinitionCallback = InArgs._OnGoToDefinition;
+  OnFindReferencesCallback = InArgs._OnFindReferences;
+  OnRenameSymbolCallback = InArgs._OnRenameSymbol;
+  bIsReadOnly = InArgs._IsReadOnly;
+
+  Document = InArgs._Document.IsValid()
+                 ? InArgs._Document
+                 : TSharedPtr<FCodeDocument>(FCodeDocument::CreateTransient(
+                       FilePath, InArgs._Text.Get().ToString()));
+  if (FilePath.IsEmpty()) {
+    FilePath = Document->GetFilePath();
+  }
 
-  SyntaxMarshaller = FCppSyntaxHighlighter::Create();
+  // Views of one document share its tokenizer, so lines another view has
+  // already highlighted come straight from the cache
+  SyntaxMarshaller = FCppSyntaxHighlighter::Create(Document->GetTokenizer());
 
-  FText InitialText = InArgs._Text.Get();
-  OriginalText = InitialText.ToString();
+  const FCodeDocumentLines &Lines = Document->GetLines();
+  FoldRegions = Lines.FoldRegions;
+  TotalLines = FMath::Max(1, Lines.Num());
+  DisplayedText = BuildDisplayedText();
 
   // Measure character width
   FSlateFontInfo MonoFont =
@@ -164,13 +265,23 @@ void SCodeEditableText::Construct(const FArguments &InArgs) {
                                               .LineHeight(
                                                   CodeEditorStyle::LineHeight)
                                               .CharWidth(CharacterWidth)
-                                              .IndentSize(IndentSize)]
+                                              .IndentSize(
+                                                  FCodeDocument::IndentSize)]
 
-                                   // Layer 1: Text editor (on top)
+                                   // Layer 1: Find matches (behind text)
+                                   + SOverlay::Slot()
+                                         [SAssignNew(FindHighlightsWidget,
+                                                     SCodeFindHighlights)
+                                              .LineHeight(
+                                                  CodeEditorStyle::LineHeight)
+                                              .CharWidth(CharacterWidth)]
+
+                                   // Layer 2: Text editor (on top)
                                    + SOverlay::Slot()
                                          [SAssignNew(TextEditor,
                                                      SMultiLineEditableText)
-                                              .Text(InitialText)
+                                              .Text(FText::FromString(
+                                                  DisplayedText))
                                               .TextStyle(&EditorTextStyle)
                                               .Marshaller(SyntaxMarshaller)
                                               .IsReadOnly(InArgs._IsReadOnly)
@@ -179,6 +290,14 @@ void SCodeEditableText::Construct(const FArguments &InArgs) {
                                               .OnTextChanged(
                                                   this, &SCodeEditableText::
                                                             HandleTextChanged)
+                                              .OnKeyDownHandler(
+                                                  this,
+                                                  &SCodeEditableText::
+                                                      HandleEditorKeyDown)
+                                              .OnContextMenuOpening(
+                                                  this,
+                                                  &SCodeEditableText::
+                                                      BuildContextMenu)
                                               .OnCursorMoved(
                                                   this,
                                                   &SCodeEditableText::
@@ -189,101 +308,55 @@ void SCodeEditableText::Construct(const FArguments &InArgs) {
                               .Orientation(Orient_Vertical)
                               .Thickness(FVector2D(8.0f, 8.0f))]];
 
-  ParseLines();
-  ParseFoldRegions();
-  CalculateLineIndentLevels();
+  DocumentEditedHandle = Document->OnEdited().AddSP(
+      this, &SCodeEditableText::HandleDocumentEdited);
+
   RebuildFoldingGutter();
   UpdateIndentGuides();
+  UpdateFindHighlights();
 }
 
-void SCodeEditableText::CalculateLineIndentLevels() {
-  LineIndentLevels.Empty();
-
-  TArray<FString> Lines;
-  (DisplayedText.IsEmpty() ? OriginalText : DisplayedText)
-      .ParseIntoArray(Lines, TEXT("\n"), false);
-
-  for (const FString &Line : Lines) {
-    // Count leading whitespace
-    int32 SpaceCount = 0;
-    for (int32 i = 0; i < Line.Len(); ++i) {
-      TCHAR C = Line[i];
-      if (C == ' ') {
-        SpaceCount++;
-      } else if (C == '\t') {
-        // Tab aligns to next tab stop
-        SpaceCount += IndentSize - (SpaceCount % IndentSize);
-      } else {
-        // First non-whitespace character
-        break;
-      }
-    }
-
-    // Convert to indent level
-    // If line is empty or whitespace-only, use 0
-    bool bIsEmptyLine = true;
-    for (TCHAR C : Line) {
-      if (!FChar::IsWhitespace(C)) {
-        bIsEmptyLine = false;
-        break;
-      }
-    }
-
-    int32 IndentLevel = bIsEmptyLine ? 0 : (SpaceCount / IndentSize);
-    LineIndentLevels.Add(IndentLevel);
-  }
-
-  // VS Code behavior: for empty/whitespace-only lines, inherit indent from
-  // context Look at surrounding non-empty lines to determine indent level
-  for (int32 i = 0; i < LineIndentLevels.Num(); ++i) {
-    if (LineIndentLevels[i] == 0) {
-      // Check if the line is truly empty
-      const FString &Line = Lines[i];
-      bool bIsEmpty = true;
-      for (TCHAR C : Line) {
-        if (!FChar::IsWhitespace(C)) {
-          bIsEmpty = false;
-          break;
-        }
-      }
-
-      if (bIsEmpty && i > 0) {
-        // Look for the minimum of previous and next non-empty lines
-        int32 PrevIndent = 0;
-        for (int32 j = i - 1; j >= 0; --j) {
-          if (LineIndentLevels[j] > 0 ||
-              !Lines[j].TrimStartAndEnd().IsEmpty()) {
-            PrevIndent = LineIndentLevels[j];
-            break;
-          }
-        }
+SCodeEditableText::~SCodeEditableText() {
+  if (Document.IsValid()) {
+    Document->OnEdited().Remove(DocumentEditedHandle);
+  }
+}
 
-        int32 NextIndent = 0;
-        for (int32 j = i + 1; j < LineIndentLevels.Num(); ++j) {
-          if (LineIndentLevels[j] > 0 ||
-              !Lines[j].TrimStartAndEnd().IsEmpty()) {
-            NextIndent = LineIndentLevels[j];
-            break;
-          }
-        }
+void SCodeEditableText::UpdateIndentGuides() {
+  if (!IndentGuidesWidget.IsValid()) {
+    return;
+  }
 
-        // Use the minimum of the two (or just prev if next is 0)
-        if (NextIndent > 0 && PrevIndent > 0) {
-          LineIndentLevels[i] = FMath::Min(PrevIndent, NextIndent);
-        } else if (PrevIndent > 0) {
-          LineIndentLevels[i] = PrevIndent;
-        } else if (NextIndent > 0) {
-          LineIndentLevels[i] = NextIndent;
-        }
-      }
-    }
+  // Guides come from the document's analysis, picked per displayed line
+  const TArray<int32> &IndentLevels = Document->GetLines().IndentLevels;
+  TArray<int32> DisplayedIndentLevels;
+  DisplayedIndentLevels.Reserve(DisplayToOriginalLine.Num());
+  for (int32 OriginalLine : DisplayToOriginalLine) {
+    DisplayedIndentLevels.Add(IndentLevels.IsValidIndex(OriginalLine)
+                                  ? IndentLevels[OriginalLine]
+                                  : 0);
   }
+  IndentGuidesWidget->SetLineIndentLevels(DisplayedIndentLevels);
 }
 
-void SCodeEditableText::UpdateIndentGuides() {
-  if (IndentGuidesWidget.IsValid()) {
-    IndentGuidesWidget->SetLineIndentLevels(LineIndentLevels);
+void SCodeEditableText::UpdateFindHighlights() {
+  if (!FindHighlightsWidget.IsValid()) {
+    return;
   }
+
+  const FCodeDocumentLines &Lines = Document->GetLines();
+  TArray<int32> LineStarts;
+  TArray<int32> LineEnds;
+  LineStarts.Reserve(DisplayToOriginalLine.Num());
+  LineEnds.Reserve(DisplayToOriginalLine.Num());
+  for (int32 OriginalLine : DisplayToOriginalLine) {
+    LineStarts.Add(Lines.LineStarts[OriginalLine]);
+    LineEnds.Add(Lines.LineStarts.IsValidIndex(OriginalLine + 1)
+                     ? Lines.LineStarts[OriginalLine + 1] - 1
+                     : Document->GetText().Len());
+  }
+  FindHighlightsWidget->SetDisplayedLines(MoveTemp(LineStarts),
+                                          MoveTemp(LineEnds));
 }
 
 void SCodeEditableText::RebuildFoldingGutter() {
@@ -296,10 +369,8 @@ void SCodeEditableText::RebuildFoldingGutter() {
   const FSlateFontInfo FontInfo =
       FCoreStyle::GetDefaultFontStyle("Mono", CodeEditorStyle::FontSize);
 
-  TArray<FString> Lines;
-  OriginalText.ParseIntoArray(Lines, TEXT("\n"), false);
-
-  for (int32 i = 0; i < Lines.Num(); ++i) {
+  const int32 NumLines = Document->GetLines().Num();
+  for (int32 i = 0; i < NumLines; ++i) {
     if (IsLineHidden(i)) {
       continue;
     }
@@ -343,67 +414,6 @@ void SCodeEditableText::RebuildFoldingGutter() {
   }
 }
 
-void SCodeEditableText::ParseFoldRegions() {
-  FoldRegions.Empty();
-
-  TArray<FString> Lines;
-  OriginalText.ParseIntoArray(Lines, TEXT("\n"), false);
-
-  TArray<int32> BraceStack;
-
-  for (int32 i = 0; i < Lines.Num(); ++i) {
-    const FString &Line = Lines[i];
-
-    bool bInString = false;
-    bool bInChar = false;
-    bool bInLineComment = false;
-
-    for (int32 j = 0; j < Line.Len(); ++j) {
-      TCHAR C = Line[j];
-      TCHAR NextC = (j + 1 < Line.Len()) ? Line[j + 1] : 0;
-      TCHAR PrevC = (j > 0) ? Line[j - 1] : 0;
-
-      if (PrevC == '\\') {
-        continue;
-      }
-
-      if (C == '"' && !bInLineComment && !bInChar) {
-        bInString = !bInString;
-        continue;
-      }
-
-      if (C == '\'' && !bInLineComment && !bInString) {
-        bInChar = !bInChar;
-        continue;
-      }
-
-      if (C == '/' && NextC == '/' && !bInString && !bInChar) {
-        bInLineComment = true;
-        continue;
-      }
-
-      if (bInString || bInChar || bInLineComment) {
-        continue;
-      }
-
-      if (C == '{') {
-        BraceStack.Push(i);
-      } else if (C == '}') {
-        if (BraceStack.Num() > 0) {
-          int32 StartLine = BraceStack.Pop();
-          if (i > StartLine) {
-            FoldRegions.Add(FCodeFoldRegion(StartLine, i, BraceStack.Num()));
-          }
-        }
-      }
-    }
-  }
-
-  FoldRegions.Sort([](const FCodeFoldRegion &A, const FCodeFoldRegion &B) {
-    return A.StartLine < B.StartLine;
-  });
-}
-
 FCodeFoldRegion *SCodeEditableText::GetFoldRegionAtLine(int32 LineIndex) {
   for (FCodeFoldRegion &Region : FoldRegions) {
     if (Region.StartLine == LineIndex) {
@@ -440,34 +450,72 @@ void SCodeEditableText::ApplyFolding() {
 
   bIsUpdatingText = true;
 
-  TArray<FString> Lines;
-  OriginalText.ParseIntoArray(Lines, TEXT("\n"), false);
+  DisplayedText = BuildDisplayedText();
+  TextEditor->SetText(FText::FromString(DisplayedText));
+  UpdateIndentGuides();
+  UpdateFindHighlights();
+
+  bIsUpdatingText = false;
+}
+
+FString SCodeEditableText::BuildDisplayedText() {
+  const int32 NumLines = Document->GetLines().Num();
 
-  DisplayToOriginalLine.Empty();
-  TArray<FString> VisibleLines;
+  DisplayToOriginalLine.Empty(NumLines);
+  DisplayedLineStarts.Empty(NumLines);
 
-  for (int32 i = 0; i < Lines.Num(); ++i) {
+  FString Result;
+  Result.Reserve(Document->GetText().Len());
+  for (int32 i = 0; i < NumLines; ++i) {
     if (IsLineHidden(i)) {
       continue;
     }
 
+    if (DisplayToOriginalLine.Num() > 0) {
+      Result.AppendChar('\n');
+    }
+    DisplayedLineStarts.Add(Result.Len());
+    DisplayToOriginalLine.Add(i);
+
+    Result += Document->GetLineText(i);
     FCodeFoldRegion *Region = GetFoldRegionAtLine(i);
     if (Region && Region->bIsFolded) {
-      FString FoldedLine = Lines[i] + TEXT(" ... }");
-      VisibleLines.Add(FoldedLine);
-    } else {
-      VisibleLines.Add(Lines[i]);
+      Result += TEXT(" ... }");
     }
-    DisplayToOriginalLine.Add(i);
   }
+  return Result;
+}
 
-  DisplayedText = FString::Join(VisibleLines, TEXT("\n"));
-  TextEditor->SetText(FText::FromString(DisplayedText));
+int32 SCodeEditableText::DisplayToDocumentOffset(int32 DisplayOffset) const {
+  if (DisplayedLineStarts.Num() == 0) {
+    return DisplayOffset;
+  }
 
-  CalculateLineIndentLevels();
-  UpdateIndentGuides();
+  const int32 DisplayLine = FMath::Max(
+      0, Algo::UpperBound(DisplayedLineStarts, DisplayOffset) - 1);
+  const int32 Column = DisplayOffset - DisplayedLineStarts[DisplayLine];
+  const int32 OriginalLine = DisplayToOriginalLine[DisplayLine];
+
+  const FCodeDocumentLines &Lines = Document->GetLines();
+  auto LineEnd = [this, &Lines](int32 LineIndex) {
+    return Lines.LineStarts.IsValidIndex(LineIndex + 1)
+               ? Lines.LineStarts[LineIndex + 1] - 1
+               : Document->GetText().Len();
+  };
+
+  const int32 LineStart = Lines.LineStarts[OriginalLine];
+  if (LineStart + Column <= LineEnd(OriginalLine)) {
+    return LineStart + Column;
+  }
 
-  bIsUpdatingText = false;
+  // Past the end of a folded line, inside its " ... }" marker: the marker
+  // stands for the hidden body, so map to the end of the folded region
+  for (const FCodeFoldRegion &Region : FoldRegions) {
+    if (Region.StartLine == OriginalLine && Region.bIsFolded) {
+      return LineEnd(Region.EndLine);
+    }
+  }
+  return LineEnd(OriginalLine);
 }
 
 void SCodeEditableText::ToggleFoldAtLine(int32 LineNumber) {
@@ -496,23 +544,351 @@ void SCodeEditableText::UnfoldAll() {
   RebuildFoldingGutter();
 }
 
-FText SCodeEditableText::GetText() const {
-  return FText::FromString(OriginalText);
+TArray<int32> SCodeEditableText::GetFoldedLines() const {
+  TArray<int32> FoldedLines;
+  for (const FCodeFoldRegion &Region : FoldRegions) {
+    if (Region.bIsFolded) {
+      FoldedLines.Add(Region.StartLine);
+    }
+  }
+  return FoldedLines;
 }
 
-void SCodeEditableText::SetText(const FText &InText) {
-  OriginalText = InText.ToString();
-  DisplayedText = OriginalText;
-  ParseLines();
-  ParseFoldRegions();
-  CalculateLineIndentLevels();
+void SCodeEditableText::SetFoldedLines(const TArray<int32> &InFoldedLines) {
+  for (FCodeFoldRegion &Region : FoldRegions) {
+    Region.bIsFolded = InFoldedLines.Contains(Region.StartLine);
+  }
   ApplyFolding();
   RebuildFoldingGutter();
-  UpdateIndentGuides();
-  bIsModified = false;
 }
 
-FString SCodeEditableText::GetPlainText() const { return OriginalText; }
+int32 SCodeEditableText::GetCursorOffset() const {
+  if (!TextEditor.IsValid() || DisplayedLineStarts.Num() == 0) {
+    return 0;
+  }
+
+  const FTextLocation Cursor = TextEditor->GetCursorLocation();
+  const int32 DisplayLine =
+      FMath::Clamp(Cursor.GetLineIndex(), 0, DisplayedLineStarts.Num() - 1);
+  return DisplayToDocumentOffset(DisplayedLineStarts[DisplayLine] +
+                                 Cursor.GetOffset());
+}
+
+void SCodeEditableText::SelectRange(int32 Start, int32 End) {
+  if (!TextEditor.IsValid()) {
+    return;
+  }
+
+  const FCodeDocumentLines &Lines = Document->GetLines();
+  const int32 Line =
+      FMath::Max(0, Algo::UpperBound(Lines.LineStarts, Start) - 1);
+
+  // A match inside a folded region is unfolded, as GoToLine does
+  bool bUnfolded = false;
+  for (FCodeFoldRegion &Region : FoldRegions) {
+    if (Region.bIsFolded && Line > Region.StartLine &&
+        Line <= Region.EndLine) {
+      Region.bIsFolded = false;
+      bUnfolded = true;
+    }
+  }
+  if (bUnfolded) {
+    ApplyFolding();
+    RebuildFoldingGutter();
+  }
+
+  const int32 DisplayedLine = Algo::LowerBound(DisplayToOriginalLine, Line);
+  if (!DisplayToOriginalLine.IsValidIndex(DisplayedLine)) {
+    return;
+  }
+  const int32 LineStart = Lines.LineStarts[Line];
+  const int32 LineEnd = Lines.LineStarts.IsValidIndex(Line + 1)
+                            ? Lines.LineStarts[Line + 1] - 1
+                            : Document->GetText().Len();
+  TextEditor->SelectText(
+      FTextLocation(DisplayedLine, Start - LineStart),
+      FTextLocation(DisplayedLine, FMath::Min(End, LineEnd) - LineStart));
+
+  // The text editor is as tall as its text; the scroll box around it has to
+  // be moved to bring the line into view
+  if (EditorScrollBox.IsValid()) {
+    const float ViewHeight =
+        EditorScrollBox->GetCachedGeometry().GetLocalSize().Y;
+    const float LineTop = DisplayedLine * CodeEditorStyle::LineHeight;
+    const float ScrollOffset = EditorScrollBox->GetScrollOffset();
+    if (LineTop < ScrollOffset ||
+        LineTop + CodeEditorStyle::LineHeight > ScrollOffset + ViewHeight) {
+      EditorScrollBox->SetScrollOffset(
+          FMath::Max(0.0f, LineTop - ViewHeight * 0.5f));
+    }
+  }
+}
+
+void SCodeEditableText::ApplyEdit(const FCodeTextEdit &Edit) {
+  if (bIsReadOnly || Edit.IsEmpty()) {
+    return;
+  }
+
+  // The document passes the edit to every view, this one included, which
+  // then replaces the edited range
+  Document->ApplyEdit(Edit);
+
+  OnTextEditedCallback.ExecuteIfBound(Edit);
+  OnTextChangedCallback.ExecuteIfBound(FText::FromString(DisplayedText));
+}
+
+void SCodeEditableText::Undo() {
+  if (!bIsReadOnly) {
+    HandleHistoryEdit(Document->Undo());
+  }
+}
+
+void SCodeEditableText::Redo() {
+  if (!bIsReadOnly) {
+    HandleHistoryEdit(Document->Redo());
+  }
+}
+
+void SCodeEditableText::HandleHistoryEdit(const FCodeTextEdit &Edit) {
+  if (Edit.IsEmpty()) {
+    return;
+  }
+  OnTextEditedCallback.ExecuteIfBound(Edit);
+  OnTextChangedCallback.ExecuteIfBound(FText::FromString(DisplayedText));
+
+  const int32 Cursor = Edit.Offset + Edit.InsertedText.Len();
+  SelectRange(Cursor, Cursor);
+}
+
+FReply SCodeEditableText::HandleEditorKeyDown(const FGeometry &MyGeometry,
+                                              const FKeyEvent &InKeyEvent) {
+  if (!InKeyEvent.IsControlDown() || InKeyEvent.IsAltDown()) {
+    return FReply::Unhandled();
+  }
+  const FKey Key = InKeyEvent.GetKey();
+  if (Key == EKeys::Z && !InKeyEvent.IsShiftDown()) {
+    Undo();
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Y || (Key == EKeys::Z && InKeyEvent.IsShiftDown())) {
+    Redo();
+    return FReply::Handled();
+  }
+  return FReply::Unhandled();
+}
+
+TSharedPtr<SWidget> SCodeEditableText::BuildContextMenu() {
+  const bool bCanEdit = !bIsReadOnly;
+  auto CanEdit = [bCanEdit]() { return bCanEdit; };
+  TWeakPtr<SMultiLineEditableText> WeakEditor = TextEditor;
+
+  FMenuBuilder MenuBuilder(true, nullptr);
+  MenuBuilder.BeginSection("EditText", LOCTEXT("EditTextHeading", "Edit"));
+  MenuBuilder.AddMenuEntry(
+      LOCTEXT("Undo", "Undo"), FText::GetEmpty(), FSlateIcon(),
+      FUIAction(FExecuteAction::CreateSP(this, &SCodeEditableText::Undo),
+                FCanExecuteAction::CreateLambda(CanEdit)));
+  MenuBuilder.AddMenuEntry(
+      LOCTEXT("Redo", "Redo"), FText::GetEmpty(), FSlateIcon(),
+      FUIAction(FExecuteAction::CreateSP(this, &SCodeEditableText::Redo),
+                FCanExecuteAction::CreateLambda(CanEdit)));
+  MenuBuilder.AddMenuSeparator();
+  MenuBuilder.AddMenuEntry(
+      LOCTEXT("Cut", "Cut"), FText::GetEmpty(), FSlateIcon(),
+      FUIAction(FExecuteAction::CreateLambda([WeakEditor]() {
+                  if (TSharedPtr<SMultiLineEditableText> Editor =
+                          WeakEditor.Pin()) {
+                    FPlatformApplicationMisc::ClipboardCopy(
+                        *Editor->GetSelectedText().ToString());
+                    Editor->InsertTextAtCursor(FString());
+                  }
+                }),
+                FCanExecuteAction::CreateLambda([WeakEditor, bCanEdit]() {
+                  TSharedPtr<SMultiLineEditableText> Editor =
+                      WeakEditor.Pin();
+                  return bCanEdit && Editor.IsValid() &&
+                         Editor->AnyTextSelected();
+                })));
+  MenuBuilder.AddMenuEntry(
+      LOCTEXT("Copy", "Copy"), FText::GetEmpty(), FSlateIcon(),
+      FUIAction(FExecuteAction::CreateLambda([WeakEditor]() {
+                  if (TSharedPtr<SMultiLineEditableText> Editor =
+                          WeakEditor.Pin()) {
+                    FPlatformApplicationMisc::ClipboardCopy(
+                        *Editor->GetSelectedText().ToString());
+                  }
+                }),
+                FCanExecuteAction::CreateLambda([WeakEditor]() {
+                  TSharedPtr<SMultiLineEditableText> Editor =
+                      WeakEditor.Pin();
+                  return Editor.IsValid() && Editor->AnyTextSelected();
+                })));
+  MenuBuilder.AddMenuEntry(
+      LOCTEXT("Paste", "Paste"), FText::GetEmpty(), FSlateIcon(),
+      FUIAction(FExecuteAction::CreateLambda([WeakEditor]() {
+                  if (TSharedPtr<SMultiLineEditableText> Editor =
+                          WeakEditor.Pin()) {
+                    FString Pasted;
+                    FPlatformApplicationMisc::ClipboardPaste(Pasted);
+                    Editor->InsertTextAtCursor(Pasted);
+                  }
+                }),
+                FCanExecuteAction::CreateLambda(CanEdit)));
+  MenuBuilder.AddMenuSeparator();
+  MenuBuilder.AddMenuEntry(
+      LOCTEXT("SelectAll", "Select All"), FText::GetEmpty(), FSlateIcon(),
+      FUIAction(FExecuteAction::CreateLambda([WeakEditor]() {
+        if (TSharedPtr<SMultiLineEditableText> Editor = WeakEditor.Pin()) {
+          Editor->SelectAllText();
+        }
+      })));
+  MenuBuilder.EndSection();
+  return MenuBuilder.MakeWidget();
+}
+
+void SCodeEditableText::SetFindResults(
+    TSharedPtr<const FCodeFindResults> Results, int32 CurrentMatch) {
+  if (FindHighlightsWidget.IsValid()) {
+    FindHighlightsWidget->SetResults(Results, CurrentMatch);
+  }
+}
+
+FString SCodeEditableText::GetIdentifierAt(int32 Offset) const {
+  const FString &Text = Document->GetText();
+  auto IsIdentifierChar = [&Text](int32 Index) {
+    return Text.IsValidIndex(Index) &&
+           (FChar::IsAlnum(Text[Index]) || Text[Index] == TEXT('_'));
+  };
+
+  // A cursor just after a name still refers to it
+  if (!IsIdentifierChar(Offset)) {
+    --Offset;
+  }
+  if (!IsIdentifierChar(Offset)) {
+    return FString();
+  }
+
+  int32 Start = Offset;
+  while (IsIdentifierChar(Start - 1)) {
+    --Start;
+  }
+  int32 End = Offset + 1;
+  while (IsIdentifierChar(End)) {
+    ++End;
+  }
+  if (FChar::IsDigit(Text[Start])) {
+    return FString();
+  }
+  return Text.Mid(Start, End - Start);
+}
+
+int32 SCodeEditableText::GetOffsetAtScreenPosition(
+    const FVector2D &ScreenPosition) const {
+  if (!TextEditor.IsValid() || DisplayedLineStarts.Num() == 0) {
+    return INDEX_NONE;
+  }
+
+  // The font is monospaced and every line is the same height, as the indent
+  // guides and find highlights assume too
+  const FGeometry &Geometry = TextEditor->GetCachedGeometry();
+  const FVector2D Local = Geometry.AbsoluteToLocal(ScreenPosition);
+  if (Local.X < 0.0 || Local.Y < 0.0 || CharacterWidth <= 0.0f) {
+    return INDEX_NONE;
+  }
+  const int32 DisplayLine = FMath::FloorToInt(
+      static_cast<float>(Local.Y) / CodeEditorStyle::LineHeight);
+  if (!DisplayedLineStarts.IsValidIndex(DisplayLine)) {
+    return INDEX_NONE;
+  }
+
+  const int32 LineStart = DisplayedLineStarts[DisplayLine];
+  const int32 LineEnd = DisplayedLineStarts.IsValidIndex(DisplayLine + 1)
+                            ? DisplayedLineStarts[DisplayLine + 1] - 1
+                            : DisplayedText.Len();
+  const int32 Column =
+      FMath::FloorToInt(static_cast<float>(Local.X) / CharacterWidth);
+  if (LineStart + Column >= LineEnd) {
+    return INDEX_NONE;
+  }
+  return DisplayToDocumentOffset(LineStart + Column);
+}
+
+bool SCodeEditableText::RequestDefinition(int32 Offset, bool bPeek) {
+  if (!OnGoToDefinitionCallback.IsBound() || Offset == INDEX_NONE) {
+    return false;
+  }
+
+  const FString Identifier = GetIdentifierAt(Offset);
+  if (Identifier.IsEmpty()) {
+    return false;
+  }
+  OnGoToDefinitionCallback.Execute(Identifier, bPeek);
+  return true;
+}
+
+FReply SCodeEditableText::OnKeyDown(const FGeometry &MyGeometry,
+                                    const FKeyEvent &InKeyEvent) {
+  // F12 goes to the declaration, Alt+F12 peeks at it
+  if (InKeyEvent.GetKey() == EKeys::F12 && !InKeyEvent.IsControlDown() &&
+      !InKeyEvent.IsShiftDown() &&
+      RequestDefinition(GetCursorOffset(), InKeyEvent.IsAltDown())) {
+    return FReply::Handled();
+  }
+
+  // Shift+F12 lists the uses
+  if (InKeyEvent.GetKey() == EKeys::F12 && InKeyEvent.IsShiftDown() &&
+      !InKeyEvent.IsControlDown() && !InKeyEvent.IsAltDown() &&
+      OnFindReferencesCallback.IsBound()) {
+    const FString Identifier = GetIdentifierAt(GetCursorOffset());
+    if (!Identifier.IsEmpty()) {
+      OnFindReferencesCallback.Execute(Identifier);
+      return FReply::Handled();
+    }
+  }
+
+  // F2 renames it everywhere
+  if (InKeyEvent.GetKey() == EKeys::F2 && !InKeyEvent.IsShiftDown() &&
+      !InKeyEvent.IsControlDown() && !InKeyEvent.IsAltDown() &&
+      !bIsReadOnly && OnRenameSymbolCallback.IsBound()) {
+    const FString Identifier = GetIdentifierAt(GetCursorOffset());
+    if (!Identifier.IsEmpty()) {
+      OnRenameSymbolCallback.Execute(Identifier);
+      return FReply::Handled();
+    }
+  }
+  return SCompoundWidget::OnKeyDown(MyGeometry, InKeyEvent);
+}
+
+FReply
+SCodeEditableText::OnPreviewMouseButtonDown(const FGeometry &MyGeometry,
+                                            const FPointerEvent &MouseEvent) {
+  // Ctrl+click is taken before the text editor would start a selection
+  if (MouseEvent.GetEffectingButton() == EKeys::LeftMouseButton &&
+      MouseEvent.IsControlDown() && !MouseEvent.IsShiftDown() &&
+      !MouseEvent.IsAltDown() &&
+      RequestDefinition(
+          GetOffsetAtScreenPosition(MouseEvent.GetScreenSpacePosition()),
+          false)) {
+    return FReply::Handled();
+  }
+  return SCompoundWidget::OnPreviewMouseButtonDown(MyGeometry, MouseEvent);
+}
+
+FText SCodeEditableText::GetText() const {
+  return FText::FromString(Document->GetText());
+}
+
+void SCodeEditableText::SetText(const FText &InText) {
+  // Replacing the text is an edit like any other, so every view of the
+  // document picks it up
+  const FCodeTextEdit Edit =
+      FCodeTextEdit::FromDiff(Document->GetText(), InText.ToString());
+  if (!Edit.IsEmpty()) {
+    Document->ApplyEdit(Edit);
+  }
+}
+
+FString SCodeEditableText::GetPlainText() const { return Document->GetText(); }
 
 void SCodeEditableText::SetPlainText(const FString &InText) {
   SetText(FText::FromString(InText));
@@ -556,18 +932,162 @@ void SCodeEditableText::HandleTextChanged(const FText &NewText) {
     return;
   }
 
-  bIsModified = true;
-  OriginalText = NewText.ToString();
-  DisplayedText = OriginalText;
+  FString NewString = NewText.ToString();
+  const FCodeTextEdit DisplayedEdit =
+      FCodeTextEdit::FromDiff(DisplayedText, NewString);
+  if (DisplayedEdit.IsEmpty()) {
+    return;
+  }
 
-  ParseLines();
-  ParseFoldRegions();
-  CalculateLineIndentLevels();
-  RebuildFoldingGutter();
-  UpdateIndentGuides();
+  // The edit was made in the displayed text, which differs from the document
+  // wherever regions are folded
+  FCodeTextEdit Edit;
+  Edit.Offset = DisplayToDocumentOffset(DisplayedEdit.Offset);
+  Edit.RemovedLength =
+      DisplayToDocumentOffset(DisplayedEdit.Offset +
+                              DisplayedEdit.RemovedLength) -
+      Edit.Offset;
+  Edit.InsertedText = DisplayedEdit.InsertedText;
+
+  // The editor already shows the new text; HandleDocumentEdited only has to
+  // refresh it if folding changes what should be displayed
+  DisplayedText = MoveTemp(NewString);
+  bIsTypingEdit = true;
+  Document->ApplyEdit(Edit);
+  bIsTypingEdit = false;
+
+  OnTextEditedCallback.ExecuteIfBound(Edit);
   OnTextChangedCallback.ExecuteIfBound(NewText);
 }
 
+/** Line and column of Offset in a text whose lines start at LineStarts */
+static FTextLocation GetTextLocation(const TArray<int32> &LineStarts,
+                                     int32 Offset) {
+  const int32 Line =
+      FMath::Max(0, Algo::UpperBound(LineStarts, Offset) - 1);
+  return FTextLocation(
+      Line, Offset - (LineStarts.IsValidIndex(Line) ? LineStarts[Line] : 0));
+}
+
+void SCodeEditableText::HandleDocumentEdited(const FCodeTextEdit &Edit) {
+  const FCodeDocumentLines &Lines = Document->GetLines();
+  const int32 EditLine =
+      FMath::Max(0, Algo::UpperBound(Lines.LineStarts, Edit.Offset) - 1);
+  const int32 LineDelta = Lines.Num() - TotalLines;
+
+  // Keep folds and the cursor on the same code when lines above them were
+  // added or removed
+  TArray<int32> FoldedLines = GetFoldedLines();
+  const bool bWasFolded = FoldedLines.Num() > 0;
+  for (int32 &FoldedLine : FoldedLines) {
+    if (FoldedLine > EditLine) {
+      FoldedLine += LineDelta;
+    }
+  }
+
+  FTextLocation Cursor = TextEditor->GetCursorLocation();
+  int32 CursorLine = DisplayToOriginalLine.IsValidIndex(Cursor.GetLineIndex())
+                         ? DisplayToOriginalLine[Cursor.GetLineIndex()]
+                         : Cursor.GetLineIndex();
+  if (CursorLine > EditLine) {
+    CursorLine += LineDelta;
+  }
+
+  const TArray<FCodeFoldRegion> OldFoldRegions = MoveTemp(FoldRegions);
+  FoldRegions = Lines.FoldRegions;
+  bool bIsFolded = false;
+  for (FCodeFoldRegion &Region : FoldRegions) {
+    Region.bIsFolded = FoldedLines.Contains(Region.StartLine);
+    bIsFolded |= Region.bIsFolded;
+  }
+  TotalLines = FMath::Max(1, Lines.Num());
+
+  // Only the edited range of the displayed text is replaced, so the editor
+  // re-lays out only the lines edited
+  FTextLocation EditStart;
+  FTextLocation EditEnd;
+  FString InsertedText;
+  bool bReplace = false;
+  if (!bWasFolded && !bIsFolded) {
+    // Nothing folded: the editor shows the document as it is
+    if (!bIsTypingEdit) {
+      EditStart = GetTextLocation(DisplayedLineStarts, Edit.Offset);
+      EditEnd = GetTextLocation(DisplayedLineStarts,
+                                Edit.Offset + Edit.RemovedLength);
+      InsertedText = Edit.InsertedText;
+      bReplace = Edit.ApplyTo(DisplayedText);
+    }
+    DisplayedLineStarts = Lines.LineStarts;
+    DisplayToOriginalLine.SetNumUninitialized(Lines.Num());
+    for (int32 Line = 0; Line < Lines.Num(); ++Line) {
+      DisplayToOriginalLine[Line] = Line;
+    }
+  } else {
+    FString NewDisplayedText = BuildDisplayedText();
+    const FCodeTextEdit DisplayedEdit =
+        FCodeTextEdit::FromDiff(DisplayedText, NewDisplayedText);
+    if (!DisplayedEdit.IsEmpty()) {
+      const int32 End = DisplayedEdit.Offset + DisplayedEdit.RemovedLength;
+      TArray<int32> OldLineStarts = {0};
+      for (int32 Index = 0; Index < End; ++Index) {
+        if (DisplayedText[Index] == '\n') {
+          OldLineStarts.Add(Index + 1);
+        }
+      }
+      EditStart = GetTextLocation(OldLineStarts, DisplayedEdit.Offset);
+      EditEnd = GetTextLocation(OldLineStarts, End);
+      InsertedText = DisplayedEdit.InsertedText;
+      bReplace = true;
+    }
+    DisplayedText = MoveTemp(NewDisplayedText);
+  }
+
+  if (bReplace) {
+    ReplaceDisplayedRange(EditStart, EditEnd, InsertedText);
+
+    const int32 DisplayedLine = DisplayToOriginalLine.Find(CursorLine);
+    bIsUpdatingText = true;
+    TextEditor->GoTo(FTextLocation(
+        DisplayedLine != INDEX_NONE ? DisplayedLine : Cursor.GetLineIndex(),
+        Cursor.GetOffset()));
+    bIsUpdatingText = false;
+  }
+
+  // The gutter only changes with the lines shown or the regions on them
+  bool bGutterChanged = LineDelta != 0 || bWasFolded != bIsFolded ||
+                        OldFoldRegions.Num() != FoldRegions.Num();
+  for (int32 Index = 0; !bGutterChanged && Index < FoldRegions.Num();
+       ++Index) {
+    const FCodeFoldRegion &Old = OldFoldRegions[Index];
+    const FCodeFoldRegion &New = FoldRegions[Index];
+    bGutterChanged = Old.StartLine != New.StartLine ||
+                     Old.bIsFolded != New.bIsFolded ||
+                     (New.bIsFolded && Old.EndLine != New.EndLine);
+  }
+  if (bGutterChanged) {
+    RebuildFoldingGutter();
+  }
+  UpdateIndentGuides();
+  UpdateFindHighlights();
+}
+
+void SCodeEditableText::ReplaceDisplayedRange(const FTextLocation &Start,
+                                              const FTextLocation &End,
+                                              const FString &Text) {
+  bIsUpdatingText = true;
+  if (bIsReadOnly) {
+    // A read-only editor ignores inserted text
+    TextEditor->SetText(FText::FromString(DisplayedText));
+  } else {
+    // The editor's own undo history is never used; the document's is
+    TextEditor->BeginEditTransaction();
+    TextEditor->SelectText(Start, End);
+    TextEditor->InsertTextAtCursor(Text);
+    TextEditor->EndEditTransaction();
+  }
+  bIsUpdatingText = false;
+}
+
 void SCodeEditableText::HandleCursorMoved(const FTextLocation &NewLocation) {
   int32 DisplayedLine = NewLocation.GetLineIndex();
 
@@ -581,10 +1101,4 @@ void SCodeEditableText::HandleCursorMoved(const FTextLocation &NewLocation) {
   OnCursorMovedCallback.ExecuteIfBound();
 }
 
-void SCodeEditableText::ParseLines() {
-  TArray<FString> Lines;
-  OriginalText.ParseIntoArray(Lines, TEXT("\n"), false);
-  TotalLines = FMath::Max(1, Lines.Num());
-}
-
 #undef LOCTEXT_NAMESPACE
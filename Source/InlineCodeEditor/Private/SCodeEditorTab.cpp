@@ -1,15 +1,29 @@
 // Copyright Yureka. All Rights Reserved.
 
 #include "SCodeEditorTab.h"
+#include "Algo/StableSort.h"
+#include "CodeDocument.h"
+#include "CodeEditJournal.h"
+#include "CodeRename.h"
+#include "CodeSymbolIndex.h"
+#include "FCppSyntaxHighlighter.h"
+#include "FindInFiles.h"
 #include "Framework/Application/SlateApplication.h"
+#include "HAL/IConsoleManager.h"
 #include "Misc/FileHelper.h"
+#include "Misc/MessageDialog.h"
 #include "Misc/Paths.h"
 #include "SCodeEditableText.h"
+#include "SCodeFindBar.h"
+#include "SCodePeekView.h"
 #include "Styling/AppStyle.h"
 #include "Widgets/Input/SButton.h"
 #include "Widgets/Input/SEditableTextBox.h"
 #include "Widgets/Layout/SBorder.h"
 #include "Widgets/Layout/SBox.h"
+#include "Widgets/Layout/SScrollBox.h"
+#include "Widgets/Layout/SSplitter.h"
+#include "Widgets/SOverlay.h"
 #include "Widgets/Text/STextBlock.h"
 
 #define LOCTEXT_NAMESPACE "SCodeEditorTab"
@@ -21,8 +35,22 @@ const FLinearColor StatusBarBackground =
     FLinearColor::FromSRGBColor(FColor::FromHex("007ACCFF")); // Blue bar
 const FLinearColor EditorBackground =
     FLinearColor::FromSRGBColor(FColor::FromHex("1E1E1EFF")); // VSCode dark
+const FLinearColor ActiveTabBackground =
+    FLinearColor::FromSRGBColor(FColor::FromHex("1E1E1EFF")); // Same as editor
+const FLinearColor InactiveTabBackground =
+    FLinearColor::FromSRGBColor(FColor::FromHex("2D2D2DFF")); // Tab strip
+const FLinearColor ActiveTabText = FLinearColor::White;
+const FLinearColor InactiveTabText =
+    FLinearColor::FromSRGBColor(FColor::FromHex("969696FF"));
 } // namespace EditorColors
 
+static TAutoConsoleVariable<int32> CVarICELayoutBudgetMB(
+    TEXT("ICE.Editor.LayoutBudgetMB"), 64,
+    TEXT("Approximate memory (MB) the ICE editor may spend on text layouts of ")
+        TEXT("open documents. Least recently viewed documents beyond this ")
+        TEXT("budget release their layout and rebuild it when shown again."),
+    ECVF_Default);
+
 void SCodeEditorTab::Construct(const FArguments &InArgs) {
   ChildSlot
       [SNew(SVerticalBox)
@@ -30,32 +58,82 @@ void SCodeEditorTab::Construct(const FArguments &InArgs) {
        // Toolbar
        + SVerticalBox::Slot().AutoHeight()[CreateToolbar()]
 
-       // Main editor area
-       +
-       SVerticalBox::Slot().FillHeight(1.0f)
-           [SNew(SBorder)
-                .BorderBackgroundColor(EditorColors::EditorBackground)
-                .BorderImage(FCoreStyle::Get().GetBrush("NoBorder"))
-                .Padding(0)
-                    [SAssignNew(CodeEditor, SCodeEditableText)
-                         .Text(FText::FromString(TEXT(
-                             "// Welcome to Pure Slate Code Editor\n// Open a "
-                             "file to begin editing\n\n#include "
-                             "\"CoreMinimal.h\"\n\nUCLASS()\nclass AMyActor : "
-                             "public AActor\n{\n    "
-                             "GENERATED_BODY()\n\npublic:\n    "
-                             "UPROPERTY(EditAnywhere, BlueprintReadWrite)\n    "
-                             "FString MyProperty;\n\n    "
-                             "UFUNCTION(BlueprintCallable)\n    void "
-                             "MyFunction()\n    {\n        UE_LOG(LogTemp, "
-                             "Log, TEXT(\"Hello from Pure Slate!\"));\n    "
-                             "}\n};\n")))
-                         .OnTextChanged(this, &SCodeEditorTab::OnTextChanged)
-                         .OnCursorMoved(this, &SCodeEditorTab::OnCursorMoved)]]
+       // Open documents
+       + SVerticalBox::Slot().AutoHeight()[CreateDocumentTabBar()]
+
+       // Find and replace
+       + SVerticalBox::Slot().AutoHeight()
+             [SAssignNew(FindBar, SCodeFindBar)
+                  .Visibility_Lambda([this]() {
+                    return bFindBarVisible ? EVisibility::Visible
+                                           : EVisibility::Collapsed;
+                  })
+                  .OnClosed(this, &SCodeEditorTab::HideFindBar)]
+
+       // Main editor area, with the peek popup over it
+       + SVerticalBox::Slot().FillHeight(1.0f)
+             [SNew(SOverlay)
+
+              + SOverlay::Slot()
+                    [SNew(SBorder)
+                         .BorderBackgroundColor(EditorColors::EditorBackground)
+                         .BorderImage(FCoreStyle::Get().GetBrush("NoBorder"))
+                         .Padding(0)[SAssignNew(PaneSplitter, SSplitter)
+                                         .Orientation(Orient_Horizontal)]]
+
+              + SOverlay::Slot()
+                    .HAlign(HAlign_Fill)
+                    .VAlign(VAlign_Bottom)
+                    .Padding(FMargin(16))
+                        [SAssignNew(PeekView, SCodePeekView)
+                             .Visibility_Lambda([this]() {
+                               return bPeekVisible ? EVisibility::Visible
+                                                   : EVisibility::Collapsed;
+                             })
+                             .OnGetDocument(
+                                 this,
+                                 &SCodeEditorTab::GetSymbolLocationDocument)
+                             .OnOpen(this, &SCodeEditorTab::OpenSymbolLocation)
+                             .OnClosed(this, &SCodeEditorTab::HidePeek)]]
 
        // Status bar
        + SVerticalBox::Slot().AutoHeight()[CreateStatusBar()]];
 
+  AddPane();
+
+  // Bring back buffers that were left unsaved by a crash
+  TArray<FRecoveredCodeDocument> RecoveredDocuments;
+  FCodeEditJournal::RecoverDocuments(RecoveredDocuments);
+  for (const FRecoveredCodeDocument &Recovered : RecoveredDocuments) {
+    TSharedRef<FCodeDocument> Document =
+        FCodeDocument::Create(Recovered.FilePath, Recovered.Text);
+    Document->ResumeJournal(FCodeEditJournal::Resume(Recovered));
+    Documents.Add(Document);
+  }
+
+  if (Documents.Num() > 0) {
+    ActivateDocument(Documents[0]);
+    if (StatusMessage.IsValid()) {
+      StatusMessage->SetText(FText::Format(
+          LOCTEXT("RecoveredFiles", "Recovered {0} unsaved file(s)"),
+          FText::AsNumber(Documents.Num())));
+    }
+  } else {
+    AddDocument(FCodeDocument::Create(
+        FString(),
+        TEXT("// Welcome to Pure Slate Code Editor\n// Open a "
+             "file to begin editing\n\n#include "
+             "\"CoreMinimal.h\"\n\nUCLASS()\nclass AMyActor : "
+             "public AActor\n{\n    "
+             "GENERATED_BODY()\n\npublic:\n    "
+             "UPROPERTY(EditAnywhere, BlueprintReadWrite)\n    "
+             "FString MyProperty;\n\n    "
+             "UFUNCTION(BlueprintCallable)\n    void "
+             "MyFunction()\n    {\n        UE_LOG(LogTemp, "
+             "Log, TEXT(\"Hello from Pure Slate!\"));\n    "
+             "}\n};\n")));
+  }
+
   UE_LOG(LogTemp, Log, TEXT("InlineCodeEditor: Pure Slate editor initialized"));
 }
 
@@ -95,6 +173,50 @@ TSharedRef<SWidget> SCodeEditorTab::CreateToolbar() {
                     1)[SNew(SBorder).BorderBackgroundColor(
                     FLinearColor(0.3f, 0.3f, 0.3f))]]
 
+              // Split right
+              + SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 4, 0)
+                    [SNew(SButton)
+                         .Text(LOCTEXT("SplitRight", "Split Right"))
+                         .ToolTipText(LOCTEXT("SplitRightTooltip",
+                                              "Show the current file in a "
+                                              "second pane to the right"))
+                         .OnClicked_Lambda([this]() {
+                           SplitEditor(Orient_Horizontal);
+                           return FReply::Handled();
+                         })]
+
+              // Split down
+              + SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 4, 0)
+                    [SNew(SButton)
+                         .Text(LOCTEXT("SplitDown", "Split Down"))
+                         .ToolTipText(LOCTEXT("SplitDownTooltip",
+                                              "Show the current file in a "
+                                              "second pane below"))
+                         .OnClicked_Lambda([this]() {
+                           SplitEditor(Orient_Vertical);
+                           return FReply::Handled();
+                         })]
+
+              // Unsplit
+              + SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 4, 0)
+                    [SNew(SButton)
+                         .Text(LOCTEXT("Unsplit", "Unsplit"))
+                         .ToolTipText(LOCTEXT("UnsplitTooltip",
+                                              "Close every pane but the "
+                                              "active one"))
+                         .IsEnabled_Lambda(
+                             [this]() { return Panes.Num() > 1; })
+                         .OnClicked_Lambda([this]() {
+                           UnsplitEditor();
+                           return FReply::Handled();
+                         })]
+
+              // Separator
+              + SHorizontalBox::Slot().AutoWidth().Padding(
+                    8, 0)[SNew(SBox).WidthOverride(
+                    1)[SNew(SBorder).BorderBackgroundColor(
+                    FLinearColor(0.3f, 0.3f, 0.3f))]]
+
               // Go to line label
               + SHorizontalBox::Slot()
                     .AutoWidth()
@@ -123,11 +245,103 @@ TSharedRef<SWidget> SCodeEditorTab::CreateToolbar() {
                                   }
                                 })]]
 
+              // Find and replace
+              + SHorizontalBox::Slot().AutoWidth().Padding(4, 0, 4, 0)
+                    [SNew(SButton)
+                         .Text(LOCTEXT("Find", "Find"))
+                         .ToolTipText(LOCTEXT("FindTooltip",
+                                              "Find and replace in the "
+                                              "current file (Ctrl+F)"))
+                         .OnClicked_Lambda([this]() {
+                           ShowFindBar(false);
+                           return FReply::Handled();
+                         })]
+
               // Spacer
               +
               SHorizontalBox::Slot().FillWidth(1.0f)[SNullWidget::NullWidget]];
 }
 
+TSharedRef<SWidget> SCodeEditorTab::CreateDocumentTabBar() {
+  return SNew(SBorder)
+      .BorderBackgroundColor(EditorColors::ToolbarBackground)
+      .BorderImage(FCoreStyle::Get().GetBrush("NoBorder"))
+      .Padding(0)[SNew(SScrollBox)
+                      .Orientation(Orient_Horizontal)
+                      .ScrollBarVisibility(EVisibility::Collapsed) +
+                  SScrollBox::Slot()[SAssignNew(DocumentTabBar,
+                                                SHorizontalBox)]];
+}
+
+void SCodeEditorTab::RebuildDocumentTabs() {
+  if (!DocumentTabBar.IsValid()) {
+    return;
+  }
+
+  DocumentTabBar->ClearChildren();
+
+  for (const TSharedPtr<FCodeDocument> &Document : Documents) {
+    TWeakPtr<FCodeDocument> WeakDocument = Document;
+    const bool bIsActive = Document == ActiveDocument;
+
+    DocumentTabBar->AddSlot().AutoWidth().Padding(0, 0, 1, 0)
+        [SNew(SBorder)
+             .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+             .BorderBackgroundColor(bIsActive
+                                        ? EditorColors::ActiveTabBackground
+                                        : EditorColors::InactiveTabBackground)
+             .Padding(FMargin(8, 4, 4, 4))
+                 [SNew(SHorizontalBox)
+
+                  // Document name (with unsaved marker)
+                  + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+                        [SNew(SButton)
+                             .ButtonStyle(FAppStyle::Get(), "NoBorder")
+                             .ContentPadding(FMargin(0))
+                             .ToolTipText(FText::FromString(
+                                 Document->GetFilePath()))
+                             .OnClicked_Lambda([this, WeakDocument]() {
+                               ActivateDocument(WeakDocument.Pin());
+                               return FReply::Handled();
+                             })[SNew(STextBlock)
+                                    .Text_Lambda([WeakDocument]() {
+                                      TSharedPtr<FCodeDocument> Pinned =
+                                          WeakDocument.Pin();
+                                      if (!Pinned.IsValid()) {
+                                        return FText::GetEmpty();
+                                      }
+                                      FString Label = Pinned->GetDisplayName();
+                                      if (Pinned->IsModified()) {
+                                        Label += TEXT(" \u25CF");
+                                      }
+                                      return FText::FromString(Label);
+                                    })
+                                    .ColorAndOpacity(
+                                        bIsActive ? EditorColors::ActiveTabText
+                                                  : EditorColors::
+                                                        InactiveTabText)]]
+
+                  // Close button
+                  + SHorizontalBox::Slot()
+                        .AutoWidth()
+                        .VAlign(VAlign_Center)
+                        .Padding(6, 0, 0, 0)
+                            [SNew(SButton)
+                                 .ButtonStyle(FAppStyle::Get(), "NoBorder")
+                                 .ContentPadding(FMargin(2, 0))
+                                 .ToolTipText(
+                                     LOCTEXT("CloseDocument", "Close"))
+                                 .OnClicked_Lambda([this, WeakDocument]() {
+                                   CloseDocument(WeakDocument.Pin());
+                                   return FReply::Handled();
+                                 })[SNew(STextBlock)
+                                        .Text(FText::FromString(
+                                            TEXT("\u2715")))
+                                        .ColorAndOpacity(
+                                            EditorColors::InactiveTabText)]]]];
+  }
+}
+
 TSharedRef<SWidget> SCodeEditorTab::CreateStatusBar() {
   return SNew(SBorder)
       .BorderBackgroundColor(EditorColors::StatusBarBackground)
@@ -159,6 +373,12 @@ TSharedRef<SWidget> SCodeEditorTab::CreateStatusBar() {
 }
 
 void SCodeEditorTab::OpenFile(const FString &FilePath) {
+  // Already open: switching is just showing its view again
+  if (TSharedPtr<FCodeDocument> Existing = FindDocument(FilePath)) {
+    ActivateDocument(Existing);
+    return;
+  }
+
   if (!FPaths::FileExists(FilePath)) {
     UE_LOG(LogTemp, Warning, TEXT("InlineCodeEditor: File not found: %s"),
            *FilePath);
@@ -172,16 +392,7 @@ void SCodeEditorTab::OpenFile(const FString &FilePath) {
     return;
   }
 
-  CurrentFilePath = FilePath;
-
-  if (CodeEditor.IsValid()) {
-    CodeEditor->SetPlainText(FileContent);
-    CodeEditor->SetFilePath(FilePath);
-    CodeEditor->ClearModified();
-    CodeEditor->FocusEditor();
-  }
-
-  bHasUnsavedChanges = false;
+  AddDocument(FCodeDocument::Create(FilePath, FileContent));
 
   // Update status
   if (StatusMessage.IsValid()) {
@@ -190,76 +401,544 @@ void SCodeEditorTab::OpenFile(const FString &FilePath) {
                                          FText::FromString(FileName)));
   }
 
-  // Update language display
-  if (StatusLanguage.IsValid()) {
-    FString Ext = FPaths::GetExtension(FilePath).ToLower();
-    if (Ext == TEXT("cpp") || Ext == TEXT("cc") || Ext == TEXT("cxx")) {
-      StatusLanguage->SetText(LOCTEXT("LangCpp", "C++"));
-    } else if (Ext == TEXT("h") || Ext == TEXT("hpp")) {
-      StatusLanguage->SetText(LOCTEXT("LangHeader", "C++ Header"));
-    } else if (Ext == TEXT("c")) {
-      StatusLanguage->SetText(LOCTEXT("LangC", "C"));
-    } else {
-      StatusLanguage->SetText(LOCTEXT("LangPlain", "Plain Text"));
-    }
-  }
-
   UE_LOG(LogTemp, Log, TEXT("InlineCodeEditor: Opened %s"), *FilePath);
 }
 
+FString SCodeEditorTab::GetCurrentFilePath() const {
+  return ActiveDocument.IsValid() ? ActiveDocument->GetFilePath() : FString();
+}
+
 bool SCodeEditorTab::SaveFile() {
-  if (CurrentFilePath.IsEmpty()) {
+  if (!ActiveDocument.IsValid() || ActiveDocument->IsUntitled()) {
     if (StatusMessage.IsValid()) {
       StatusMessage->SetText(LOCTEXT("NoFile", "No file to save"));
     }
     return false;
   }
 
-  if (!CodeEditor.IsValid()) {
-    return false;
-  }
-
-  FString Content = CodeEditor->GetPlainText();
+  const FString &FilePath = ActiveDocument->GetFilePath();
 
-  if (!FFileHelper::SaveStringToFile(Content, *CurrentFilePath)) {
-    UE_LOG(LogTemp, Error, TEXT("InlineCodeEditor: Failed to save file: %s"),
-           *CurrentFilePath);
+  if (!ActiveDocument->Save()) {
     if (StatusMessage.IsValid()) {
       StatusMessage->SetText(LOCTEXT("SaveFailed", "Save failed!"));
     }
     return false;
   }
 
-  CodeEditor->ClearModified();
-  bHasUnsavedChanges = false;
-
   if (StatusMessage.IsValid()) {
-    FString FileName = FPaths::GetCleanFilename(CurrentFilePath);
+    FString FileName = FPaths::GetCleanFilename(FilePath);
     StatusMessage->SetText(FText::Format(LOCTEXT("SavedFile", "Saved: {0}"),
                                          FText::FromString(FileName)));
   }
 
-  UE_LOG(LogTemp, Log, TEXT("InlineCodeEditor: Saved %s"), *CurrentFilePath);
+  UE_LOG(LogTemp, Log, TEXT("InlineCodeEditor: Saved %s"), *FilePath);
+  FileSavedEvent.Broadcast(FilePath);
   return true;
 }
 
 bool SCodeEditorTab::HasUnsavedChanges() const {
+  return ActiveDocument.IsValid() && ActiveDocument->IsModified();
+}
+
+void SCodeEditorTab::GoToLine(int32 LineNumber) {
+  if (CodeEditor.IsValid() && LineNumber > 0) {
+    CodeEditor->GoToLine(LineNumber);
+    CodeEditor->FocusEditor();
+  }
+}
+
+void SCodeEditorTab::ActivateDocument(TSharedPtr<FCodeDocument> Document) {
+  if (!Document.IsValid() || !Panes.IsValidIndex(ActivePane)) {
+    return;
+  }
+
+  ShowDocumentInPane(ActivePane, Document);
+  SetActivePane(ActivePane);
   if (CodeEditor.IsValid()) {
-    return CodeEditor->IsModified();
+    CodeEditor->FocusEditor();
   }
-  return bHasUnsavedChanges;
+  EnforceLayoutBudget();
 }
 
-FReply SCodeEditorTab::OnNewFileClicked() {
-  CurrentFilePath.Empty();
+void SCodeEditorTab::SplitEditor(EOrientation Orientation) {
+  if (!PaneSplitter.IsValid()) {
+    return;
+  }
+
+  PaneSplitter->SetOrientation(Orientation);
+  if (Panes.Num() > 1 || !ActiveDocument.IsValid()) {
+    return;
+  }
+
+  // The new pane gets its own view of the same document, starting where the
+  // active one is
+  const int32 CursorLine =
+      CodeEditor.IsValid() ? CodeEditor->GetCursorLine() : 1;
+  TSharedPtr<FCodeDocument> Document = ActiveDocument;
+
+  AddPane();
+  const int32 NewPane = Panes.Num() - 1;
+  ShowDocumentInPane(NewPane, Document);
+  Panes[NewPane].Views[Document]->GoToLine(CursorLine);
+
+  SetActivePane(NewPane);
+  CodeEditor->FocusEditor();
+  EnforceLayoutBudget();
+}
+
+void SCodeEditorTab::UnsplitEditor() {
+  if (Panes.Num() <= 1 || !PaneSplitter.IsValid()) {
+    return;
+  }
+
+  for (int32 PaneIndex = Panes.Num() - 1; PaneIndex >= 0; --PaneIndex) {
+    if (PaneIndex != ActivePane) {
+      PaneSplitter->RemoveAt(PaneIndex);
+      Panes.RemoveAt(PaneIndex);
+    }
+  }
+
+  SetActivePane(0);
+}
+
+void SCodeEditorTab::ShowFindBar(bool bReplace) {
+  if (!FindBar.IsValid()) {
+    return;
+  }
+
+  bFindBarVisible = true;
+  FindBar->SetTarget(CodeEditor);
+  FindBar->FocusQuery(bReplace);
+}
 
+void SCodeEditorTab::HideFindBar() {
+  bFindBarVisible = false;
+  if (FindBar.IsValid()) {
+    FindBar->SetTarget(nullptr);
+  }
   if (CodeEditor.IsValid()) {
-    CodeEditor->SetPlainText(TEXT("// New file\n\n"));
-    CodeEditor->ClearModified();
     CodeEditor->FocusEditor();
   }
+}
+
+void SCodeEditorTab::SetSymbolIndex(
+    TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> InIndex) {
+  SymbolIndex = InIndex;
+  bPeekVisible = false;
+}
+
+void SCodeEditorTab::GoToDefinition(const FString &Identifier, bool bPeek) {
+  if (!SymbolIndex.IsValid()) {
+    if (StatusMessage.IsValid()) {
+      StatusMessage->SetText(LOCTEXT("NoSymbolIndex",
+                                     "Go to definition needs the symbol "
+                                     "index (ICE.Symbols.Index)"));
+    }
+    return;
+  }
+
+  // A few probes into the mapped index, however large the project is
+  TArray<FCodeSymbolLocation> Locations;
+  SymbolIndex->Find(Identifier, Locations);
+  if (Locations.Num() == 0) {
+    if (StatusMessage.IsValid()) {
+      StatusMessage->SetText(FText::Format(
+          SymbolIndex->IsReady()
+              ? LOCTEXT("NoDeclaration", "No declaration of {0} found")
+              : LOCTEXT("NoDeclarationYet",
+                        "No declaration of {0} found yet; the symbol index "
+                        "is still being built"),
+          FText::FromString(Identifier)));
+    }
+    return;
+  }
+
+  // Types before the constructors named after them, bodies before
+  // declarations, and this file before others
+  FString CurrentPath =
+      FPaths::ConvertRelativePathToFull(GetCurrentFilePath());
+  const FString RootPrefix = SymbolIndex->GetRootPath() + TEXT("/");
+  CurrentPath = CurrentPath.StartsWith(RootPrefix)
+                    ? CurrentPath.RightChop(RootPrefix.Len())
+                    : FString();
+  auto IsType = [](const FCodeSymbolLocation &Location) {
+    return Location.Kind == ECodeSymbolKind::Class ||
+           Location.Kind == ECodeSymbolKind::Struct ||
+           Location.Kind == ECodeSymbolKind::Enum;
+  };
+  Algo::StableSort(Locations, [&CurrentPath,
+                               &IsType](const FCodeSymbolLocation &A,
+                                        const FCodeSymbolLocation &B) {
+    if (IsType(A) != IsType(B)) {
+      return IsType(A);
+    }
+    if (A.bDefinition != B.bDefinition) {
+      return A.bDefinition;
+    }
+    const bool bACurrent = A.Path == CurrentPath;
+    const bool bBCurrent = B.Path == CurrentPath;
+    if (bACurrent != bBCurrent) {
+      return bACurrent;
+    }
+    const int32 Compare = A.Path.Compare(B.Path);
+    return Compare != 0 ? Compare < 0 : A.Line < B.Line;
+  });
+
+  if (bPeek && PeekView.IsValid()) {
+    bPeekVisible = true;
+    PeekView->SetLocations(Identifier, MoveTemp(Locations));
+    return;
+  }
+
+  const int32 NumLocations = Locations.Num();
+  OpenSymbolLocation(Locations[0]);
+  if (NumLocations > 1 && StatusMessage.IsValid()) {
+    StatusMessage->SetText(
+        FText::Format(LOCTEXT("ManyDeclarations",
+                              "{0}: first of {1} declarations (Alt+F12 "
+                              "shows them all)"),
+                      FText::FromString(Identifier),
+                      FText::AsNumber(NumLocations)));
+  }
+}
+
+void SCodeEditorTab::HidePeek() {
+  bPeekVisible = false;
+  if (CodeEditor.IsValid()) {
+    CodeEditor->FocusEditor();
+  }
+}
+
+bool SCodeEditorTab::CanFindReferences() {
+  if (!SymbolIndex.IsValid()) {
+    if (StatusMessage.IsValid()) {
+      StatusMessage->SetText(LOCTEXT("NoReferenceIndex",
+                                     "Finding references needs the symbol "
+                                     "index (ICE.Symbols.Index)"));
+    }
+    return false;
+  }
+
+  if (!SymbolIndex->IsReady() && StatusMessage.IsValid()) {
+    StatusMessage->SetText(
+        LOCTEXT("ReferencesIncomplete", "The symbol index is still being "
+                                        "built; some references may be "
+                                        "missing"));
+  }
+  return true;
+}
+
+void SCodeEditorTab::FindReferences(const FString &Identifier) {
+  if (CanFindReferences()) {
+    FindReferencesEvent.Broadcast(Identifier);
+  }
+}
+
+void SCodeEditorTab::RenameSymbol(const FString &Identifier) {
+  if (CanFindReferences()) {
+    RenameSymbolEvent.Broadcast(Identifier);
+  }
+}
+
+FCodeRenameResult
+SCodeEditorTab::RenameInDocuments(const FString &RootPath,
+                                  const FString &OldName,
+                                  const FString &NewName,
+                                  TArray<FString> &OutOpenFiles) {
+  FCodeRenameResult Result;
+  OutOpenFiles.Reset();
+  const FString RootPrefix =
+      FPaths::ConvertRelativePathToFull(RootPath) / TEXT("");
+  TSharedPtr<FCppSyntaxTokenizer> Tokenizer;
+  for (const TSharedPtr<FCodeDocument> &Document : Documents) {
+    FString RelativePath =
+        FPaths::ConvertRelativePathToFull(Document->GetFilePath());
+    if (Document->IsUntitled() || !RelativePath.StartsWith(RootPrefix)) {
+      continue;
+    }
+    RelativePath.RightChopInline(RootPrefix.Len());
+    OutOpenFiles.Add(RelativePath);
+    if (!FCodeSymbolIndex::IsSourceFile(RelativePath)) {
+      continue;
+    }
+
+    // The uses in the buffer, not those of the file on disk, whose lines
+    // unsaved edits may have moved
+    if (!Tokenizer.IsValid()) {
+      Tokenizer = FCppSyntaxTokenizer::Create();
+    }
+    TArray<FCodeSymbol> Symbols;
+    FCodeOccurrences Occurrences;
+    FCodeSymbolIndex::ParseSymbols(*Tokenizer, Document->GetText(), Symbols,
+                                   Occurrences);
+    TArray<FFindInFilesMatch> Sites;
+    for (const FIntPoint &Position : Occurrences.Find(OldName)) {
+      FFindInFilesMatch &Site = Sites.AddDefaulted_GetRef();
+      Site.Line = Position.X;
+      Site.Column = Position.Y;
+    }
+
+    int32 NumEdits = 0;
+    const TArray<int32> &LineStarts = Document->GetLines().LineStarts;
+    const FCodeTextEdit Edit = FCodeRename::MakeEdit(
+        Document->GetText(), LineStarts, OldName, NewName, Sites, NumEdits);
+    if (Edit.IsEmpty()) {
+      continue;
+    }
+    Result.ChangedFiles.Add(RelativePath);
+    Result.NumEdits += NumEdits;
+
+    // A live view takes the edit, the active pane's first, so its cursor
+    // follows; the document hands it to the other views
+    bool bApplied = false;
+    for (int32 Index = 0; Index < Panes.Num() && !bApplied; ++Index) {
+      const int32 PaneIndex = (ActivePane + Index) % Panes.Num();
+      if (const TSharedPtr<SCodeEditableText> *View =
+              Panes[PaneIndex].Views.Find(Document)) {
+        (*View)->ApplyEdit(Edit);
+        bApplied = true;
+      }
+    }
+    if (!bApplied) {
+      Document->ApplyEdit(Edit);
+    }
+  }
+  return Result;
+}
+
+void SCodeEditorTab::OpenSymbolLocation(const FCodeSymbolLocation &Location) {
+  if (!SymbolIndex.IsValid()) {
+    return;
+  }
+
+  HidePeek();
+  const FString FilePath =
+      FPaths::Combine(SymbolIndex->GetRootPath(), Location.Path);
+  OpenFile(FilePath);
+  if (FPaths::IsSamePath(GetCurrentFilePath(), FilePath)) {
+    GoToLine(Location.Line);
+  }
+}
+
+TSharedPtr<FCodeDocument> SCodeEditorTab::GetSymbolLocationDocument(
+    const FCodeSymbolLocation &Location) const {
+  if (!SymbolIndex.IsValid()) {
+    return nullptr;
+  }
+
+  const FString FilePath =
+      FPaths::Combine(SymbolIndex->GetRootPath(), Location.Path);
+  if (TSharedPtr<FCodeDocument> Existing = FindDocument(FilePath)) {
+    return Existing;
+  }
+
+  // A scratch document still comes with the file's cached tokens
+  FString Text;
+  if (!FFileHelper::LoadFileToString(Text, *FilePath)) {
+    return nullptr;
+  }
+  return FCodeDocument::CreateTransient(FilePath, Text);
+}
+
+FReply SCodeEditorTab::OnKeyDown(const FGeometry &MyGeometry,
+                                 const FKeyEvent &InKeyEvent) {
+  const FKey Key = InKeyEvent.GetKey();
+  if ((Key == EKeys::F || Key == EKeys::H) && InKeyEvent.IsControlDown() &&
+      !InKeyEvent.IsShiftDown() && !InKeyEvent.IsAltDown()) {
+    ShowFindBar(Key == EKeys::H);
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Escape && bPeekVisible) {
+    HidePeek();
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Escape && bFindBarVisible) {
+    HideFindBar();
+    return FReply::Handled();
+  }
+  return SCompoundWidget::OnKeyDown(MyGeometry, InKeyEvent);
+}
+
+SCodeEditorTab::FEditorPane &SCodeEditorTab::AddPane() {
+  FEditorPane &Pane = Panes.AddDefaulted_GetRef();
+  PaneSplitter->AddSlot()[SAssignNew(Pane.Host, SBox)];
+  return Pane;
+}
+
+void SCodeEditorTab::SetActivePane(int32 PaneIndex) {
+  if (!Panes.IsValidIndex(PaneIndex)) {
+    return;
+  }
+
+  ActivePane = PaneIndex;
+  FEditorPane &Pane = Panes[PaneIndex];
+  ActiveDocument = Pane.Document;
+
+  const TSharedPtr<SCodeEditableText> *View =
+      ActiveDocument.IsValid() ? Pane.Views.Find(ActiveDocument) : nullptr;
+  CodeEditor = View ? *View : nullptr;
+  if (bFindBarVisible && FindBar.IsValid()) {
+    FindBar->SetTarget(CodeEditor);
+  }
 
-  bHasUnsavedChanges = false;
+  RebuildDocumentTabs();
+  UpdateLanguageDisplay();
+  UpdateStatusBar();
+}
+
+void SCodeEditorTab::ShowDocumentInPane(int32 PaneIndex,
+                                        TSharedPtr<FCodeDocument> Document) {
+  FEditorPane &Pane = Panes[PaneIndex];
+  Pane.Document = Document;
+
+  if (!Document.IsValid()) {
+    Pane.Host->SetContent(SNullWidget::NullWidget);
+    return;
+  }
+
+  Document->LastViewedTime = FPlatformTime::Seconds();
+  Pane.Host->SetContent(GetOrCreateView(PaneIndex, Document.ToSharedRef()));
+}
+
+void SCodeEditorTab::CloseDocument(TSharedPtr<FCodeDocument> Document) {
+  const int32 Index = Documents.IndexOfByKey(Document);
+  if (!Document.IsValid() || Index == INDEX_NONE) {
+    return;
+  }
+
+  if (Document->IsModified() &&
+      FMessageDialog::Open(
+          EAppMsgType::YesNo,
+          FText::Format(LOCTEXT("CloseUnsaved",
+                                "{0} has unsaved changes. Close anyway?"),
+                        FText::FromString(Document->GetDisplayName()))) !=
+          EAppReturnType::Yes) {
+    return;
+  }
+
+  Document->Discard();
+  Documents.RemoveAt(Index);
+
+  // Panes that showed the document move on to a neighbouring one
+  TSharedPtr<FCodeDocument> Replacement =
+      Documents.Num() > 0 ? Documents[FMath::Min(Index, Documents.Num() - 1)]
+                          : nullptr;
+  for (int32 PaneIndex = 0; PaneIndex < Panes.Num(); ++PaneIndex) {
+    Panes[PaneIndex].Views.Remove(Document);
+    if (Panes[PaneIndex].Document == Document) {
+      ShowDocumentInPane(PaneIndex, Replacement);
+    }
+  }
+
+  SetActivePane(ActivePane);
+  EnforceLayoutBudget();
+}
+
+void SCodeEditorTab::AddDocument(TSharedRef<FCodeDocument> Document) {
+  Documents.Add(Document);
+  ActivateDocument(Document);
+}
+
+TSharedPtr<FCodeDocument>
+SCodeEditorTab::FindDocument(const FString &FilePath) const {
+  for (const TSharedPtr<FCodeDocument> &Document : Documents) {
+    if (!Document->IsUntitled() &&
+        FPaths::IsSamePath(Document->GetFilePath(), FilePath)) {
+      return Document;
+    }
+  }
+  return nullptr;
+}
+
+TSharedRef<SCodeEditableText>
+SCodeEditorTab::GetOrCreateView(int32 PaneIndex,
+                                TSharedRef<FCodeDocument> Document) {
+  FEditorPane &Pane = Panes[PaneIndex];
+  if (const TSharedPtr<SCodeEditableText> *Existing =
+          Pane.Views.Find(Document)) {
+    return Existing->ToSharedRef();
+  }
+
+  // Rebuilding a view only lays the text out again; tokens and line analysis
+  // come from the document
+  TSharedRef<SCodeEditableText> View =
+      SNew(SCodeEditableText)
+          .Document(Document)
+          .OnCursorMoved(this, &SCodeEditorTab::OnCursorMoved,
+                         TWeakPtr<SBox>(Pane.Host))
+          .OnGoToDefinition(this, &SCodeEditorTab::GoToDefinition)
+          .OnFindReferences(this, &SCodeEditorTab::FindReferences)
+          .OnRenameSymbol(this, &SCodeEditorTab::RenameSymbol);
+
+  if (Document->FoldedLines.Num() > 0) {
+    View->SetFoldedLines(Document->FoldedLines);
+  }
+  if (Document->CursorLine > 1) {
+    View->GoToLine(Document->CursorLine);
+  }
+
+  Pane.Views.Add(Document, View);
+  return View;
+}
+
+void SCodeEditorTab::EnforceLayoutBudget() {
+  const SIZE_T BudgetBytes =
+      static_cast<SIZE_T>(
+          FMath::Max(0, CVarICELayoutBudgetMB.GetValueOnGameThread())) *
+      1024 * 1024;
+
+  // Every pane's view builds its own layout, so each one counts
+  TArray<TPair<int32, TSharedPtr<FCodeDocument>>> ResidentViews;
+  SIZE_T ResidentBytes = 0;
+  for (int32 PaneIndex = 0; PaneIndex < Panes.Num(); ++PaneIndex) {
+    for (const TPair<TSharedPtr<FCodeDocument>, TSharedPtr<SCodeEditableText>>
+             &Pair : Panes[PaneIndex].Views) {
+      ResidentViews.Emplace(PaneIndex, Pair.Key);
+      ResidentBytes += Pair.Key->GetLayoutMemoryEstimate();
+    }
+  }
+
+  if (ResidentBytes <= BudgetBytes) {
+    return;
+  }
+
+  // Least recently viewed first
+  ResidentViews.Sort([](const TPair<int32, TSharedPtr<FCodeDocument>> &A,
+                        const TPair<int32, TSharedPtr<FCodeDocument>> &B) {
+    return A.Value->LastViewedTime < B.Value->LastViewedTime;
+  });
+
+  for (const TPair<int32, TSharedPtr<FCodeDocument>> &View : ResidentViews) {
+    if (ResidentBytes <= BudgetBytes) {
+      break;
+    }
+    if (Panes[View.Key].Document == View.Value) {
+      continue;
+    }
+
+    ResidentBytes -= View.Value->GetLayoutMemoryEstimate();
+    EvictView(View.Key, View.Value);
+  }
+}
+
+void SCodeEditorTab::EvictView(int32 PaneIndex,
+                               TSharedPtr<FCodeDocument> Document) {
+  TSharedPtr<SCodeEditableText> View;
+  if (!Panes[PaneIndex].Views.RemoveAndCopyValue(Document, View) ||
+      !View.IsValid()) {
+    return;
+  }
+
+  Document->FoldedLines = View->GetFoldedLines();
+  Document->CursorLine = View->GetCursorLine();
+
+  UE_LOG(LogTemp, Verbose,
+         TEXT("InlineCodeEditor: Evicted text layout for %s"),
+         *Document->GetDisplayName());
+}
+
+FReply SCodeEditorTab::OnNewFileClicked() {
+  AddDocument(FCodeDocument::Create(FString(), TEXT("// New file\n\n")));
 
   if (StatusMessage.IsValid()) {
     StatusMessage->SetText(LOCTEXT("NewFileCreated", "New file created"));
@@ -273,11 +952,19 @@ FReply SCodeEditorTab::OnSaveClicked() {
   return FReply::Handled();
 }
 
-void SCodeEditorTab::OnTextChanged(const FText &NewText) {
-  bHasUnsavedChanges = true;
-}
+void SCodeEditorTab::OnCursorMoved(TWeakPtr<SBox> WeakPaneHost) {
+  // Moving the cursor in a pane is what makes it the active one
+  const int32 PaneIndex = Panes.IndexOfByPredicate(
+      [&WeakPaneHost](const FEditorPane &Pane) {
+        return Pane.Host == WeakPaneHost.Pin();
+      });
+  if (PaneIndex != INDEX_NONE && PaneIndex != ActivePane) {
+    SetActivePane(PaneIndex);
+    return;
+  }
 
-void SCodeEditorTab::OnCursorMoved() { UpdateStatusBar(); }
+  UpdateStatusBar();
+}
 
 void SCodeEditorTab::UpdateStatusBar() {
   if (!CodeEditor.IsValid() || !StatusLineColumn.IsValid()) {
@@ -292,4 +979,23 @@ void SCodeEditorTab::UpdateStatusBar() {
                     FText::AsNumber(Line), FText::AsNumber(Column)));
 }
 
+void SCodeEditorTab::UpdateLanguageDisplay() {
+  if (!StatusLanguage.IsValid()) {
+    return;
+  }
+
+  FString Ext = FPaths::GetExtension(GetCurrentFilePath()).ToLower();
+  if (Ext == TEXT("cpp") || Ext == TEXT("cc") || Ext == TEXT("cxx")) {
+    StatusLanguage->SetText(LOCTEXT("LangCpp", "C++"));
+  } else if (Ext == TEXT("h") || Ext == TEXT("hpp")) {
+    StatusLanguage->SetText(LOCTEXT("LangHeader", "C++ Header"));
+  } else if (Ext == TEXT("c")) {
+    StatusLanguage->SetText(LOCTEXT("LangC", "C"));
+  } else if (ActiveDocument.IsValid() && ActiveDocument->IsUntitled()) {
+    StatusLanguage->SetText(LOCTEXT("Language", "C++"));
+  } else {
+    StatusLanguage->SetText(LOCTEXT("LangPlain", "Plain Text"));
+  }
+}
+
 #undef LOCTEXT_NAMESPACE
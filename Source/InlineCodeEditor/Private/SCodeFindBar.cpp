@@ -0,0 +1,387 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "SCodeFindBar.h"
+#include "CodeDocument.h"
+#include "CodeFind.h"
+#include "Framework/Application/SlateApplication.h"
+#include "SCodeEditableText.h"
+#include "Styling/AppStyle.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "SCodeFindBar"
+
+namespace CodeFindBarColors {
+const FLinearColor Background =
+    FLinearColor::FromSRGBColor(FColor::FromHex("252526FF")); // VSCode widget
+const FLinearColor StatusText =
+    FLinearColor::FromSRGBColor(FColor::FromHex("CCCCCCFF"));
+const FLinearColor ErrorText =
+    FLinearColor::FromSRGBColor(FColor::FromHex("F48771FF"));
+} // namespace CodeFindBarColors
+
+namespace CodeFindBarConstants {
+constexpr float QueryWidth = 260.0f;
+} // namespace CodeFindBarConstants
+
+void SCodeFindBar::Construct(const FArguments &InArgs) {
+  OnClosed = InArgs._OnClosed;
+  Results = MakeShared<FCodeFindResults>();
+
+  ChildSlot
+      [SNew(SBorder)
+           .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+           .BorderBackgroundColor(CodeFindBarColors::Background)
+           .Padding(FMargin(8, 4))
+               [SNew(SVerticalBox)
+
+                // Find row
+                + SVerticalBox::Slot().AutoHeight()
+                      [SNew(SHorizontalBox)
+
+                       // Replace row toggle
+                       + SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 4, 0)
+                             [SNew(SButton)
+                                  .ButtonStyle(FAppStyle::Get(), "NoBorder")
+                                  .ToolTipText(LOCTEXT("ToggleReplace",
+                                                       "Toggle Replace"))
+                                  .OnClicked_Lambda([this]() {
+                                    bShowReplace = !bShowReplace;
+                                    return FReply::Handled();
+                                  })[SNew(STextBlock)
+                                         .Text_Lambda([this]() {
+                                           return FText::FromString(
+                                               bShowReplace ? TEXT("\u25BC")
+                                                            : TEXT("\u25B6"));
+                                         })
+                                         .ColorAndOpacity(
+                                             CodeFindBarColors::StatusText)]]
+
+                       // Query
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SBox).WidthOverride(
+                                  CodeFindBarConstants::QueryWidth)
+                                  [SAssignNew(QueryBox, SEditableTextBox)
+                                       .HintText(LOCTEXT("FindHint", "Find"))
+                                       .ClearKeyboardFocusOnCommit(false)
+                                       .OnTextChanged_Lambda(
+                                           [this](const FText &) {
+                                             UpdateMatches(true);
+                                           })
+                                       .OnKeyDownHandler(
+                                           this,
+                                           &SCodeFindBar::OnQueryKeyDown)]]
+
+                       // Options
+                       + SHorizontalBox::Slot().AutoWidth().Padding(4, 0, 0, 0)
+                             [MakeOptionToggle(
+                                 bMatchCase, FText::FromString(TEXT("Aa")),
+                                 LOCTEXT("MatchCase", "Match Case"))]
+                       + SHorizontalBox::Slot().AutoWidth()[MakeOptionToggle(
+                             bWholeWord, FText::FromString(TEXT("ab")),
+                             LOCTEXT("WholeWord", "Match Whole Word"))]
+                       + SHorizontalBox::Slot().AutoWidth()[MakeOptionToggle(
+                             bRegex, FText::FromString(TEXT(".*")),
+                             LOCTEXT("Regex", "Use Regular Expression"))]
+
+                       // Match count or error
+                       + SHorizontalBox::Slot()
+                             .AutoWidth()
+                             .VAlign(VAlign_Center)
+                             .Padding(8, 0)
+                                 [SNew(STextBlock)
+                                      .Text(this, &SCodeFindBar::GetStatusText)
+                                      .ColorAndOpacity_Lambda([this]() {
+                                        return FSlateColor(
+                                            QueryError.IsEmpty()
+                                                ? CodeFindBarColors::StatusText
+                                                : CodeFindBarColors::ErrorText);
+                                      })]
+
+                       // Previous, next and close
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SButton)
+                                  .Text(FText::FromString(TEXT("\u2191")))
+                                  .ToolTipText(
+                                      LOCTEXT("Previous",
+                                              "Previous Match (Shift+Enter)"))
+                                  .OnClicked_Lambda([this]() {
+                                    FindNext(true);
+                                    return FReply::Handled();
+                                  })]
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SButton)
+                                  .Text(FText::FromString(TEXT("\u2193")))
+                                  .ToolTipText(
+                                      LOCTEXT("Next", "Next Match (Enter)"))
+                                  .OnClicked_Lambda([this]() {
+                                    FindNext(false);
+                                    return FReply::Handled();
+                                  })]
+                       + SHorizontalBox::Slot().AutoWidth().Padding(4, 0, 0, 0)
+                             [SNew(SButton)
+                                  .ButtonStyle(FAppStyle::Get(), "NoBorder")
+                                  .ToolTipText(
+                                      LOCTEXT("Close", "Close (Escape)"))
+                                  .OnClicked_Lambda([this]() {
+                                    OnClosed.ExecuteIfBound();
+                                    return FReply::Handled();
+                                  })[SNew(STextBlock)
+                                         .Text(FText::FromString(
+                                             TEXT("\u2715")))
+                                         .ColorAndOpacity(
+                                             CodeFindBarColors::StatusText)]]]
+
+                // Replace row
+                + SVerticalBox::Slot().AutoHeight().Padding(0, 4, 0, 0)
+                      [SNew(SHorizontalBox)
+                           .Visibility_Lambda([this]() {
+                             return bShowReplace ? EVisibility::Visible
+                                                 : EVisibility::Collapsed;
+                           })
+
+                       // Lines the replacement up with the query
+                       + SHorizontalBox::Slot().AutoWidth().Padding(0, 0, 4, 0)
+                             [SNew(SBox).WidthOverride(12.0f)]
+
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SBox).WidthOverride(
+                                  CodeFindBarConstants::QueryWidth)
+                                  [SAssignNew(ReplaceBox, SEditableTextBox)
+                                       .HintText(
+                                           LOCTEXT("ReplaceHint", "Replace"))
+                                       .ClearKeyboardFocusOnCommit(false)
+                                       .OnKeyDownHandler(
+                                           this,
+                                           &SCodeFindBar::OnReplaceKeyDown)]]
+
+                       + SHorizontalBox::Slot().AutoWidth().Padding(4, 0, 0, 0)
+                             [SNew(SButton)
+                                  .Text(LOCTEXT("Replace", "Replace"))
+                                  .ToolTipText(LOCTEXT(
+                                      "ReplaceTooltip",
+                                      "Replace the current match (Enter)"))
+                                  .IsEnabled_Lambda(
+                                      [this]() { return Results->Num() > 0; })
+                                  .OnClicked_Lambda([this]() {
+                                    Replace();
+                                    return FReply::Handled();
+                                  })]
+
+                       + SHorizontalBox::Slot().AutoWidth().Padding(4, 0, 0, 0)
+                             [SNew(SButton)
+                                  .Text(LOCTEXT("ReplaceAll", "Replace All"))
+                                  .ToolTipText(LOCTEXT(
+                                      "ReplaceAllTooltip",
+                                      "Replace every match as one edit"))
+                                  .IsEnabled_Lambda(
+                                      [this]() { return Results->Num() > 0; })
+                                  .OnClicked_Lambda([this]() {
+                                    ReplaceAll();
+                                    return FReply::Handled();
+                                  })]]]];
+}
+
+SCodeFindBar::~SCodeFindBar() { SetTarget(nullptr); }
+
+TSharedRef<SWidget> SCodeFindBar::MakeOptionToggle(bool &bOption,
+                                                   const FText &Label,
+                                                   const FText &ToolTip) {
+  return SNew(SCheckBox)
+      .Style(FAppStyle::Get(), "ToggleButtonCheckbox")
+      .ToolTipText(ToolTip)
+      .IsChecked_Lambda([&bOption]() {
+        return bOption ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+      })
+      .OnCheckStateChanged_Lambda([this, &bOption](ECheckBoxState State) {
+        bOption = State == ECheckBoxState::Checked;
+        UpdateMatches(true);
+      })[SNew(STextBlock).Text(Label)];
+}
+
+void SCodeFindBar::SetTarget(TSharedPtr<SCodeEditableText> InView) {
+  TSharedPtr<SCodeEditableText> OldView = View.Pin();
+  if (OldView == InView && OldView.IsValid()) {
+    return;
+  }
+
+  if (OldView.IsValid()) {
+    OldView->SetFindResults(nullptr, INDEX_NONE);
+  }
+  if (Document.IsValid()) {
+    Document->OnEdited().Remove(DocumentEditedHandle);
+  }
+
+  View = InView;
+  Document = InView.IsValid() ? TSharedPtr<FCodeDocument>(InView->GetDocument())
+                              : nullptr;
+  if (Document.IsValid()) {
+    DocumentEditedHandle = Document->OnEdited().AddSP(
+        this, &SCodeFindBar::HandleDocumentEdited);
+  }
+
+  UpdateMatches(false);
+}
+
+void SCodeFindBar::FocusQuery(bool bInShowReplace) {
+  bShowReplace = bInShowReplace;
+  if (QueryBox.IsValid()) {
+    FSlateApplication::Get().SetKeyboardFocus(QueryBox);
+    QueryBox->SelectAllText();
+  }
+}
+
+void SCodeFindBar::UpdateMatches(bool bSelectNearest) {
+  CurrentMatch = INDEX_NONE;
+  QueryError = FText::GetEmpty();
+
+  TSharedPtr<SCodeEditableText> PinnedView = View.Pin();
+  FCodeFindQuery Query;
+  if (QueryBox.IsValid()) {
+    Query.Text = QueryBox->GetText().ToString();
+  }
+  Query.bMatchCase = bMatchCase;
+  Query.bWholeWord = bWholeWord;
+  Query.bRegex = bRegex;
+
+  if (!Document.IsValid() || !PinnedView.IsValid() || Query.Text.IsEmpty()) {
+    Results->Reset();
+  } else if (Results->SetQuery(Document->GetText(), Query, QueryError) &&
+             bSelectNearest) {
+    // The nearest match ahead of the cursor follows the query as it is
+    // typed; selecting it moves the cursor there, so a longer query stays
+    // on the same match if it still matches
+    SelectMatch(Results->FindNext(PinnedView->GetCursorOffset()));
+  }
+
+  UpdateHighlights();
+}
+
+void SCodeFindBar::HandleDocumentEdited(const FCodeTextEdit &Edit) {
+  Results->HandleEdit(Document->GetText(), Edit);
+  CurrentMatch = INDEX_NONE;
+  UpdateHighlights();
+}
+
+void SCodeFindBar::SelectMatch(int32 Index) {
+  TSharedPtr<SCodeEditableText> PinnedView = View.Pin();
+  if (!PinnedView.IsValid() || !Results->GetMatches().IsValidIndex(Index)) {
+    return;
+  }
+
+  CurrentMatch = Index;
+  const FCodeFindMatch &Match = Results->GetMatches()[Index];
+  PinnedView->SelectRange(Match.Start, Match.End);
+  UpdateHighlights();
+}
+
+void SCodeFindBar::FindNext(bool bBackward) {
+  TSharedPtr<SCodeEditableText> PinnedView = View.Pin();
+  if (!PinnedView.IsValid() || Results->Num() == 0) {
+    return;
+  }
+
+  // Step from the current match, or from the cursor if there is none
+  const TArray<FCodeFindMatch> &Matches = Results->GetMatches();
+  if (Matches.IsValidIndex(CurrentMatch)) {
+    SelectMatch(bBackward ? (CurrentMatch + Matches.Num() - 1) % Matches.Num()
+                          : (CurrentMatch + 1) % Matches.Num());
+    return;
+  }
+  const int32 Cursor = PinnedView->GetCursorOffset();
+  SelectMatch(bBackward ? Results->FindPrevious(Cursor)
+                        : Results->FindNext(Cursor));
+}
+
+void SCodeFindBar::Replace() {
+  TSharedPtr<SCodeEditableText> PinnedView = View.Pin();
+  if (!PinnedView.IsValid() || !ReplaceBox.IsValid()) {
+    return;
+  }
+
+  // The first press only shows which match would be replaced
+  if (!Results->GetMatches().IsValidIndex(CurrentMatch)) {
+    FindNext(false);
+    return;
+  }
+
+  const FCodeFindMatch Match = Results->GetMatches()[CurrentMatch];
+  const FString Replacement = ReplaceBox->GetText().ToString();
+  PinnedView->ApplyEdit(
+      FCodeTextEdit(Match.Start, Match.End - Match.Start, Replacement));
+  SelectMatch(Results->FindNext(Match.Start + Replacement.Len()));
+}
+
+void SCodeFindBar::ReplaceAll() {
+  TSharedPtr<SCodeEditableText> PinnedView = View.Pin();
+  if (!PinnedView.IsValid() || !ReplaceBox.IsValid() ||
+      Results->Num() == 0) {
+    return;
+  }
+
+  PinnedView->ApplyEdit(Results->MakeReplaceAllEdit(
+      Document->GetText(), ReplaceBox->GetText().ToString()));
+}
+
+void SCodeFindBar::UpdateHighlights() {
+  if (TSharedPtr<SCodeEditableText> PinnedView = View.Pin()) {
+    PinnedView->SetFindResults(Results, CurrentMatch);
+  }
+}
+
+FText SCodeFindBar::GetStatusText() const {
+  if (!QueryError.IsEmpty()) {
+    return QueryError;
+  }
+  if (!QueryBox.IsValid() || QueryBox->GetText().IsEmpty()) {
+    return FText::GetEmpty();
+  }
+  if (Results->Num() == 0) {
+    return LOCTEXT("NoResults", "No results");
+  }
+  if (Results->GetMatches().IsValidIndex(CurrentMatch)) {
+    return FText::Format(LOCTEXT("MatchOf", "{0} of {1}"),
+                         FText::AsNumber(CurrentMatch + 1),
+                         FText::AsNumber(Results->Num()));
+  }
+  return FText::Format(LOCTEXT("MatchCount", "{0} results"),
+                       FText::AsNumber(Results->Num()));
+}
+
+FReply SCodeFindBar::OnQueryKeyDown(const FGeometry &MyGeometry,
+                                    const FKeyEvent &InKeyEvent) {
+  const FKey Key = InKeyEvent.GetKey();
+  if (Key == EKeys::Enter) {
+    FindNext(InKeyEvent.IsShiftDown());
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Escape) {
+    OnClosed.ExecuteIfBound();
+    return FReply::Handled();
+  }
+  return FReply::Unhandled();
+}
+
+FReply SCodeFindBar::OnReplaceKeyDown(const FGeometry &MyGeometry,
+                                      const FKeyEvent &InKeyEvent) {
+  const FKey Key = InKeyEvent.GetKey();
+  if (Key == EKeys::Enter) {
+    if (InKeyEvent.IsControlDown() && InKeyEvent.IsAltDown()) {
+      ReplaceAll();
+    } else {
+      Replace();
+    }
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Escape) {
+    OnClosed.ExecuteIfBound();
+    return FReply::Handled();
+  }
+  return FReply::Unhandled();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,261 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "SCodePeekView.h"
+#include "CodeDocument.h"
+#include "FCppSyntaxHighlighter.h"
+#include "Styling/AppStyle.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/SMultiLineEditableText.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "SCodePeekView"
+
+namespace CodePeekColors {
+const FLinearColor Background =
+    FLinearColor::FromSRGBColor(FColor::FromHex("1E1E1EFF")); // VSCode dark
+const FLinearColor HeaderBackground =
+    FLinearColor::FromSRGBColor(FColor::FromHex("252526FF")); // VSCode widget
+const FLinearColor Border =
+    FLinearColor::FromSRGBColor(FColor::FromHex("007ACCFF"));
+const FLinearColor HeaderText =
+    FLinearColor::FromSRGBColor(FColor::FromHex("CCCCCCFF"));
+const FLinearColor LineNumberText =
+    FLinearColor::FromSRGBColor(FColor::FromHex("858585FF"));
+const FLinearColor Text =
+    FLinearColor::FromSRGBColor(FColor::FromHex("D4D4D4FF"));
+} // namespace CodePeekColors
+
+namespace CodePeekConstants {
+/** Lines shown above and below the declared name */
+constexpr int32 LinesBefore = 3;
+constexpr int32 LinesAfter = 12;
+
+constexpr int32 FontSize = 10;
+} // namespace CodePeekConstants
+
+void SCodePeekView::Construct(const FArguments &InArgs) {
+  OnGetDocument = InArgs._OnGetDocument;
+  OnOpen = InArgs._OnOpen;
+  OnClosed = InArgs._OnClosed;
+
+  const FSlateFontInfo MonoFont =
+      FCoreStyle::GetDefaultFontStyle("Mono", CodePeekConstants::FontSize);
+
+  ChildSlot
+      [SNew(SBorder)
+           .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+           .BorderBackgroundColor(CodePeekColors::Border)
+           .Padding(FMargin(1))
+               [SNew(SVerticalBox)
+
+                // Header: where the declaration is, and which one of them
+                + SVerticalBox::Slot().AutoHeight()
+                      [SNew(SBorder)
+                           .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+                           .BorderBackgroundColor(
+                               CodePeekColors::HeaderBackground)
+                           .Padding(FMargin(8, 2))
+                               [SNew(SHorizontalBox)
+
+                                + SHorizontalBox::Slot()
+                                      .FillWidth(1.0f)
+                                      .VAlign(VAlign_Center)
+                                          [SNew(STextBlock)
+                                               .Text(this, &SCodePeekView::
+                                                               GetHeaderText)
+                                               .ColorAndOpacity(
+                                                   CodePeekColors::HeaderText)]
+
+                                // Previous, next, open and close
+                                + SHorizontalBox::Slot().AutoWidth()
+                                      [SNew(SButton)
+                                           .Text(FText::FromString(
+                                               TEXT("\u2191")))
+                                           .ToolTipText(LOCTEXT(
+                                               "Previous",
+                                               "Previous Declaration"))
+                                           .IsEnabled_Lambda([this]() {
+                                             return Locations.Num() > 1;
+                                           })
+                                           .OnClicked_Lambda([this]() {
+                                             ShowNext(true);
+                                             return FReply::Handled();
+                                           })]
+                                + SHorizontalBox::Slot().AutoWidth()
+                                      [SNew(SButton)
+                                           .Text(FText::FromString(
+                                               TEXT("\u2193")))
+                                           .ToolTipText(LOCTEXT(
+                                               "Next", "Next Declaration"))
+                                           .IsEnabled_Lambda([this]() {
+                                             return Locations.Num() > 1;
+                                           })
+                                           .OnClicked_Lambda([this]() {
+                                             ShowNext(false);
+                                             return FReply::Handled();
+                                           })]
+                                + SHorizontalBox::Slot().AutoWidth().Padding(
+                                      4, 0, 0, 0)
+                                      [SNew(SButton)
+                                           .Text(LOCTEXT("Open", "Open"))
+                                           .ToolTipText(LOCTEXT(
+                                               "OpenTooltip",
+                                               "Open in the editor (Enter)"))
+                                           .OnClicked_Lambda([this]() {
+                                             OpenCurrent();
+                                             return FReply::Handled();
+                                           })]
+                                + SHorizontalBox::Slot().AutoWidth().Padding(
+                                      4, 0, 0, 0)
+                                      [SNew(SButton)
+                                           .ButtonStyle(FAppStyle::Get(),
+                                                        "NoBorder")
+                                           .ToolTipText(LOCTEXT(
+                                               "Close", "Close (Escape)"))
+                                           .OnClicked_Lambda([this]() {
+                                             OnClosed.ExecuteIfBound();
+                                             return FReply::Handled();
+                                           })[SNew(STextBlock)
+                                                  .Text(FText::FromString(
+                                                      TEXT("\u2715")))
+                                                  .ColorAndOpacity(
+                                                      CodePeekColors::
+                                                          HeaderText)]]]]
+
+                // Lines around the declaration
+                + SVerticalBox::Slot().AutoHeight()
+                      [SNew(SBorder)
+                           .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+                           .BorderBackgroundColor(CodePeekColors::Background)
+                           .Padding(FMargin(4, 4))
+                               [SNew(SHorizontalBox)
+
+                                + SHorizontalBox::Slot().AutoWidth().Padding(
+                                      0, 0, 12, 0)
+                                      [SAssignNew(LineNumbers, STextBlock)
+                                           .Font(MonoFont)
+                                           .Justification(ETextJustify::Right)
+                                           .ColorAndOpacity(
+                                               CodePeekColors::LineNumberText)]
+
+                                + SHorizontalBox::Slot().FillWidth(1.0f)
+                                      [SAssignNew(TextHost, SBox)]]]]];
+}
+
+void SCodePeekView::SetLocations(const FString &InName,
+                                 TArray<FCodeSymbolLocation> &&InLocations) {
+  Name = InName;
+  Locations = MoveTemp(InLocations);
+  CurrentLocation = INDEX_NONE;
+  Document.Reset();
+  ShowLocation(0);
+}
+
+void SCodePeekView::ShowNext(bool bBackward) {
+  if (Locations.Num() == 0) {
+    return;
+  }
+
+  const int32 Step = bBackward ? Locations.Num() - 1 : 1;
+  ShowLocation((CurrentLocation + Step) % Locations.Num());
+}
+
+void SCodePeekView::OpenCurrent() {
+  if (Locations.IsValidIndex(CurrentLocation)) {
+    OnOpen.ExecuteIfBound(Locations[CurrentLocation]);
+  }
+}
+
+FReply SCodePeekView::OnKeyDown(const FGeometry &MyGeometry,
+                                const FKeyEvent &InKeyEvent) {
+  if (InKeyEvent.GetKey() == EKeys::Escape) {
+    OnClosed.ExecuteIfBound();
+    return FReply::Handled();
+  }
+  if (InKeyEvent.GetKey() == EKeys::Enter) {
+    OpenCurrent();
+    return FReply::Handled();
+  }
+  return SCompoundWidget::OnKeyDown(MyGeometry, InKeyEvent);
+}
+
+void SCodePeekView::ShowLocation(int32 Index) {
+  if (!Locations.IsValidIndex(Index) || !TextHost.IsValid()) {
+    return;
+  }
+
+  const FCodeSymbolLocation &Location = Locations[Index];
+  CurrentLocation = Index;
+  Document =
+      OnGetDocument.IsBound() ? OnGetDocument.Execute(Location) : nullptr;
+
+  const int32 NumLines = Document.IsValid() ? Document->GetLines().Num() : 0;
+  if (NumLines == 0) {
+    LineNumbers->SetText(FText::GetEmpty());
+    TextHost->SetContent(
+        SNew(STextBlock)
+            .Text(FText::Format(LOCTEXT("Unreadable", "Could not read {0}"),
+                                FText::FromString(Location.Path)))
+            .ColorAndOpacity(CodePeekColors::HeaderText));
+    return;
+  }
+
+  const int32 TargetLine = FMath::Clamp(Location.Line - 1, 0, NumLines - 1);
+  const int32 FirstLine =
+      FMath::Max(0, TargetLine - CodePeekConstants::LinesBefore);
+  const int32 LastLine =
+      FMath::Min(NumLines - 1, TargetLine + CodePeekConstants::LinesAfter);
+
+  // Lines are taken exactly as views display them, so the tokenizer finds
+  // them in its cache
+  FString Excerpt;
+  FString Numbers;
+  for (int32 Line = FirstLine; Line <= LastLine; ++Line) {
+    if (Line > FirstLine) {
+      Excerpt.AppendChar('\n');
+      Numbers.AppendChar('\n');
+    }
+    Excerpt += Document->GetLineText(Line);
+    if (Line == TargetLine) {
+      Numbers += TEXT("\u25B6 ");
+    }
+    Numbers.AppendInt(Line + 1);
+  }
+
+  const FSlateFontInfo MonoFont =
+      FCoreStyle::GetDefaultFontStyle("Mono", CodePeekConstants::FontSize);
+  FTextBlockStyle TextStyle =
+      FCoreStyle::Get().GetWidgetStyle<FTextBlockStyle>("NormalText");
+  TextStyle.SetFont(MonoFont);
+  TextStyle.SetColorAndOpacity(FSlateColor(CodePeekColors::Text));
+
+  LineNumbers->SetText(FText::FromString(Numbers));
+  TextHost->SetContent(
+      SNew(SMultiLineEditableText)
+          .Text(FText::FromString(Excerpt))
+          .TextStyle(&TextStyle)
+          .Marshaller(FCppSyntaxHighlighter::Create(Document->GetTokenizer()))
+          .IsReadOnly(true)
+          .AutoWrapText(false)
+          .Margin(FMargin(0)));
+}
+
+FText SCodePeekView::GetHeaderText() const {
+  if (!Locations.IsValidIndex(CurrentLocation)) {
+    return FText::GetEmpty();
+  }
+
+  const FCodeSymbolLocation &Location = Locations[CurrentLocation];
+  return FText::Format(LOCTEXT("Header", "{0} \u2014 {1}:{2}  ({3} of {4})"),
+                       FText::FromString(Name),
+                       FText::FromString(Location.Path),
+                       FText::AsNumber(
+                           Location.Line,
+                           &FNumberFormattingOptions::DefaultNoGrouping()),
+                       FText::AsNumber(CurrentLocation + 1),
+                       FText::AsNumber(Locations.Num()));
+}
+
+#undef LOCTEXT_NAMESPACE
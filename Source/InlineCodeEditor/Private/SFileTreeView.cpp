@@ -1,12 +1,23 @@
 // Copyright Yureka. All Rights Reserved.
 
 #include "SFileTreeView.h"
+#include "Async/Async.h"
+#include "DirectoryWatcherModule.h"
+#include "FileTreeExclusions.h"
+#include "FileTreeGitStatus.h"
 #include "FileTreeIconManager.h"
+#include "FileTreePathIndex.h"
+#include "FileTreeSnapshot.h"
 #include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "IDirectoryWatcher.h"
 #include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
 #include "Styling/AppStyle.h"
 #include "Widgets/Images/SImage.h"
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SSearchBox.h"
 #include "Widgets/Layout/SBorder.h"
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Layout/SScrollBox.h"
@@ -32,6 +43,14 @@ const FLinearColor TextNormal = FLinearColor(0.8f, 0.8f, 0.8f); // #CCCCCC
 const FLinearColor TextFolder =
     FLinearColor(0.878f, 0.788f, 0.557f); // #E0C98E - Gold
 const FLinearColor TextSelected = FLinearColor(1.0f, 1.0f, 1.0f); // #FFFFFF
+const FLinearColor TextPlaceholder =
+    FLinearColor(0.5f, 0.5f, 0.5f); // #808080 - Dim gray
+const FLinearColor TextExcluded =
+    FLinearColor(0.549f, 0.549f, 0.549f); // #8C8C8C - Ignored gray
+const FLinearColor TextGitModified =
+    FLinearColor::FromSRGBColor(FColor::FromHex("E2C08DFF")); // Git modified
+const FLinearColor TextGitUntracked =
+    FLinearColor::FromSRGBColor(FColor::FromHex("73C991FF")); // Git untracked
 
 // File type colors (matching VSCode icons)
 const FLinearColor IconFolder =
@@ -54,6 +73,30 @@ const FLinearColor IconDefault =
     FLinearColor(0.7f, 0.7f, 0.7f); // #B3B3B3 - Light Gray
 } // namespace FileTreeColors
 
+namespace FileTreeEnumeration {
+/** Entries listed before a batch is handed to the game thread */
+constexpr int32 BatchSize = 256;
+} // namespace FileTreeEnumeration
+
+namespace FileTreeExpandAll {
+/** Game thread time the expand-all job may use per frame */
+constexpr double FrameBudgetSeconds = 0.004;
+
+/** Deepest folder expand-all descends into, in case a loop goes unnoticed */
+constexpr int32 MaxDepth = 32;
+} // namespace FileTreeExpandAll
+
+namespace FileTreeFilter {
+/** Matches turned into tree items; the rest are left out of the view */
+constexpr int32 MaxShownMatches = 5000;
+} // namespace FileTreeFilter
+
+static TAutoConsoleVariable<int32> CVarICEExpandAllMaxNodes(
+    TEXT("ICE.FileTree.ExpandAllMaxNodes"), 20000,
+    TEXT("Maximum number of files and folders Expand All reveals in the ICE ")
+        TEXT("file tree before it stops."),
+    ECVF_Default);
+
 void SFileTreeView::Construct(const FArguments &InArgs) {
   RootPath = InArgs._RootPath;
   OnFileDoubleClicked = InArgs._OnFileDoubleClicked;
@@ -159,6 +202,20 @@ void SFileTreeView::Construct(const FArguments &InArgs) {
                                        .ColorAndOpacity(FSlateColor(
                                            FileTreeColors::TextFolder))]]]
 
+                // Filter box
+                +
+                SVerticalBox::Slot().AutoHeight()
+                    [SNew(SBorder)
+                         .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+                         .BorderBackgroundColor(FileTreeColors::TreeBackground)
+                         .Padding(FMargin(8.0f, 2.0f))
+                             [SAssignNew(FilterBox, SSearchBox)
+                                  .HintText(
+                                      LOCTEXT("FilterHint", "Filter files"))
+                                  .OnTextChanged(
+                                      this,
+                                      &SFileTreeView::OnFilterTextChanged)]]
+
                 // Tree view
                 +
                 SVerticalBox::Slot().FillHeight(1.0f)
@@ -183,6 +240,10 @@ void SFileTreeView::Construct(const FArguments &InArgs) {
 
   // Build initial tree if path is set
   FFileTreeIconManager::Get().Initialize();
+  if (!FFileTreeIconManager::Get().IsInitialized()) {
+    FFileTreeIconManager::Get().OnIconsLoaded().AddSP(
+        this, &SFileTreeView::RedrawRows);
+  }
   if (!RootPath.IsEmpty()) {
     BuildTreeFromDirectory(RootPath);
   }
@@ -199,10 +260,62 @@ void SFileTreeView::SetRootPath(const FString &NewRootPath) {
   RefreshTree();
 }
 
-void SFileTreeView::RefreshTree() { BuildTreeFromDirectory(RootPath); }
+SFileTreeView::~SFileTreeView() {
+  SaveSnapshot();
+  ResetPathIndex();
+  CancelAllEnumerations();
+  UnwatchAll();
+}
+
+void SFileTreeView::RefreshTree() {
+  if (!RootItem.IsValid() || RootItem->GetPath() != RootPath) {
+    BuildTreeFromDirectory(RootPath);
+    return;
+  }
+
+  // Mark every listed folder stale; the root is re-listed now and expanded
+  // folders follow as their parents finish, reusing their existing nodes
+  CancelAllEnumerations();
+  DefaultIgnoreScope = FFileTreeIgnoreScope::CreateDefault(RootPath);
+  TFunction<void(const TSharedPtr<FFileTreeItem> &)> MarkStale;
+  MarkStale = [&MarkStale](const TSharedPtr<FFileTreeItem> &Item) {
+    if (Item->bIsDirectory && Item->HasLoadedChildren()) {
+      Item->SetChildrenLoaded(false);
+      for (const TSharedPtr<FFileTreeItem> &Child : Item->Children) {
+        MarkStale(Child);
+      }
+    }
+  };
+  MarkStale(RootItem);
+  PopulateChildren(RootItem);
+  if (GitStatus.IsValid()) {
+    GitStatus->Refresh();
+  }
+
+  // Walk the root again for the path index, keeping the current one
+  // until the new one is built
+  const bool bWantsPathIndex = PathIndex.IsValid() ||
+                               PathIndexCancelled.IsValid() || IsFiltering();
+  if (PathIndexCancelled.IsValid()) {
+    *PathIndexCancelled = true;
+    PathIndexCancelled.Reset();
+  }
+  if (bWantsPathIndex) {
+    BuildPathIndex();
+  }
+}
 
 void SFileTreeView::BuildTreeFromDirectory(const FString &DirectoryPath) {
+  SaveSnapshot();
+  ResetPathIndex();
+  CancelAllEnumerations();
+  UnwatchAll();
   RootItems.Empty();
+  FilteredRootItems.Empty();
+  RootItem.Reset();
+  IgnoreScopes.Empty();
+  DefaultIgnoreScope.Reset();
+  GitStatus.Reset();
 
   if (DirectoryPath.IsEmpty() || !FPaths::DirectoryExists(DirectoryPath)) {
     if (TreeView.IsValid()) {
@@ -211,112 +324,522 @@ void SFileTreeView::BuildTreeFromDirectory(const FString &DirectoryPath) {
     return;
   }
 
-  // Get all items in the root directory
-  TArray<FString> Files;
-  TArray<FString> Directories;
+  RootItem = MakeShared<FFileTreeItem>(FName(*DirectoryPath), true);
+  DefaultIgnoreScope = FFileTreeIgnoreScope::CreateDefault(DirectoryPath);
+  WatchRoot();
 
-  IFileManager &FileManager = IFileManager::Get();
+  GitStatus = FFileTreeGitStatus::Create(DirectoryPath);
+  if (GitStatus.IsValid()) {
+    GitStatus->OnChanged().AddSP(this, &SFileTreeView::RedrawRows);
+    GitStatus->Refresh();
+  }
 
-  // Find directories
-  FileManager.FindFiles(Directories, *(DirectoryPath / TEXT("*")), false, true);
+  // Draw the last known tree right away. Listing the root reconciles it
+  // with disk, and restoring expansion revalidates the open folders.
+  TArray<TSharedPtr<FFileTreeItem>> ExpandedItems;
+  if (FFileTreeSnapshot::Load(RootItem.ToSharedRef())) {
+    TFunction<void(const TSharedPtr<FFileTreeItem> &)> Prepare;
+    Prepare = [&Prepare,
+               &ExpandedItems](const TSharedPtr<FFileTreeItem> &Item) {
+      for (const TSharedPtr<FFileTreeItem> &Child : Item->Children) {
+        if (!Child->bIsDirectory || Child->bIsExcluded) {
+          continue;
+        }
+        if (Child->Children.Num() == 0) {
+          Child->Children.Add(MakePlaceholder(Child));
+        }
+        if (Child->bIsExpanded) {
+          ExpandedItems.Add(Child);
+        }
+        Prepare(Child);
+      }
+    };
+    Prepare(RootItem);
+    RootItems = RootItem->Children;
+  }
 
-  // Find files
-  FileManager.FindFiles(Files, *(DirectoryPath / TEXT("*")), true, false);
+  PopulateChildren(RootItem);
+  if (TreeView.IsValid()) {
+    for (const TSharedPtr<FFileTreeItem> &Item : ExpandedItems) {
+      TreeView->SetItemExpansion(Item, true);
+    }
+    TreeView->RequestTreeRefresh();
+  }
 
-  // Sort alphabetically (directories first)
-  Directories.Sort();
-  Files.Sort();
+  if (IsFiltering()) {
+    BuildPathIndex();
+  }
+}
 
-  // Create directory items
-  for (const FString &DirName : Directories) {
-    // Skip hidden directories
-    if (DirName.StartsWith(TEXT("."))) {
-      continue;
+void SFileTreeView::SaveSnapshot() const {
+  if (!RootItem.IsValid()) {
+    return;
+  }
+
+  // A root that never got listed has nothing worth keeping
+  for (const TSharedPtr<FFileTreeItem> &Child : RootItem->Children) {
+    if (!Child->bIsPlaceholder) {
+      FFileTreeSnapshot::Save(*RootItem);
+      return;
     }
+  }
+}
+
+TSharedRef<FFileTreeItem>
+SFileTreeView::MakePlaceholder(TSharedPtr<FFileTreeItem> DirectoryItem) {
+  TSharedRef<FFileTreeItem> Placeholder =
+      MakeShared<FFileTreeItem>(NAME_None, false);
+  Placeholder->bIsPlaceholder = true;
+  Placeholder->Parent = DirectoryItem;
+  return Placeholder;
+}
 
-    FString FullPath = DirectoryPath / DirName;
-    TSharedPtr<FFileTreeItem> Item =
-        MakeShared<FFileTreeItem>(FullPath, DirName, true);
-    RootItems.Add(Item);
+TSharedRef<FFileTreeItem>
+SFileTreeView::MakeItem(TSharedPtr<FFileTreeItem> DirectoryItem,
+                        const FFileTreeEntry &Entry) {
+  TSharedRef<FFileTreeItem> Item =
+      MakeShared<FFileTreeItem>(Entry.Name, Entry.bIsDirectory);
+  Item->Size = Entry.Size;
+  Item->ModificationTime = Entry.ModificationTime;
+  Item->Parent = DirectoryItem;
+  Item->bIsExcluded = Entry.bIsExcluded;
+
+  // Unlisted directories show a placeholder so they get an expander arrow
+  // without being listed until they are actually opened
+  if (Entry.bIsDirectory && !Entry.bIsExcluded) {
+    Item->Children.Add(MakePlaceholder(Item));
   }
+  return Item;
+}
 
-  // Create file items
-  for (const FString &FileName : Files) {
-    // Skip hidden files
-    if (FileName.StartsWith(TEXT("."))) {
-      continue;
+void SFileTreeView::PopulateChildren(TSharedPtr<FFileTreeItem> DirectoryItem) {
+  if (!DirectoryItem.IsValid() || !DirectoryItem->bIsDirectory ||
+      DirectoryItem->bIsExcluded || DirectoryItem->HasLoadedChildren() ||
+      DirectoryItem->IsLoadingChildren()) {
+    return;
+  }
+
+  // Children from an earlier listing stay visible and are matched by name
+  // against the new one, so their expansion and selection survive
+  TArray<TSharedPtr<FFileTreeItem>> &Children = DirectoryItem->Children;
+  DirectoryItem->Listing = MakeUnique<FFileTreeListing>();
+  for (const TSharedPtr<FFileTreeItem> &Child : Children) {
+    if (!Child->bIsPlaceholder) {
+      DirectoryItem->Listing->StaleChildren.Add(Child->Name.ToString(),
+                                                Child);
     }
+  }
+  Children.RemoveAll([](const TSharedPtr<FFileTreeItem> &Child) {
+    return Child->bIsPlaceholder;
+  });
+  DirectoryItem->Listing->bShowLoadingRow = Children.Num() == 0;
+  if (DirectoryItem->Listing->bShowLoadingRow) {
+    Children.Add(MakePlaceholder(DirectoryItem));
+  }
+
+  TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled =
+      MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+  DirectoryItem->Listing->Cancelled = Cancelled;
+  PendingEnumerations.Add(DirectoryItem);
+
+  TWeakPtr<SFileTreeView> WeakView =
+      StaticCastSharedRef<SFileTreeView>(AsShared());
+  TWeakPtr<FFileTreeItem> WeakItem = DirectoryItem;
+  const FString DirectoryPath = DirectoryItem->GetPath();
+  const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+      ParentScope = DirectoryItem == RootItem
+                        ? DefaultIgnoreScope
+                        : FindIgnoreScope(FPaths::GetPath(DirectoryPath));
+
+  Async(EAsyncExecution::ThreadPool, [WeakView, WeakItem, Cancelled,
+                                      DirectoryPath, ParentScope]() {
+    // Hand a batch to the game thread, unless the listing was cancelled
+    auto PostBatch = [&](TArray<FFileTreeEntry> &&Batch, bool bIsFinal) {
+      AsyncTask(ENamedThreads::GameThread,
+                [WeakView, WeakItem, Cancelled, bIsFinal,
+                 Batch = MoveTemp(Batch)]() mutable {
+                  TSharedPtr<SFileTreeView> View = WeakView.Pin();
+                  TSharedPtr<FFileTreeItem> Item = WeakItem.Pin();
+                  if (*Cancelled || !View.IsValid() || !Item.IsValid()) {
+                    return;
+                  }
+                  View->ApplyEnumerationBatch(Item.ToSharedRef(),
+                                              MoveTemp(Batch), bIsFinal);
+                });
+    };
+
+    // Rules of this directory's own ignore files apply to its entries and
+    // are kept for listing its subdirectories
+    const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+        OwnScope =
+            FFileTreeIgnoreScope::LoadForDirectory(ParentScope, DirectoryPath);
+    const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe> Scope =
+        OwnScope.IsValid() ? OwnScope : ParentScope;
+    AsyncTask(ENamedThreads::GameThread,
+              [WeakView, Cancelled, DirectoryPath, OwnScope]() {
+                TSharedPtr<SFileTreeView> View = WeakView.Pin();
+                if (*Cancelled || !View.IsValid()) {
+                  return;
+                }
+                if (OwnScope.IsValid()) {
+                  View->IgnoreScopes.Add(DirectoryPath, OwnScope);
+                } else {
+                  View->IgnoreScopes.Remove(DirectoryPath);
+                }
+              });
+
+    // One stat pass lists each entry with its type, size and timestamp
+    TArray<FFileTreeEntry> Batch;
+    IFileManager::Get().IterateDirectoryStat(
+        *DirectoryPath,
+        [&Batch, &PostBatch, &Cancelled, &Scope,
+         &DirectoryPath](const TCHAR *FilenameOrDirectory,
+                         const FFileStatData &StatData) {
+          const FString Name = FPaths::GetCleanFilename(FilenameOrDirectory);
+
+          // Skip hidden files and directories
+          if (Name.StartsWith(TEXT("."))) {
+            return true;
+          }
 
-    FString FullPath = DirectoryPath / FileName;
-    TSharedPtr<FFileTreeItem> Item =
-        MakeShared<FFileTreeItem>(FullPath, FileName, false);
-    RootItems.Add(Item);
+          // Interning here keeps the hashing off the game thread
+          FFileTreeEntry &Entry = Batch.AddDefaulted_GetRef();
+          Entry.Name = FName(*Name);
+          Entry.bIsDirectory = StatData.bIsDirectory;
+          Entry.bIsExcluded =
+              Scope.IsValid() &&
+              Scope->IsExcluded(DirectoryPath, Name, StatData.bIsDirectory);
+          Entry.Size = StatData.bIsDirectory ? -1 : StatData.FileSize;
+          Entry.ModificationTime = StatData.ModificationTime;
+
+          if (Batch.Num() >= FileTreeEnumeration::BatchSize) {
+            PostBatch(MoveTemp(Batch), false);
+            Batch.Reset();
+          }
+          return !*Cancelled;
+        });
+
+    if (*Cancelled) {
+      return;
+    }
+
+    PostBatch(MoveTemp(Batch), true);
+  });
+}
+
+void SFileTreeView::ApplyEnumerationBatch(
+    TSharedRef<FFileTreeItem> DirectoryItem, TArray<FFileTreeEntry> Batch,
+    bool bIsFinal) {
+  TArray<TSharedPtr<FFileTreeItem>> &Children = DirectoryItem->Children;
+  Children.RemoveAll([](const TSharedPtr<FFileTreeItem> &Child) {
+    return Child->bIsPlaceholder;
+  });
+
+  for (const FFileTreeEntry &Entry : Batch) {
+    TSharedPtr<FFileTreeItem> Existing;
+    DirectoryItem->Listing->StaleChildren.RemoveAndCopyValue(
+        Entry.Name.ToString(), Existing);
+    if (Existing.IsValid()) {
+      if (Existing->bIsDirectory == Entry.bIsDirectory &&
+          Existing->bIsExcluded == Entry.bIsExcluded) {
+        Existing->Size = Entry.Size;
+        Existing->ModificationTime = Entry.ModificationTime;
+        continue;
+      }
+      RemoveChild(DirectoryItem, Existing);
+    }
+
+    Children.Add(MakeItem(DirectoryItem, Entry));
+  }
+
+  SortChildren(Children);
+
+  if (bIsFinal) {
+    TUniquePtr<FFileTreeListing> Listing = MoveTemp(DirectoryItem->Listing);
+    PendingEnumerations.Remove(DirectoryItem);
+    DirectoryItem->SetChildrenLoaded(true);
+
+    // Whatever the listing did not find is gone
+    TArray<TSharedPtr<FFileTreeItem>> Removed;
+    Listing->StaleChildren.GenerateValueArray(Removed);
+    for (const TSharedPtr<FFileTreeItem> &Child : Removed) {
+      RemoveChild(DirectoryItem, Child);
+    }
+  } else if (DirectoryItem->Listing->bShowLoadingRow) {
+    Children.Add(MakePlaceholder(DirectoryItem));
+  }
+
+  if (DirectoryItem == RootItem) {
+    RootItems = Children;
   }
 
   if (TreeView.IsValid()) {
+    const bool bIsShown =
+        DirectoryItem == RootItem || TreeView->IsItemExpanded(DirectoryItem);
+    if (bIsFinal && bIsShown) {
+      WatchDirectory(DirectoryItem);
+
+      // Expanded subfolders kept from an earlier listing are stale too
+      for (const TSharedPtr<FFileTreeItem> &Child : Children) {
+        if (Child->bIsDirectory && !Child->HasLoadedChildren() &&
+            TreeView->IsItemExpanded(Child)) {
+          PopulateChildren(Child);
+        }
+      }
+    }
+
     TreeView->RequestTreeRefresh();
   }
 }
 
-void SFileTreeView::PopulateChildren(TSharedPtr<FFileTreeItem> DirectoryItem) {
-  if (!DirectoryItem.IsValid() || !DirectoryItem->bIsDirectory ||
-      DirectoryItem->HasLoadedChildren()) {
+void SFileTreeView::CancelEnumeration(TSharedPtr<FFileTreeItem> DirectoryItem) {
+  if (!DirectoryItem.IsValid() || !DirectoryItem->IsLoadingChildren()) {
     return;
   }
 
-  DirectoryItem->Children.Empty();
+  *DirectoryItem->Listing->Cancelled = true;
+  PendingEnumerations.Remove(DirectoryItem);
+  DirectoryItem->Listing.Reset();
+
+  // What was found so far stays, unconfirmed; the directory is reconciled
+  // again when reopened
+  DirectoryItem->Children.RemoveAll([](const TSharedPtr<FFileTreeItem> &Child) {
+    return Child->bIsPlaceholder;
+  });
+  DirectoryItem->Children.Add(MakePlaceholder(DirectoryItem));
+  DirectoryItem->SetChildrenLoaded(false);
+}
 
-  TArray<FString> Files;
-  TArray<FString> Directories;
+void SFileTreeView::CancelAllEnumerations() {
+  // Each item drops its listing too, so it can be listed again
+  const TArray<TWeakPtr<FFileTreeItem>> Pending =
+      MoveTemp(PendingEnumerations);
+  for (const TWeakPtr<FFileTreeItem> &Item : Pending) {
+    CancelEnumeration(Item.Pin());
+  }
+  StopExpandAll();
+}
 
-  IFileManager &FileManager = IFileManager::Get();
+void SFileTreeView::RemoveChild(TSharedPtr<FFileTreeItem> DirectoryItem,
+                                TSharedPtr<FFileTreeItem> Child) {
+  DirectoryItem->Children.Remove(Child);
+  CancelEnumeration(Child);
+  UnwatchSubtree(Child);
+
+  if (SelectedItem.IsValid()) {
+    for (TSharedPtr<FFileTreeItem> Item = SelectedItem; Item.IsValid();
+         Item = Item->Parent.Pin()) {
+      if (Item == Child) {
+        SelectedItem.Reset();
+        break;
+      }
+    }
+  }
+}
 
-  // Find directories
-  FileManager.FindFiles(Directories, *(DirectoryItem->Path / TEXT("*")), false,
-                        true);
+void SFileTreeView::SortChildren(TArray<TSharedPtr<FFileTreeItem>> &Children) {
+  Children.Sort([](const TSharedPtr<FFileTreeItem> &A,
+                   const TSharedPtr<FFileTreeItem> &B) {
+    if (A->bIsDirectory != B->bIsDirectory) {
+      return A->bIsDirectory;
+    }
+    return A->Name.LexicalLess(B->Name);
+  });
+}
 
-  // Find files
-  FileManager.FindFiles(Files, *(DirectoryItem->Path / TEXT("*")), true, false);
+TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+SFileTreeView::FindIgnoreScope(const FString &DirectoryPath) const {
+  const int32 RootLength = RootItem.IsValid() ? RootItem->GetPath().Len() : 0;
+  for (FString Directory = DirectoryPath;
+       !Directory.IsEmpty() && Directory.Len() >= RootLength;
+       Directory = FPaths::GetPath(Directory)) {
+    if (const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+            *Scope = IgnoreScopes.Find(Directory)) {
+      return *Scope;
+    }
+  }
+  return DefaultIgnoreScope;
+}
 
-  // Sort alphabetically
-  Directories.Sort();
-  Files.Sort();
+FString SFileTreeView::GetWatchKey(const FString &DirectoryPath) {
+  FString Key = FPaths::ConvertRelativePathToFull(DirectoryPath);
+  FPaths::NormalizeDirectoryName(Key);
+  return Key;
+}
 
-  // Create directory items
-  for (const FString &DirName : Directories) {
-    if (DirName.StartsWith(TEXT("."))) {
-      continue;
+void SFileTreeView::WatchRoot() {
+  if (RootWatchHandle.IsValid() || !RootItem.IsValid()) {
+    return;
+  }
+
+  FDirectoryWatcherModule *WatcherModule =
+      FModuleManager::Get().LoadModulePtr<FDirectoryWatcherModule>(
+          TEXT("DirectoryWatcher"));
+  IDirectoryWatcher *Watcher = WatcherModule ? WatcherModule->Get() : nullptr;
+  if (!Watcher) {
+    return;
+  }
+
+  // One recursive registration serves the tree and the path index. The
+  // watcher shares a request between callbacks on the same directory, so
+  // per-folder registrations could not also watch the whole root.
+  RootWatchPath = GetWatchKey(RootItem->GetPath());
+  if (!Watcher->RegisterDirectoryChangedCallback_Handle(
+          RootWatchPath,
+          IDirectoryWatcher::FDirectoryChanged::CreateSP(
+              this, &SFileTreeView::OnDirectoryChanged),
+          RootWatchHandle,
+          IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges)) {
+    RootWatchHandle.Reset();
+  }
+}
+
+void SFileTreeView::WatchDirectory(TSharedPtr<FFileTreeItem> DirectoryItem) {
+  WatchedDirectories.Add(GetWatchKey(DirectoryItem->GetPath()), DirectoryItem);
+}
+
+void SFileTreeView::UnwatchSubtree(TSharedPtr<FFileTreeItem> Item) {
+  if (!Item.IsValid() || !Item->bIsDirectory) {
+    return;
+  }
+  WatchedDirectories.Remove(GetWatchKey(Item->GetPath()));
+
+  // Unwatched children can go out of date; reconcile them when next shown
+  CancelEnumeration(Item);
+  Item->SetChildrenLoaded(false);
+  for (const TSharedPtr<FFileTreeItem> &Child : Item->Children) {
+    UnwatchSubtree(Child);
+  }
+}
+
+void SFileTreeView::UnwatchAll() {
+  if (RootWatchHandle.IsValid()) {
+    FDirectoryWatcherModule *WatcherModule =
+        FModuleManager::GetModulePtr<FDirectoryWatcherModule>(
+            TEXT("DirectoryWatcher"));
+    if (IDirectoryWatcher *Watcher =
+            WatcherModule ? WatcherModule->Get() : nullptr) {
+      Watcher->UnregisterDirectoryChangedCallback_Handle(RootWatchPath,
+                                                         RootWatchHandle);
     }
+    RootWatchHandle.Reset();
+  }
+  WatchedDirectories.Empty();
+}
 
-    FString FullPath = DirectoryItem->Path / DirName;
-    TSharedPtr<FFileTreeItem> Item =
-        MakeShared<FFileTreeItem>(FullPath, DirName, true);
-    Item->Parent = DirectoryItem;
-    DirectoryItem->Children.Add(Item);
+void SFileTreeView::OnDirectoryChanged(const TArray<FFileChangeData> &Changes) {
+  QueuePathIndexChanges(Changes);
+  UpdatePathIndex();
+  if (GitStatus.IsValid()) {
+    GitStatus->HandleChanges(Changes);
   }
 
-  // Create file items
-  for (const FString &FileName : Files) {
-    if (FileName.StartsWith(TEXT("."))) {
+  // Dropped events leave no telling what changed
+  for (const FFileChangeData &Change : Changes) {
+    if (Change.Action == FFileChangeData::FCA_RescanRequired) {
+      RefreshTree();
+      return;
+    }
+  }
+
+  bool bRootChanged = false;
+  for (const FFileChangeData &Change : Changes) {
+    const TWeakPtr<FFileTreeItem> *Watched =
+        WatchedDirectories.Find(GetWatchKey(FPaths::GetPath(Change.Filename)));
+    TSharedPtr<FFileTreeItem> DirectoryItem =
+        Watched ? Watched->Pin() : nullptr;
+
+    // Folders that are collapsed or being listed are reconciled by their
+    // next listing
+    if (!DirectoryItem.IsValid() || !DirectoryItem->HasLoadedChildren()) {
       continue;
     }
 
-    FString FullPath = DirectoryItem->Path / FileName;
-    TSharedPtr<FFileTreeItem> Item =
-        MakeShared<FFileTreeItem>(FullPath, FileName, false);
-    Item->Parent = DirectoryItem;
-    DirectoryItem->Children.Add(Item);
+    // Edited ignore rules can change what the whole folder shows
+    const FString CleanName = FPaths::GetCleanFilename(Change.Filename);
+    if (FFileTreeIgnoreScope::IsIgnoreFileName(CleanName)) {
+      DirectoryItem->SetChildrenLoaded(false);
+      PopulateChildren(DirectoryItem);
+      continue;
+    }
+    if (CleanName.StartsWith(TEXT("."))) {
+      continue;
+    }
+    const FName Name(*CleanName);
+
+    TArray<TSharedPtr<FFileTreeItem>> &Children = DirectoryItem->Children;
+    TSharedPtr<FFileTreeItem> Existing;
+    for (const TSharedPtr<FFileTreeItem> &Child : Children) {
+      if (!Child->bIsPlaceholder &&
+          Child->Name.IsEqual(Name, ENameCase::CaseSensitive)) {
+        Existing = Child;
+        break;
+      }
+    }
+
+    // Renames arrive as a removal and an addition; stat to see which state
+    // the entry ended up in
+    const FFileStatData StatData =
+        IFileManager::Get().GetStatData(*Change.Filename);
+    if (!StatData.bIsValid ||
+        Change.Action == FFileChangeData::FCA_Removed) {
+      if (Existing.IsValid() && !StatData.bIsValid) {
+        RemoveChild(DirectoryItem, Existing);
+      }
+    } else if (Existing.IsValid() &&
+               Existing->bIsDirectory == StatData.bIsDirectory) {
+      Existing->Size = StatData.bIsDirectory ? -1 : StatData.FileSize;
+      Existing->ModificationTime = StatData.ModificationTime;
+    } else {
+      if (Existing.IsValid()) {
+        RemoveChild(DirectoryItem, Existing);
+      }
+
+      const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+          Scope = FindIgnoreScope(DirectoryItem->GetPath());
+
+      FFileTreeEntry Entry;
+      Entry.Name = Name;
+      Entry.bIsDirectory = StatData.bIsDirectory;
+      Entry.bIsExcluded =
+          Scope.IsValid() &&
+          Scope->IsExcluded(DirectoryItem->GetPath(), CleanName,
+                            StatData.bIsDirectory);
+      Entry.Size = StatData.bIsDirectory ? -1 : StatData.FileSize;
+      Entry.ModificationTime = StatData.ModificationTime;
+      Children.Add(MakeItem(DirectoryItem, Entry));
+      SortChildren(Children);
+    }
+
+    bRootChanged |= DirectoryItem == RootItem;
   }
 
-  DirectoryItem->SetChildrenLoaded(true);
+  if (bRootChanged) {
+    RootItems = RootItem->Children;
+  }
+  if (TreeView.IsValid()) {
+    TreeView->RequestTreeRefresh();
+  }
 }
 
 TSharedRef<ITableRow>
 SFileTreeView::OnGenerateRow(TSharedPtr<FFileTreeItem> Item,
                              const TSharedRef<STableViewBase> &OwnerTable) {
+  if (Item->bIsPlaceholder) {
+    return SNew(STableRow<TSharedPtr<FFileTreeItem>>, OwnerTable)
+        .Style(
+            &FAppStyle::Get().GetWidgetStyle<FTableRowStyle>("TableView.Row"))
+        .Padding(FMargin(24.0f, 1.0f, 0.0f, 1.0f))
+            [SNew(STextBlock)
+                 .Text(LOCTEXT("Loading", "Loading..."))
+                 .Font(FCoreStyle::GetDefaultFontStyle("Italic", 10))
+                 .ColorAndOpacity(FileTreeColors::TextPlaceholder)];
+  }
+
   return SNew(STableRow<TSharedPtr<FFileTreeItem>>, OwnerTable)
       .Style(&FAppStyle::Get().GetWidgetStyle<FTableRowStyle>("TableView.Row"))
       .Padding(FMargin(0.0f, 1.0f))
+      .ToolTipText(GetToolTipForItem(Item))
           [SNew(SHorizontalBox)
 
            // File/Folder icon (using VS Code-style SVG icons)
@@ -332,7 +855,7 @@ SFileTreeView::OnGenerateRow(TSharedPtr<FFileTreeItem> Item,
            // File/Folder name
            + SHorizontalBox::Slot().FillWidth(1.0f).VAlign(VAlign_Center)
                  [SNew(STextBlock)
-                      .Text(FText::FromString(Item->DisplayName))
+                      .Text(FText::FromName(Item->Name))
                       .Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
                       .ColorAndOpacity(GetTextColorForItem(Item))]];
 }
@@ -340,17 +863,15 @@ SFileTreeView::OnGenerateRow(TSharedPtr<FFileTreeItem> Item,
 void SFileTreeView::OnGetChildren(
     TSharedPtr<FFileTreeItem> Item,
     TArray<TSharedPtr<FFileTreeItem>> &OutChildren) {
+  // Directories are listed when expanded; until then Children only holds a
+  // placeholder so the expander arrow shows
   if (Item.IsValid() && Item->bIsDirectory) {
-    // Lazy load children when needed
-    if (!Item->HasLoadedChildren()) {
-      PopulateChildren(Item);
-    }
     OutChildren = Item->Children;
   }
 }
 
 void SFileTreeView::OnItemDoubleClicked(TSharedPtr<FFileTreeItem> Item) {
-  if (!Item.IsValid()) {
+  if (!Item.IsValid() || Item->bIsPlaceholder) {
     return;
   }
 
@@ -362,7 +883,7 @@ void SFileTreeView::OnItemDoubleClicked(TSharedPtr<FFileTreeItem> Item) {
     }
   } else {
     // Fire callback for files
-    OnFileDoubleClicked.ExecuteIfBound(Item->Path);
+    OnFileDoubleClicked.ExecuteIfBound(Item->GetPath());
   }
 }
 
@@ -371,12 +892,25 @@ void SFileTreeView::OnExpansionChanged(TSharedPtr<FFileTreeItem> Item,
   if (Item.IsValid()) {
     Item->bIsExpanded = bExpanded;
 
-    // If expanding and children not loaded, load them
-    if (bExpanded && !Item->HasLoadedChildren()) {
-      PopulateChildren(Item);
+    // Filter results are complete as built and are not watched
+    if (IsFiltering()) {
       if (TreeView.IsValid()) {
         TreeView->RequestTreeRefresh();
       }
+      return;
+    }
+
+    // If expanding and children not loaded (or stale), list them. A
+    // collapsed folder stops being watched and abandons any listing in
+    // flight; it is reconciled again when reopened.
+    if (bExpanded && !Item->HasLoadedChildren()) {
+      PopulateChildren(Item);
+    } else if (!bExpanded) {
+      UnwatchSubtree(Item);
+    }
+
+    if (TreeView.IsValid()) {
+      TreeView->RequestTreeRefresh();
     }
   }
 }
@@ -409,9 +943,12 @@ SFileTreeView::GetIconForItem(TSharedPtr<FFileTreeItem> Item) const {
                : FAppStyle::GetBrush("ContentBrowser.AssetTreeFolderClosed");
   }
 
-  // Get VS Code file icon based on extension
-  const FString Ext = Item->GetExtension();
-  const FSlateBrush *Icon = IconManager.GetFileIcon(Ext);
+  // Get VS Code file icon based on extension, looked up once per item
+  if (Item->IconIndex == FFileTreeIconManager::NoIcon) {
+    Item->IconIndex = IconManager.FindFileIcon(FName(
+        *FPaths::GetExtension(Item->Name.ToString()), FNAME_Find));
+  }
+  const FSlateBrush *Icon = IconManager.GetIconBrush(Item->IconIndex);
 
   if (Icon) {
     return Icon;
@@ -438,9 +975,371 @@ SFileTreeView::GetTextColorForItem(TSharedPtr<FFileTreeItem> Item) const {
     return FSlateColor(FileTreeColors::TextSelected);
   }
 
+  if (GitStatus.IsValid()) {
+    switch (GitStatus->GetState(Item->GetPath(), Item->bIsDirectory,
+                                Item->bIsExcluded)) {
+    case EFileTreeGitState::Modified:
+      return FSlateColor(FileTreeColors::TextGitModified);
+    case EFileTreeGitState::Untracked:
+      return FSlateColor(FileTreeColors::TextGitUntracked);
+    case EFileTreeGitState::Ignored:
+      return FSlateColor(FileTreeColors::TextExcluded);
+    default:
+      break;
+    }
+  }
+
+  if (Item->bIsExcluded) {
+    return FSlateColor(FileTreeColors::TextExcluded);
+  }
+
   return FSlateColor(FileTreeColors::TextNormal);
 }
 
+FText SFileTreeView::GetToolTipForItem(TSharedPtr<FFileTreeItem> Item) const {
+  if (!Item.IsValid()) {
+    return FText::GetEmpty();
+  }
+
+  // Metadata comes from the listing; no extra I/O per row
+  const FText Modified =
+      Item->ModificationTime == FDateTime::MinValue()
+          ? FText::GetEmpty()
+          : FText::AsDateTime(Item->ModificationTime);
+  if (Item->bIsExcluded && Item->bIsDirectory) {
+    return FText::Format(
+        LOCTEXT("ExcludedFolderToolTip", "{0}\nExcluded from the file tree"),
+        FText::FromString(Item->GetPath()));
+  }
+  if (Item->bIsDirectory) {
+    return FText::Format(LOCTEXT("FolderToolTip", "{0}\nModified: {1}"),
+                         FText::FromString(Item->GetPath()), Modified);
+  }
+  return FText::Format(LOCTEXT("FileToolTip", "{0}\n{1} - Modified: {2}"),
+                       FText::FromString(Item->GetPath()),
+                       FText::AsMemory(FMath::Max<int64>(Item->Size, 0)),
+                       Modified);
+}
+
+void SFileTreeView::OnFilterTextChanged(const FText &Text) {
+  SetFilterText(Text.ToString());
+}
+
+void SFileTreeView::SetFilterText(const FString &Text) {
+  if (FilterBox.IsValid() && FilterBox->GetText().ToString() != Text) {
+    FilterBox->SetText(FText::FromString(Text));
+  }
+
+  const FString NewFilterText = Text.TrimStartAndEnd();
+  if (NewFilterText.Equals(FilterText, ESearchCase::CaseSensitive)) {
+    return;
+  }
+  FilterText = NewFilterText;
+
+  if (!TreeView.IsValid()) {
+    return;
+  }
+
+  if (!IsFiltering()) {
+    FilteredRootItems.Reset();
+    FilterMatches.Reset();
+    MatchedFilterText.Reset();
+    TreeView->SetTreeItemsSource(&RootItems);
+    TreeView->RequestTreeRefresh();
+    return;
+  }
+
+  TreeView->SetTreeItemsSource(&FilteredRootItems);
+  if (PathIndex.IsValid()) {
+    ApplyFilter();
+  } else {
+    BuildPathIndex();
+  }
+}
+
+void SFileTreeView::ApplyFilter() {
+  if (!PathIndex.IsValid() || !RootItem.IsValid() || !TreeView.IsValid()) {
+    return;
+  }
+
+  // Extending the filter can only drop matches, so only the previous ones
+  // are tested again
+  const bool bNarrows = !MatchedFilterText.IsEmpty() &&
+                        FilterText.StartsWith(MatchedFilterText);
+  TArray<int32> Matches;
+  PathIndex->Match(FilterText, bNarrows ? &FilterMatches : nullptr, Matches);
+  FilterMatches = MoveTemp(Matches);
+  MatchedFilterText = FilterText;
+
+  // Rebuild the matching branches; folders are shared by their matches
+  FilteredRootItems.Reset();
+  TMap<FString, TSharedPtr<FFileTreeItem>, FDefaultSetAllocator,
+       TCaseSensitiveKeyFuncs<TSharedPtr<FFileTreeItem>>>
+      Directories;
+  const int32 NumShown =
+      FMath::Min(FilterMatches.Num(), FileTreeFilter::MaxShownMatches);
+  for (int32 MatchIndex = 0; MatchIndex < NumShown; ++MatchIndex) {
+    const FStringView Path = PathIndex->GetPath(FilterMatches[MatchIndex]);
+    TSharedPtr<FFileTreeItem> ParentItem = RootItem;
+    TArray<TSharedPtr<FFileTreeItem>> *Siblings = &FilteredRootItems;
+
+    int32 SegmentStart = 0;
+    int32 SlashOffset = INDEX_NONE;
+    while (Path.RightChop(SegmentStart).FindChar('/', SlashOffset)) {
+      const int32 Slash = SegmentStart + SlashOffset;
+      TSharedPtr<FFileTreeItem> &Directory =
+          Directories.FindOrAdd(FString(Path.Left(Slash)));
+      if (!Directory.IsValid()) {
+        Directory = MakeShared<FFileTreeItem>(
+            FName(Slash - SegmentStart, Path.GetData() + SegmentStart), true);
+        Directory->Parent = ParentItem;
+        Directory->SetChildrenLoaded(true);
+        Siblings->Add(Directory);
+      }
+      ParentItem = Directory;
+      Siblings = &Directory->Children;
+      SegmentStart = Slash + 1;
+    }
+
+    TSharedRef<FFileTreeItem> File = MakeShared<FFileTreeItem>(
+        FName(Path.Len() - SegmentStart, Path.GetData() + SegmentStart),
+        false);
+    File->Parent = ParentItem;
+    Siblings->Add(File);
+  }
+
+  SortChildren(FilteredRootItems);
+  for (const TPair<FString, TSharedPtr<FFileTreeItem>> &Pair : Directories) {
+    SortChildren(Pair.Value->Children);
+    TreeView->SetItemExpansion(Pair.Value, true);
+  }
+  TreeView->RequestTreeRefresh();
+}
+
+void SFileTreeView::BuildPathIndex() {
+  if (PathIndexCancelled.IsValid() || !RootItem.IsValid()) {
+    return;
+  }
+
+  // Filtering shows a "Loading..." row until the first index arrives;
+  // rebuilds keep showing the current one
+  if (IsFiltering() && !PathIndex.IsValid()) {
+    FilteredRootItems.Reset();
+    FilteredRootItems.Add(MakePlaceholder(RootItem));
+    if (TreeView.IsValid()) {
+      TreeView->RequestTreeRefresh();
+    }
+  }
+
+  // The walk sees every change made before it starts
+  PendingIndexChanges.Reset();
+  bPathIndexNeedsRebuild = false;
+
+  TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled =
+      MakeShared<FThreadSafeBool, ESPMode::ThreadSafe>(false);
+  PathIndexCancelled = Cancelled;
+
+  TWeakPtr<SFileTreeView> WeakView =
+      StaticCastSharedRef<SFileTreeView>(AsShared());
+  FFileTreePathIndex::BuildAsync(
+      RootItem->GetPath(), DefaultIgnoreScope, Cancelled,
+      [WeakView](
+          TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index) {
+        TSharedPtr<SFileTreeView> View = WeakView.Pin();
+        if (!View.IsValid()) {
+          return;
+        }
+
+        View->PathIndexCancelled.Reset();
+        View->SetPathIndex(Index);
+
+        // Apply what changed during the walk
+        View->UpdatePathIndex();
+      });
+}
+
+void SFileTreeView::ResetPathIndex() {
+  if (PathIndexCancelled.IsValid()) {
+    *PathIndexCancelled = true;
+    PathIndexCancelled.Reset();
+  }
+  PathIndex.Reset();
+  MatchedFilterText.Reset();
+  FilterMatches.Reset();
+  PendingIndexChanges.Reset();
+  bPathIndexNeedsRebuild = false;
+}
+
+TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe>
+SFileTreeView::GetPathIndex() {
+  if (!PathIndex.IsValid()) {
+    BuildPathIndex();
+  }
+  return PathIndex;
+}
+
+void SFileTreeView::SetPathIndex(
+    TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index) {
+  PathIndex = Index;
+  MatchedFilterText.Reset();
+  if (IsFiltering()) {
+    ApplyFilter();
+  }
+  PathIndexChangedEvent.Broadcast();
+}
+
+void SFileTreeView::QueuePathIndexChanges(
+    const TArray<FFileChangeData> &Changes) {
+  if (!RootItem.IsValid() ||
+      (!PathIndex.IsValid() && !PathIndexCancelled.IsValid())) {
+    return;
+  }
+
+  TArray<FString> ChangedFiles;
+  for (const FFileChangeData &Change : Changes) {
+    if (Change.Action == FFileChangeData::FCA_RescanRequired) {
+      bPathIndexNeedsRebuild = true;
+      continue;
+    }
+
+    const FString Path = GetWatchKey(Change.Filename);
+    if (!Path.StartsWith(RootWatchPath + TEXT("/"))) {
+      continue;
+    }
+    const FString RelativePath = Path.RightChop(RootWatchPath.Len() + 1);
+
+    // Edited ignore rules can change what the whole index holds
+    if (FFileTreeIgnoreScope::IsIgnoreFileName(
+            FPaths::GetCleanFilename(RelativePath))) {
+      bPathIndexNeedsRebuild = true;
+      continue;
+    }
+    if (Change.Action == FFileChangeData::FCA_Modified) {
+      if (!IsPathExcluded(RelativePath, false)) {
+        ChangedFiles.Add(RelativePath);
+      }
+      continue;
+    }
+
+    // Build output churning in excluded folders is dropped before anything
+    // touches the disk; the rest is stat'ed by the update, off this thread
+    const bool bMayBeFile = !IsPathExcluded(RelativePath, false);
+    const bool bMayBeFolder = !IsPathExcluded(RelativePath, true);
+    if (!bMayBeFile && !bMayBeFolder) {
+      continue;
+    }
+    FFileTreePathChange &Pending = PendingIndexChanges.FindOrAdd(RelativePath);
+    Pending.bMayBeFile = bMayBeFile;
+    Pending.bMayBeAddedFolder |=
+        bMayBeFolder && Change.Action == FFileChangeData::FCA_Added;
+  }
+
+  if (ChangedFiles.Num() > 0) {
+    FilesChangedEvent.Broadcast(ChangedFiles);
+  }
+}
+
+bool SFileTreeView::IsPathExcluded(const FString &RelativePath,
+                                   bool bIsDirectory) const {
+  TArray<FString> Segments;
+  RelativePath.ParseIntoArray(Segments, TEXT("/"));
+
+  // Same rules as the index walk: hidden entries and anything excluded
+  FString DirectoryPath = RootItem->GetPath();
+  for (int32 Index = 0; Index < Segments.Num(); ++Index) {
+    const FString &Segment = Segments[Index];
+    if (Segment.StartsWith(TEXT("."))) {
+      return true;
+    }
+
+    const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe> Scope =
+        FindIgnoreScope(DirectoryPath);
+    const bool bSegmentIsDirectory =
+        Index < Segments.Num() - 1 || bIsDirectory;
+    if (Scope.IsValid() &&
+        Scope->IsExcluded(DirectoryPath, Segment, bSegmentIsDirectory)) {
+      return true;
+    }
+    DirectoryPath /= Segment;
+  }
+  return false;
+}
+
+void SFileTreeView::UpdatePathIndex() {
+  // A walk in flight applies the queue when it finishes, and so does an
+  // update in flight
+  if (!PathIndex.IsValid() || PathIndexCancelled.IsValid() ||
+      bPathIndexUpdating) {
+    return;
+  }
+
+  // The current index stays in use until the new walk is done
+  if (bPathIndexNeedsRebuild) {
+    BuildPathIndex();
+    return;
+  }
+
+  if (PendingIndexChanges.Num() == 0) {
+    return;
+  }
+
+  bPathIndexUpdating = true;
+  TWeakPtr<SFileTreeView> WeakView =
+      StaticCastSharedRef<SFileTreeView>(AsShared());
+  Async(EAsyncExecution::ThreadPool, [WeakView, RootPath = RootWatchPath,
+                                      OldIndex = PathIndex.ToSharedRef(),
+                                      Changes = MoveTemp(
+                                          PendingIndexChanges)]() {
+    // Each path is taken in the state it ended up in, so a file created
+    // and deleted again between updates leaves no trace
+    TArray<FString> Added;
+    TArray<FString> Removed;
+    bool bFolderAdded = false;
+    for (const TPair<FString, FFileTreePathChange> &Change : Changes) {
+      const FFileStatData StatData =
+          IFileManager::Get().GetStatData(*(RootPath / Change.Key));
+      if (!StatData.bIsValid) {
+        Removed.Add(Change.Key);
+      } else if (StatData.bIsDirectory) {
+        // A folder moved in brings files that raise no events of their own
+        bFolderAdded |= Change.Value.bMayBeAddedFolder;
+      } else if (Change.Value.bMayBeFile) {
+        Added.Add(Change.Key);
+      }
+    }
+
+    TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index =
+        FFileTreePathIndex::WithChanges(*OldIndex, Added, Removed);
+
+    AsyncTask(ENamedThreads::GameThread, [WeakView, OldIndex, Index,
+                                          Added = MoveTemp(Added),
+                                          bFolderAdded]() {
+      TSharedPtr<SFileTreeView> View = WeakView.Pin();
+      if (!View.IsValid()) {
+        return;
+      }
+
+      // A walk that finished meanwhile already covers these changes
+      View->bPathIndexUpdating = false;
+      if (View->PathIndex == OldIndex) {
+        View->bPathIndexNeedsRebuild |= bFolderAdded;
+        View->SetPathIndex(Index);
+      }
+      if (Added.Num() > 0) {
+        View->FilesChangedEvent.Broadcast(Added);
+      }
+      View->UpdatePathIndex();
+    });
+  });
+  PendingIndexChanges.Reset();
+}
+
+void SFileTreeView::RedrawRows() {
+  if (TreeView.IsValid()) {
+    TreeView->RebuildList();
+  }
+}
+
 FReply SFileTreeView::OnRefreshClicked() {
   RefreshTree();
   return FReply::Handled();
@@ -452,26 +1351,110 @@ FReply SFileTreeView::OnCollapseAllClicked() {
 }
 
 void SFileTreeView::ExpandAll() {
-  if (!TreeView.IsValid()) {
+  if (!TreeView.IsValid() || !RootItem.IsValid()) {
     return;
   }
 
-  TFunction<void(const TArray<TSharedPtr<FFileTreeItem>> &)> ExpandRecursive;
-  ExpandRecursive =
-      [this, &ExpandRecursive](const TArray<TSharedPtr<FFileTreeItem>> &Items) {
-        for (const auto &Item : Items) {
-          if (Item->bIsDirectory) {
-            if (!Item->HasLoadedChildren()) {
-              PopulateChildren(Item);
-            }
-            TreeView->SetItemExpansion(Item, true);
-            ExpandRecursive(Item->Children);
-          }
-        }
-      };
+  // Expanding a large project synchronously would list thousands of folders
+  // in one frame, so the tree is walked breadth first by an active timer
+  StopExpandAll();
+  ExpandAllNodeCount = RootItems.Num();
+  QueueExpandAllChildren(RootItem, 0);
+  ExpandAllTimer = RegisterActiveTimer(
+      0.0f, FWidgetActiveTimerDelegate::CreateSP(
+                this, &SFileTreeView::TickExpandAll));
+}
+
+EActiveTimerReturnType SFileTreeView::TickExpandAll(double InCurrentTime,
+                                                    float InDeltaTime) {
+  if (!TreeView.IsValid()) {
+    StopExpandAll();
+    return EActiveTimerReturnType::Stop;
+  }
+
+  const double EndTime =
+      FPlatformTime::Seconds() + FileTreeExpandAll::FrameBudgetSeconds;
+
+  // Descend into folders whose listing has arrived; drop those whose
+  // listing was abandoned (e.g. collapsed by hand meanwhile)
+  for (int32 Index = ExpandAllAwaiting.Num() - 1; Index >= 0; --Index) {
+    const FExpandAllEntry Entry = ExpandAllAwaiting[Index];
+    if (Entry.Item->HasLoadedChildren()) {
+      ExpandAllAwaiting.RemoveAtSwap(Index);
+      QueueExpandAllChildren(Entry.Item, Entry.Depth + 1);
+    } else if (!Entry.Item->IsLoadingChildren()) {
+      ExpandAllAwaiting.RemoveAtSwap(Index);
+    }
+  }
+
+  const int32 MaxNodes = CVarICEExpandAllMaxNodes.GetValueOnGameThread();
+  while (ExpandAllQueueHead < ExpandAllQueue.Num() &&
+         FPlatformTime::Seconds() < EndTime) {
+    if (ExpandAllNodeCount >= MaxNodes) {
+      UE_LOG(LogTemp, Log,
+             TEXT("InlineCodeEditor: Expand All stopped after %d items ")
+                 TEXT("(ICE.FileTree.ExpandAllMaxNodes)"),
+             ExpandAllNodeCount);
+      StopExpandAll();
+      break;
+    }
+
+    const FExpandAllEntry Entry = ExpandAllQueue[ExpandAllQueueHead++];
+    TreeView->SetItemExpansion(Entry.Item, true);
+
+    // Already expanded folders get no expansion event; make sure they are
+    // listed all the same
+    PopulateChildren(Entry.Item);
+    if (Entry.Item->HasLoadedChildren()) {
+      QueueExpandAllChildren(Entry.Item, Entry.Depth + 1);
+    } else {
+      ExpandAllAwaiting.Add(Entry);
+    }
+  }
 
-  ExpandRecursive(RootItems);
   TreeView->RequestTreeRefresh();
+
+  if (ExpandAllQueueHead < ExpandAllQueue.Num() ||
+      ExpandAllAwaiting.Num() > 0) {
+    return EActiveTimerReturnType::Continue;
+  }
+
+  ExpandAllTimer.Reset();
+  StopExpandAll();
+  return EActiveTimerReturnType::Stop;
+}
+
+void SFileTreeView::QueueExpandAllChildren(
+    const TSharedPtr<FFileTreeItem> &DirectoryItem, int32 Depth) {
+  if (Depth > FileTreeExpandAll::MaxDepth) {
+    return;
+  }
+
+  IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+  for (const TSharedPtr<FFileTreeItem> &Child : DirectoryItem->Children) {
+    if (Child->bIsPlaceholder) {
+      continue;
+    }
+    ++ExpandAllNodeCount;
+
+    // Symlinked folders can point back up the tree; they are shown but
+    // never followed
+    if (Child->bIsDirectory && !Child->bIsExcluded &&
+        PlatformFile.IsSymlink(*Child->GetPath()) != ESymlinkResult::Symlink) {
+      ExpandAllQueue.Add({Child, Depth});
+    }
+  }
+}
+
+void SFileTreeView::StopExpandAll() {
+  if (ExpandAllTimer.IsValid()) {
+    UnRegisterActiveTimer(ExpandAllTimer.ToSharedRef());
+    ExpandAllTimer.Reset();
+  }
+  ExpandAllQueue.Empty();
+  ExpandAllQueueHead = 0;
+  ExpandAllAwaiting.Empty();
+  ExpandAllNodeCount = 0;
 }
 
 void SFileTreeView::CollapseAll() {
@@ -491,13 +1474,14 @@ void SFileTreeView::CollapseAll() {
     }
   };
 
+  StopExpandAll();
   CollapseRecursive(RootItems);
   TreeView->RequestTreeRefresh();
 }
 
 FString SFileTreeView::GetSelectedFilePath() const {
   if (SelectedItem.IsValid() && !SelectedItem->bIsDirectory) {
-    return SelectedItem->Path;
+    return SelectedItem->GetPath();
   }
   return FString();
 }
@@ -0,0 +1,621 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "SFindInFiles.h"
+#include "CodeRename.h"
+#include "CodeSymbolIndex.h"
+#include "FileTreeIconManager.h"
+#include "FileTreePathIndex.h"
+#include "FindInFiles.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Misc/Paths.h"
+#include "Styling/AppStyle.h"
+#include "Widgets/Images/SImage.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/STableRow.h"
+
+#define LOCTEXT_NAMESPACE "SFindInFiles"
+
+namespace FindInFilesColors {
+const FLinearColor Background =
+    FLinearColor::FromSRGBColor(FColor::FromHex("1E1E1EFF")); // Same as tree
+const FLinearColor TextNormal = FLinearColor(0.8f, 0.8f, 0.8f); // #CCCCCC
+const FLinearColor TextDim =
+    FLinearColor(0.549f, 0.549f, 0.549f); // #8C8C8C - Dim gray
+const FLinearColor MatchHighlight =
+    FLinearColor::FromSRGBColor(FColor::FromHex("623F1EFF")); // Find match
+} // namespace FindInFilesColors
+
+void SFindInFiles::Construct(const FArguments &InArgs) {
+  OnMatchChosen = InArgs._OnMatchChosen;
+  OnRenameAccepted = InArgs._OnRenameAccepted;
+
+  ChildSlot
+      [SNew(SBorder)
+           .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+           .BorderBackgroundColor(FindInFilesColors::Background)
+           .Padding(0)
+               [SNew(SVerticalBox)
+
+                // Title
+                + SVerticalBox::Slot().AutoHeight().Padding(8.0f, 6.0f)
+                      [SNew(STextBlock)
+                           .Text(LOCTEXT("SearchTitle", "SEARCH"))
+                           .Font(FCoreStyle::GetDefaultFontStyle("Bold", 10))
+                           .ColorAndOpacity(FindInFilesColors::TextNormal)]
+
+                // Query box and options
+                + SVerticalBox::Slot().AutoHeight().Padding(8.0f, 2.0f)
+                      [SNew(SHorizontalBox)
+
+                       + SHorizontalBox::Slot().FillWidth(1.0f)
+                             [SAssignNew(SearchBox, SSearchBox)
+                                  .HintText(LOCTEXT("SearchHint",
+                                                    "Search (Enter)"))
+                                  .OnTextCommitted(
+                                      this, &SFindInFiles::OnQueryCommitted)]
+
+                       // Match case toggle
+                       + SHorizontalBox::Slot().AutoWidth().Padding(2.0f,
+                                                                    0.0f)
+                             [SNew(SCheckBox)
+                                  .Style(FAppStyle::Get(),
+                                         "ToggleButtonCheckbox")
+                                  .ToolTipText(
+                                      LOCTEXT("MatchCase", "Match Case"))
+                                  .IsChecked_Lambda([this]() {
+                                    return bMatchCase
+                                               ? ECheckBoxState::Checked
+                                               : ECheckBoxState::Unchecked;
+                                  })
+                                  .OnCheckStateChanged_Lambda(
+                                      [this](ECheckBoxState State) {
+                                        bMatchCase =
+                                            State == ECheckBoxState::Checked;
+                                        StartSearch();
+                                      })[SNew(STextBlock)
+                                             .Text(FText::FromString(
+                                                 TEXT("Aa")))]]
+
+                       // Whole word toggle
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SCheckBox)
+                                  .Style(FAppStyle::Get(),
+                                         "ToggleButtonCheckbox")
+                                  .ToolTipText(LOCTEXT("WholeWord",
+                                                       "Match Whole Word"))
+                                  .IsChecked_Lambda([this]() {
+                                    return bWholeWord
+                                               ? ECheckBoxState::Checked
+                                               : ECheckBoxState::Unchecked;
+                                  })
+                                  .OnCheckStateChanged_Lambda(
+                                      [this](ECheckBoxState State) {
+                                        bWholeWord =
+                                            State == ECheckBoxState::Checked;
+                                        StartSearch();
+                                      })[SNew(STextBlock)
+                                             .Text(FText::FromString(
+                                                 TEXT("ab")))]]
+
+                       // Regular expression toggle
+                       + SHorizontalBox::Slot().AutoWidth().Padding(2.0f,
+                                                                    0.0f)
+                             [SNew(SCheckBox)
+                                  .Style(FAppStyle::Get(),
+                                         "ToggleButtonCheckbox")
+                                  .ToolTipText(LOCTEXT(
+                                      "Regex", "Use Regular Expression"))
+                                  .IsChecked_Lambda([this]() {
+                                    return bRegex
+                                               ? ECheckBoxState::Checked
+                                               : ECheckBoxState::Unchecked;
+                                  })
+                                  .OnCheckStateChanged_Lambda(
+                                      [this](ECheckBoxState State) {
+                                        bRegex =
+                                            State == ECheckBoxState::Checked;
+                                        StartSearch();
+                                      })[SNew(STextBlock)
+                                             .Text(FText::FromString(
+                                                 TEXT(".*")))]]]
+
+                // New name, while uses are listed to be renamed
+                + SVerticalBox::Slot().AutoHeight().Padding(8.0f, 2.0f)
+                      [SNew(SHorizontalBox)
+                           .Visibility_Lambda([this]() {
+                             return bRenaming ? EVisibility::Visible
+                                              : EVisibility::Collapsed;
+                           })
+
+                       + SHorizontalBox::Slot().AutoWidth().VAlign(
+                             VAlign_Center)
+                             [SNew(STextBlock)
+                                  .Text_Lambda([this]() {
+                                    return FText::Format(
+                                        LOCTEXT("RenameTo", "Rename {0} to"),
+                                        FText::FromString(ReferencesName));
+                                  })
+                                  .ColorAndOpacity(
+                                      FindInFilesColors::TextNormal)]
+
+                       + SHorizontalBox::Slot().FillWidth(1.0f).Padding(
+                             4.0f, 0.0f)
+                             [SAssignNew(NewNameBox, SEditableTextBox)
+                                  .SelectAllTextWhenFocused(true)
+                                  .OnTextCommitted(
+                                      this,
+                                      &SFindInFiles::OnNewNameCommitted)]
+
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SButton)
+                                  .ButtonStyle(FAppStyle::Get(), "FlatButton")
+                                  .ContentPadding(FMargin(4.0f, 0.0f))
+                                  .IsEnabled(this,
+                                             &SFindInFiles::CanApplyRename)
+                                  .OnClicked_Lambda([this]() {
+                                    ApplyRename();
+                                    return FReply::Handled();
+                                  })[SNew(STextBlock)
+                                         .Text(LOCTEXT("Apply", "Apply"))
+                                         .ColorAndOpacity(
+                                             FindInFilesColors::TextNormal)]]
+
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SButton)
+                                  .ButtonStyle(FAppStyle::Get(), "FlatButton")
+                                  .ContentPadding(FMargin(4.0f, 0.0f))
+                                  .OnClicked_Lambda([this]() {
+                                    bRenaming = false;
+                                    return FReply::Handled();
+                                  })[SNew(STextBlock)
+                                         .Text(LOCTEXT("Cancel", "Cancel"))
+                                         .ColorAndOpacity(
+                                             FindInFilesColors::TextNormal)]]]
+
+                // Progress or summary, with a stop button while searching
+                + SVerticalBox::Slot().AutoHeight().Padding(8.0f, 4.0f)
+                      [SNew(SHorizontalBox)
+
+                       + SHorizontalBox::Slot().FillWidth(1.0f).VAlign(
+                             VAlign_Center)
+                             [SNew(STextBlock)
+                                  .Text(this, &SFindInFiles::GetStatusText)
+                                  .Font(FCoreStyle::GetDefaultFontStyle(
+                                      "Italic", 9))
+                                  .ColorAndOpacity(FindInFilesColors::TextDim)]
+
+                       + SHorizontalBox::Slot().AutoWidth()
+                             [SNew(SButton)
+                                  .ButtonStyle(FAppStyle::Get(), "FlatButton")
+                                  .ContentPadding(FMargin(4.0f, 0.0f))
+                                  .Visibility_Lambda([this]() {
+                                    return Search.IsValid() &&
+                                                   Search->IsRunning()
+                                               ? EVisibility::Visible
+                                               : EVisibility::Collapsed;
+                                  })
+                                  .OnClicked_Lambda([this]() {
+                                    StopSearch();
+                                    return FReply::Handled();
+                                  })[SNew(STextBlock)
+                                         .Text(LOCTEXT("Stop", "Stop"))
+                                         .ColorAndOpacity(
+                                             FindInFilesColors::TextNormal)]]]
+
+                // Results
+                + SVerticalBox::Slot().FillHeight(1.0f).Padding(4.0f, 0.0f)
+                      [SAssignNew(ResultsView,
+                                  SListView<TSharedPtr<FFindInFilesRow>>)
+                           .ListItemsSource(&Rows)
+                           .OnGenerateRow(this, &SFindInFiles::OnGenerateRow)
+                           .OnMouseButtonClick(this,
+                                               &SFindInFiles::OnRowClicked)
+                           .SelectionMode(ESelectionMode::Single)]]];
+}
+
+SFindInFiles::~SFindInFiles() { StopSearch(); }
+
+void SFindInFiles::SetRootPath(const FString &InRootPath) {
+  ResetResults();
+  RootPath = InRootPath;
+  PathIndex.Reset();
+  Index = FFindInFilesIndex::Create(RootPath);
+}
+
+void SFindInFiles::SetPathIndex(
+    TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> InPathIndex) {
+  PathIndex = InPathIndex;
+  if (Index.IsValid() && PathIndex.IsValid()) {
+    Index->SetPathIndex(PathIndex.ToSharedRef());
+  }
+  if (bSearchPending && PathIndex.IsValid()) {
+    StartSearch();
+  }
+}
+
+void SFindInFiles::HandleFilesChanged(const TArray<FString> &RelativePaths) {
+  if (Index.IsValid()) {
+    Index->HandleFilesChanged(RelativePaths);
+  }
+}
+
+void SFindInFiles::FocusSearchBox() {
+  if (SearchBox.IsValid()) {
+    FSlateApplication::Get().SetKeyboardFocus(SearchBox,
+                                              EFocusCause::SetDirectly);
+  }
+}
+
+void SFindInFiles::ShowReferences(const FString &Name,
+                                  TArray<FCodeReferences> &&References) {
+  ResetResults();
+  ReferencesName = Name;
+  if (SearchBox.IsValid()) {
+    SearchBox->SetText(FText::FromString(Name));
+  }
+
+  // Only positions are known; the search reads the previews
+  TArray<FFindInFilesResult> Files;
+  Files.Reserve(References.Num());
+  for (FCodeReferences &File : References) {
+    FFindInFilesResult &Result = Files.AddDefaulted_GetRef();
+    Result.Path = MoveTemp(File.Path);
+    Result.Matches.SetNum(File.Positions.Num());
+    for (int32 Use = 0; Use < File.Positions.Num(); ++Use) {
+      Result.Matches[Use].Line = File.Positions[Use].X;
+      Result.Matches[Use].Column = File.Positions[Use].Y;
+    }
+  }
+
+  TWeakPtr<SFindInFiles> WeakPanel =
+      StaticCastSharedRef<SFindInFiles>(AsShared());
+  Search = FFindInFilesSearch::StartAt(
+      RootPath, Name, MoveTemp(Files),
+      [WeakPanel](TArray<FFindInFilesResult> &&Results) {
+        if (TSharedPtr<SFindInFiles> Panel = WeakPanel.Pin()) {
+          Panel->HandleResults(MoveTemp(Results));
+        }
+      },
+      [WeakPanel](bool bReachedMax) {
+        if (TSharedPtr<SFindInFiles> Panel = WeakPanel.Pin()) {
+          Panel->HandleFinished(bReachedMax);
+        }
+      });
+}
+
+void SFindInFiles::ShowRename(const FString &Name,
+                              TArray<FCodeReferences> &&References) {
+  ShowReferences(Name, MoveTemp(References));
+  bRenaming = true;
+  if (NewNameBox.IsValid()) {
+    NewNameBox->SetText(FText::FromString(Name));
+    FSlateApplication::Get().SetKeyboardFocus(NewNameBox,
+                                              EFocusCause::SetDirectly);
+  }
+}
+
+void SFindInFiles::ShowNotice(const FText &InNotice) { Notice = InNotice; }
+
+bool SFindInFiles::CanApplyRename() const {
+  // Uses of a stopped search are only some of them; renaming those alone
+  // would leave the others behind
+  if (!bRenaming || !NewNameBox.IsValid() || !bSearchCompleted ||
+      NumResultMatches == 0) {
+    return false;
+  }
+  const FString NewName = NewNameBox->GetText().ToString();
+  return FCodeRename::IsValidName(NewName) &&
+         !NewName.Equals(ReferencesName, ESearchCase::CaseSensitive);
+}
+
+void SFindInFiles::ApplyRename() {
+  if (!CanApplyRename()) {
+    return;
+  }
+
+  // The rows hold the uses as read, each file once before its uses
+  TArray<FFindInFilesResult> Files;
+  Files.Reserve(NumResultFiles);
+  for (const TSharedPtr<FFindInFilesRow> &Row : Rows) {
+    if (Row->MatchIndex == INDEX_NONE) {
+      Files.Add(*Row->File);
+    }
+  }
+
+  const FString NewName = NewNameBox->GetText().ToString();
+  bRenaming = false;
+  Notice = FText::Format(LOCTEXT("Renaming", "Renaming {0} to {1}..."),
+                         FText::FromString(ReferencesName),
+                         FText::FromString(NewName));
+  OnRenameAccepted.ExecuteIfBound(ReferencesName, NewName, Files);
+}
+
+void SFindInFiles::ResetResults() {
+  StopSearch();
+  Search.Reset();
+  Rows.Reset();
+  NumResultFiles = 0;
+  NumResultMatches = 0;
+  bReachedMaxResults = false;
+  bSearchCompleted = false;
+  bSearchPending = false;
+  QueryError = FText::GetEmpty();
+  ReferencesName.Reset();
+  bRenaming = false;
+  Notice = FText::GetEmpty();
+  if (ResultsView.IsValid()) {
+    ResultsView->RequestListRefresh();
+  }
+}
+
+void SFindInFiles::StartSearch() {
+  ResetResults();
+
+  FFindInFilesQuery Query;
+  if (SearchBox.IsValid()) {
+    Query.Text = SearchBox->GetText().ToString();
+  }
+  Query.bMatchCase = bMatchCase;
+  Query.bWholeWord = bWholeWord;
+  Query.bRegex = bRegex;
+  if (Query.Text.IsEmpty()) {
+    return;
+  }
+  if (Query.bRegex &&
+      !FFindInFilesSearch::CompileRegex(Query, QueryError).IsValid()) {
+    return;
+  }
+
+  // The owner hands over the index once the file tree has built it
+  if (!PathIndex.IsValid()) {
+    bSearchPending = true;
+    return;
+  }
+
+  TWeakPtr<SFindInFiles> WeakPanel =
+      StaticCastSharedRef<SFindInFiles>(AsShared());
+  Search = FFindInFilesSearch::Start(
+      RootPath, PathIndex.ToSharedRef(),
+      Index.IsValid() ? Index->GetFilter() : FFindInFilesFilter(), Query,
+      [WeakPanel](TArray<FFindInFilesResult> &&Results) {
+        if (TSharedPtr<SFindInFiles> Panel = WeakPanel.Pin()) {
+          Panel->HandleResults(MoveTemp(Results));
+        }
+      },
+      [WeakPanel](bool bReachedMax) {
+        if (TSharedPtr<SFindInFiles> Panel = WeakPanel.Pin()) {
+          Panel->HandleFinished(bReachedMax);
+        }
+      });
+}
+
+void SFindInFiles::StopSearch() {
+  if (Search.IsValid()) {
+    Search->Cancel();
+  }
+}
+
+void SFindInFiles::HandleResults(TArray<FFindInFilesResult> &&NewResults) {
+  for (FFindInFilesResult &Result : NewResults) {
+    TSharedPtr<FFindInFilesResult> File =
+        MakeShared<FFindInFilesResult>(MoveTemp(Result));
+    ++NumResultFiles;
+    NumResultMatches += File->Matches.Num();
+
+    Rows.Add(MakeShared<FFindInFilesRow>(FFindInFilesRow{File}));
+    for (int32 Index = 0; Index < File->Matches.Num(); ++Index) {
+      Rows.Add(MakeShared<FFindInFilesRow>(FFindInFilesRow{File, Index}));
+    }
+  }
+
+  if (ResultsView.IsValid()) {
+    ResultsView->RequestListRefresh();
+  }
+}
+
+void SFindInFiles::HandleFinished(bool bInReachedMaxResults) {
+  bReachedMaxResults = bInReachedMaxResults;
+  bSearchCompleted = true;
+}
+
+FText SFindInFiles::GetStatusText() const {
+  if (!QueryError.IsEmpty()) {
+    return QueryError;
+  }
+  if (!Notice.IsEmpty()) {
+    return Notice;
+  }
+  if (bSearchPending) {
+    return LOCTEXT("Indexing", "Indexing files...");
+  }
+  if (!Search.IsValid()) {
+    return FText::GetEmpty();
+  }
+  if (!ReferencesName.IsEmpty()) {
+    const FText Name = FText::FromString(ReferencesName);
+    if (Search->IsRunning()) {
+      return FText::Format(
+          LOCTEXT("ReadingReferences",
+                  "Reading {0} of {1} files, {2} references so far..."),
+          FText::AsNumber(Search->GetNumFilesSearched()),
+          FText::AsNumber(Search->GetNumFiles()),
+          FText::AsNumber(NumResultMatches));
+    }
+    if (NumResultMatches == 0) {
+      return FText::Format(LOCTEXT("NoReferences", "No references to {0}"),
+                           Name);
+    }
+    if (bRenaming && !bSearchCompleted) {
+      return FText::Format(
+          LOCTEXT("RenameStopped",
+                  "Stopped after {0} uses of {1}; rename again to find "
+                  "them all"),
+          FText::AsNumber(NumResultMatches), Name);
+    }
+    if (bRenaming) {
+      return FText::Format(LOCTEXT("RenameSummary",
+                                   "{0} uses of {1} in {2} files will be "
+                                   "renamed"),
+                           FText::AsNumber(NumResultMatches), Name,
+                           FText::AsNumber(NumResultFiles));
+    }
+    return FText::Format(
+        LOCTEXT("ReferencesSummary", "{0} references to {1} in {2} files"),
+        FText::AsNumber(NumResultMatches), Name,
+        FText::AsNumber(NumResultFiles));
+  }
+  if (Search->IsRunning()) {
+    return FText::Format(
+        LOCTEXT("Searching",
+                "Searching {0} of {1} files, {2} results so far..."),
+        FText::AsNumber(Search->GetNumFilesSearched()),
+        FText::AsNumber(Search->GetNumFiles()),
+        FText::AsNumber(NumResultMatches));
+  }
+  if (NumResultMatches == 0) {
+    return LOCTEXT("NoResults", "No results found");
+  }
+
+  const FText Summary =
+      FText::Format(LOCTEXT("Summary", "{0} results in {1} files"),
+                    FText::AsNumber(NumResultMatches),
+                    FText::AsNumber(NumResultFiles));
+  if (bReachedMaxResults) {
+    return FText::Format(
+        LOCTEXT("SummaryCapped", "{0} (stopped at the result limit)"),
+        Summary);
+  }
+  return Summary;
+}
+
+void SFindInFiles::OnNewNameCommitted(const FText &Text,
+                                      ETextCommit::Type CommitType) {
+  if (CommitType == ETextCommit::OnEnter) {
+    ApplyRename();
+  }
+}
+
+void SFindInFiles::OnQueryCommitted(const FText &Text,
+                                    ETextCommit::Type CommitType) {
+  if (CommitType == ETextCommit::OnEnter) {
+    StartSearch();
+  }
+}
+
+TSharedRef<ITableRow>
+SFindInFiles::OnGenerateRow(TSharedPtr<FFindInFilesRow> Row,
+                            const TSharedRef<STableViewBase> &Owner) {
+  const FFindInFilesResult &File = *Row->File;
+  TSharedPtr<SWidget> Content;
+
+  if (Row->MatchIndex == INDEX_NONE) {
+    // File: icon, name, folder and match count
+    const FString Name = FPaths::GetCleanFilename(File.Path);
+    const FSlateBrush *Icon = FFileTreeIconManager::Get().GetFileIcon(
+        FName(*FPaths::GetExtension(Name), FNAME_Find));
+
+    Content =
+        SNew(SHorizontalBox)
+
+        + SHorizontalBox::Slot()
+              .AutoWidth()
+              .VAlign(VAlign_Center)
+              .Padding(2.0f, 0.0f, 6.0f, 0.0f)
+                  [SNew(SImage)
+                       .Image(Icon ? Icon
+                                   : FAppStyle::GetBrush(
+                                         "ContentBrowser.AssetActions."
+                                         "ReimportAsset"))
+                       .DesiredSizeOverride(FVector2D(16.0f, 16.0f))]
+
+        + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+              [SNew(STextBlock)
+                   .Text(FText::FromString(Name))
+                   .Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
+                   .ColorAndOpacity(FindInFilesColors::TextNormal)]
+
+        + SHorizontalBox::Slot()
+              .FillWidth(1.0f)
+              .VAlign(VAlign_Center)
+              .Padding(8.0f, 0.0f, 0.0f, 0.0f)
+                  [SNew(STextBlock)
+                       .Text(FText::FromString(FPaths::GetPath(File.Path)))
+                       .Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+                       .ColorAndOpacity(FindInFilesColors::TextDim)
+                       .OverflowPolicy(ETextOverflowPolicy::Ellipsis)]
+
+        + SHorizontalBox::Slot()
+              .AutoWidth()
+              .VAlign(VAlign_Center)
+              .Padding(4.0f, 0.0f)
+                  [SNew(STextBlock)
+                       .Text(FText::AsNumber(File.Matches.Num()))
+                       .Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+                       .ColorAndOpacity(FindInFilesColors::TextDim)];
+  } else {
+    // Match: line number, then the line with the match highlighted
+    const FFindInFilesMatch &Match = File.Matches[Row->MatchIndex];
+    const FSlateFontInfo Font = FCoreStyle::GetDefaultFontStyle("Mono", 9);
+
+    Content =
+        SNew(SHorizontalBox)
+
+        + SHorizontalBox::Slot()
+              .AutoWidth()
+              .VAlign(VAlign_Center)
+              .Padding(22.0f, 0.0f, 6.0f, 0.0f)
+                  [SNew(STextBlock)
+                       .Text(FText::AsNumber(Match.Line))
+                       .Font(Font)
+                       .ColorAndOpacity(FindInFilesColors::TextDim)]
+
+        + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+              [SNew(STextBlock)
+                   .Text(FText::FromString(
+                       Match.Preview.Left(Match.PreviewStart)))
+                   .Font(Font)
+                   .ColorAndOpacity(FindInFilesColors::TextNormal)]
+
+        + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+              [SNew(SBorder)
+                   .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+                   .BorderBackgroundColor(FindInFilesColors::MatchHighlight)
+                   .Padding(0)[SNew(STextBlock)
+                                   .Text(FText::FromString(Match.Preview.Mid(
+                                       Match.PreviewStart,
+                                       Match.PreviewLength)))
+                                   .Font(Font)
+                                   .ColorAndOpacity(
+                                       FindInFilesColors::TextNormal)]]
+
+        + SHorizontalBox::Slot().FillWidth(1.0f).VAlign(VAlign_Center)
+              [SNew(STextBlock)
+                   .Text(FText::FromString(Match.Preview.Mid(
+                       Match.PreviewStart + Match.PreviewLength)))
+                   .Font(Font)
+                   .ColorAndOpacity(FindInFilesColors::TextNormal)
+                   .OverflowPolicy(ETextOverflowPolicy::Ellipsis)];
+  }
+
+  return SNew(STableRow<TSharedPtr<FFindInFilesRow>>, Owner)
+      .Style(&FAppStyle::Get().GetWidgetStyle<FTableRowStyle>("TableView.Row"))
+      .Padding(FMargin(2.0f, 1.0f))
+      .ToolTipText(FText::FromString(File.Path))[Content.ToSharedRef()];
+}
+
+void SFindInFiles::OnRowClicked(TSharedPtr<FFindInFilesRow> Row) {
+  if (!Row.IsValid() || Row->File->Matches.Num() == 0) {
+    return;
+  }
+
+  const FFindInFilesMatch &Match =
+      Row->File->Matches[FMath::Max(Row->MatchIndex, 0)];
+  OnMatchChosen.ExecuteIfBound(Row->File->Path, Match.Line, Match.Column);
+}
+
+#undef LOCTEXT_NAMESPACE
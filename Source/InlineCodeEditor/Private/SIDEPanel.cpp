@@ -1,16 +1,23 @@
 // Copyright Yureka. All Rights Reserved.
 
 #include "SIDEPanel.h"
+#include "CodeRename.h"
+#include "CodeSymbolIndex.h"
 #include "DesktopPlatformModule.h"
+#include "FindInFiles.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Misc/Paths.h"
 #include "SCodeEditorTab.h"
 #include "SFileTreeView.h"
+#include "SFindInFiles.h"
+#include "SQuickOpen.h"
 #include "Styling/AppStyle.h"
 #include "Widgets/Images/SImage.h"
 #include "Widgets/Input/SButton.h"
 #include "Widgets/Layout/SBorder.h"
 #include "Widgets/Layout/SSplitter.h"
+#include "Widgets/Layout/SWidgetSwitcher.h"
+#include "Widgets/SOverlay.h"
 #include "Widgets/Text/STextBlock.h"
 
 #define LOCTEXT_NAMESPACE "SIDEPanel"
@@ -32,6 +39,12 @@ void SIDEPanel::Construct(const FArguments &InArgs) {
     RootPath = FPaths::ProjectDir();
   }
 
+  SAssignNew(FindInFiles, SFindInFiles)
+      .OnMatchChosen(this, &SIDEPanel::OnFindInFilesMatchChosen)
+      .OnRenameAccepted(this, &SIDEPanel::HandleRenameAccepted);
+  FindInFiles->SetRootPath(RootPath);
+  SymbolIndex = FCodeSymbolIndex::Create(RootPath);
+
   ChildSlot
       [SNew(SBorder)
            .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
@@ -71,6 +84,29 @@ void SIDEPanel::Construct(const FArguments &InArgs) {
                                                   .DesiredSizeOverride(
                                                       FVector2D(20.0f, 20.0f))]]
 
+                              // Search button (always visible)
+                              +
+                              SVerticalBox::Slot().AutoHeight().Padding(0.0f,
+                                                                        2.0f)
+                                  [SNew(SButton)
+                                       .ButtonStyle(FAppStyle::Get(), "FlatButt"
+                                                                      "on")
+                                       .ContentPadding(FMargin(4.0f))
+                                       .OnClicked_Lambda([this]() {
+                                         ShowFindInFiles();
+                                         return FReply::Handled();
+                                       })
+                                       .ToolTipText(LOCTEXT(
+                                           "SearchTooltip",
+                                           "Search (Ctrl+Shift+F)"))
+                                           [SNew(SImage)
+                                                .Image(FAppStyle::GetBrush(
+                                                    "Icons.Search"))
+                                                .ColorAndOpacity(FSlateColor(
+                                                    IDEColors::IconColor))
+                                                .DesiredSizeOverride(
+                                                    FVector2D(20.0f, 20.0f))]]
+
                               // Open folder button (always visible)
                               +
                               SVerticalBox::Slot().AutoHeight().Padding(0.0f,
@@ -100,29 +136,70 @@ void SIDEPanel::Construct(const FArguments &InArgs) {
                            .HitDetectionSplitterHandleSize(6.0f)
                            .Style(FAppStyle::Get(), "SplitterDark")
 
-                       // File tree panel (can be toggled)
+                       // Sidebar (can be toggled): the file tree, or the
+                       // search panel
                        + SSplitter::Slot().Value(0.25f).MinSize(150.0f)
                              [SAssignNew(FileTreeContainer, SBorder)
                                   .BorderImage(FAppStyle::GetBrush("NoBorder"))
-                                  .Padding(
-                                      0)[SAssignNew(FileTreeView, SFileTreeView)
-                                             .RootPath(RootPath)
-                                             .OnFileDoubleClicked(
-                                                 FOnFileSelected::CreateSP(
-                                                     this,
-                                                     &SIDEPanel::
-                                                         OnFileDoubleClicked))]]
+                                  .Padding(0)
+                                      [SAssignNew(SidebarSwitcher,
+                                                  SWidgetSwitcher) +
+                                       SWidgetSwitcher::Slot()
+                                           [SAssignNew(FileTreeView,
+                                                       SFileTreeView)
+                                                .RootPath(RootPath)
+                                                .OnFileDoubleClicked(
+                                                    this,
+                                                    &SIDEPanel::
+                                                        OnFileDoubleClicked)] +
+                                       SWidgetSwitcher::Slot()
+                                           [FindInFiles.ToSharedRef()]]]
+
+                       // Code editor panel (fills remaining space), with
+                       // Quick Open floating over its top
+                       + SSplitter::Slot().Value(0.75f)
+                             [SNew(SOverlay) +
+                              SOverlay::Slot()[SAssignNew(CodeEditor,
+                                                          SCodeEditorTab)] +
+                              SOverlay::Slot()
+                                  .HAlign(HAlign_Center)
+                                  .VAlign(VAlign_Top)
+                                  .Padding(0.0f, 8.0f, 0.0f, 0.0f)
+                                      [SAssignNew(QuickOpen, SQuickOpen)
+                                           .Visibility(EVisibility::Collapsed)
+                                           .OnFileChosen(
+                                               this,
+                                               &SIDEPanel::
+                                                   OnQuickOpenFileChosen)
+                                           .OnDismissed(
+                                               this,
+                                               &SIDEPanel::CloseQuickOpen)]]]]];
 
-                       // Code editor panel (fills remaining space)
-                       + SSplitter::Slot().Value(
-                             0.75f)[SAssignNew(CodeEditor, SCodeEditorTab)]]]];
+  FileTreeView->OnPathIndexChanged().AddSP(
+      this, &SIDEPanel::HandlePathIndexChanged);
+  FileTreeView->OnFilesChanged().AddSP(this, &SIDEPanel::HandleFilesChanged);
+  CodeEditor->OnFileSaved().AddSP(this, &SIDEPanel::HandleFileSaved);
+  CodeEditor->OnFindReferences().AddSP(this,
+                                       &SIDEPanel::HandleReferencesRequested);
+  CodeEditor->OnRenameSymbol().AddSP(this, &SIDEPanel::HandleRenameRequested);
+  CodeEditor->SetSymbolIndex(SymbolIndex);
+  RequestSearchIndex();
 }
 
 void SIDEPanel::SetFileTreeRootPath(const FString &Path) {
+  CloseQuickOpen();
   RootPath = Path;
+  if (FindInFiles.IsValid()) {
+    FindInFiles->SetRootPath(Path);
+  }
   if (FileTreeView.IsValid()) {
     FileTreeView->SetRootPath(Path);
   }
+  SymbolIndex = FCodeSymbolIndex::Create(Path);
+  if (CodeEditor.IsValid()) {
+    CodeEditor->SetSymbolIndex(SymbolIndex);
+  }
+  RequestSearchIndex();
 }
 
 void SIDEPanel::OpenFile(const FString &FilePath) {
@@ -154,6 +231,12 @@ void SIDEPanel::OnFileDoubleClicked(const FString &FilePath) {
 void SIDEPanel::OnToggleExplorerClicked() { ToggleFileTreeVisibility(); }
 
 FReply SIDEPanel::OnToggleExplorerButtonClicked() {
+  // From the search panel the button goes back to the file tree
+  if (bFileTreeVisible && SidebarSwitcher.IsValid() &&
+      SidebarSwitcher->GetActiveWidget() != FileTreeView) {
+    SidebarSwitcher->SetActiveWidget(FileTreeView.ToSharedRef());
+    return FReply::Handled();
+  }
   ToggleFileTreeVisibility();
   return FReply::Handled();
 }
@@ -187,4 +270,199 @@ void SIDEPanel::UpdateLayout() {
   // Reserved for future layout updates
 }
 
+void SIDEPanel::ShowQuickOpen() {
+  if (!QuickOpen.IsValid() || !FileTreeView.IsValid()) {
+    return;
+  }
+
+  // The index is built on first use; Quick Open says so until it arrives
+  QuickOpen->SetPathIndex(FileTreeView->GetPathIndex());
+  QuickOpen->SetVisibility(EVisibility::Visible);
+  QuickOpen->Open();
+}
+
+void SIDEPanel::ShowFindInFiles() {
+  if (!FindInFiles.IsValid() || !FileTreeView.IsValid()) {
+    return;
+  }
+
+  if (!bFileTreeVisible) {
+    ToggleFileTreeVisibility();
+  }
+  SidebarSwitcher->SetActiveWidget(FindInFiles.ToSharedRef());
+
+  // The index is built on first use; a search waits until it arrives
+  FindInFiles->SetPathIndex(FileTreeView->GetPathIndex());
+  FindInFiles->FocusSearchBox();
+}
+
+void SIDEPanel::CloseQuickOpen() {
+  if (!QuickOpen.IsValid() ||
+      QuickOpen->GetVisibility() == EVisibility::Collapsed) {
+    return;
+  }
+
+  // Keep focus in the panel so Ctrl+P keeps working
+  QuickOpen->SetVisibility(EVisibility::Collapsed);
+  FSlateApplication::Get().SetKeyboardFocus(SharedThis(this),
+                                            EFocusCause::SetDirectly);
+}
+
+void SIDEPanel::OnQuickOpenFileChosen(const FString &RelativePath) {
+  CloseQuickOpen();
+  OpenFile(FPaths::Combine(RootPath, RelativePath));
+}
+
+void SIDEPanel::HandlePathIndexChanged() {
+  if (!FileTreeView.IsValid()) {
+    return;
+  }
+  if (QuickOpen.IsValid()) {
+    QuickOpen->SetPathIndex(FileTreeView->GetPathIndex());
+  }
+  if (FindInFiles.IsValid()) {
+    FindInFiles->SetPathIndex(FileTreeView->GetPathIndex());
+  }
+  RequestSymbolIndex();
+}
+
+void SIDEPanel::RequestSearchIndex() {
+  // The search index follows the file list from the start, so it is built
+  // before the first search rather than during it
+  if (FindInFiles.IsValid() && FindInFiles->HasIndex() &&
+      FileTreeView.IsValid()) {
+    FindInFiles->SetPathIndex(FileTreeView->GetPathIndex());
+  }
+  RequestSymbolIndex();
+}
+
+void SIDEPanel::RequestSymbolIndex() {
+  if (!SymbolIndex.IsValid() || !FileTreeView.IsValid()) {
+    return;
+  }
+
+  // Until the path index is built, its change event brings it here
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex =
+      FileTreeView->GetPathIndex();
+  if (PathIndex.IsValid()) {
+    SymbolIndex->SetPathIndex(PathIndex.ToSharedRef());
+  }
+}
+
+void SIDEPanel::HandleFilesChanged(const TArray<FString> &RelativePaths) {
+  if (FindInFiles.IsValid()) {
+    FindInFiles->HandleFilesChanged(RelativePaths);
+  }
+  if (SymbolIndex.IsValid()) {
+    SymbolIndex->HandleFilesChanged(RelativePaths);
+  }
+}
+
+void SIDEPanel::HandleFileSaved(const FString &FilePath) {
+  FString RelativePath = FPaths::ConvertRelativePathToFull(FilePath);
+  FString FullRoot = FPaths::ConvertRelativePathToFull(RootPath);
+  FPaths::NormalizeFilename(RelativePath);
+  FPaths::NormalizeDirectoryName(FullRoot);
+  if (!RootPath.IsEmpty() && RelativePath.StartsWith(FullRoot + TEXT("/"))) {
+    HandleFilesChanged({RelativePath.RightChop(FullRoot.Len() + 1)});
+  }
+}
+
+void SIDEPanel::HandleReferencesRequested(const FString &Identifier) {
+  if (!SymbolIndex.IsValid() || !FindInFiles.IsValid()) {
+    return;
+  }
+
+  // The uses come from the index; only their lines are read
+  TArray<FCodeReferences> References;
+  SymbolIndex->FindReferences(Identifier, References);
+  ShowFindInFiles();
+  FindInFiles->ShowReferences(Identifier, MoveTemp(References));
+}
+
+void SIDEPanel::HandleRenameRequested(const FString &Identifier) {
+  if (!SymbolIndex.IsValid() || !FindInFiles.IsValid()) {
+    return;
+  }
+
+  TArray<FCodeReferences> References;
+  SymbolIndex->FindReferences(Identifier, References);
+  ShowFindInFiles();
+  FindInFiles->ShowRename(Identifier, MoveTemp(References));
+}
+
+void SIDEPanel::HandleRenameAccepted(const FString &OldName,
+                                     const FString &NewName,
+                                     const TArray<FFindInFilesResult> &Files) {
+  // Open documents are renamed in their buffers, to be saved by the user;
+  // the other files are rewritten on disk
+  FCodeRenameResult BufferResult;
+  TArray<FString> OpenFiles;
+  if (CodeEditor.IsValid()) {
+    BufferResult =
+        CodeEditor->RenameInDocuments(RootPath, OldName, NewName, OpenFiles);
+  }
+  const int32 NumBufferEdits = BufferResult.NumEdits;
+  const int32 NumBufferFiles = BufferResult.ChangedFiles.Num();
+  TArray<FFindInFilesResult> DiskFiles;
+  for (const FFindInFilesResult &File : Files) {
+    if (!OpenFiles.ContainsByPredicate([&File](const FString &OpenFile) {
+          return FPaths::IsSamePath(OpenFile, File.Path);
+        })) {
+      DiskFiles.Add(File);
+    }
+  }
+
+  TWeakPtr<SIDEPanel> WeakPanel = SharedThis(this);
+  const FString RenameRoot = RootPath;
+  FCodeRename::Start(
+      RootPath, OldName, NewName, MoveTemp(DiskFiles),
+      [WeakPanel, RenameRoot, OldName, NewName, NumBufferEdits,
+       NumBufferFiles](FCodeRenameResult &&Result) {
+        TSharedPtr<SIDEPanel> Panel = WeakPanel.Pin();
+        if (!Panel.IsValid() || Panel->RootPath != RenameRoot) {
+          return;
+        }
+        Panel->HandleFilesChanged(Result.ChangedFiles);
+
+        FText Summary = FText::Format(
+            LOCTEXT("RenameFinished", "Renamed {0} to {1}: {2} uses in {3} "
+                                      "files"),
+            FText::FromString(OldName), FText::FromString(NewName),
+            FText::AsNumber(Result.NumEdits + NumBufferEdits),
+            FText::AsNumber(Result.ChangedFiles.Num() + NumBufferFiles));
+        if (Result.FailedFiles.Num() > 0) {
+          Summary = FText::Format(
+              LOCTEXT("RenameFailed", "{0}; {1} files could not be written"),
+              Summary, FText::AsNumber(Result.FailedFiles.Num()));
+        }
+        if (Panel->FindInFiles.IsValid()) {
+          Panel->FindInFiles->ShowNotice(Summary);
+        }
+      });
+}
+
+void SIDEPanel::OnFindInFilesMatchChosen(const FString &RelativePath,
+                                         int32 Line, int32 Column) {
+  OpenFile(FPaths::Combine(RootPath, RelativePath));
+  if (CodeEditor.IsValid()) {
+    CodeEditor->GoToLine(Line);
+  }
+}
+
+FReply SIDEPanel::OnKeyDown(const FGeometry &MyGeometry,
+                            const FKeyEvent &InKeyEvent) {
+  if (InKeyEvent.GetKey() == EKeys::P && InKeyEvent.IsControlDown() &&
+      !InKeyEvent.IsAltDown() && !InKeyEvent.IsShiftDown()) {
+    ShowQuickOpen();
+    return FReply::Handled();
+  }
+  if (InKeyEvent.GetKey() == EKeys::F && InKeyEvent.IsControlDown() &&
+      InKeyEvent.IsShiftDown() && !InKeyEvent.IsAltDown()) {
+    ShowFindInFiles();
+    return FReply::Handled();
+  }
+  return SCompoundWidget::OnKeyDown(MyGeometry, InKeyEvent);
+}
+
 #undef LOCTEXT_NAMESPACE
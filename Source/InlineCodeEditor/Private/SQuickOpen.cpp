@@ -0,0 +1,291 @@
+// Copyright Yureka. All Rights Reserved.
+
+#include "SQuickOpen.h"
+#include "FileTreeIconManager.h"
+#include "FileTreePathIndex.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Misc/Paths.h"
+#include "Styling/AppStyle.h"
+#include "Widgets/Images/SImage.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/STableRow.h"
+
+#define LOCTEXT_NAMESPACE "SQuickOpen"
+
+namespace QuickOpenColors {
+const FLinearColor Background =
+    FLinearColor::FromSRGBColor(FColor::FromHex("252526FF")); // Widget
+const FLinearColor Border =
+    FLinearColor::FromSRGBColor(FColor::FromHex("454545FF")); // Outline
+const FLinearColor TextName = FLinearColor(0.8f, 0.8f, 0.8f); // #CCCCCC
+const FLinearColor TextDirectory =
+    FLinearColor(0.549f, 0.549f, 0.549f); // #8C8C8C - Dim gray
+} // namespace QuickOpenColors
+
+namespace QuickOpenConstants {
+/** Results listed for a query */
+constexpr int32 MaxResults = 50;
+
+/** Size of the popup */
+constexpr float Width = 600.0f;
+constexpr float MaxListHeight = 400.0f;
+} // namespace QuickOpenConstants
+
+void SQuickOpen::Construct(const FArguments &InArgs) {
+  OnFileChosen = InArgs._OnFileChosen;
+  OnDismissed = InArgs._OnDismissed;
+
+  ChildSlot
+      [SNew(SBox).WidthOverride(QuickOpenConstants::Width)
+           [SNew(SBorder)
+                .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+                .BorderBackgroundColor(QuickOpenColors::Border)
+                .Padding(1.0f)
+                    [SNew(SBorder)
+                         .BorderImage(FAppStyle::GetBrush("WhiteBrush"))
+                         .BorderBackgroundColor(QuickOpenColors::Background)
+                         .Padding(FMargin(6.0f))
+                             [SNew(SVerticalBox)
+
+                              // Query box
+                              + SVerticalBox::Slot().AutoHeight()
+                                    [SAssignNew(SearchBox, SSearchBox)
+                                         .HintText(LOCTEXT(
+                                             "QueryHint",
+                                             "Search files by name"))
+                                         .OnTextChanged(
+                                             this, &SQuickOpen::OnQueryChanged)
+                                         .OnTextCommitted(
+                                             this,
+                                             &SQuickOpen::OnQueryCommitted)
+                                         .OnKeyDownHandler(
+                                             this, &SQuickOpen::OnQueryKeyDown)]
+
+                              // Indexing and no-match notes
+                              + SVerticalBox::Slot().AutoHeight().Padding(
+                                    4.0f, 4.0f, 4.0f, 0.0f)
+                                    [SNew(STextBlock)
+                                         .Text_Lambda([this]() {
+                                           if (PathIndex.IsValid()) {
+                                             return LOCTEXT(
+                                                 "NoMatches",
+                                                 "No matching files");
+                                           }
+                                           return LOCTEXT("Indexing",
+                                                          "Indexing files...");
+                                         })
+                                         .Visibility_Lambda([this]() {
+                                           const bool bShown =
+                                               !PathIndex.IsValid() ||
+                                               (!Query.IsEmpty() &&
+                                                Results.Num() == 0);
+                                           return bShown
+                                                      ? EVisibility::Visible
+                                                      : EVisibility::Collapsed;
+                                         })
+                                         .Font(FCoreStyle::GetDefaultFontStyle(
+                                             "Italic", 10))
+                                         .ColorAndOpacity(
+                                             QuickOpenColors::TextDirectory)]
+
+                              // Results
+                              + SVerticalBox::Slot().AutoHeight().Padding(
+                                    0.0f, 4.0f, 0.0f, 0.0f)
+                                    [SNew(SBox)
+                                         .MaxDesiredHeight(
+                                             QuickOpenConstants::MaxListHeight)
+                                             [SAssignNew(
+                                                  ResultsView,
+                                                  SListView<TSharedPtr<
+                                                      FQuickOpenResult>>)
+                                                  .ListItemsSource(&Results)
+                                                  .OnGenerateRow(
+                                                      this,
+                                                      &SQuickOpen::
+                                                          OnGenerateRow)
+                                                  .OnMouseButtonClick(
+                                                      this,
+                                                      &SQuickOpen::
+                                                          OnResultClicked)
+                                                  .SelectionMode(
+                                                      ESelectionMode::
+                                                          Single)]]]]]];
+}
+
+void SQuickOpen::Open() {
+  if (SearchBox.IsValid()) {
+    SearchBox->SetText(FText::GetEmpty());
+    FSlateApplication::Get().SetKeyboardFocus(SearchBox,
+                                              EFocusCause::SetDirectly);
+  }
+  Query.Reset();
+  UpdateResults();
+}
+
+void SQuickOpen::SetPathIndex(
+    TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> Index) {
+  if (PathIndex == Index) {
+    return;
+  }
+
+  // Entry numbers change with the index, so the matches start over
+  PathIndex = Index;
+  MatchedQuery.Reset();
+  Matches.Reset();
+  UpdateResults();
+}
+
+void SQuickOpen::UpdateResults() {
+  Results.Reset();
+
+  if (PathIndex.IsValid() && !Query.IsEmpty()) {
+    // Extending the query can only drop matches, so only the previous ones
+    // are scored again
+    const bool bNarrows =
+        !MatchedQuery.IsEmpty() && Query.StartsWith(MatchedQuery);
+    TArray<int32> NewMatches;
+    TArray<FFileTreePathMatch> Best;
+    PathIndex->FindBest(Query, bNarrows ? &Matches : nullptr,
+                        QuickOpenConstants::MaxResults, NewMatches, Best);
+    Matches = MoveTemp(NewMatches);
+    MatchedQuery = Query;
+
+    Results.Reserve(Best.Num());
+    for (const FFileTreePathMatch &Match : Best) {
+      TSharedRef<FQuickOpenResult> Result = MakeShared<FQuickOpenResult>();
+      Result->Path = FString(PathIndex->GetPath(Match.Index));
+      Result->Name = FPaths::GetCleanFilename(Result->Path);
+      Result->Directory = FPaths::GetPath(Result->Path);
+      Result->Extension = FName(*FPaths::GetExtension(Result->Name));
+      Results.Add(Result);
+    }
+  } else {
+    MatchedQuery.Reset();
+    Matches.Reset();
+  }
+
+  if (ResultsView.IsValid()) {
+    ResultsView->RequestListRefresh();
+    if (Results.Num() > 0) {
+      ResultsView->SetSelection(Results[0]);
+      ResultsView->RequestScrollIntoView(Results[0]);
+    } else {
+      ResultsView->ClearSelection();
+    }
+  }
+}
+
+void SQuickOpen::ChooseSelected() {
+  TSharedPtr<FQuickOpenResult> Chosen;
+  if (ResultsView.IsValid() && ResultsView->GetNumItemsSelected() > 0) {
+    Chosen = ResultsView->GetSelectedItems()[0];
+  } else if (Results.Num() > 0) {
+    Chosen = Results[0];
+  }
+
+  if (Chosen.IsValid()) {
+    OnFileChosen.ExecuteIfBound(Chosen->Path);
+  }
+}
+
+void SQuickOpen::MoveSelection(int32 Delta) {
+  if (!ResultsView.IsValid() || Results.Num() == 0) {
+    return;
+  }
+
+  int32 Index = 0;
+  if (ResultsView->GetNumItemsSelected() > 0) {
+    Index = Results.IndexOfByKey(ResultsView->GetSelectedItems()[0]) + Delta;
+  }
+  Index = FMath::Clamp(Index, 0, Results.Num() - 1);
+  ResultsView->SetSelection(Results[Index]);
+  ResultsView->RequestScrollIntoView(Results[Index]);
+}
+
+void SQuickOpen::OnQueryChanged(const FText &Text) {
+  const FString NewQuery = Text.ToString().TrimStartAndEnd();
+  if (NewQuery.Equals(Query, ESearchCase::CaseSensitive)) {
+    return;
+  }
+  Query = NewQuery;
+  UpdateResults();
+}
+
+void SQuickOpen::OnQueryCommitted(const FText &Text,
+                                  ETextCommit::Type CommitType) {
+  if (CommitType == ETextCommit::OnEnter) {
+    ChooseSelected();
+  }
+}
+
+FReply SQuickOpen::OnQueryKeyDown(const FGeometry &MyGeometry,
+                                  const FKeyEvent &InKeyEvent) {
+  const FKey Key = InKeyEvent.GetKey();
+  if (Key == EKeys::Up) {
+    MoveSelection(-1);
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Down) {
+    MoveSelection(1);
+    return FReply::Handled();
+  }
+  if (Key == EKeys::Escape) {
+    OnDismissed.ExecuteIfBound();
+    return FReply::Handled();
+  }
+  return FReply::Unhandled();
+}
+
+TSharedRef<ITableRow>
+SQuickOpen::OnGenerateRow(TSharedPtr<FQuickOpenResult> Result,
+                          const TSharedRef<STableViewBase> &OwnerTable) {
+  const FSlateBrush *Icon =
+      FFileTreeIconManager::Get().GetFileIcon(Result->Extension);
+
+  return SNew(STableRow<TSharedPtr<FQuickOpenResult>>, OwnerTable)
+      .Style(&FAppStyle::Get().GetWidgetStyle<FTableRowStyle>("TableView.Row"))
+      .Padding(FMargin(2.0f, 1.0f))
+      .ToolTipText(FText::FromString(Result->Path))
+          [SNew(SHorizontalBox)
+
+           // File icon
+           + SHorizontalBox::Slot()
+                 .AutoWidth()
+                 .VAlign(VAlign_Center)
+                 .Padding(2.0f, 0.0f, 6.0f, 0.0f)
+                     [SNew(SImage)
+                          .Image(Icon ? Icon
+                                      : FAppStyle::GetBrush(
+                                            "ContentBrowser.AssetActions."
+                                            "ReimportAsset"))
+                          .DesiredSizeOverride(FVector2D(16.0f, 16.0f))]
+
+           // File name
+           + SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+                 [SNew(STextBlock)
+                      .Text(FText::FromString(Result->Name))
+                      .Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
+                      .ColorAndOpacity(QuickOpenColors::TextName)]
+
+           // Folder
+           + SHorizontalBox::Slot()
+                 .FillWidth(1.0f)
+                 .VAlign(VAlign_Center)
+                 .Padding(8.0f, 0.0f, 0.0f, 0.0f)
+                     [SNew(STextBlock)
+                          .Text(FText::FromString(Result->Directory))
+                          .Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+                          .ColorAndOpacity(QuickOpenColors::TextDirectory)
+                          .OverflowPolicy(ETextOverflowPolicy::Ellipsis)]];
+}
+
+void SQuickOpen::OnResultClicked(TSharedPtr<FQuickOpenResult> Result) {
+  if (Result.IsValid()) {
+    OnFileChosen.ExecuteIfBound(Result->Path);
+  }
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,13 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * ASCII letters folded to lower case; anything else, UTF-8 bytes and
+ * non-ASCII characters included, is returned as is
+ */
+template <typename CharType> FORCEINLINE CharType ToLowerAscii(CharType C) {
+  return C >= 'A' && C <= 'Z' ? CharType(C + ('a' - 'A')) : C;
+}
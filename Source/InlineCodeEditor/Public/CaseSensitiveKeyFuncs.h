@@ -0,0 +1,34 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Map key functions telling FString keys apart by case, as C++ names and
+ * case-sensitive file systems do
+ */
+template <typename ValueType>
+struct TCaseSensitiveKeyFuncs
+    : BaseKeyFuncs<TPair<FString, ValueType>, FString, false> {
+  static const FString &GetSetKey(const TPair<FString, ValueType> &Element) {
+    return Element.Key;
+  }
+  static bool Matches(const FString &A, const FString &B) {
+    return A.Equals(B, ESearchCase::CaseSensitive);
+  }
+  static uint32 GetKeyHash(const FString &Key) {
+    return FCrc::StrCrc32(*Key);
+  }
+};
+
+/** Set key functions telling FStrings apart by case */
+struct FCaseSensitiveSetKeyFuncs : BaseKeyFuncs<FString, FString, false> {
+  static const FString &GetSetKey(const FString &Element) { return Element; }
+  static bool Matches(const FString &A, const FString &B) {
+    return A.Equals(B, ESearchCase::CaseSensitive);
+  }
+  static uint32 GetKeyHash(const FString &Key) {
+    return FCrc::StrCrc32(*Key);
+  }
+};
@@ -0,0 +1,70 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "Async/Future.h"
+#include "CodeDocument.h"
+#include "CoreMinimal.h"
+
+class FCppSyntaxTokenizer;
+
+/** Analysis of a text read from an FCodeAnalysisCache entry */
+struct FCodeAnalysisCacheHit {
+  /** Entry the analysis was read from; empty if there was none */
+  FString EntryPath;
+
+  FCodeDocumentLines Lines;
+
+  /** Serialized token lines, for FCppSyntaxTokenizer::LoadCachedLines */
+  TArray<uint8> TokenLines;
+};
+
+/**
+ * Content-addressed on-disk cache of document analysis.
+ *
+ * Stores the per-line token stream, lexer states, line starts, indent levels
+ * and fold regions of a text, keyed by a CityHash of the text itself, so
+ * reopening an unchanged file skips tokenizing and fold parsing entirely.
+ *
+ * Entries live under Saved/ICE/Cache and are read and written on worker
+ * threads. The directory is bounded by ICE.Cache.MaxSizeMB; its size is
+ * tracked in memory after one scan, and the least recently used entries
+ * are evicted first.
+ */
+class INLINECODEEDITOR_API FCodeAnalysisCache {
+public:
+  /**
+   * Look up the analysis of Text on a worker. The hit's EntryPath is empty
+   * if there is no usable entry.
+   */
+  static TFuture<FCodeAnalysisCacheHit> Load(const FString &Text);
+
+  /**
+   * Seed a tokenizer's line cache from a hit. Returns false, discarding the
+   * entry, if its token lines cannot be read.
+   */
+  static bool Apply(const FCodeAnalysisCacheHit &Hit,
+                    FCppSyntaxTokenizer &Tokenizer);
+
+  /**
+   * Store the analysis of Text, writing it on a worker. Does nothing if the
+   * tokenizer has not seen every line of Text yet, or if an entry already
+   * exists.
+   */
+  static void Store(const FString &Text, const FCodeDocumentLines &Lines,
+                    const FCppSyntaxTokenizer &Tokenizer);
+
+private:
+  /** Directory holding all cache entries */
+  static FString GetCacheDir();
+
+  /** Path of the entry for a content hash */
+  static FString GetEntryPath(uint64 ContentHash);
+
+  /** Read and check an entry; on a worker */
+  static bool ReadEntry(const FString &Text, FCodeAnalysisCacheHit &OutHit);
+
+  /** Write an entry and evict others past the budget; on a worker */
+  static void WriteEntry(const FString &EntryPath, const TArray<uint8> &Bytes,
+                         int64 BudgetBytes);
+};
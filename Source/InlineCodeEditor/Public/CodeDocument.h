@@ -0,0 +1,185 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "Async/Future.h"
+#include "CodeTextEdit.h"
+#include "CoreMinimal.h"
+
+class FCodeEditJournal;
+class FCppSyntaxTokenizer;
+struct FCodeAnalysisCacheHit;
+
+/**
+ * Represents a foldable code region (e.g., function body, class, etc.)
+ */
+struct FCodeFoldRegion {
+  int32 StartLine = 0;
+  int32 EndLine = 0;
+  bool bIsFolded = false;
+  int32 IndentLevel = 0;
+
+  FCodeFoldRegion() = default;
+  FCodeFoldRegion(int32 InStart, int32 InEnd, int32 InIndent = 0)
+      : StartLine(InStart), EndLine(InEnd), IndentLevel(InIndent) {}
+};
+
+/**
+ * Line structure of a document, computed once per edit and shared by every
+ * view of the document
+ */
+struct FCodeDocumentLines {
+  /** Offset of the first character of each line */
+  TArray<int32> LineStarts;
+
+  /** Indent guide level of each line */
+  TArray<int32> IndentLevels;
+
+  /** Brace-delimited foldable regions (unfolded), sorted by start line */
+  TArray<FCodeFoldRegion> FoldRegions;
+
+  int32 Num() const { return LineStarts.Num(); }
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCodeDocumentEdited,
+                                    const FCodeTextEdit & /*Edit*/);
+
+/**
+ * An open document in the code editor.
+ * Owns the buffer, its crash journal, its token cache and its line
+ * analysis, and outlives the widgets that display it, so switching between
+ * documents never re-reads the file or re-tokenizes from scratch. Any number
+ * of views can show the same document; they share all of the above. The
+ * analysis of saved text is kept in FCodeAnalysisCache across sessions.
+ */
+class INLINECODEEDITOR_API FCodeDocument
+    : public TSharedFromThis<FCodeDocument> {
+public:
+  /** Create a document for a buffer; FilePath is empty for untitled files */
+  static TSharedRef<FCodeDocument> Create(const FString &FilePath,
+                                          const FString &Text);
+
+  /** Create a scratch document that is never journaled */
+  static TSharedRef<FCodeDocument> CreateTransient(const FString &FilePath,
+                                                   const FString &Text);
+
+  /** Number of spaces per indent level */
+  static constexpr int32 IndentSize = 2;
+
+  ~FCodeDocument();
+
+  const FString &GetFilePath() const { return FilePath; }
+  bool IsUntitled() const { return FilePath.IsEmpty(); }
+
+  /** Name shown on the document tab */
+  FString GetDisplayName() const;
+
+  /** Current buffer contents */
+  const FString &GetText() const { return Text; }
+
+  /**
+   * Apply an edit made in a view, record it in the journal and the undo
+   * history, and notify every view of the document
+   */
+  void ApplyEdit(const FCodeTextEdit &Edit);
+
+  /**
+   * Take back the last edit made in any view, or make the last one taken
+   * back again. Returns the edit applied; empty if there was none.
+   */
+  FCodeTextEdit Undo();
+  FCodeTextEdit Redo();
+
+  /** Broadcast after every applied edit */
+  FOnCodeDocumentEdited &OnEdited() { return EditedEvent; }
+
+  /** Incremented by every applied edit */
+  uint32 GetRevision() const { return Revision; }
+
+  /** Line structure of the current text, rebuilt lazily after edits */
+  const FCodeDocumentLines &GetLines();
+
+  /** Text of one line, without its line break */
+  FString GetLineText(int32 LineIndex);
+
+  bool IsModified() const { return bIsModified; }
+
+  /** Write the buffer to its file. Returns false on failure. */
+  bool Save();
+
+  /** The document is being closed on purpose: forget its unsaved edits */
+  void Discard();
+
+  /** Continue the crash journal of a recovered buffer */
+  void ResumeJournal(TSharedRef<FCodeEditJournal> InJournal);
+
+  /** Token cache shared by every view of this document */
+  TSharedRef<FCppSyntaxTokenizer> GetTokenizer() const { return Tokenizer; }
+
+  /**
+   * Estimated size of the text layout and shaped glyphs a view of this
+   * builds, from its length; the layout itself is not measured
+   */
+  SIZE_T GetLayoutMemoryEstimate() const;
+
+  /** View state kept while the document's layout is evicted */
+  TArray<int32> FoldedLines;
+  int32 CursorLine = 1;
+
+  /** Last time the document was shown, for layout eviction */
+  double LastViewedTime = 0.0;
+
+private:
+  FCodeDocument(const FString &InFilePath, const FString &InText,
+                bool bJournaled);
+
+  /** Start looking the text up in FCodeAnalysisCache */
+  void LoadAnalysis();
+
+  /**
+   * Take the analysis from the cache lookup, waiting a little for it if
+   * needed. Returns false if there is none for the current text.
+   */
+  bool ResolveCachedAnalysis();
+
+  /**
+   * Apply an edit, record it in the journal and notify the views. Returns
+   * false, with the text unchanged, if the edit is out of range.
+   */
+  bool ApplyEditAndInvert(const FCodeTextEdit &Edit,
+                          FCodeTextEdit &OutInverse);
+
+  /** Rebuild line starts, indent levels and fold regions */
+  void AnalyzeLines();
+  void ParseFoldRegions(const TArray<FString> &SourceLines);
+  void CalculateLineIndentLevels(const TArray<FString> &SourceLines);
+
+  /** Save the analysis of the text as it is on disk to the analysis cache */
+  void StoreAnalysis();
+
+  FString FilePath;
+  FString Text;
+  bool bIsModified = false;
+
+  uint32 Revision = 0;
+  uint32 AnalyzedRevision = MAX_uint32;
+  FCodeDocumentLines Lines;
+
+  /** Cache lookup of the text as opened, until the first analysis */
+  TFuture<FCodeAnalysisCacheHit> CachedAnalysis;
+  FOnCodeDocumentEdited EditedEvent;
+
+  /**
+   * Edits taking back the last edits, and the last undone ones, most
+   * recent last. Shared by every view, so undo in one view never restores
+   * text from before edits made in another.
+   */
+  TArray<FCodeTextEdit> UndoEdits;
+  TArray<FCodeTextEdit> RedoEdits;
+
+  /** Whether a typed character may join the last undo step */
+  bool bCanMergeUndo = false;
+
+  TSharedPtr<FCodeEditJournal> Journal;
+  TSharedRef<FCppSyntaxTokenizer> Tokenizer;
+};
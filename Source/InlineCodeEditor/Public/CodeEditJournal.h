@@ -0,0 +1,95 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CodeTextEdit.h"
+#include "CoreMinimal.h"
+
+/**
+ * A document buffer reconstructed from a journal left behind by a crash
+ */
+struct FRecoveredCodeDocument {
+  /** File the journal belongs to (empty for untitled buffers) */
+  FString FilePath;
+
+  /** Buffer contents after replaying every intact journal record */
+  FString Text;
+
+  /** Journal file the buffer was recovered from */
+  FString JournalPath;
+};
+
+/**
+ * Crash-safe, append-only edit journal for one document buffer.
+ *
+ * Every edit is serialized into a small length/CRC-framed record and handed
+ * to a shared background writer, which appends and fsyncs records in
+ * batches. Editing never touches the disk on the game thread, and saving
+ * deletes the journal instead of rewriting the buffer; the next edit starts
+ * it again on the saved text.
+ *
+ * Journals live under Saved/ICE/Journal and are replayed on the next launch
+ * by RecoverDocuments(), which reads and deletes them synchronously on the
+ * calling thread.
+ */
+class INLINECODEEDITOR_API FCodeEditJournal {
+public:
+  /**
+   * Start a fresh journal for a buffer whose current contents are BaseText.
+   * For files on disk only the hash of BaseText is recorded; untitled
+   * buffers store BaseText itself since there is nothing to replay onto.
+   */
+  static TSharedRef<FCodeEditJournal> Create(const FString &FilePath,
+                                             const FString &BaseText);
+
+  /** Continue appending to a journal returned by RecoverDocuments() */
+  static TSharedRef<FCodeEditJournal>
+  Resume(const FRecoveredCodeDocument &Recovered);
+
+  /**
+   * Replay every journal left on disk. Journals whose base no longer matches
+   * the file on disk are stale and get deleted. Blocks on the file reads and
+   * deletes; the editor calls it once, when its tab opens.
+   */
+  static void RecoverDocuments(TArray<FRecoveredCodeDocument> &OutDocuments);
+
+  /** Let the background writer start again, as after a module reload */
+  static void StartupWriter();
+
+  /** Flush outstanding records and stop the background writer */
+  static void ShutdownWriter();
+
+  ~FCodeEditJournal();
+
+  /** Record an edit. Cheap: serializes a few bytes and queues them. */
+  void Append(const FCodeTextEdit &Edit);
+
+  /**
+   * The buffer was saved: delete the journal, to be started again on the
+   * new base by the next edit
+   */
+  void Reset(const FString &FilePath, const FString &BaseText);
+
+  /** The buffer was closed cleanly: delete the journal */
+  void Discard();
+
+  /** Path of the journal file on disk */
+  const FString &GetJournalPath() const { return JournalPath; }
+
+private:
+  FCodeEditJournal(const FString &InJournalPath);
+
+  /** Serialize the journal header for a given base */
+  static TArray<uint8> MakeHeader(const FString &FilePath,
+                                  const FString &BaseText);
+
+  /** Directory holding all journals */
+  static FString GetJournalDir();
+
+  FString JournalPath;
+
+  /** Header is written lazily with the first edit */
+  TArray<uint8> PendingHeader;
+
+  bool bDiscarded = false;
+};
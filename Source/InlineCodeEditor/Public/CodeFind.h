@@ -0,0 +1,100 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CodeTextEdit.h"
+#include "CoreMinimal.h"
+
+class FCodeRegex;
+class FCodeRegexMatcher;
+
+/** What the find bar looks for in a document */
+struct FCodeFindQuery {
+  /** Text or pattern to find */
+  FString Text;
+
+  /** Whether case must match; otherwise ASCII letters match either case */
+  bool bMatchCase = false;
+
+  /** Whether matches may not be part of a longer identifier */
+  bool bWholeWord = false;
+
+  /** Whether Text is an FCodeRegex pattern rather than literal text */
+  bool bRegex = false;
+};
+
+/** A match in a document, as a range of its text */
+using FCodeFindMatch = FCodeTextRange;
+
+/**
+ * The matches of an FCodeFindQuery in a document buffer, kept up to date as
+ * the query and the text change.
+ *
+ * Literal queries are scanned for with SIMD compares of the query's rarest
+ * character, checking the whole query only where it occurs. Regular
+ * expressions run line by line through an FCodeRegexMatcher, on the lines
+ * holding their required literal when they have one. Matches never
+ * overlap and never span lines.
+ *
+ * Typing more of a literal query only rechecks the previous matches, and an
+ * edit to the text only rescans the lines it touched; everything else is
+ * shifted in place.
+ */
+class INLINECODEEDITOR_API FCodeFindResults {
+public:
+  FCodeFindResults();
+  ~FCodeFindResults();
+
+  /**
+   * Find Query in Text, replacing the matches. Returns false, with the
+   * reason in OutError, if the query is an invalid pattern.
+   */
+  bool SetQuery(const FString &Text, const FCodeFindQuery &Query,
+                FText &OutError);
+
+  /** Drop the query and its matches */
+  void Reset();
+
+  /** Update the matches after Edit was applied, making Text */
+  void HandleEdit(const FString &Text, const FCodeTextEdit &Edit);
+
+  /** Matches in text order */
+  const TArray<FCodeFindMatch> &GetMatches() const { return Matches; }
+  int32 Num() const { return Matches.Num(); }
+
+  /** First match ending after Offset; Num() if there is none */
+  int32 FindFirstEndingAfter(int32 Offset) const;
+
+  /** Match at or after Offset, wrapping around; INDEX_NONE if none */
+  int32 FindNext(int32 Offset) const;
+
+  /** Last match starting before Offset, wrapping around */
+  int32 FindPrevious(int32 Offset) const;
+
+  /** Single edit replacing every match of Text with Replacement */
+  FCodeTextEdit MakeReplaceAllEdit(const FString &Text,
+                                   const FString &Replacement) const;
+
+private:
+  class FLiteral;
+
+  /** Find the matches in [From, To) of Text, appending them to OutMatches */
+  void Scan(const FString &Text, int32 From, int32 To,
+            TArray<FCodeFindMatch> &OutMatches);
+
+  /** Keep the previous matches that still match a longer literal */
+  void Refine(const FString &Text);
+
+  FCodeFindQuery Query;
+
+  /** Literal query, or the required literal of a pattern */
+  TUniquePtr<FLiteral> Literal;
+
+  /** Compiled pattern of a regular expression query */
+  TSharedPtr<const FCodeRegex, ESPMode::ThreadSafe> Regex;
+
+  /** Matcher of Regex, kept so its DFA states carry over between scans */
+  TUniquePtr<FCodeRegexMatcher> Matcher;
+
+  TArray<FCodeFindMatch> Matches;
+};
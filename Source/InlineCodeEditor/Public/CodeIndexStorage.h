@@ -0,0 +1,158 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "Async/MappedFileHandle.h"
+#include "Async/ParallelFor.h"
+#include "CoreMinimal.h"
+#include "HAL/FileManager.h"
+#include "HAL/ThreadSafeBool.h"
+
+/**
+ * Storage shared by the indexes ICE saves under Saved/ICE: path hashes,
+ * varints, and numbered generations of an image that are memory-mapped
+ * when read back.
+ *
+ * Each index writes Name.<Generation>Extension files. A new generation is
+ * written beside the one in use and replaces it once it is mapped; the old
+ * file is deleted when its last reader lets go of it.
+ */
+namespace CodeIndexStorage {
+/** Indexed files each worker task stats when checking a saved index */
+constexpr int32 StatChunkSize = 1024;
+
+/** Hash of a root-relative path, as file records keep it */
+uint64 HashPath(FStringView Path);
+
+/** File name prefix of the generations of a root's index */
+FString MakeIndexName(const FString &RootPath);
+
+/** Path of generation Generation of index Name in Directory */
+FString GetGenerationPath(const FString &Directory, const FString &Name,
+                          int32 Generation, const TCHAR *Extension);
+
+/** Append a value in groups of 7 bits, low first, the top bit on all but
+ *  the last */
+void WriteVarint(TArray<uint8> &Out, uint32 Value);
+
+/** Read a value written by WriteVarint; false if it runs past End */
+bool ReadVarint(const uint8 *&Data, const uint8 *End, uint32 &Value);
+
+/** Write an image through a temporary file; false if it was not saved */
+bool SaveImage(const TArray<uint8> &Bytes, const FString &FilePath);
+
+/** Saved generations of index Name in Directory, newest first */
+TArray<TPair<int32, FString>> FindGenerations(const FString &Directory,
+                                              const FString &Name,
+                                              const TCHAR *Extension);
+
+/** Image of an index, in memory or mapped from FilePath */
+struct FImage {
+  FImage() = default;
+  FImage(const FImage &) = delete;
+  FImage &operator=(const FImage &) = delete;
+  ~FImage();
+
+  /** Map a saved generation, or read it where mapping is not supported */
+  bool Map(const FString &InFilePath, int32 InGeneration);
+
+  /** Hold an image that was not saved */
+  void Adopt(TArray<uint8> &&InBytes, int32 InGeneration);
+
+  TArray<uint8> Bytes;
+  TUniquePtr<IMappedFileHandle> MappedFile;
+  TUniquePtr<IMappedFileRegion> MappedRegion;
+  const uint8 *Data = nullptr;
+  int64 Size = 0;
+
+  /** Saved generation this was mapped from; empty if only in memory */
+  FString FilePath;
+  int32 Generation = 0;
+
+  /** Set once a newer generation is saved, to delete this one's file */
+  mutable FThreadSafeBool bSuperseded;
+};
+
+/**
+ * Map a saved generation as an image type deriving from FImage with a
+ * bool Parse(); null if it is missing or malformed
+ */
+template <typename ImageType>
+TSharedPtr<ImageType, ESPMode::ThreadSafe> MapImage(const FString &FilePath,
+                                                    int32 Generation) {
+  TSharedRef<ImageType, ESPMode::ThreadSafe> Image =
+      MakeShared<ImageType, ESPMode::ThreadSafe>();
+  if (!Image->Map(FilePath, Generation) || !Image->Parse()) {
+    return nullptr;
+  }
+  return Image;
+}
+
+/** Parse an image held in memory; null if it is malformed */
+template <typename ImageType>
+TSharedPtr<ImageType, ESPMode::ThreadSafe>
+AdoptImage(TArray<uint8> &&Bytes, int32 Generation) {
+  TSharedRef<ImageType, ESPMode::ThreadSafe> Image =
+      MakeShared<ImageType, ESPMode::ThreadSafe>();
+  Image->Adopt(MoveTemp(Bytes), Generation);
+  if (!Image->Parse()) {
+    return nullptr;
+  }
+  return Image;
+}
+
+/**
+ * Map the newest readable generation of index Name in Directory, deleting
+ * the others; null if there is none
+ */
+template <typename ImageType>
+TSharedPtr<ImageType, ESPMode::ThreadSafe>
+MapNewestGeneration(const FString &Directory, const FString &Name,
+                    const TCHAR *Extension) {
+  TSharedPtr<ImageType, ESPMode::ThreadSafe> Image;
+  for (const TPair<int32, FString> &Generation :
+       FindGenerations(Directory, Name, Extension)) {
+    if (!Image.IsValid()) {
+      Image = MapImage<ImageType>(Generation.Value, Generation.Key);
+      if (Image.IsValid()) {
+        continue;
+      }
+    }
+    IFileManager::Get().Delete(*Generation.Value, false, false, true);
+  }
+  return Image;
+}
+
+/**
+ * Path hashes of the files of an image whose size or time changed since
+ * it was written, stat in parallel. ImageType has NumFiles(), GetPath()
+ * and GetFile() records with Size, Ticks and PathHash.
+ */
+template <typename ImageType>
+TArray<uint64> FindStaleFiles(const FString &RootPath, const ImageType &Image,
+                              const FThreadSafeBool &Cancelled) {
+  const int32 NumChunks =
+      FMath::DivideAndRoundUp(Image.NumFiles(), StatChunkSize);
+  TArray<TArray<uint64>> ChunkStale;
+  ChunkStale.SetNum(NumChunks);
+  ParallelFor(NumChunks, [&](int32 Chunk) {
+    const int32 First = Chunk * StatChunkSize;
+    const int32 Last = FMath::Min(First + StatChunkSize, Image.NumFiles());
+    for (int32 Index = First; Index < Last && !Cancelled; ++Index) {
+      const auto File = Image.GetFile(Index);
+      const FString FilePath = RootPath / Image.GetPath(Index);
+      const FFileStatData Stat = IFileManager::Get().GetStatData(*FilePath);
+      if (Stat.bIsValid && (Stat.FileSize != File.Size ||
+                            Stat.ModificationTime.GetTicks() != File.Ticks)) {
+        ChunkStale[Chunk].Add(File.PathHash);
+      }
+    }
+  });
+
+  TArray<uint64> Stale;
+  for (const TArray<uint64> &Chunk : ChunkStale) {
+    Stale.Append(Chunk);
+  }
+  return Stale;
+}
+} // namespace CodeIndexStorage
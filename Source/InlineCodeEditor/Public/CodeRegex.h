@@ -0,0 +1,119 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "Algo/BinarySearch.h"
+#include "CoreMinimal.h"
+
+/**
+ * A regular expression compiled for FCodeRegexMatcher.
+ *
+ * Nothing ever backtracks: the pattern becomes a Thompson NFA, whose sets
+ * of states are turned into DFA states as the text reaches them, so finding
+ * a match takes time linear in the line whatever the pattern. In exchange
+ * there are no backreferences or lookaround, and of the matches starting
+ * leftmost the longest wins, whatever the order of alternatives.
+ *
+ * Syntax: literal characters, ., [...] and [^...] with ranges, \d \w \s and
+ * their negations, (...) and (?:...), |, * + ? {n} {n,} {n,m} (a trailing ?
+ * is accepted and changes nothing), ^ $ \b \B, and the escapes \t \r \f \v
+ * \xHH \x{H...} \uHHHH. Matches never span lines: ^ and $ match at the ends
+ * of a line and nothing matches a line break. Characters outside ASCII are
+ * word characters, as in identifiers; ignoring case folds ASCII letters.
+ */
+class INLINECODEEDITOR_API FCodeRegex {
+public:
+  /** Compile Pattern; null, with the reason in OutError, if it is invalid */
+  static TSharedPtr<const FCodeRegex, ESPMode::ThreadSafe>
+  Compile(const FString &Pattern, bool bIgnoreCase, FText &OutError);
+
+  ~FCodeRegex();
+
+  /**
+   * Longest text that every match contains, for cheap prefilters; empty if
+   * there is none. Letters in it may differ in case when case is ignored.
+   */
+  const FString &GetRequiredLiteral() const { return RequiredLiteral; }
+
+private:
+  friend class FCodeRegexMatcher;
+  struct FProgram;
+
+  FCodeRegex();
+
+  /** Class of a character; characters of a class match the same sets */
+  int32 GetClass(uint32 CodePoint) const {
+    return CodePoint < 128 ? AsciiClasses[CodePoint]
+                           : Algo::UpperBound(ClassStarts, CodePoint) - 1;
+  }
+
+  /** NFA of the pattern, and of the pattern reversed */
+  TUniquePtr<FProgram> Forward;
+  TUniquePtr<FProgram> Reverse;
+
+  /** First character of each class, ascending */
+  TArray<uint32> ClassStarts;
+
+  /** Class of each ASCII character */
+  int32 AsciiClasses[128];
+
+  /** Classes each character set of the programs matches */
+  TArray<TBitArray<>> SetClasses;
+
+  /** Classes of word characters */
+  TBitArray<> WordClasses;
+
+  FString RequiredLiteral;
+};
+
+/**
+ * Finds the matches of an FCodeRegex line by line, building DFA states on
+ * first use and keeping them for later lines. Once they take more than a
+ * few megabytes they are thrown away and built again as needed, so memory
+ * stays bounded and no match allocates. Not thread safe; use one matcher
+ * per thread.
+ *
+ * Lines are passed without their line break. A line is first run through
+ * a DFA that only tells whether it holds a match; for lines that do, one
+ * backward pass marks where matches start and a forward pass from each
+ * start finds the longest match.
+ */
+class INLINECODEEDITOR_API FCodeRegexMatcher {
+public:
+  explicit FCodeRegexMatcher(
+      TSharedRef<const FCodeRegex, ESPMode::ThreadSafe> InRegex);
+  ~FCodeRegexMatcher();
+
+  /** Called with each match's start and end; returning false stops */
+  using FVisitor = TFunctionRef<bool(int32 Start, int32 End)>;
+
+  /** Visit the nonempty matches of a line in order, in TCHAR offsets */
+  void FindAll(FStringView Line, FVisitor Visitor);
+
+  /** Visit the nonempty matches of a UTF-8 line in order, in byte offsets */
+  void FindAll(const uint8 *Line, int32 Length, FVisitor Visitor);
+
+private:
+  struct FDfa;
+
+  template <typename LineType>
+  void FindAllIn(const LineType &Line, FVisitor Visitor);
+
+  /** End of the longest match starting at Start, or INDEX_NONE */
+  template <typename LineType>
+  int32 FindLongest(const LineType &Line, int32 Start);
+
+  TSharedRef<const FCodeRegex, ESPMode::ThreadSafe> Regex;
+
+  /** Forward and unanchored, to tell whether a line has a match */
+  TUniquePtr<FDfa> Search;
+
+  /** Backward and unanchored, to find where matches start */
+  TUniquePtr<FDfa> Starts;
+
+  /** Forward and anchored, to find where a match ends */
+  TUniquePtr<FDfa> Extent;
+
+  /** Whether a match starts at each offset of the current line */
+  TArray<uint8> StartMarks;
+};
@@ -0,0 +1,61 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CodeTextEdit.h"
+#include "CoreMinimal.h"
+
+struct FFindInFilesMatch;
+struct FFindInFilesResult;
+
+/** What renaming the uses of a name in files on disk did */
+struct FCodeRenameResult {
+  /** Root-relative files rewritten */
+  TArray<FString> ChangedFiles;
+
+  /** Root-relative files that could not be read or replaced */
+  TArray<FString> FailedFiles;
+
+  /** Uses renamed */
+  int32 NumEdits = 0;
+};
+
+/**
+ * Renames the uses of an identifier, as found by an FCodeSymbolIndex and
+ * previewed by find in files.
+ *
+ * Files on disk are rewritten by all task graph workers at once. Each is
+ * edited as bytes, so its encoding and line breaks are kept, and written to
+ * a temporary file beside it that then replaces it in one atomic rename,
+ * so a failed write never leaves a file half renamed or missing. Open
+ * documents are edited in their buffers instead, at the uses parsed from
+ * the buffer, with one edit spanning all of them, so undo takes the rename
+ * back in one step.
+ *
+ * A use is renamed where it is checked to still be, or where it is found
+ * again on its line if the file changed since it was found.
+ */
+class INLINECODEEDITOR_API FCodeRename {
+public:
+  /** Called on the game thread once every file is rewritten or failed */
+  using FOnFinished = TFunction<void(FCodeRenameResult &&)>;
+
+  /** Rename OldName to NewName in Files below RootPath, on the workers */
+  static void Start(const FString &RootPath, const FString &OldName,
+                    const FString &NewName, TArray<FFindInFilesResult> &&Files,
+                    FOnFinished OnFinished);
+
+  /**
+   * The single edit renaming OldName at Sites in Text, whose lines start at
+   * LineStarts; empty if no use is found. OutNumEdits is set to the number
+   * of uses renamed.
+   */
+  static FCodeTextEdit MakeEdit(const FString &Text,
+                                const TArray<int32> &LineStarts,
+                                const FString &OldName, const FString &NewName,
+                                const TArray<FFindInFilesMatch> &Sites,
+                                int32 &OutNumEdits);
+
+  /** Whether a name can replace an identifier */
+  static bool IsValidName(FStringView Name);
+};
@@ -0,0 +1,197 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FCppSyntaxTokenizer;
+class FFileTreePathIndex;
+
+/** What a declaration found by an FCodeSymbolIndex declares */
+enum class ECodeSymbolKind : uint8 {
+  Class,
+  Struct,
+  Enum,
+  Function,
+  /** Member declared with UPROPERTY */
+  Property,
+};
+
+/** A declaration in a source text */
+struct FCodeSymbol {
+  /** Declared name, without qualifiers */
+  FString Name;
+
+  /** Line of the name, 1-based */
+  int32 Line = 0;
+
+  ECodeSymbolKind Kind = ECodeSymbolKind::Function;
+
+  /** Whether it has a body here, rather than only being declared */
+  bool bDefinition = false;
+};
+
+/** A declaration found in a file below the root of an FCodeSymbolIndex */
+struct FCodeSymbolLocation {
+  /** File declaring it, relative to the root */
+  FString Path;
+
+  /** Line of the name, 1-based */
+  int32 Line = 0;
+
+  ECodeSymbolKind Kind = ECodeSymbolKind::Function;
+
+  /** Whether it has a body there, rather than only being declared */
+  bool bDefinition = false;
+};
+
+/** Where each identifier of a source text is used */
+struct FCodeOccurrences {
+  /** Identifiers used, sorted case-sensitively, each once */
+  TArray<FString> Names;
+
+  /** Index in Positions of the first use of each name, then of none */
+  TArray<int32> FirstPositions;
+
+  /** Line (X) and column (Y), both 1-based, of every use, by name */
+  TArray<FIntPoint> Positions;
+
+  /** Uses of a name in text order; empty if it is not used */
+  TConstArrayView<FIntPoint> Find(FStringView Name) const;
+};
+
+/** Uses of a name found in a file below the root of an FCodeSymbolIndex */
+struct FCodeReferences {
+  /** File using it, relative to the root */
+  FString Path;
+
+  /** Line (X) and column (Y), both 1-based, of each use, in file order */
+  TArray<FIntPoint> Positions;
+};
+
+/**
+ * Where the classes, structs, enums, functions and UPROPERTY members of the
+ * C++ source below a root are declared, and where every identifier in it
+ * is used.
+ *
+ * Files are run through FCppSyntaxTokenizer and a light declaration
+ * recognizer on worker threads, in parallel. The names are written under
+ * Saved/ICE/Symbols with an open-addressing hash table over them, so a
+ * lookup is a few probes into the memory-mapped file. Each name leads to
+ * its declarations and to a posting list of its uses, delta and varint
+ * encoded. Later sessions map it and stat every indexed file to find what
+ * changed while the editor was closed.
+ *
+ * A saved or changed file is parsed again straight away and held in memory
+ * over the mapped table, hiding its old symbols and uses. Once
+ * ICE.Symbols.IndexMergeThreshold files are held that way, a new table is
+ * written in the background, carrying the other files' entries over.
+ */
+class INLINECODEEDITOR_API FCodeSymbolIndex
+    : public TSharedFromThis<FCodeSymbolIndex, ESPMode::ThreadSafe> {
+public:
+  /** Index image, mapped or in memory; defined with the index format */
+  struct FSnapshot;
+
+  /** Index of RootPath; null if ICE.Symbols.Index is off */
+  static TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe>
+  Create(const FString &RootPath);
+
+  ~FCodeSymbolIndex();
+
+  /** Root directory, full; found paths are relative to it */
+  const FString &GetRootPath() const { return RootPath; }
+
+  /** Follow the files of a new path index of the root */
+  void
+  SetPathIndex(TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index);
+
+  /** Parse root-relative files that were added or modified again */
+  void HandleFilesChanged(const TArray<FString> &RelativePaths);
+
+  /** Whether lookups see every file yet */
+  bool IsReady() const { return Snapshot.IsValid() && !bLoading; }
+
+  /** Declarations of Name, exactly as spelled, in no particular order */
+  void Find(FStringView Name, TArray<FCodeSymbolLocation> &OutLocations) const;
+
+  /**
+   * Uses of Name, exactly as spelled, outside comments and string literals,
+   * by file in path order
+   */
+  void FindReferences(FStringView Name,
+                      TArray<FCodeReferences> &OutReferences) const;
+
+  /** Whether a root-relative file is C++ source the index parses */
+  static bool IsSourceFile(FStringView RelativePath);
+
+  /**
+   * Declarations in Text, and the uses of its identifiers, found from the
+   * tokens Tokenizer makes of it. Declarations inside function bodies are
+   * skipped; keywords are not identifiers. Safe on any thread with a
+   * Tokenizer of its own.
+   */
+  static void ParseSymbols(FCppSyntaxTokenizer &Tokenizer, const FString &Text,
+                           TArray<FCodeSymbol> &OutSymbols,
+                           FCodeOccurrences &OutOccurrences);
+
+private:
+  /** Symbols and uses of a file parsed since Snapshot was written */
+  struct FParsedFile {
+    FString Path;
+    TArray<FCodeSymbol> Symbols;
+    FCodeOccurrences Occurrences;
+  };
+
+  explicit FCodeSymbolIndex(const FString &InRootPath);
+
+  /** Map the index saved by an earlier session, and find what changed */
+  void Load();
+
+  /** Parse changed files, writing a new index if enough have changed */
+  void Update();
+
+  /** Hold a parsed file over Snapshot, replacing what was held for it */
+  void SetParsedFile(uint64 PathHash, FParsedFile &&File);
+
+  /** Path of generation Generation of this root's index */
+  FString GetIndexPath(int32 Generation) const;
+
+  /** Root directory, full */
+  FString RootPath;
+
+  /** File name prefix of this root's index generations */
+  FString IndexName;
+
+  /** Current index; null until loaded or built */
+  TSharedPtr<const FSnapshot, ESPMode::ThreadSafe> Snapshot;
+
+  /** Latest file list of the root */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex;
+
+  /**
+   * Files parsed since Snapshot was written, by path hash. Files removed
+   * since then are held without symbols.
+   */
+  TMap<uint64, FParsedFile> ParsedFiles;
+
+  /** Path hashes of the ParsedFiles declaring each name */
+  TMultiMap<FString, uint64> ParsedFilesByName;
+
+  /** Path hashes of files changed since the last update started */
+  TSet<uint64> ChangedFiles;
+
+  /** Of ChangedFiles, those changed while an update runs */
+  TSet<uint64> ChangedDuringUpdate;
+
+  /** Whether a saved index is being loaded and checked */
+  bool bLoading = false;
+
+  /** Whether an update is running, and whether another one was asked for */
+  bool bUpdating = false;
+  bool bUpdateAgain = false;
+
+  /** Set when this goes away, to abandon background work */
+  TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled;
+};
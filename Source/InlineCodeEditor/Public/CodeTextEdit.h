@@ -0,0 +1,47 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A range of a document's text, from Start up to End */
+struct FCodeTextRange {
+  int32 Start = 0;
+  int32 End = 0;
+};
+
+/**
+ * A single contiguous edit to a document buffer:
+ * replace RemovedLength characters at Offset with InsertedText.
+ */
+struct INLINECODEEDITOR_API FCodeTextEdit {
+  int32 Offset = 0;
+  int32 RemovedLength = 0;
+  FString InsertedText;
+
+  FCodeTextEdit() = default;
+  FCodeTextEdit(int32 InOffset, int32 InRemovedLength, FString InInsertedText)
+      : Offset(InOffset), RemovedLength(InRemovedLength),
+        InsertedText(MoveTemp(InInsertedText)) {}
+
+  /** Whether applying this edit would leave the text unchanged */
+  bool IsEmpty() const { return RemovedLength == 0 && InsertedText.IsEmpty(); }
+
+  /**
+   * Compute the smallest single edit that turns OldText into NewText
+   * (common prefix and suffix are trimmed away)
+   */
+  static FCodeTextEdit FromDiff(const FString &OldText, const FString &NewText);
+
+  /**
+   * The single edit replacing sorted, non-overlapping Ranges of Text with
+   * Replacement. It spans the first range to the last, copying whatever
+   * lies between them over unchanged; empty if there are no ranges.
+   */
+  static FCodeTextEdit FromReplacements(const FString &Text,
+                                        TConstArrayView<FCodeTextRange> Ranges,
+                                        const FString &Replacement);
+
+  /** Apply the edit in place. Returns false if the edit is out of range. */
+  bool ApplyTo(FString &Text) const;
+};
@@ -0,0 +1,70 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Framework/Text/SyntaxTokenizer.h"
+
+/** Range of tokens belonging to one line inside an FCodeTokenStore */
+struct FCodeTokenSpan {
+  int32 First = 0;
+  int32 Num = 0;
+};
+
+/**
+ * Compact storage for cached line tokens.
+ *
+ * Tokens are kept line-relative in three contiguous arrays (uint8 type,
+ * uint16 begin, uint16 end): 5 bytes per token instead of the 12 of an
+ * ISyntaxTokenizer::FToken, and no per-line array allocation. Lines refer
+ * to their tokens by span. Released spans leave holes that Compact()
+ * squeezes out once they make up most of the store.
+ */
+class INLINECODEEDITOR_API FCodeTokenStore {
+public:
+  /** Longest line whose tokens fit the 16-bit offsets */
+  static constexpr int32 MaxLineLength = MAX_uint16;
+
+  /**
+   * Append the tokens of a line starting at LineBegin, storing them relative
+   * to it. The line must be at most MaxLineLength long.
+   */
+  FCodeTokenSpan Add(const TArray<ISyntaxTokenizer::FToken> &Tokens,
+                     int32 LineBegin);
+
+  /** Append one line-relative token; used when building a span piecewise */
+  void AddToken(uint8 Type, uint16 Begin, uint16 End);
+
+  /** Expand a span into tokens rebased onto LineBegin (marshaller view) */
+  void CopyTo(const FCodeTokenSpan &Span, int32 LineBegin,
+              TArray<ISyntaxTokenizer::FToken> &OutTokens) const;
+
+  /** Mark a span's tokens as unused */
+  void Release(const FCodeTokenSpan &Span) { NumReleased += Span.Num; }
+
+  /** Whether released tokens outweigh live ones */
+  bool NeedsCompaction() const { return NumReleased > Types.Num() / 2; }
+
+  /** Drop released tokens, moving every live span to its new position */
+  void Compact(const TArray<FCodeTokenSpan *> &LiveSpans);
+
+  void Reset();
+
+  /** Drop the tokens added since Num() returned NumTokens */
+  void Truncate(int32 NumTokens);
+
+  /** Number of stored tokens, live or released */
+  int32 Num() const { return Types.Num(); }
+
+  uint8 GetType(int32 Index) const { return Types[Index]; }
+  uint16 GetBegin(int32 Index) const { return Begins[Index]; }
+  uint16 GetEnd(int32 Index) const { return Ends[Index]; }
+
+private:
+  TArray<uint8> Types;
+  TArray<uint16> Begins;
+  TArray<uint16> Ends;
+
+  /** Tokens belonging to released spans */
+  int32 NumReleased = 0;
+};
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "CaseSensitiveKeyFuncs.h"
+#include "CodeTokenStore.h"
 #include "CoreMinimal.h"
 #include "Framework/Text/SyntaxHighlighterTextLayoutMarshaller.h"
 #include "Framework/Text/SyntaxTokenizer.h"
@@ -39,6 +41,8 @@ enum class ECppTokenType : uint8 {
  * - Template parameter detection
  * - Multi-line comments
  * - Advanced preprocessor handling
+ * - Per-line token cache, so re-tokenizing after an edit only lexes the
+ *   lines that actually changed, shared by every view of a document
  */
 class INLINECODEEDITOR_API FCppSyntaxTokenizer : public ISyntaxTokenizer {
 public:
@@ -49,9 +53,57 @@ public:
   virtual void Process(TArray<FTokenizedLine> &OutTokenizedLines,
                        const FString &Input) override;
 
+  /** Drop all cached per-line tokens */
+  void ResetCache();
+
+  /**
+   * Serialize the cached tokens and lexer states of every line of Input.
+   * Returns false if some line of Input has not been tokenized yet.
+   */
+  bool SaveCachedLines(FArchive &Ar, const FString &Input) const;
+
+  /**
+   * Seed the line cache from data written by SaveCachedLines. Nothing is
+   * cached if it returns false.
+   */
+  bool LoadCachedLines(FArchive &Ar);
+
 private:
   FCppSyntaxTokenizer();
 
+  /**
+   * Tokens for one line, relative to the line start, keyed by the line's
+   * content and the lexer state it starts in
+   */
+  struct FCachedLine {
+    int32 Length = 0;
+    bool bEndsInBlockComment = false;
+    uint32 LastUsedPass = 0;
+    FCodeTokenSpan Tokens;
+  };
+
+  /**
+   * Passes a line survives without being seen. Views of one document with
+   * different folds tokenize different texts; this keeps them from evicting
+   * each other's lines.
+   */
+  static constexpr uint32 CacheRetainPasses = 4;
+
+  /** Tokenize a single line, advancing the multi-line lexer state */
+  void TokenizeLine(const FString &Input, const FTextRange &LineRange,
+                    FTokenizedLine &TokenizedLine);
+
+  /** Rebase cached tokens onto a line and restore its exit lexer state */
+  void CopyCachedTokens(const FCachedLine &CachedLine, int32 LineBegin,
+                        FTokenizedLine &OutTokenizedLine);
+
+  /** Squeeze tokens of evicted lines out of the token store */
+  void CompactTokenStore();
+
+  /** Cache key for a line */
+  static uint64 HashLine(const FString &Input, const FTextRange &LineRange,
+                         bool bStartsInBlockComment);
+
   /** Check token type helper */
   ECppTokenType GetTokenType(const FString &Token, bool bFollowedByParen,
                              bool bAfterClassKeyword, bool bAfterNamespace,
@@ -60,15 +112,23 @@ private:
   /** Check if character is operator-like */
   bool IsOperatorChar(TCHAR C) const;
 
-  TSet<FString> Keywords;
-  TSet<FString> ControlFlowKeywords;
-  TSet<FString> BuiltInTypes;
-  TSet<FString> UnrealTypes;
-  TSet<FString> UnrealMacros;
-  TSet<FString> PreProcessorDirectives;
+  /** Matched by exact spelling, so Delete or Return stay identifiers */
+  TSet<FString, FCaseSensitiveSetKeyFuncs> Keywords;
+  TSet<FString, FCaseSensitiveSetKeyFuncs> ControlFlowKeywords;
+  TSet<FString, FCaseSensitiveSetKeyFuncs> BuiltInTypes;
+  TSet<FString, FCaseSensitiveSetKeyFuncs> UnrealTypes;
+  TSet<FString, FCaseSensitiveSetKeyFuncs> UnrealMacros;
+  TSet<FString, FCaseSensitiveSetKeyFuncs> PreProcessorDirectives;
 
   /** State tracking for multi-line features */
   bool bInBlockComment = false;
+
+  /** Recently processed lines, one entry per unique line */
+  TMap<uint64, FCachedLine> CachedLines;
+
+  /** Tokens of every cached line */
+  FCodeTokenStore TokenStore;
+  uint32 ProcessPass = 0;
 };
 
 /**
@@ -78,6 +138,11 @@ class INLINECODEEDITOR_API FCppSyntaxHighlighter
     : public FSyntaxHighlighterTextLayoutMarshaller {
 public:
   static TSharedRef<FCppSyntaxHighlighter> Create();
+
+  /** Create a highlighter that shares an existing tokenizer and its cache */
+  static TSharedRef<FCppSyntaxHighlighter>
+  Create(TSharedRef<FCppSyntaxTokenizer> InTokenizer);
+
   virtual ~FCppSyntaxHighlighter() = default;
 
 protected:
@@ -0,0 +1,105 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** What a set of ignore rules says about a path */
+enum class EFileTreeIgnoreMatch : uint8 {
+  /** No rule matches */
+  None,
+  /** The last matching rule excludes the path */
+  Excluded,
+  /** The last matching rule is a negation ("!pattern") */
+  Included
+};
+
+/**
+ * Compiled rules of one ignore file, in .gitignore syntax.
+ *
+ * Supports comments, "!" negation, trailing "/" for directories only,
+ * anchored patterns (containing a "/"), and the "*", "?", "**" and
+ * "[...]" wildcards. Matching is case-insensitive, like the rest of the
+ * engine's path handling. Plain names are looked up in a hash map and
+ * "*.ext" patterns are matched as suffixes; only the remaining patterns
+ * are run through the wildcard matcher.
+ */
+class INLINECODEEDITOR_API FFileTreeIgnoreRules {
+public:
+  /** Compile one line of an ignore file */
+  void AddPattern(const FString &Line);
+
+  /** Compile every line of an ignore file; returns false if unreadable */
+  bool AddPatternsFromFile(const FString &FilePath);
+
+  bool IsEmpty() const { return Rules.Num() == 0; }
+
+  /**
+   * Match an entry. RelativePath is its path below the directory holding
+   * the rules, Name its last segment.
+   */
+  EFileTreeIgnoreMatch Match(const FString &RelativePath, const FString &Name,
+                             bool bIsDirectory) const;
+
+private:
+  enum class ERuleKind : uint8 { Literal, Suffix, Glob };
+
+  struct FRule {
+    /** Lowercase pattern, without "!" and leading or trailing "/" */
+    FString Pattern;
+    ERuleKind Kind = ERuleKind::Glob;
+    bool bNegated = false;
+    bool bDirectoryOnly = false;
+    /** Matched against the relative path rather than the name */
+    bool bAnchored = false;
+  };
+
+  /** Whether a rule applies to an entry */
+  static bool RuleMatches(const FRule &Rule, const FString &LowerPath,
+                          const FString &LowerName, bool bIsDirectory);
+
+  TArray<FRule> Rules;
+
+  /** Unanchored literal rules by pattern, indices ascending */
+  TMap<FString, TArray<int32, TInlineAllocator<1>>> LiteralRules;
+
+  /** Every other rule, indices ascending */
+  TArray<int32> PatternRules;
+};
+
+/**
+ * Ignore rules in effect below a directory: those of its own ignore files,
+ * falling back to those of its ancestors. Immutable once built, so listing
+ * threads can share it.
+ */
+struct INLINECODEEDITOR_API FFileTreeIgnoreScope {
+  /** Rules of the nearest ancestor with any, or null */
+  TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe> Parent;
+
+  /** Directory the rules are relative to */
+  FString BaseDir;
+
+  FFileTreeIgnoreRules Rules;
+
+  /** Whether an entry of a directory is excluded from the file tree */
+  bool IsExcluded(const FString &DirectoryPath, const FString &Name,
+                  bool bIsDirectory) const;
+
+  /** Scope of the ICE.FileTree.ExcludePatterns globs for a tree root */
+  static TSharedRef<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+  CreateDefault(const FString &RootPath);
+
+  /**
+   * Scope of the .gitignore and .p4ignore files of a directory, chained to
+   * Parent. Returns null if it has none or ICE.FileTree.UseIgnoreFiles is
+   * off. Reads files; meant for listing threads.
+   */
+  static TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+  LoadForDirectory(
+      const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+          &Parent,
+      const FString &DirectoryPath);
+
+  /** Whether a file name is one of the ignore files read by LoadForDirectory */
+  static bool IsIgnoreFileName(const FString &Name);
+};
@@ -0,0 +1,116 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+
+struct FFileChangeData;
+
+/** Git state of a file tree item */
+enum class EFileTreeGitState : uint8 {
+  /** Not in a git work tree, or not known yet */
+  None,
+  /** Tracked and unchanged */
+  Clean,
+  /** Tracked and changed or deleted; folders holding such files */
+  Modified,
+  /** Neither tracked nor excluded */
+  Untracked,
+  /** Excluded from the file tree, and not tracked */
+  Ignored,
+};
+
+/**
+ * Git status of the work tree around a file tree root, without running git.
+ *
+ * The repository's .git/index is parsed on a worker thread and its cached
+ * stat data compared with the files on disk. Only files whose size matches
+ * but whose modification time does not, or that were written in the same
+ * second as the index, are hashed. Afterwards the directory watcher's
+ * events recheck just the paths they name, and rewriting the index (a
+ * commit, checkout or add) re-reads it.
+ *
+ * States compare the work tree with the index, so staged changes show as
+ * clean. Untracked means neither in the index nor excluded from the tree;
+ * ignored reuses the tree's exclusion rules. Content filters such as
+ * core.autocrlf are not applied, so a file git considers clean can show as
+ * modified until git refreshes its index. Repositories using SHA-256 object
+ * names are not hashed; their suspicious files count as modified.
+ */
+class INLINECODEEDITOR_API FFileTreeGitStatus
+    : public TSharedFromThis<FFileTreeGitStatus, ESPMode::ThreadSafe> {
+public:
+  /** Status of the work tree containing RootPath; null outside one */
+  static TSharedPtr<FFileTreeGitStatus, ESPMode::ThreadSafe>
+  Create(const FString &RootPath);
+
+  ~FFileTreeGitStatus();
+
+  /** Re-read the index and recheck every tracked file in the background */
+  void Refresh();
+
+  /** Recheck the paths named by directory watcher events */
+  void HandleChanges(const TArray<FFileChangeData> &Changes);
+
+  /** State of a file or folder, given whether the tree excludes it */
+  EFileTreeGitState GetState(const FString &Path, bool bIsDirectory,
+                             bool bIsExcluded) const;
+
+  /** Broadcast on the game thread when states change */
+  FSimpleMulticastDelegate &OnChanged() { return ChangedEvent; }
+
+private:
+  struct FIndex;
+
+  FFileTreeGitStatus(const FString &InWorkTree, const FString &InGitDir);
+
+  /** Recheck work tree paths, and any tracked files below them */
+  void CheckPaths();
+
+  /** Record whether tracked files differ from the index */
+  bool ApplyChecks(const TArray<TPair<FString, bool>> &Checks);
+
+  /** Make a path relative to the work tree; false if outside it */
+  bool MakeRelative(const FString &Path, FString &OutRelativePath) const;
+
+  /** Handle changes to the repository's own directory */
+  void OnGitDirChanged(const TArray<FFileChangeData> &Changes);
+
+  /** Root of the work tree, full and without a trailing "/" */
+  FString WorkTree;
+
+  /** The repository directory holding the index */
+  FString GitDir;
+
+  /** Parsed index; null until first read */
+  TSharedPtr<const FIndex, ESPMode::ThreadSafe> Index;
+
+  /** Tracked files that differ from the index or are gone */
+  TSet<FString> ChangedFiles;
+
+  /** Number of ChangedFiles below each folder; "" is the work tree root */
+  TMap<FString, int32> ChangedDirectories;
+
+  /**
+   * Work tree paths waiting to be rechecked, and whether the tracked files
+   * below them are too, as when a folder is added or removed
+   */
+  TMap<FString, bool> PendingPaths;
+
+  /** Whether a refresh is running, and whether another one was asked for */
+  bool bRefreshing = false;
+  bool bRefreshAgain = false;
+
+  /** Whether a recheck of PendingPaths is running */
+  bool bChecking = false;
+
+  /** Set when this goes away, to abandon background work */
+  TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled;
+
+  /** Registration of GitDir with the directory watcher */
+  FDelegateHandle GitDirWatchHandle;
+
+  /** Broadcast when states change */
+  FSimpleMulticastDelegate ChangedEvent;
+};
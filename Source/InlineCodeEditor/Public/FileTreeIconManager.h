@@ -9,13 +9,33 @@
 /**
  * Manages VS Code-style file icons for the file tree view
  * Uses FSlateVectorImageBrush to render SVG icons
+ *
+ * Which icon each extension shows comes from the icon pack manifest,
+ * Resources/Icons/IconPack.json, so extensions can be added without
+ * recompiling. Icons are found through the plugin's base directory,
+ * wherever it is installed.
+ *
+ * The manifest is read and the icon folder listed on a worker thread, and
+ * each brush is made the first time it is asked for; until then no icons
+ * are returned and callers show their fallback. All icons share one size,
+ * so Slate rasterizes them onto the same atlas page and rows using them
+ * batch together.
+ *
+ * Extensions resolve to a small icon index through a case-insensitive
+ * FName table, which tree items resolve once and keep.
  */
 class FFileTreeIconManager {
 public:
+  /** Index of an icon */
+  using FIconIndex = uint16;
+
+  /** No icon, or not resolved yet */
+  static constexpr FIconIndex NoIcon = MAX_uint16;
+
   /** Get the singleton instance */
   static FFileTreeIconManager &Get();
 
-  /** Initialize icon brushes */
+  /** Start reading the icon pack in the background */
   void Initialize();
 
   /** Cleanup icon brushes */
@@ -27,49 +47,58 @@ public:
   /** Get icon for a file based on its extension */
   const FSlateBrush *GetFileIcon(const FString &Extension) const;
 
-  /** Check if the icons have been initialized */
+  /** Get icon for a file based on its extension, without a string lookup */
+  const FSlateBrush *GetFileIcon(FName Extension) const;
+
+  /**
+   * Icon a file extension shows, the default file icon if it has none;
+   * NoIcon until the icon pack is read
+   */
+  FIconIndex FindFileIcon(FName Extension) const;
+
+  /** Brush of an icon, made on first use; null if its SVG is missing */
+  const FSlateBrush *GetIconBrush(FIconIndex Index) const;
+
+  /** Check if the icon pack has been read */
   bool IsInitialized() const { return bIsInitialized; }
 
+  /** Broadcast on the game thread once the icon pack has been read */
+  FSimpleMulticastDelegate &OnIconsLoaded() { return IconsLoadedEvent; }
+
 private:
   FFileTreeIconManager() = default;
   ~FFileTreeIconManager() = default;
 
-  /** Load an SVG icon from the Resources folder */
-  TSharedPtr<FSlateVectorImageBrush>
-  LoadSVGIcon(const FString &IconName,
-              const FVector2D &IconSize = FVector2D(16.0f, 16.0f));
-
   /** Get the base path for icons */
-  FString GetIconBasePath() const;
+  static FString GetIconBasePath();
 
 private:
+  /** An icon of the pack */
+  struct FIcon {
+    /** SVG path; empty if the file is missing */
+    FString Path;
+
+    /** Brush, once made */
+    TSharedPtr<FSlateVectorImageBrush> Brush;
+  };
+
+  /** Whether Initialize() has started reading the icon pack */
+  bool bIsLoading = false;
+
+  /** Whether the icon pack has been read */
   bool bIsInitialized = false;
 
-  // Folder icons
-  TSharedPtr<FSlateVectorImageBrush> FolderIcon;
-  TSharedPtr<FSlateVectorImageBrush> FolderOpenIcon;
-
-  // File type icons
-  TSharedPtr<FSlateVectorImageBrush> DefaultFileIcon;
-  TSharedPtr<FSlateVectorImageBrush> CppIcon;
-  TSharedPtr<FSlateVectorImageBrush> CIcon;
-  TSharedPtr<FSlateVectorImageBrush> HeaderIcon;
-  TSharedPtr<FSlateVectorImageBrush> CHeaderIcon;
-  TSharedPtr<FSlateVectorImageBrush> CSharpIcon;
-  TSharedPtr<FSlateVectorImageBrush> JsonIcon;
-  TSharedPtr<FSlateVectorImageBrush> ConfigIcon;
-  TSharedPtr<FSlateVectorImageBrush> TextIcon;
-  TSharedPtr<FSlateVectorImageBrush> MarkdownIcon;
-  TSharedPtr<FSlateVectorImageBrush> ImageIcon;
-  TSharedPtr<FSlateVectorImageBrush> XmlIcon;
-  TSharedPtr<FSlateVectorImageBrush> PythonIcon;
-  TSharedPtr<FSlateVectorImageBrush> JsIcon;
-  TSharedPtr<FSlateVectorImageBrush> TsIcon;
-  TSharedPtr<FSlateVectorImageBrush> HtmlIcon;
-  TSharedPtr<FSlateVectorImageBrush> CssIcon;
-  TSharedPtr<FSlateVectorImageBrush> ShellIcon;
-  TSharedPtr<FSlateVectorImageBrush> BatIcon;
-
-  // Extension to icon mapping
-  TMap<FString, TSharedPtr<FSlateVectorImageBrush>> ExtensionIconMap;
+  /** Icons of the pack; brushes are made on first use */
+  mutable TArray<FIcon> Icons;
+
+  /** Folder icons and the icon of unmapped files */
+  FIconIndex FolderIcon = NoIcon;
+  FIconIndex FolderOpenIcon = NoIcon;
+  FIconIndex DefaultFileIcon = NoIcon;
+
+  // Extension to icon mapping (FName compares case-insensitively)
+  TMap<FName, FIconIndex> ExtensionIconMap;
+
+  /** Broadcast once the icon pack has been read */
+  FSimpleMulticastDelegate IconsLoadedEvent;
 };
@@ -0,0 +1,85 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+
+struct FFileTreeIgnoreScope;
+
+/** A scored path of an FFileTreePathIndex */
+struct FFileTreePathMatch {
+  int32 Index = INDEX_NONE;
+  int32 Score = 0;
+};
+
+/**
+ * Flat index of every file below a root, for filtering the file tree and
+ * Quick Open without listing folders one by one.
+ *
+ * Paths are stored root-relative with "/" separators, back to back in one
+ * character buffer. An index is built on a background thread and is
+ * immutable afterwards, so any thread may match against it; changes on disk
+ * produce a new index with WithChanges().
+ */
+class INLINECODEEDITOR_API FFileTreePathIndex {
+public:
+  /**
+   * Walk a root on a background thread, honouring the same exclusion rules
+   * as the file tree and skipping hidden entries and symlinked folders.
+   * OnBuilt runs on the game thread unless Cancelled is set first.
+   */
+  static void BuildAsync(
+      const FString &RootPath,
+      const TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+          &RootScope,
+      const TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> &Cancelled,
+      TFunction<void(TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe>)>
+          OnBuilt);
+
+  /**
+   * Copy of an index without the Removed paths (and anything below them)
+   * and with the Added ones. Both are root-relative. Meant for background
+   * threads; costs one pass over the index and no I/O.
+   */
+  static TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe>
+  WithChanges(const FFileTreePathIndex &Index, const TArray<FString> &Added,
+              const TArray<FString> &Removed);
+
+  /** Number of indexed paths */
+  int32 Num() const { return Starts.Num() - 1; }
+
+  /** Root-relative path of an indexed file */
+  FStringView GetPath(int32 Index) const {
+    return FStringView(Chars.GetData() + Starts[Index],
+                       Starts[Index + 1] - Starts[Index]);
+  }
+
+  /**
+   * Find the paths that contain every character of Query in order,
+   * ignoring case and spaces. When Candidates is set only those indices are
+   * tested, which is how a longer query narrows a previous result. Matches
+   * keep index order.
+   */
+  void Match(const FString &Query, const TArray<int32> *Candidates,
+             TArray<int32> &OutMatches) const;
+
+  /**
+   * Score the paths matching Query like Match() does, filling OutMatches
+   * with every match and OutBest with the MaxResults best, best first.
+   * Matches in the file name, at word starts and in runs score higher;
+   * shorter paths win ties.
+   */
+  void FindBest(const FString &Query, const TArray<int32> *Candidates,
+                int32 MaxResults, TArray<int32> &OutMatches,
+                TArray<FFileTreePathMatch> &OutBest) const;
+
+private:
+  void AddPath(FStringView Path);
+
+  /** Characters of every path, back to back */
+  TArray<TCHAR> Chars;
+
+  /** Start of each path in Chars, plus the end of the last one */
+  TArray<int32> Starts = {0};
+};
@@ -0,0 +1,36 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FFileTreeItem;
+
+/**
+ * On-disk snapshot of a file tree, so the tree can be drawn immediately
+ * when the ICE tab opens and validated against disk afterwards.
+ *
+ * Holds the names, types, sizes, modification times, exclusion and
+ * expansion state of every item listed so far. One snapshot per root
+ * directory lives under Saved/ICE/FileTree.
+ */
+class INLINECODEEDITOR_API FFileTreeSnapshot {
+public:
+  /**
+   * Fill the children of a root item from its snapshot. Loaded directories
+   * are left unlisted, to be reconciled with disk. Returns false if there
+   * is no usable snapshot.
+   */
+  static bool Load(const TSharedRef<FFileTreeItem> &RootItem);
+
+  /**
+   * Copy the snapshot of a root item and everything listed below it, and
+   * write it on a worker thread. Of saves of the same root still waiting,
+   * only the latest is written.
+   */
+  static void Save(const FFileTreeItem &RootItem);
+
+private:
+  /** Path of the snapshot for a root directory */
+  static FString GetSnapshotPath(const FString &RootPath);
+};
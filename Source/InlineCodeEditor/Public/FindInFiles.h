@@ -0,0 +1,202 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FindInFilesIndex.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+
+class FCodeRegex;
+class FFileTreePathIndex;
+
+/** What a find-in-files search looks for */
+struct FFindInFilesQuery {
+  /** Text to find */
+  FString Text;
+
+  /** Whether case must match; otherwise ASCII letters match either case */
+  bool bMatchCase = false;
+
+  /** Whether matches may not be part of a longer identifier */
+  bool bWholeWord = false;
+
+  /** Whether Text is an FCodeRegex pattern rather than literal text */
+  bool bRegex = false;
+};
+
+/** One match of a find-in-files search */
+struct FFindInFilesMatch {
+  /** Line of the match, 1-based */
+  int32 Line = 0;
+
+  /** Column the match starts at in characters, 1-based */
+  int32 Column = 0;
+
+  /** Byte offset of the match in the file */
+  int64 Offset = 0;
+
+  /** The line, or the part of it around the match if it is long */
+  FString Preview;
+
+  /** Where the match is in Preview */
+  int32 PreviewStart = 0;
+  int32 PreviewLength = 0;
+};
+
+/** The matches of a find-in-files search in one file */
+struct FFindInFilesResult {
+  /** Root-relative path */
+  FString Path;
+
+  /** Matches in file order */
+  TArray<FFindInFilesMatch> Matches;
+};
+
+/**
+ * A search for text in every file of an FFileTreePathIndex, so it honours
+ * the file tree's exclusion rules.
+ *
+ * When the root's FFindInFilesIndex is ready, only the files its posting
+ * lists cannot rule out are read.
+ *
+ * Files are memory-mapped and scanned by all task graph workers at once,
+ * looking for the query's rarest byte sixteen bytes at a time and checking
+ * the whole query only where it occurs. A regular expression query is run
+ * line by line through an FCodeRegexMatcher per worker, on the lines
+ * holding the text all its matches contain when there is such text.
+ *
+ * Files are read as UTF-8; files with a NUL byte near the start are taken
+ * to be binary and skipped, as are files over
+ * ICE.FindInFiles.MaxFileSizeMB.
+ *
+ * Results are handed to the game thread in batches while the search runs,
+ * and it stops after ICE.FindInFiles.MaxResults matches. Cancelling stops
+ * the workers between files.
+ *
+ * A search can also be given the matches, as found by an FCodeSymbolIndex,
+ * and only read their lines in parallel for the previews.
+ */
+class INLINECODEEDITOR_API FFindInFilesSearch
+    : public TSharedFromThis<FFindInFilesSearch, ESPMode::ThreadSafe> {
+public:
+  /** Called on the game thread with newly found results */
+  using FOnResults = TFunction<void(TArray<FFindInFilesResult> &&)>;
+
+  /** Called on the game thread when a search that was not cancelled ends */
+  using FOnFinished = TFunction<void(bool bReachedMaxResults)>;
+
+  /**
+   * Start searching the files of PathIndex, below RootPath. Filter skips
+   * the files an FFindInFilesIndex rules out.
+   */
+  static TSharedRef<FFindInFilesSearch, ESPMode::ThreadSafe>
+  Start(const FString &RootPath,
+        TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex,
+        FFindInFilesFilter Filter, const FFindInFilesQuery &Query,
+        FOnResults OnResults, FOnFinished OnFinished);
+
+  /**
+   * Start reading the lines of known uses of Word below RootPath, given as
+   * Files whose matches only hold a line and a column, for their previews.
+   * A use no longer at its column is looked for on its line, and dropped
+   * if it is not there. ICE.FindInFiles.MaxResults does not apply.
+   */
+  static TSharedRef<FFindInFilesSearch, ESPMode::ThreadSafe>
+  StartAt(const FString &RootPath, const FString &Word,
+          TArray<FFindInFilesResult> &&Files, FOnResults OnResults,
+          FOnFinished OnFinished);
+
+  /**
+   * Call Visitor with the contents of a file as searches see them: mapped
+   * into memory, and not at all if the file is empty, binary or over
+   * ICE.FindInFiles.MaxFileSizeMB. Returns whether Visitor was called.
+   * Safe on any thread.
+   */
+  static bool
+  VisitTextFile(const FString &FilePath,
+                TFunctionRef<void(const uint8 *Data, int64 Size)> Visitor);
+
+  /**
+   * Find known uses of Word in a file's contents as StartAt does, Targets
+   * giving their lines and columns in file order. Safe on any thread.
+   */
+  static void FindWordAt(const uint8 *Data, int64 Size, const FString &Word,
+                         const TArray<FFindInFilesMatch> &Targets,
+                         TArray<FFindInFilesMatch> &OutMatches);
+
+  /**
+   * Compile a regular expression query as searches do; null, with the
+   * reason in OutError, if the pattern is invalid
+   */
+  static TSharedPtr<const FCodeRegex, ESPMode::ThreadSafe>
+  CompileRegex(const FFindInFilesQuery &Query, FText &OutError);
+
+  /** Stop searching; no more callbacks are made */
+  void Cancel();
+
+  /** Whether the search is still running; call on the game thread */
+  bool IsRunning() const { return bRunning; }
+
+  /** Number of files searched so far, and in total */
+  int32 GetNumFilesSearched() const { return NumFilesSearched.GetValue(); }
+  int32 GetNumFiles() const;
+
+private:
+  FFindInFilesSearch(
+      const FString &InRootPath,
+      TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> InPathIndex,
+      FFindInFilesFilter InFilter, const FFindInFilesQuery &InQuery);
+
+  /** Search, then report the end; runs on a worker thread */
+  void Run();
+
+  /** Search every file of PathIndex */
+  void SearchFiles();
+
+  /** Fill in the previews of the matches in Targets */
+  void ReadTargets();
+
+  /** Queue results for the game thread */
+  void AddResults(TArray<FFindInFilesResult> &&Results);
+
+  /** Hand queued results to OnResults, on the game thread */
+  void FlushResults();
+
+  /** Root the indexed paths are relative to */
+  FString RootPath;
+
+  /** Files to search; null when the matches are known */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex;
+
+  /** Known matches, by file, whose previews are read */
+  TArray<FFindInFilesResult> Targets;
+
+  /** Rules out files that cannot match */
+  FFindInFilesFilter Filter;
+
+  /** What to find */
+  FFindInFilesQuery Query;
+
+  /** Callbacks, only touched on the game thread */
+  FOnResults OnResults;
+  FOnFinished OnFinished;
+
+  /** Whether the search is running, as seen from the game thread */
+  bool bRunning = true;
+
+  /** Set to stop the workers */
+  FThreadSafeBool bCancelled;
+
+  /** Set once ICE.FindInFiles.MaxResults matches were found */
+  FThreadSafeBool bReachedMaxResults;
+
+  /** Progress counters */
+  FThreadSafeCounter NumFilesSearched;
+  FThreadSafeCounter NumMatches;
+
+  /** Results waiting for the game thread, and whether a flush is queued */
+  FCriticalSection PendingLock;
+  TArray<FFindInFilesResult> PendingResults;
+  bool bFlushQueued = false;
+};
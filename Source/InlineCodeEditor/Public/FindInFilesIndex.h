@@ -0,0 +1,122 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FFileTreePathIndex;
+class FFindInFilesFilter;
+
+/**
+ * Trigram index of the text files below a root, so find in files only
+ * reads the files that can contain the query.
+ *
+ * For every three-byte sequence (ASCII letters folded to lower case) the
+ * index holds a delta-encoded posting list of the files containing it. A
+ * query's trigrams are looked up and their lists intersected; files added
+ * or changed since the index was written are always searched.
+ *
+ * The index is built from the file tree's FFileTreePathIndex on a worker
+ * thread and written under Saved/ICE/Index, from where later sessions
+ * memory-map it and stat every indexed file to find what changed while the
+ * editor was closed. Once ICE.FindInFiles.IndexMergeThreshold files have
+ * changed, the changed files are re-read and merged into a new index in
+ * the background; the rest of the postings are carried over without I/O.
+ */
+class INLINECODEEDITOR_API FFindInFilesIndex
+    : public TSharedFromThis<FFindInFilesIndex, ESPMode::ThreadSafe> {
+public:
+  /** Index image, mapped or in memory; defined with the index format */
+  struct FSnapshot;
+
+  /** Index of RootPath; null if ICE.FindInFiles.Index is off */
+  static TSharedPtr<FFindInFilesIndex, ESPMode::ThreadSafe>
+  Create(const FString &RootPath);
+
+  ~FFindInFilesIndex();
+
+  /** Follow the files of a new path index of the root */
+  void
+  SetPathIndex(TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index);
+
+  /** Note root-relative files that were added or modified */
+  void HandleFilesChanged(const TArray<FString> &RelativePaths);
+
+  /** Whether the index can narrow searches yet */
+  bool IsReady() const { return Snapshot.IsValid() && !bLoading; }
+
+  /** Filter for a search starting now; passes every file if not ready */
+  FFindInFilesFilter GetFilter() const;
+
+private:
+  friend class FFindInFilesFilter;
+
+  explicit FFindInFilesIndex(const FString &InRootPath);
+
+  /** Map the index saved by an earlier session, and find what changed */
+  void Load();
+
+  /** Build or merge a new index in the background, if it is worth it */
+  void Update();
+
+  /** Path of generation Generation of this root's index */
+  FString GetIndexPath(int32 Generation) const;
+
+  /** Root directory, full */
+  FString RootPath;
+
+  /** File name prefix of this root's index generations */
+  FString IndexName;
+
+  /** Current index; null until loaded or built */
+  TSharedPtr<const FSnapshot, ESPMode::ThreadSafe> Snapshot;
+
+  /** Latest file list of the root */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex;
+
+  /** Path hashes of files changed since Snapshot was written */
+  TSet<uint64> ChangedFiles;
+
+  /** Of ChangedFiles, those changed while an update runs */
+  TSet<uint64> ChangedDuringUpdate;
+
+  /** Whether a saved index is being loaded and checked */
+  bool bLoading = false;
+
+  /** Whether an update is running, and whether another one was asked for */
+  bool bUpdating = false;
+  bool bUpdateAgain = false;
+
+  /** Set when this goes away, to abandon background work */
+  TSharedRef<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled;
+};
+
+/**
+ * Which files of a root may contain a search's text, according to an
+ * FFindInFilesIndex. Taken on the game thread, used on any thread.
+ */
+class INLINECODEEDITOR_API FFindInFilesFilter {
+public:
+  /** Look up the posting lists of Text's trigrams */
+  void Narrow(const FString &Text);
+
+  /** Whether a root-relative file may contain the text */
+  bool MayContain(FStringView RelativePath) const;
+
+private:
+  friend class FFindInFilesIndex;
+
+  /** Index consulted; null passes every file */
+  TSharedPtr<const FFindInFilesIndex::FSnapshot, ESPMode::ThreadSafe>
+      Snapshot;
+
+  /** Files changed since the index was written, always searched */
+  TSet<uint64> ChangedFiles;
+
+  /** Indexed files holding every trigram of the text */
+  TBitArray<> Candidates;
+
+  /** Whether Candidates applies; texts under three bytes match anything */
+  bool bNarrowed = false;
+};
@@ -2,27 +2,23 @@
 
 #pragma once
 
+#include "CodeDocument.h"
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/Text/SMultiLineEditableText.h"
 
+class FCodeFindResults;
 class FCppSyntaxHighlighter;
 class SScrollBar;
 class SVerticalBox;
 
-/**
- * Represents a foldable code region (e.g., function body, class, etc.)
- */
-struct FCodeFoldRegion {
-  int32 StartLine = 0;
-  int32 EndLine = 0;
-  bool bIsFolded = false;
-  int32 IndentLevel = 0;
-
-  FCodeFoldRegion() = default;
-  FCodeFoldRegion(int32 InStart, int32 InEnd, int32 InIndent = 0)
-      : StartLine(InStart), EndLine(InEnd), IndentLevel(InIndent) {}
-};
+DECLARE_DELEGATE_OneParam(FOnCodeTextEdited, const FCodeTextEdit & /*Edit*/);
+DECLARE_DELEGATE_TwoParams(FOnCodeGoToDefinition,
+                           const FString & /*Identifier*/, bool /*bPeek*/);
+DECLARE_DELEGATE_OneParam(FOnCodeFindReferences,
+                          const FString & /*Identifier*/);
+DECLARE_DELEGATE_OneParam(FOnCodeRenameSymbol,
+                          const FString & /*Identifier*/);
 
 /**
  * Widget that draws indentation guide lines (VS Code style)
@@ -63,25 +59,92 @@ private:
   FLinearColor GuideColor;
 };
 
+/**
+ * Widget that paints find matches behind the text. Only the lines in view
+ * are visited, each finding its first match by binary search, so painting
+ * costs the same however many matches the document has.
+ */
+class SCodeFindHighlights : public SLeafWidget {
+public:
+  SLATE_BEGIN_ARGS(SCodeFindHighlights) {}
+  SLATE_ARGUMENT(float, LineHeight)
+  SLATE_ARGUMENT(float, CharWidth)
+  SLATE_END_ARGS()
+
+  void Construct(const FArguments &InArgs);
+
+  virtual int32 OnPaint(const FPaintArgs &Args,
+                        const FGeometry &AllottedGeometry,
+                        const FSlateRect &MyCullingRect,
+                        FSlateWindowElementList &OutDrawElements, int32 LayerId,
+                        const FWidgetStyle &InWidgetStyle,
+                        bool bParentEnabled) const override;
+
+  virtual FVector2D ComputeDesiredSize(float) const override;
+
+  /** Set the document range shown by each displayed line */
+  void SetDisplayedLines(TArray<int32> &&InLineStarts,
+                         TArray<int32> &&InLineEnds);
+
+  /** Set the matches to paint and the current one; null paints nothing */
+  void SetResults(TSharedPtr<const FCodeFindResults> InResults,
+                  int32 InCurrentMatch);
+
+private:
+  /** Document offsets where each displayed line starts and ends */
+  TArray<int32> LineStarts;
+  TArray<int32> LineEnds;
+
+  TSharedPtr<const FCodeFindResults> Results;
+  int32 CurrentMatch = INDEX_NONE;
+
+  float LineHeight = 15.0f;
+  float CharWidth = 8.0f;
+};
+
 /**
  * A code editor widget with:
  * - Code folding
  * - Character-based indentation guides
  * - Monaco Dark+ theme styling
  * - Syntax highlighting
+ *
+ * The widget is a view of an FCodeDocument: the buffer, token cache and line
+ * analysis live in the document and are shared by every view of it, while
+ * fold state, cursor and scroll position are per view.
+ *
+ * F12 or Ctrl+click on an identifier asks for its declaration through
+ * OnGoToDefinition, and Alt+F12 asks to peek at it. Shift+F12 asks for its
+ * uses through OnFindReferences, and F2 asks to rename it through
+ * OnRenameSymbol.
  */
 class INLINECODEEDITOR_API SCodeEditableText : public SCompoundWidget {
 public:
   SLATE_BEGIN_ARGS(SCodeEditableText)
       : _Text(), _IsReadOnly(false), _FilePath() {}
+  /** Document to show; a transient one is made from Text if unset */
+  SLATE_ARGUMENT(TSharedPtr<FCodeDocument>, Document)
   SLATE_ATTRIBUTE(FText, Text)
   SLATE_ARGUMENT(bool, IsReadOnly)
   SLATE_ARGUMENT(FString, FilePath)
   SLATE_EVENT(FOnTextChanged, OnTextChanged)
+  /** Called with the minimal edit for every user change to the text */
+  SLATE_EVENT(FOnCodeTextEdited, OnTextEdited)
   SLATE_EVENT(FSimpleDelegate, OnCursorMoved)
+  /** Called with the identifier to find the declaration of */
+  SLATE_EVENT(FOnCodeGoToDefinition, OnGoToDefinition)
+  /** Called with the identifier to find the uses of */
+  SLATE_EVENT(FOnCodeFindReferences, OnFindReferences)
+  /** Called with the identifier to rename across the project */
+  SLATE_EVENT(FOnCodeRenameSymbol, OnRenameSymbol)
   SLATE_END_ARGS()
 
   void Construct(const FArguments &InArgs);
+  virtual ~SCodeEditableText() override;
+
+  TSharedRef<FCodeDocument> GetDocument() const {
+    return Document.ToSharedRef();
+  }
 
   FText GetText() const;
   void SetText(const FText &InText);
@@ -96,48 +159,123 @@ public:
   void SetFilePath(const FString &InPath) { FilePath = InPath; }
   FString GetFilePath() const { return FilePath; }
 
-  bool IsModified() const { return bIsModified; }
-  void ClearModified() { bIsModified = false; }
+  bool IsModified() const { return Document->IsModified(); }
 
   void FocusEditor();
   void ToggleFoldAtLine(int32 LineNumber);
   void FoldAll();
   void UnfoldAll();
 
+  /** Start lines (0-based) of the currently folded regions */
+  TArray<int32> GetFoldedLines() const;
+
+  /** Fold exactly the regions starting at the given lines (0-based) */
+  void SetFoldedLines(const TArray<int32> &InFoldedLines);
+
+  /** Document offset of the cursor */
+  int32 GetCursorOffset() const;
+
+  /** Select a range within one line, unfolding and scrolling to it */
+  void SelectRange(int32 Start, int32 End);
+
+  /**
+   * Apply an edit to the document as one step of its undo history, however
+   * much of the text it spans
+   */
+  void ApplyEdit(const FCodeTextEdit &Edit);
+
+  /** Take back the document's last edit, or make it again, from any view */
+  void Undo();
+  void Redo();
+
+  /** Paint the matches of a find, the current one apart; null clears */
+  void SetFindResults(TSharedPtr<const FCodeFindResults> Results,
+                      int32 CurrentMatch);
+
+  /**
+   * Identifier at, or ending at, a document offset; empty if there is none
+   */
+  FString GetIdentifierAt(int32 Offset) const;
+
+  virtual FReply OnKeyDown(const FGeometry &MyGeometry,
+                           const FKeyEvent &InKeyEvent) override;
+  virtual FReply
+  OnPreviewMouseButtonDown(const FGeometry &MyGeometry,
+                           const FPointerEvent &MouseEvent) override;
+
 private:
   void HandleTextChanged(const FText &NewText);
   void HandleCursorMoved(const FTextLocation &NewLocation);
-  void RebuildFoldingGutter();
-  void ParseFoldRegions();
-  void ParseLines();
 
-  /** Calculate indent levels for each line based on leading whitespace */
-  void CalculateLineIndentLevels();
+  /**
+   * Keys the text editor would handle itself. Undo and redo go to the
+   * document: the editor's own history restores whole texts, which would
+   * drop the edits made in other views since.
+   */
+  FReply HandleEditorKeyDown(const FGeometry &MyGeometry,
+                             const FKeyEvent &InKeyEvent);
+
+  /** Edit menu of the text, with the document's undo and redo */
+  TSharedPtr<SWidget> BuildContextMenu();
+
+  /** Notify and place the cursor after an undo or redo */
+  void HandleHistoryEdit(const FCodeTextEdit &Edit);
 
+  /** Re-sync with the document after an edit made in any of its views */
+  void HandleDocumentEdited(const FCodeTextEdit &Edit);
+
+  /**
+   * Replace the range of the text the editor shows from Start to End with
+   * Text, so only the lines edited are laid out again. DisplayedText already
+   * holds the result.
+   */
+  void ReplaceDisplayedRange(const FTextLocation &Start,
+                             const FTextLocation &End, const FString &Text);
+
+  /** Map an offset in the displayed (folded) text to the document */
+  int32 DisplayToDocumentOffset(int32 DisplayOffset) const;
+
+  /** Document offset of the character under a screen position, if any */
+  int32 GetOffsetAtScreenPosition(const FVector2D &ScreenPosition) const;
+
+  /** Ask for the declaration of the identifier at a document offset */
+  bool RequestDefinition(int32 Offset, bool bPeek);
+
+  void RebuildFoldingGutter();
   void ApplyFolding();
   FCodeFoldRegion *GetFoldRegionAtLine(int32 LineIndex);
   bool IsLineHidden(int32 LineIndex) const;
   FReply OnFoldButtonClicked(int32 LineIndex);
   void UpdateIndentGuides();
 
+  /** Tell the find highlights where the displayed lines are */
+  void UpdateFindHighlights();
+
+  /** Build the text shown for the current fold state */
+  FString BuildDisplayedText();
+
 private:
   TSharedPtr<SMultiLineEditableText> TextEditor;
   TSharedPtr<SVerticalBox> FoldingGutter;
   TSharedPtr<class SScrollBox> EditorScrollBox;
   TSharedPtr<SIndentGuides> IndentGuidesWidget;
+  TSharedPtr<SCodeFindHighlights> FindHighlightsWidget;
   TSharedPtr<FCppSyntaxHighlighter> SyntaxMarshaller;
 
-  TArray<FCodeFoldRegion> FoldRegions;
+  /** Document shown by this view */
+  TSharedPtr<FCodeDocument> Document;
+  FDelegateHandle DocumentEditedHandle;
 
-  /** Indent level for each displayed line */
-  TArray<int32> LineIndentLevels;
+  /** The document's fold regions with this view's fold flags */
+  TArray<FCodeFoldRegion> FoldRegions;
 
-  FString OriginalText;
   FString DisplayedText;
   TArray<int32> DisplayToOriginalLine;
 
+  /** Offset of each displayed line in DisplayedText */
+  TArray<int32> DisplayedLineStarts;
+
   FString FilePath;
-  bool bIsModified = false;
   int32 CurrentLine = 1;
   int32 CurrentColumn = 1;
   int32 TotalLines = 1;
@@ -145,10 +283,15 @@ private:
   /** Measured character width in pixels */
   float CharacterWidth = 8.0f;
 
-  /** Indent size in spaces */
-  static constexpr int32 IndentSize = 2;
-
   FOnTextChanged OnTextChangedCallback;
+  FOnCodeTextEdited OnTextEditedCallback;
   FSimpleDelegate OnCursorMovedCallback;
+  FOnCodeGoToDefinition OnGoToDefinitionCallback;
+  FOnCodeFindReferences OnFindReferencesCallback;
+  FOnCodeRenameSymbol OnRenameSymbolCallback;
   bool bIsUpdatingText = false;
+  bool bIsReadOnly = false;
+
+  /** Set while an edit typed here is applied; the editor already shows it */
+  bool bIsTypingEdit = false;
 };
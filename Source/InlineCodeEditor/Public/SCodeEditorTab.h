@@ -6,13 +6,44 @@
 #include "Widgets/Docking/SDockTab.h"
 #include "Widgets/SCompoundWidget.h"
 
+class FCodeDocument;
+class FCodeSymbolIndex;
+class SBox;
 class SCodeEditableText;
+class SCodeFindBar;
+class SCodePeekView;
 class SEditableTextBox;
+class SHorizontalBox;
+class SSplitter;
 class STextBlock;
+struct FCodeRenameResult;
+struct FCodeSymbolLocation;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCodeFileSaved,
+                                    const FString & /*FilePath*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCodeReferencesRequested,
+                                    const FString & /*Identifier*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCodeRenameRequested,
+                                    const FString & /*Identifier*/);
 
 /**
  * Inline code editor tab using native Slate widgets
- * Features: Toolbar, code editor with line numbers, status bar
+ * Features: Toolbar, document tabs, code editor, status bar
+ *
+ * Every open document keeps its buffer, token cache and fold state. View
+ * widgets (and the text layouts they build) are kept alive for recently
+ * viewed documents so switching is instant, and evicted least recently
+ * viewed first once they exceed ICE.Editor.LayoutBudgetMB.
+ *
+ * The editor area can be split into panes. Panes showing the same document
+ * each have their own view (cursor, folds, scroll) of the one shared buffer
+ * and analysis.
+ *
+ * Ctrl+F and Ctrl+H open an SCodeFindBar on the active pane's view.
+ *
+ * F12 and Ctrl+click go to the declaration of a name, found in the symbol
+ * index; Alt+F12 shows its declarations in an SCodePeekView instead.
+ * Shift+F12 asks the owner to list its uses, and F2 to rename it.
  */
 class SCodeEditorTab : public SCompoundWidget {
 public:
@@ -25,50 +56,183 @@ public:
   /** Set the parent dock tab for visibility tracking */
   void SetParentTab(TSharedPtr<SDockTab> InTab) { ParentTab = InTab; }
 
-  /** Open a file in the editor */
+  /** Open a file in the editor (or switch to it if already open) */
   void OpenFile(const FString &FilePath);
 
   /** Get the current file path */
-  FString GetCurrentFilePath() const { return CurrentFilePath; }
+  FString GetCurrentFilePath() const;
 
   /** Save the current file */
   bool SaveFile();
 
+  /** Broadcast after a document is saved to its file */
+  FOnCodeFileSaved &OnFileSaved() { return FileSavedEvent; }
+
+  /** Broadcast with a name whose uses are asked for */
+  FOnCodeReferencesRequested &OnFindReferences() {
+    return FindReferencesEvent;
+  }
+
+  /** Broadcast with a name the user asked to rename */
+  FOnCodeRenameRequested &OnRenameSymbol() { return RenameSymbolEvent; }
+
   /** Check if current file has unsaved changes */
   bool HasUnsavedChanges() const;
 
+  /** Move the cursor to a line (1-based) of the active document */
+  void GoToLine(int32 LineNumber);
+
+  /** Show an open document in the active pane */
+  void ActivateDocument(TSharedPtr<FCodeDocument> Document);
+
+  /** Close an open document, asking first if it has unsaved changes */
+  void CloseDocument(TSharedPtr<FCodeDocument> Document);
+
+  /** Split the editor area, showing the active document in both panes */
+  void SplitEditor(EOrientation Orientation);
+
+  /** Close every pane but the active one */
+  void UnsplitEditor();
+
+  /** Show the find bar on the active view, with its replace row if asked */
+  void ShowFindBar(bool bReplace);
+
+  /** Hide the find bar and return to the text */
+  void HideFindBar();
+
+  /** Index used to find declarations; null turns go to definition off */
+  void
+  SetSymbolIndex(TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> InIndex);
+
+  /**
+   * Open the declaration of a name, or with bPeek show its declarations
+   * over the editor
+   */
+  void GoToDefinition(const FString &Identifier, bool bPeek);
+
+  /** Hide the peek popup and return to the text */
+  void HidePeek();
+
+  /** Ask for the uses of a name to be listed */
+  void FindReferences(const FString &Identifier);
+
+  /** Ask for a name to be renamed wherever it is used */
+  void RenameSymbol(const FString &Identifier);
+
+  /**
+   * Rename the uses of OldName in the open source documents below RootPath,
+   * each as one undo step. The uses are found in the buffers, so unsaved
+   * edits are renamed too. OutOpenFiles is set to the root-relative paths
+   * of every open document below RootPath, renamed or not.
+   */
+  FCodeRenameResult RenameInDocuments(const FString &RootPath,
+                                      const FString &OldName,
+                                      const FString &NewName,
+                                      TArray<FString> &OutOpenFiles);
+
+  virtual FReply OnKeyDown(const FGeometry &MyGeometry,
+                           const FKeyEvent &InKeyEvent) override;
+
 private:
+  /** One side of a split editor area */
+  struct FEditorPane {
+    /** Container the pane's current view is placed in */
+    TSharedPtr<SBox> Host;
+
+    /** Document shown in this pane */
+    TSharedPtr<FCodeDocument> Document;
+
+    /** Live views of documents recently viewed in this pane */
+    TMap<TSharedPtr<FCodeDocument>, TSharedPtr<SCodeEditableText>> Views;
+  };
+
   /** Create the toolbar widget */
   TSharedRef<SWidget> CreateToolbar();
 
+  /** Create the row of open document tabs */
+  TSharedRef<SWidget> CreateDocumentTabBar();
+
   /** Create the status bar widget */
   TSharedRef<SWidget> CreateStatusBar();
 
+  /** Rebuild the document tab buttons */
+  void RebuildDocumentTabs();
+
+  /** Add a new document and show it */
+  void AddDocument(TSharedRef<FCodeDocument> Document);
+
+  /** Find an open document by file path */
+  TSharedPtr<FCodeDocument> FindDocument(const FString &FilePath) const;
+
+  /** Add an empty pane to the splitter */
+  FEditorPane &AddPane();
+
+  /** Make a pane the target of document switches, saves and go to line */
+  void SetActivePane(int32 PaneIndex);
+
+  /** Show a document in a pane */
+  void ShowDocumentInPane(int32 PaneIndex, TSharedPtr<FCodeDocument> Document);
+
+  /** Get a pane's live view of a document, building it if it was evicted */
+  TSharedRef<SCodeEditableText>
+  GetOrCreateView(int32 PaneIndex, TSharedRef<FCodeDocument> Document);
+
+  /** Evict views, least recently viewed first, until within budget */
+  void EnforceLayoutBudget();
+
+  /** Release a pane's view of a document, keeping its fold/cursor state */
+  void EvictView(int32 PaneIndex, TSharedPtr<FCodeDocument> Document);
+
   /** Handle new file button */
   FReply OnNewFileClicked();
 
   /** Handle save button */
   FReply OnSaveClicked();
 
-  /** Handle text changed in editor */
-  void OnTextChanged(const FText &NewText);
+  /** Whether the symbol index can find uses; says why not if it cannot */
+  bool CanFindReferences();
+
+  /** Open a declaration found in the symbol index at its line */
+  void OpenSymbolLocation(const FCodeSymbolLocation &Location);
 
-  /** Handle cursor position changed */
-  void OnCursorMoved();
+  /** Open document holding a declaration, or a scratch one read from disk */
+  TSharedPtr<FCodeDocument>
+  GetSymbolLocationDocument(const FCodeSymbolLocation &Location) const;
+
+  /** Handle cursor position changed in a pane's view */
+  void OnCursorMoved(TWeakPtr<SBox> WeakPaneHost);
 
   /** Update status bar text */
   void UpdateStatusBar();
 
+  /** Update the language shown in the status bar */
+  void UpdateLanguageDisplay();
+
 private:
-  /** The code editor widget */
+  /** View of the active document in the active pane */
   TSharedPtr<SCodeEditableText> CodeEditor;
 
+  /** Splitter holding the editor panes */
+  TSharedPtr<SSplitter> PaneSplitter;
+
+  /** Editor panes, in splitter order */
+  TArray<FEditorPane> Panes;
+
+  /** Pane that has focus */
+  int32 ActivePane = 0;
+
+  /** Row of document tab buttons */
+  TSharedPtr<SHorizontalBox> DocumentTabBar;
+
+  /** Open documents, in tab order */
+  TArray<TSharedPtr<FCodeDocument>> Documents;
+
+  /** Document shown in the active pane */
+  TSharedPtr<FCodeDocument> ActiveDocument;
+
   /** Parent dock tab reference */
   TWeakPtr<SDockTab> ParentTab;
 
-  /** Currently open file path */
-  FString CurrentFilePath;
-
   /** Status bar line/column text */
   TSharedPtr<STextBlock> StatusLineColumn;
 
@@ -81,6 +245,23 @@ private:
   /** Go to line input box */
   TSharedPtr<SEditableTextBox> GoToLineInput;
 
-  /** Whether there are unsaved changes */
-  bool bHasUnsavedChanges = false;
+  /** Find and replace bar, and whether it is shown */
+  TSharedPtr<SCodeFindBar> FindBar;
+  bool bFindBarVisible = false;
+
+  /** Declarations of the source below the project root */
+  TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> SymbolIndex;
+
+  /** Popup showing declarations over the editor, and whether it is shown */
+  TSharedPtr<SCodePeekView> PeekView;
+  bool bPeekVisible = false;
+
+  /** Broadcast by SaveFile */
+  FOnCodeFileSaved FileSavedEvent;
+
+  /** Broadcast by FindReferences */
+  FOnCodeReferencesRequested FindReferencesEvent;
+
+  /** Broadcast by RenameSymbol */
+  FOnCodeRenameRequested RenameSymbolEvent;
 };
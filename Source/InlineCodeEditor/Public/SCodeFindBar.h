@@ -0,0 +1,104 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+
+class FCodeDocument;
+class FCodeFindResults;
+class SCodeEditableText;
+class SEditableTextBox;
+struct FCodeTextEdit;
+
+/**
+ * Ctrl+F find and Ctrl+H replace bar of the code editor, searching the
+ * document of one view with an FCodeFindResults.
+ *
+ * Matches are found again on every keystroke in the query box, only
+ * rechecking the previous matches while a literal query grows, and follow
+ * the document as it is edited. The view paints just the matches on screen.
+ * Replace All applies every replacement as one edit, so it is one undo
+ * step; a regular expression's matches are replaced by the literal text.
+ */
+class SCodeFindBar : public SCompoundWidget {
+public:
+  SLATE_BEGIN_ARGS(SCodeFindBar) {}
+  /** Called when the bar asks to be closed */
+  SLATE_EVENT(FSimpleDelegate, OnClosed)
+  SLATE_END_ARGS()
+
+  void Construct(const FArguments &InArgs);
+  virtual ~SCodeFindBar() override;
+
+  /** Search the document of another view; null searches nothing */
+  void SetTarget(TSharedPtr<SCodeEditableText> InView);
+
+  /** Focus the query box, selecting its text */
+  void FocusQuery(bool bInShowReplace);
+
+private:
+  /** Find the query in the document again, optionally selecting the
+   *  match nearest after the cursor */
+  void UpdateMatches(bool bSelectNearest);
+
+  /** Keep the matches on the same text after an edit */
+  void HandleDocumentEdited(const FCodeTextEdit &Edit);
+
+  /** Make a match current and select it in the view */
+  void SelectMatch(int32 Index);
+
+  /** Select the match after, or before, the cursor */
+  void FindNext(bool bBackward);
+
+  /** Replace the current match and go to the next one */
+  void Replace();
+
+  /** Replace every match in one edit */
+  void ReplaceAll();
+
+  /** Toggle button for a search option, searching again when flipped */
+  TSharedRef<SWidget> MakeOptionToggle(bool &bOption, const FText &Label,
+                                       const FText &ToolTip);
+
+  /** Hand the matches to the view to paint */
+  void UpdateHighlights();
+
+  /** Match count, position or query error */
+  FText GetStatusText() const;
+
+  /** Enter finds the next match, Shift+Enter the previous one */
+  FReply OnQueryKeyDown(const FGeometry &MyGeometry,
+                        const FKeyEvent &InKeyEvent);
+
+  /** Enter replaces the current match */
+  FReply OnReplaceKeyDown(const FGeometry &MyGeometry,
+                          const FKeyEvent &InKeyEvent);
+
+  /** View searched, and its document */
+  TWeakPtr<SCodeEditableText> View;
+  TSharedPtr<FCodeDocument> Document;
+  FDelegateHandle DocumentEditedHandle;
+
+  /** Matches of the query in the document */
+  TSharedPtr<FCodeFindResults> Results;
+
+  /** Match selected in the view; INDEX_NONE before one is */
+  int32 CurrentMatch = INDEX_NONE;
+
+  /** Search options */
+  bool bMatchCase = false;
+  bool bWholeWord = false;
+  bool bRegex = false;
+
+  /** Whether the replace row is shown */
+  bool bShowReplace = false;
+
+  /** Why the query cannot be searched for, if it is an invalid pattern */
+  FText QueryError;
+
+  TSharedPtr<SEditableTextBox> QueryBox;
+  TSharedPtr<SEditableTextBox> ReplaceBox;
+
+  FSimpleDelegate OnClosed;
+};
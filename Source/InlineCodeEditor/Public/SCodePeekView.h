@@ -0,0 +1,76 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CodeSymbolIndex.h"
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+
+class FCodeDocument;
+class SBox;
+class STextBlock;
+
+DECLARE_DELEGATE_RetVal_OneParam(TSharedPtr<FCodeDocument>,
+                                 FOnCodePeekGetDocument,
+                                 const FCodeSymbolLocation & /*Location*/);
+DECLARE_DELEGATE_OneParam(FOnCodePeekOpen,
+                          const FCodeSymbolLocation & /*Location*/);
+
+/**
+ * Alt+F12 popup of the code editor, showing the lines around the
+ * declarations of a name without leaving the current file.
+ *
+ * Only the lines around one declaration are laid out, highlighted through
+ * the tokenizer of the document holding them. That is the open document's
+ * when there is one, or a scratch document seeded from FCodeAnalysisCache,
+ * so the lines usually come from cached tokens rather than being lexed.
+ */
+class SCodePeekView : public SCompoundWidget {
+public:
+  SLATE_BEGIN_ARGS(SCodePeekView) {}
+  /** Called for the document holding a declaration; null if unreadable */
+  SLATE_EVENT(FOnCodePeekGetDocument, OnGetDocument)
+  /** Called to open a declaration in the editor */
+  SLATE_EVENT(FOnCodePeekOpen, OnOpen)
+  /** Called when the popup asks to be closed */
+  SLATE_EVENT(FSimpleDelegate, OnClosed)
+  SLATE_END_ARGS()
+
+  void Construct(const FArguments &InArgs);
+
+  /** Show the declarations of Name, starting with the first */
+  void SetLocations(const FString &InName,
+                    TArray<FCodeSymbolLocation> &&InLocations);
+
+  /** Show the declaration after, or before, the current one */
+  void ShowNext(bool bBackward);
+
+  /** Open the declaration shown in the editor */
+  void OpenCurrent();
+
+  virtual FReply OnKeyDown(const FGeometry &MyGeometry,
+                           const FKeyEvent &InKeyEvent) override;
+
+private:
+  /** Lay out the lines around a declaration */
+  void ShowLocation(int32 Index);
+
+  /** Path and line of the declaration shown, and its position */
+  FText GetHeaderText() const;
+
+  FOnCodePeekGetDocument OnGetDocument;
+  FOnCodePeekOpen OnOpen;
+  FSimpleDelegate OnClosed;
+
+  /** Name peeked, and where it is declared */
+  FString Name;
+  TArray<FCodeSymbolLocation> Locations;
+  int32 CurrentLocation = INDEX_NONE;
+
+  /** Document of the declaration shown, kept for its token cache */
+  TSharedPtr<FCodeDocument> Document;
+
+  /** Line numbers of the lines shown, and the box holding their text */
+  TSharedPtr<STextBlock> LineNumbers;
+  TSharedPtr<SBox> TextHost;
+};
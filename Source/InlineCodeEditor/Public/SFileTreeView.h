@@ -2,35 +2,82 @@
 
 #pragma once
 
+#include "CaseSensitiveKeyFuncs.h"
 #include "CoreMinimal.h"
 #include "FileTreeIconManager.h"
+#include "HAL/ThreadSafeBool.h"
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/Views/STreeView.h"
 
+class FFileTreeGitStatus;
+class FFileTreeItem;
+class FFileTreePathIndex;
+class SSearchBox;
+struct FFileChangeData;
+struct FFileTreeIgnoreScope;
+
 DECLARE_DELEGATE_OneParam(FOnFileSelected, const FString & /*FilePath*/);
 DECLARE_DELEGATE(FOnSimpleAction);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnFileTreeFilesChanged,
+                                    const TArray<FString> & /*RelativePaths*/);
+
+/**
+ * State of a directory while a background listing fills its children
+ */
+struct FFileTreeListing {
+  /** Set to cancel the listing */
+  TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> Cancelled;
+
+  /**
+   * Children from an earlier listing that this one has not found yet, by
+   * name, told apart by case. Whatever is left when it finishes no longer
+   * exists.
+   */
+  TMap<FString, TSharedPtr<FFileTreeItem>, FDefaultSetAllocator,
+       TCaseSensitiveKeyFuncs<TSharedPtr<FFileTreeItem>>>
+      StaleChildren;
+
+  /** Whether a "Loading..." row is shown; not while earlier children are */
+  bool bShowLoadingRow = true;
+};
 
 /**
  * Represents a single item in the file tree (file or folder)
+ *
+ * Browsing large trees creates hundreds of thousands of items, so they are
+ * kept small: names are interned FNames, the full path is rebuilt from the
+ * parent chain on demand, and listing state only exists while a listing is
+ * in flight.
  */
 class FFileTreeItem : public TSharedFromThis<FFileTreeItem> {
 public:
-  FFileTreeItem(const FString &InPath, const FString &InName,
-                bool bInIsDirectory)
-      : Path(InPath), DisplayName(InName), bIsDirectory(bInIsDirectory),
-        bIsExpanded(false) {}
-
-  /** Full path to this item */
-  FString Path;
+  FFileTreeItem(FName InName, bool bInIsDirectory)
+      : Name(InName), bIsDirectory(bInIsDirectory), bIsExpanded(false),
+        bIsPlaceholder(false), bIsExcluded(false), bChildrenLoaded(false) {}
 
-  /** Display name shown in the tree */
-  FString DisplayName;
+  /** Path segment of this item; the full path for the root item */
+  FName Name;
 
   /** Whether this is a directory */
-  bool bIsDirectory;
+  uint8 bIsDirectory : 1;
 
   /** Whether the directory is expanded */
-  bool bIsExpanded;
+  uint8 bIsExpanded : 1;
+
+  /** Whether this is the "Loading..." row of a directory being listed */
+  uint8 bIsPlaceholder : 1;
+
+  /** Whether exclusion rules match this item; such folders are never listed */
+  uint8 bIsExcluded : 1;
+
+  /** Icon of a file, resolved from its extension when first drawn */
+  FFileTreeIconManager::FIconIndex IconIndex = FFileTreeIconManager::NoIcon;
+
+  /** File size in bytes, from the directory listing (-1 for directories) */
+  int64 Size = -1;
+
+  /** Last modification time, from the directory listing */
+  FDateTime ModificationTime;
 
   /** Child items (for directories) */
   TArray<TSharedPtr<FFileTreeItem>> Children;
@@ -38,9 +85,14 @@ public:
   /** Parent item */
   TWeakPtr<FFileTreeItem> Parent;
 
-  /** Get file extension */
-  FString GetExtension() const {
-    return bIsDirectory ? TEXT("") : FPaths::GetExtension(Path).ToLower();
+  /** Listing in flight for this directory, if any */
+  TUniquePtr<FFileTreeListing> Listing;
+
+  /** Full path to this item, rebuilt from the parent chain */
+  FString GetPath() const {
+    const TSharedPtr<FFileTreeItem> ParentItem = Parent.Pin();
+    return ParentItem.IsValid() ? ParentItem->GetPath() / Name.ToString()
+                                : Name.ToString();
   }
 
   /** Check if children have been loaded */
@@ -49,13 +101,57 @@ public:
   /** Mark children as loaded */
   void SetChildrenLoaded(bool bLoaded) { bChildrenLoaded = bLoaded; }
 
+  /** Check if a background listing of this directory is in flight */
+  bool IsLoadingChildren() const { return Listing.IsValid(); }
+
 private:
-  bool bChildrenLoaded = false;
+  uint8 bChildrenLoaded : 1;
+};
+
+/**
+ * One directory entry found by a background listing
+ */
+struct FFileTreeEntry {
+  FName Name;
+  bool bIsDirectory = false;
+  bool bIsExcluded = false;
+  int64 Size = -1;
+  FDateTime ModificationTime;
+};
+
+/**
+ * A root-relative path added or removed on disk, waiting to be stat'ed by
+ * the next path index update
+ */
+struct FFileTreePathChange {
+  /** Whether the exclusion rules let it be indexed as a file */
+  bool bMayBeFile = false;
+
+  /** Whether it was added, and would be walked if it is a folder */
+  bool bMayBeAddedFolder = false;
 };
 
 /**
  * File tree view widget for browsing project files
  * Provides a VSCode-like file explorer experience
+ *
+ * The root is watched with IDirectoryWatcher and changes in expanded
+ * folders are applied to the existing nodes, so expansion and selection
+ * survive and updates cost what changed rather than what is shown.
+ * Refreshing re-lists loaded folders and reconciles them the same way.
+ *
+ * Entries matching ICE.FileTree.ExcludePatterns or a .gitignore/.p4ignore
+ * rule are shown dimmed; excluded folders are stubs that are never listed.
+ *
+ * The tree is saved as an FFileTreeSnapshot when the view goes away and
+ * drawn from it on the next open, then validated against disk.
+ *
+ * The filter box matches against an FFileTreePathIndex of the whole root,
+ * built in the background on first use, and shows only matching branches.
+ * Once built, the index follows files being added and removed.
+ *
+ * Inside a git work tree, names are colored by FFileTreeGitStatus as
+ * modified, untracked or ignored.
  */
 class SFileTreeView : public SCompoundWidget {
 public:
@@ -74,29 +170,127 @@ public:
   SLATE_END_ARGS()
 
   void Construct(const FArguments &InArgs);
+  virtual ~SFileTreeView() override;
 
   /** Set the root path and refresh the tree */
   void SetRootPath(const FString &NewRootPath);
 
-  /** Refresh the entire tree from disk */
+  /** Re-list every loaded folder, keeping expansion and selection */
   void RefreshTree();
 
-  /** Expand all folders */
+  /**
+   * Expand all folders. Runs as an incremental job over several frames,
+   * bounded by ICE.FileTree.ExpandAllMaxNodes; symlinked folders are not
+   * followed.
+   */
   void ExpandAll();
 
-  /** Collapse all folders */
+  /** Collapse all folders, stopping an expand-all job in progress */
   void CollapseAll();
 
   /** Get currently selected file path (empty if none or folder selected) */
   FString GetSelectedFilePath() const;
 
+  /** Show only files whose path fuzzily matches Text; empty clears it */
+  void SetFilterText(const FString &Text);
+
+  /**
+   * Index of every file below the root. Starts building it if needed and
+   * is null until it is built; OnPathIndexChanged() tells when.
+   */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> GetPathIndex();
+
+  /** Broadcast when the path index is built or updated */
+  FSimpleMulticastDelegate &OnPathIndexChanged() {
+    return PathIndexChangedEvent;
+  }
+
+  /** Broadcast with the indexed files seen being added or modified */
+  FOnFileTreeFilesChanged &OnFilesChanged() { return FilesChangedEvent; }
+
 private:
-  /** Build tree items from a directory */
+  /**
+   * Build tree items from a directory, starting from its snapshot when
+   * there is one
+   */
   void BuildTreeFromDirectory(const FString &DirectoryPath);
 
-  /** Populate children for a directory item */
+  /** Save the snapshot of the current tree */
+  void SaveSnapshot() const;
+
+  /**
+   * Start listing a directory item on a background thread. Its children
+   * stream in batches; a "Loading..." row is shown until the last one.
+   */
   void PopulateChildren(TSharedPtr<FFileTreeItem> DirectoryItem);
 
+  /** Merge a batch of listed entries into a directory item */
+  void ApplyEnumerationBatch(TSharedRef<FFileTreeItem> DirectoryItem,
+                             TArray<FFileTreeEntry> Batch, bool bIsFinal);
+
+  /** Cancel a directory's listing, keeping what it had loaded so far */
+  void CancelEnumeration(TSharedPtr<FFileTreeItem> DirectoryItem);
+
+  /** Cancel every listing in flight */
+  void CancelAllEnumerations();
+
+  /** Remove a child that no longer exists on disk */
+  void RemoveChild(TSharedPtr<FFileTreeItem> DirectoryItem,
+                   TSharedPtr<FFileTreeItem> Child);
+
+  /** Sort children alphabetically, directories first */
+  static void SortChildren(TArray<TSharedPtr<FFileTreeItem>> &Children);
+
+  /** Register the recursive directory watcher of the root */
+  void WatchRoot();
+
+  /** Start applying changes to a listed directory */
+  void WatchDirectory(TSharedPtr<FFileTreeItem> DirectoryItem);
+
+  /**
+   * Stop applying changes to a directory and everything below it. Their
+   * children are kept but marked stale, to be reconciled when listed again.
+   */
+  void UnwatchSubtree(TSharedPtr<FFileTreeItem> Item);
+
+  /** Unregister the root watcher and forget every watched directory */
+  void UnwatchAll();
+
+  /** Apply file changes reported by the directory watcher */
+  void OnDirectoryChanged(const TArray<FFileChangeData> &Changes);
+
+  /** Queue the file changes that affect the path index */
+  void QueuePathIndexChanges(const TArray<FFileChangeData> &Changes);
+
+  /** Whether a root-relative path is hidden or excluded */
+  bool IsPathExcluded(const FString &RelativePath, bool bIsDirectory) const;
+
+  /** Ignore rules in effect for the entries of a directory */
+  TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+  FindIgnoreScope(const FString &DirectoryPath) const;
+
+  /** Key of a directory in WatchedDirectories */
+  static FString GetWatchKey(const FString &DirectoryPath);
+
+  /** Run the expand-all job for up to a frame's budget */
+  EActiveTimerReturnType TickExpandAll(double InCurrentTime, float InDeltaTime);
+
+  /** Queue the subdirectories of a listed directory for the expand-all job */
+  void QueueExpandAllChildren(const TSharedPtr<FFileTreeItem> &DirectoryItem,
+                              int32 Depth);
+
+  /** Stop the expand-all job, leaving what it expanded so far */
+  void StopExpandAll();
+
+  /** Make the "Loading..." row for a directory */
+  static TSharedRef<FFileTreeItem>
+  MakePlaceholder(TSharedPtr<FFileTreeItem> DirectoryItem);
+
+  /** Make an unlisted item for an entry of a directory */
+  TSharedRef<FFileTreeItem>
+  MakeItem(TSharedPtr<FFileTreeItem> DirectoryItem,
+           const FFileTreeEntry &Entry);
+
   /** Generate a row for the tree view */
   TSharedRef<ITableRow>
   OnGenerateRow(TSharedPtr<FFileTreeItem> Item,
@@ -125,6 +319,37 @@ private:
   /** Get text color for an item */
   FSlateColor GetTextColorForItem(TSharedPtr<FFileTreeItem> Item) const;
 
+  /** Get the tooltip for an item: its path, size and modification time */
+  FText GetToolTipForItem(TSharedPtr<FFileTreeItem> Item) const;
+
+  /** Handle filter box edits */
+  void OnFilterTextChanged(const FText &Text);
+
+  /** Whether the tree shows filter results */
+  bool IsFiltering() const { return !FilterText.IsEmpty(); }
+
+  /** Match the filter against the path index and show the result */
+  void ApplyFilter();
+
+  /** Start building the path index, unless a build is in flight */
+  void BuildPathIndex();
+
+  /** Drop the path index, cancelling its build; rebuilt when next needed */
+  void ResetPathIndex();
+
+  /**
+   * Stat the queued changes and apply them to the path index on a
+   * background thread
+   */
+  void UpdatePathIndex();
+
+  /** Replace the path index, re-run the filter and tell listeners */
+  void SetPathIndex(
+      TSharedRef<const FFileTreePathIndex, ESPMode::ThreadSafe> Index);
+
+  /** Remake the shown rows, whose icons and colors are set when made */
+  void RedrawRows();
+
   /** Handle refresh button click */
   FReply OnRefreshClicked();
 
@@ -138,6 +363,97 @@ private:
   /** Root items in the tree */
   TArray<TSharedPtr<FFileTreeItem>> RootItems;
 
+  /** Item for the root directory; its children are RootItems */
+  TSharedPtr<FFileTreeItem> RootItem;
+
+  /** Directories with a listing in flight */
+  TArray<TWeakPtr<FFileTreeItem>> PendingEnumerations;
+
+  /** A directory the expand-all job has yet to expand or descend into */
+  struct FExpandAllEntry {
+    TSharedPtr<FFileTreeItem> Item;
+    int32 Depth = 0;
+  };
+
+  /** Directories waiting to be expanded by the expand-all job */
+  TArray<FExpandAllEntry> ExpandAllQueue;
+
+  /** Index of the next entry of ExpandAllQueue */
+  int32 ExpandAllQueueHead = 0;
+
+  /** Expanded directories whose listing the expand-all job waits for */
+  TArray<FExpandAllEntry> ExpandAllAwaiting;
+
+  /** Items the expand-all job has made visible, against its node cap */
+  int32 ExpandAllNodeCount = 0;
+
+  /** Active timer running the expand-all job, if one is in progress */
+  TSharedPtr<FActiveTimerHandle> ExpandAllTimer;
+
+  /** Exclusion globs of the current root */
+  TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>
+      DefaultIgnoreScope;
+
+  /** Rules of listed directories that have ignore files, by path */
+  TMap<FString, TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>,
+       FDefaultSetAllocator,
+       TCaseSensitiveKeyFuncs<
+           TSharedPtr<const FFileTreeIgnoreScope, ESPMode::ThreadSafe>>>
+      IgnoreScopes;
+
+  /** Root directory as registered with the directory watcher */
+  FString RootWatchPath;
+
+  /** Registration of the root with the directory watcher */
+  FDelegateHandle RootWatchHandle;
+
+  /** Listed directories whose changes are applied, by GetWatchKey */
+  TMap<FString, TWeakPtr<FFileTreeItem>, FDefaultSetAllocator,
+       TCaseSensitiveKeyFuncs<TWeakPtr<FFileTreeItem>>>
+      WatchedDirectories;
+
+  /** Current filter, trimmed; empty when not filtering */
+  FString FilterText;
+
+  /** Filter that produced FilterMatches; a longer one only narrows them */
+  FString MatchedFilterText;
+
+  /** Path index entries matching MatchedFilterText */
+  TArray<int32> FilterMatches;
+
+  /** Items shown while filtering */
+  TArray<TSharedPtr<FFileTreeItem>> FilteredRootItems;
+
+  /** Index of every file below the root, once built */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex;
+
+  /** Set to cancel the path index build in flight, if any */
+  TSharedPtr<FThreadSafeBool, ESPMode::ThreadSafe> PathIndexCancelled;
+
+  /** Root-relative paths added or removed since the path index was last
+   *  updated */
+  TMap<FString, FFileTreePathChange, FDefaultSetAllocator,
+       TCaseSensitiveKeyFuncs<FFileTreePathChange>>
+      PendingIndexChanges;
+
+  /** Set when a change needs a full walk, such as a folder moved in */
+  bool bPathIndexNeedsRebuild = false;
+
+  /** Whether a path index update is running in the background */
+  bool bPathIndexUpdating = false;
+
+  /** Broadcast when the path index is built or updated */
+  FSimpleMulticastDelegate PathIndexChangedEvent;
+
+  /** Broadcast when files below the root are added or modified */
+  FOnFileTreeFilesChanged FilesChangedEvent;
+
+  /** Git status of the work tree holding the root, if any */
+  TSharedPtr<FFileTreeGitStatus, ESPMode::ThreadSafe> GitStatus;
+
+  /** Filter box */
+  TSharedPtr<SSearchBox> FilterBox;
+
   /** The tree view widget */
   TSharedPtr<STreeView<TSharedPtr<FFileTreeItem>>> TreeView;
 
@@ -0,0 +1,187 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+class FFileTreePathIndex;
+class FFindInFilesIndex;
+class FFindInFilesSearch;
+class SEditableTextBox;
+class SSearchBox;
+struct FCodeReferences;
+struct FFindInFilesResult;
+
+DECLARE_DELEGATE_ThreeParams(FOnFindInFilesMatchChosen,
+                             const FString & /*RelativePath*/,
+                             int32 /*Line*/, int32 /*Column*/);
+DECLARE_DELEGATE_ThreeParams(FOnFindInFilesRenameAccepted,
+                             const FString & /*OldName*/,
+                             const FString & /*NewName*/,
+                             const TArray<FFindInFilesResult> & /*Files*/);
+
+/**
+ * A row of the find-in-files results: a file, or one of its matches
+ */
+struct FFindInFilesRow {
+  /** File the row belongs to */
+  TSharedPtr<FFindInFilesResult> File;
+
+  /** Match shown by the row; INDEX_NONE for the file's own row */
+  int32 MatchIndex = INDEX_NONE;
+};
+
+/**
+ * Ctrl+Shift+F search panel: finds text in every file below the file tree
+ * root with an FFindInFilesSearch and lists the matches under their files.
+ *
+ * Results are appended as the search hands them over, to a list that only
+ * builds widgets for the rows on screen. Starting a new search, changing
+ * the root or closing the panel cancels the running one. While the root's
+ * FFindInFilesIndex is ready, only the files it cannot rule out are read.
+ * Queries may be regular expressions, whose errors show in place of the
+ * status.
+ *
+ * The panel also lists the uses of a name found by an FCodeSymbolIndex,
+ * only reading the lines they are on. Listed to be renamed, they preview
+ * the rename, which is applied once a new name is entered.
+ */
+class SFindInFiles : public SCompoundWidget {
+public:
+  SLATE_BEGIN_ARGS(SFindInFiles) {}
+  /** Called with the root-relative path and position of a chosen match */
+  SLATE_EVENT(FOnFindInFilesMatchChosen, OnMatchChosen)
+  /** Called with the names and the files of the uses of an applied rename */
+  SLATE_EVENT(FOnFindInFilesRenameAccepted, OnRenameAccepted)
+  SLATE_END_ARGS()
+
+  void Construct(const FArguments &InArgs);
+  virtual ~SFindInFiles() override;
+
+  /** Search below another root, dropping the current results */
+  void SetRootPath(const FString &InRootPath);
+
+  /** Search another index; a search waiting for one starts */
+  void SetPathIndex(
+      TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> InPathIndex);
+
+  /** Whether the root has an index, kept up to date with its files */
+  bool HasIndex() const { return Index.IsValid(); }
+
+  /** Note root-relative files that were added or modified */
+  void HandleFilesChanged(const TArray<FString> &RelativePaths);
+
+  /** Focus the search box, selecting its text */
+  void FocusSearchBox();
+
+  /** List the uses of Name, in place of the results */
+  void ShowReferences(const FString &Name,
+                      TArray<FCodeReferences> &&References);
+
+  /** List the uses of Name, in place of the results, to rename them */
+  void ShowRename(const FString &Name, TArray<FCodeReferences> &&References);
+
+  /** Show a message in place of the status until the results change */
+  void ShowNotice(const FText &InNotice);
+
+private:
+  /** Search for the query, replacing the results */
+  void StartSearch();
+
+  /** Drop the results, cancelling the search finding them */
+  void ResetResults();
+
+  /** Cancel the running search, keeping what it found */
+  void StopSearch();
+
+  /** Append results handed over by the search */
+  void HandleResults(TArray<FFindInFilesResult> &&NewResults);
+
+  /** Note that the search ended */
+  void HandleFinished(bool bInReachedMaxResults);
+
+  /** Progress or summary shown above the results */
+  FText GetStatusText() const;
+
+  /** Whether the listed uses can be renamed to the entered name */
+  bool CanApplyRename() const;
+
+  /** Hand the listed uses over to be renamed */
+  void ApplyRename();
+
+  /** Handle Enter in the new name box */
+  void OnNewNameCommitted(const FText &Text, ETextCommit::Type CommitType);
+
+  /** Handle Enter in the search box */
+  void OnQueryCommitted(const FText &Text, ETextCommit::Type CommitType);
+
+  /** Generate a row for a file or a match */
+  TSharedRef<ITableRow> OnGenerateRow(TSharedPtr<FFindInFilesRow> Row,
+                                      const TSharedRef<STableViewBase> &Owner);
+
+  /** Open the clicked match, or the first match of a clicked file */
+  void OnRowClicked(TSharedPtr<FFindInFilesRow> Row);
+
+private:
+  /** Root the indexed paths are relative to */
+  FString RootPath;
+
+  /** Files to search; null while the file tree builds it */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex;
+
+  /** Trigram index of the root; null if ICE.FindInFiles.Index is off */
+  TSharedPtr<FFindInFilesIndex, ESPMode::ThreadSafe> Index;
+
+  /** Search in progress or last run */
+  TSharedPtr<FFindInFilesSearch, ESPMode::ThreadSafe> Search;
+
+  /** Whether a search waits for the path index */
+  bool bSearchPending = false;
+
+  /** Whether the last search stopped at ICE.FindInFiles.MaxResults */
+  bool bReachedMaxResults = false;
+
+  /** Whether the last search read every file, rather than being stopped */
+  bool bSearchCompleted = false;
+
+  /** Search options */
+  bool bMatchCase = false;
+  bool bWholeWord = false;
+  bool bRegex = false;
+
+  /** Why the query cannot be searched for, if it is an invalid pattern */
+  FText QueryError;
+
+  /** Name whose uses are listed; empty for search results */
+  FString ReferencesName;
+
+  /** Whether the listed uses are to be renamed */
+  bool bRenaming = false;
+
+  /** Shown in place of the status, if set */
+  FText Notice;
+
+  /** Rows of every file and match found, in arrival order */
+  TArray<TSharedPtr<FFindInFilesRow>> Rows;
+
+  /** Files with matches, and matches found */
+  int32 NumResultFiles = 0;
+  int32 NumResultMatches = 0;
+
+  /** Query box */
+  TSharedPtr<SSearchBox> SearchBox;
+
+  /** Name to rename the listed uses to */
+  TSharedPtr<SEditableTextBox> NewNameBox;
+
+  /** Result list */
+  TSharedPtr<SListView<TSharedPtr<FFindInFilesRow>>> ResultsView;
+
+  /** Callback for a chosen match */
+  FOnFindInFilesMatchChosen OnMatchChosen;
+
+  /** Callback for an applied rename */
+  FOnFindInFilesRenameAccepted OnRenameAccepted;
+};
@@ -5,14 +5,23 @@
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
 
+class FCodeSymbolIndex;
+class FFileTreePathIndex;
 class SCodeEditorTab;
 class SFileTreeView;
+class SFindInFiles;
 class SBorder;
+class SQuickOpen;
 class SSplitter;
+class SWidgetSwitcher;
+struct FFindInFilesResult;
 
 /**
  * Main IDE panel that combines the file tree and code editor
  * Provides a VSCode-like split panel experience
+ *
+ * Ctrl+P shows Quick Open over the editor to open any file below the root.
+ * Ctrl+Shift+F shows the search panel in place of the file tree.
  */
 class SIDEPanel : public SCompoundWidget {
 public:
@@ -38,6 +47,16 @@ public:
   /** Check if file tree is visible */
   bool IsFileTreeVisible() const { return bFileTreeVisible; }
 
+  /** Show Quick Open and focus its search box */
+  void ShowQuickOpen();
+
+  /** Show the search panel in the sidebar and focus its search box */
+  void ShowFindInFiles();
+
+  virtual bool SupportsKeyboardFocus() const override { return true; }
+  virtual FReply OnKeyDown(const FGeometry &MyGeometry,
+                           const FKeyEvent &InKeyEvent) override;
+
 private:
   /** Handle file double-click from file tree */
   void OnFileDoubleClicked(const FString &FilePath);
@@ -57,6 +76,42 @@ private:
   /** Update the splitter based on visibility */
   void UpdateLayout();
 
+  /** Open the file chosen in Quick Open */
+  void OnQuickOpenFileChosen(const FString &RelativePath);
+
+  /** Hide Quick Open */
+  void CloseQuickOpen();
+
+  /** Hand an updated file tree path index to Quick Open and search */
+  void HandlePathIndexChanged();
+
+  /** Have the search and symbol indexes follow the file tree's path index */
+  void RequestSearchIndex();
+
+  /** Hand the file tree's path index to the symbol index, once built */
+  void RequestSymbolIndex();
+
+  /** Tell search and the symbol index about files added or modified below
+   *  the root */
+  void HandleFilesChanged(const TArray<FString> &RelativePaths);
+
+  /** Tell search and the symbol index about a file saved in the editor */
+  void HandleFileSaved(const FString &FilePath);
+
+  /** List the uses of a name in the search panel */
+  void HandleReferencesRequested(const FString &Identifier);
+
+  /** List the uses of a name in the search panel, to rename them */
+  void HandleRenameRequested(const FString &Identifier);
+
+  /** Rename the previewed uses, in open documents and in files on disk */
+  void HandleRenameAccepted(const FString &OldName, const FString &NewName,
+                            const TArray<FFindInFilesResult> &Files);
+
+  /** Open the file of a search result at its line */
+  void OnFindInFilesMatchChosen(const FString &RelativePath, int32 Line,
+                                int32 Column);
+
 private:
   /** The file tree view widget */
   TSharedPtr<SFileTreeView> FileTreeView;
@@ -64,12 +119,25 @@ private:
   /** Container for file tree (used for visibility toggle) */
   TSharedPtr<SBorder> FileTreeContainer;
 
+  /** Switches the sidebar between the file tree and the search panel */
+  TSharedPtr<SWidgetSwitcher> SidebarSwitcher;
+
+  /** Search panel, shown in the sidebar */
+  TSharedPtr<SFindInFiles> FindInFiles;
+
+  /** Declarations of the source below the root; null if
+   *  ICE.Symbols.Index is off */
+  TSharedPtr<FCodeSymbolIndex, ESPMode::ThreadSafe> SymbolIndex;
+
   /** The code editor widget */
   TSharedPtr<SCodeEditorTab> CodeEditor;
 
   /** Main splitter for resizing between file tree and editor */
   TSharedPtr<SSplitter> MainSplitter;
 
+  /** Quick Open popup, shown over the code editor */
+  TSharedPtr<SQuickOpen> QuickOpen;
+
   /** Current root path for the file tree */
   FString RootPath;
 
@@ -0,0 +1,113 @@
+// Copyright Yureka. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SFileTreeView.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/Views/SListView.h"
+
+class FFileTreePathIndex;
+class SSearchBox;
+
+/**
+ * A file listed by Quick Open
+ */
+struct FQuickOpenResult {
+  /** Root-relative path */
+  FString Path;
+
+  /** File name, shown first */
+  FString Name;
+
+  /** Folder of the file, shown dimmed after the name */
+  FString Directory;
+
+  /** Extension of the file, for its icon */
+  FName Extension;
+};
+
+/**
+ * Ctrl+P file finder: fuzzily matches every file below the root as the
+ * query is typed and lists the best matches, best first.
+ *
+ * Matches come from the file tree's FFileTreePathIndex. Scoring runs in
+ * parallel chunks that each keep a bounded heap of their best paths, so
+ * only the shown results are ever sorted, and a query that extends the
+ * previous one only rescores its matches.
+ */
+class SQuickOpen : public SCompoundWidget {
+public:
+  SLATE_BEGIN_ARGS(SQuickOpen) {}
+  /** Called with the root-relative path of the chosen file */
+  SLATE_EVENT(FOnFileSelected, OnFileChosen)
+
+  /** Called when dismissed without choosing a file */
+  SLATE_EVENT(FOnSimpleAction, OnDismissed)
+  SLATE_END_ARGS()
+
+  void Construct(const FArguments &InArgs);
+
+  /** Clear the query and focus the search box */
+  void Open();
+
+  /** Search another index, such as one updated after files changed */
+  void
+  SetPathIndex(TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> Index);
+
+private:
+  /** Rescore the results for the query */
+  void UpdateResults();
+
+  /** Choose the selected result, or the best one if none is selected */
+  void ChooseSelected();
+
+  /** Move the selection up or down the results */
+  void MoveSelection(int32 Delta);
+
+  /** Handle query edits */
+  void OnQueryChanged(const FText &Text);
+
+  /** Handle Enter in the search box */
+  void OnQueryCommitted(const FText &Text, ETextCommit::Type CommitType);
+
+  /** Handle Up, Down and Escape in the search box */
+  FReply OnQueryKeyDown(const FGeometry &MyGeometry,
+                        const FKeyEvent &InKeyEvent);
+
+  /** Generate a row for a result */
+  TSharedRef<ITableRow>
+  OnGenerateRow(TSharedPtr<FQuickOpenResult> Result,
+                const TSharedRef<STableViewBase> &OwnerTable);
+
+  /** Handle a click on a result */
+  void OnResultClicked(TSharedPtr<FQuickOpenResult> Result);
+
+private:
+  /** Index being searched; null while it is built */
+  TSharedPtr<const FFileTreePathIndex, ESPMode::ThreadSafe> PathIndex;
+
+  /** Current query, trimmed */
+  FString Query;
+
+  /** Query that produced Matches; a longer one only narrows them */
+  FString MatchedQuery;
+
+  /** Every path index entry matching MatchedQuery */
+  TArray<int32> Matches;
+
+  /** Best matches, best first */
+  TArray<TSharedPtr<FQuickOpenResult>> Results;
+
+  /** Query box */
+  TSharedPtr<SSearchBox> SearchBox;
+
+  /** Result list */
+  TSharedPtr<SListView<TSharedPtr<FQuickOpenResult>>> ResultsView;
+
+  /** Callback for a chosen file */
+  FOnFileSelected OnFileChosen;
+
+  /** Callback for dismissal */
+  FOnSimpleAction OnDismissed;
+};